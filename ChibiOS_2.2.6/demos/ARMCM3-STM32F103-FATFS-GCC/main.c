@@ -126,42 +126,6 @@ static void cmd_mem(BaseChannel *chp, int argc, char *argv[]) {
   shellPrintLine(chp, buf);
 }
 
-static void cmd_threads(BaseChannel *chp, int argc, char *argv[]) {
-  static const char *states[] = {
-    "READY",
-    "CURRENT",
-    "SUSPENDED",
-    "WTSEM",
-    "WTMTX",
-    "WTCOND",
-    "SLEEPING",
-    "WTEXIT",
-    "WTOREVT",
-    "WTANDEVT",
-    "SNDMSG",
-    "WTMSG",
-    "FINAL"
-  };
-  Thread *tp;
-  char buf[60];
-
-  (void)argv;
-  if (argc > 0) {
-    shellPrintLine(chp, "Usage: threads");
-    return;
-  }
-  shellPrintLine(chp, "    addr    stack prio refs     state time");
-  tp = chRegFirstThread();
-  do {
-    siprintf(buf, "%8lx %8lx %4u %4i %9s %u",
-             (uint32_t)tp, (uint32_t)tp->p_ctx.r13,
-             (unsigned int)tp->p_prio, tp->p_refs - 1,
-             states[tp->p_state], (unsigned int)tp->p_time);
-    shellPrintLine(chp, buf);
-    tp = chRegNextThread(tp);
-  } while (tp != NULL);
-}
-
 static void cmd_test(BaseChannel *chp, int argc, char *argv[]) {
   Thread *tp;
 
@@ -209,7 +173,6 @@ static void cmd_tree(BaseChannel *chp, int argc, char *argv[]) {
 
 static const ShellCommand commands[] = {
   {"mem", cmd_mem},
-  {"threads", cmd_threads},
   {"test", cmd_test},
   {"tree", cmd_tree},
   {NULL, NULL}
@@ -66,6 +66,40 @@
 #define CH_TIME_QUANTUM                 20
 #endif
 
+/**
+ * @brief   Tickless mode.
+ * @details If enabled then the periodic system tick is not used, the
+ *          virtual timers are served by a one-shot alarm programmed on the
+ *          next deadline and the system time is read from a free-running
+ *          counter running at @p CH_FREQUENCY.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires a port supporting the tickless mode.
+ * @note    Requires @p CH_TIME_QUANTUM set to zero and
+ *          @p CH_DBG_THREADS_PROFILING disabled, both depend on the
+ *          periodic tick.
+ */
+#if !defined(CH_USE_TICKLESS) || defined(__DOXYGEN__)
+#define CH_USE_TICKLESS                 FALSE
+#endif
+
+/**
+ * @brief   Virtual timers wheel.
+ * @details If enabled then the virtual timers are kept in a hierarchical
+ *          timer wheel instead of a delta list, arming and disarming a
+ *          timer take a constant time regardless of the number of armed
+ *          timers.
+ *
+ * @note    The default is @p FALSE.
+ * @note    The wheel costs two pointers for each slot, 384 slots with the
+ *          default settings, it is worth enabling only in systems with many
+ *          concurrent timeouts.
+ * @note    Not compatible with @p CH_USE_TICKLESS.
+ */
+#if !defined(CH_USE_VT_WHEEL) || defined(__DOXYGEN__)
+#define CH_USE_VT_WHEEL                 FALSE
+#endif
+
 /**
  * @brief   Nested locks.
  * @details If enabled then the use of nested @p chSysLock() / @p chSysUnlock()
@@ -129,6 +163,22 @@
 #define CH_OPTIMIZE_SPEED               TRUE
 #endif
 
+/**
+ * @brief   Indexed ready list.
+ * @details If enabled then the ready list is indexed by a priorities bitmap
+ *          and a per-priority tail pointer, threads insertion becomes O(1)
+ *          regardless of the number of ready threads.
+ *
+ * @note    The index costs about one pointer per priority level, it is
+ *          worth enabling only in systems with many ready threads.
+ * @note    Ports capturing the scheduler functions must maintain the
+ *          index, see @p readylist_insert() and @p readylist_remove().
+ * @note    The default is @p FALSE.
+ */
+#if !defined(CH_OPTIMIZED_READYLIST) || defined(__DOXYGEN__)
+#define CH_OPTIMIZED_READYLIST          FALSE
+#endif
+
 /**
  * @brief   Exotic optimization.
  * @details If defined then a CPU register is used as storage for the global
@@ -218,6 +268,21 @@
 #define CH_USE_MUTEXES                  TRUE
 #endif
 
+/**
+ * @brief   Priority ceiling mutexes APIs.
+ * @details If enabled then the @p chMtxInitCeiling() API is included in the
+ *          kernel and the mutexes can use the immediate priority ceiling
+ *          protocol.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_USE_MUTEXES.
+ * @note    Enabling this option adds a priority field to the @p Mutex
+ *          structure.
+ */
+#if !defined(CH_USE_MUTEXES_CEILING) || defined(__DOXYGEN__)
+#define CH_USE_MUTEXES_CEILING          TRUE
+#endif
+
 /**
  * @brief   Conditional Variables APIs.
  * @details If enabled then the conditional variables APIs are included
@@ -309,6 +374,33 @@
 #define CH_USE_QUEUES                   TRUE
 #endif
 
+/**
+ * @brief   I/O Queues bulk transfers chunk size.
+ * @details Maximum number of bytes moved by @p chIQReadTimeout() and
+ *          @p chOQWriteTimeout() within a single critical section, the
+ *          data is copied in contiguous chunks instead of byte by byte.
+ *          Bigger values improve the throughput at the cost of a longer
+ *          critical section.
+ *
+ * @note    The default is 16.
+ * @note    The value 1 selects the byte by byte transfer.
+ */
+#if !defined(CH_QUEUES_MAX_CHUNK) || defined(__DOXYGEN__)
+#define CH_QUEUES_MAX_CHUNK             16
+#endif
+
+/**
+ * @brief   Single producer single consumer rings APIs.
+ * @details If enabled then the lock-free rings APIs are included in the
+ *          kernel.
+ *
+ * @note    The default is @p TRUE.
+ * @note    Requires @p CH_USE_SEMAPHORES.
+ */
+#if !defined(CH_USE_RINGS) || defined(__DOXYGEN__)
+#define CH_USE_RINGS                    TRUE
+#endif
+
 /**
  * @brief   Core Memory Manager APIs.
  * @details If enabled then the core memory manager APIs are included
@@ -348,6 +440,20 @@
 #define CH_USE_MALLOC_HEAP              FALSE
 #endif
 
+/**
+ * @brief   TLSF heap allocator.
+ * @details If enabled then the heap allocator uses a two-level segregated
+ *          fit (TLSF) strategy instead of first-fit, allocation and release
+ *          of blocks take a bounded time regardless of the heap state.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_USE_HEAP.
+ * @note    Not compatible with @p CH_USE_MALLOC_HEAP.
+ */
+#if !defined(CH_USE_HEAP_TLSF) || defined(__DOXYGEN__)
+#define CH_USE_HEAP_TLSF                FALSE
+#endif
+
 /**
  * @brief   Memory Pools Allocator APIs.
  * @details If enabled then the memory pools allocator APIs are included
@@ -359,6 +465,18 @@
 #define CH_USE_MEMPOOLS                 TRUE
 #endif
 
+/**
+ * @brief   Memory Pools magazines APIs.
+ * @details If enabled then the per-thread memory pool magazines APIs are
+ *          included in the kernel.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_USE_MEMPOOLS.
+ */
+#if !defined(CH_USE_POOL_MAGAZINES) || defined(__DOXYGEN__)
+#define CH_USE_POOL_MAGAZINES           FALSE
+#endif
+
 /**
  * @brief   Dynamic Threads APIs.
  * @details If enabled then the dynamic threads creation APIs are included
@@ -401,8 +519,9 @@
 
 /**
  * @brief   Debug option, trace buffer.
- * @details If enabled then the context switch circular trace buffer is
- *          activated.
+ * @details If enabled then the kernel events circular trace buffer is
+ *          activated. Context switches, interrupts, semaphores, mutexes,
+ *          mailboxes and virtual timers events are recorded.
  *
  * @note    The default is @p FALSE.
  */
@@ -410,6 +529,14 @@
 #define CH_DBG_ENABLE_TRACE             FALSE
 #endif
 
+/**
+ * @brief   Trace buffer entries.
+ * @details Large enough to absorb the bursts while the trace is streamed.
+ */
+#if !defined(TRACE_BUFFER_SIZE) || defined(__DOXYGEN__)
+#define TRACE_BUFFER_SIZE               4096
+#endif
+
 /**
  * @brief   Debug option, stack checks.
  * @details If enabled then a runtime stack check is performed.
@@ -449,6 +576,22 @@
 #define CH_DBG_THREADS_PROFILING        TRUE
 #endif
 
+/**
+ * @brief   Debug option, threads accounting.
+ * @details If enabled then the time spent by each thread is measured on
+ *          the context switches using the port realtime counter, the
+ *          number of switches and the longest uninterrupted run are also
+ *          recorded.
+ *
+ * @note    The default is @p TRUE.
+ * @note    Requires a port supporting the realtime counter.
+ * @note    The time spent serving interrupts is charged to the interrupted
+ *          thread.
+ */
+#if !defined(CH_DBG_THREADS_ACCOUNTING) || defined(__DOXYGEN__)
+#define CH_DBG_THREADS_ACCOUNTING       TRUE
+#endif
+
 /*===========================================================================*/
 /* Kernel hooks.                                                             */
 /*===========================================================================*/
@@ -51,28 +51,36 @@
  * @brief   Enables the ADC subsystem.
  */
 #if !defined(HAL_USE_ADC) || defined(__DOXYGEN__)
+#if defined(__linux__)
+#define HAL_USE_ADC                 TRUE
+#else
 #define HAL_USE_ADC                 FALSE
 #endif
+#endif
 
 /**
  * @brief   Enables the CAN subsystem.
  */
 #if !defined(HAL_USE_CAN) || defined(__DOXYGEN__)
-#define HAL_USE_CAN                 FALSE
+#define HAL_USE_CAN                 TRUE
 #endif
 
 /**
  * @brief   Enables the MAC subsystem.
  */
 #if !defined(HAL_USE_MAC) || defined(__DOXYGEN__)
+#if defined(__linux__)
+#define HAL_USE_MAC                 TRUE
+#else
 #define HAL_USE_MAC                 FALSE
 #endif
+#endif
 
 /**
  * @brief   Enables the MMC_SPI subsystem.
  */
 #if !defined(HAL_USE_MMC_SPI) || defined(__DOXYGEN__)
-#define HAL_USE_MMC_SPI             FALSE
+#define HAL_USE_MMC_SPI             TRUE
 #endif
 
 /**
@@ -93,14 +101,14 @@
  * @brief   Enables the SPI subsystem.
  */
 #if !defined(HAL_USE_SPI) || defined(__DOXYGEN__)
-#define HAL_USE_SPI                 FALSE
+#define HAL_USE_SPI                 TRUE
 #endif
 
 /**
  * @brief   Enables the UART subsystem.
  */
 #if !defined(HAL_USE_UART) || defined(__DOXYGEN__)
-#define HAL_USE_UART                FALSE
+#define HAL_USE_UART                TRUE
 #endif
 
 /*===========================================================================*/
@@ -134,6 +142,20 @@
 #define CAN_USE_SLEEP_MODE          TRUE
 #endif
 
+/**
+ * @brief   Software receive FIFO switch.
+ */
+#if !defined(CAN_USE_RX_FIFO) || defined(__DOXYGEN__)
+#define CAN_USE_RX_FIFO             TRUE
+#endif
+
+/**
+ * @brief   Number of frames in the software receive FIFO.
+ */
+#if !defined(CAN_RX_FIFO_SIZE) || defined(__DOXYGEN__)
+#define CAN_RX_FIFO_SIZE            64
+#endif
+
 /*===========================================================================*/
 /* I2C driver related settings.                                              */
 /*===========================================================================*/
@@ -149,6 +171,14 @@
 /* MAC driver related settings.                                              */
 /*===========================================================================*/
 
+/**
+ * @brief   Enables the zero-copy API.
+ * @note    Disabling this option saves both code and data space.
+ */
+#if !defined(MAC_USE_ZERO_COPY) || defined(__DOXYGEN__)
+#define MAC_USE_ZERO_COPY           TRUE
+#endif
+
 /*===========================================================================*/
 /* MMC_SPI driver related settings.                                          */
 /*===========================================================================*/
@@ -198,6 +228,27 @@
 #define MMC_USE_SPI_POLLING         TRUE
 #endif
 
+/**
+ * @brief   Enables the sectors cache.
+ */
+#if !defined(MMC_USE_CACHE) || defined(__DOXYGEN__)
+#define MMC_USE_CACHE               TRUE
+#endif
+
+/**
+ * @brief   Number of cached sectors.
+ */
+#if !defined(MMC_CACHE_SECTORS) || defined(__DOXYGEN__)
+#define MMC_CACHE_SECTORS           32
+#endif
+
+/**
+ * @brief   Number of sectors read ahead on sequential reads.
+ */
+#if !defined(MMC_CACHE_READ_AHEAD) || defined(__DOXYGEN__)
+#define MMC_CACHE_READ_AHEAD        4
+#endif
+
 /*===========================================================================*/
 /* PAL driver related settings.                                              */
 /*===========================================================================*/
@@ -227,8 +278,13 @@
  *          buffers.
  */
 #if !defined(SERIAL_BUFFERS_SIZE) || defined(__DOXYGEN__)
+#if CH_DBG_ENABLE_TRACE
+/* Large enough to absorb the kernel trace stream bursts.*/
+#define SERIAL_BUFFERS_SIZE         1024
+#else
 #define SERIAL_BUFFERS_SIZE         16
 #endif
+#endif
 
 /*===========================================================================*/
 /* SPI driver related settings.                                              */
@@ -250,10 +306,25 @@
 #define SPI_USE_MUTUAL_EXCLUSION    TRUE
 #endif
 
+/**
+ * @brief   Enables the jobs queue APIs.
+ * @note    Disabling this option saves both code and data space.
+ */
+#if !defined(SPI_USE_JOBS) || defined(__DOXYGEN__)
+#define SPI_USE_JOBS                TRUE
+#endif
+
 /*===========================================================================*/
 /* UART driver related settings.                                             */
 /*===========================================================================*/
 
+/**
+ * @brief   Continuous receive mode related APIs inclusion switch.
+ */
+#if !defined(UART_USE_CONTINUOUS) || defined(__DOXYGEN__)
+#define UART_USE_CONTINUOUS         TRUE
+#endif
+
 #endif /* _HALCONF_H_ */
 
 /** @} */
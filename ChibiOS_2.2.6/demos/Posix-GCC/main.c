@@ -25,21 +25,35 @@
 */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/socket.h>
 
 #include "ch.h"
 #include "hal.h"
 #include "test.h"
 #include "shell.h"
+#if CH_DBG_ENABLE_TRACE
+#include "tracestream.h"
+#endif
 
 #define SHELL_WA_SIZE       THD_WA_SIZE(4096)
 #define CONSOLE_WA_SIZE     THD_WA_SIZE(4096)
 #define TEST_WA_SIZE        THD_WA_SIZE(4096)
+#define TRACE_WA_SIZE       THD_WA_SIZE(4096)
 
 #define cputs(msg) chMsgSend(cdtp, (msg_t)msg)
 
 static Thread *cdtp;
 static Thread *shelltp1;
 static Thread *shelltp2;
+#if CH_DBG_ENABLE_TRACE
+static Thread *tracetp;
+#endif
 
 void cmd_test(BaseChannel *chp, int argc, char *argv[]) {
   Thread *tp;
@@ -58,8 +72,1193 @@ void cmd_test(BaseChannel *chp, int argc, char *argv[]) {
   chThdWait(tp);
 }
 
+void cmd_idle(BaseChannel *chp, int argc, char *argv[]) {
+  char buf[64];
+
+  (void)argv;
+  if (argc > 0) {
+    shellPrintLine(chp, "Usage: idle");
+    return;
+  }
+  sprintf(buf, "wakeups: %lu", (unsigned long)sim_stats.wakeups);
+  shellPrintLine(chp, buf);
+#if CH_USE_TICKLESS
+  sprintf(buf, "alarms: %lu, max latency: %lu nS",
+          (unsigned long)sim_stats.alarms,
+          (unsigned long)sim_stats.max_latency);
+  shellPrintLine(chp, buf);
+#endif
+}
+
+static uint64_t host_ns(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+}
+
+#define SERBENCH_LINE       64
+
+/*
+ * Serial output throughput, sends the specified amount of KB of text lines
+ * through the shell channel to the connected client.
+ */
+void cmd_serbench(BaseChannel *chp, int argc, char *argv[]) {
+  uint8_t line[SERBENCH_LINE];
+  uint32_t i, n, kb = 1024;
+  uint64_t t;
+  char buf[64];
+
+  if (argc > 1) {
+    shellPrintLine(chp, "Usage: serbench [kbytes]");
+    return;
+  }
+  if (argc > 0)
+    kb = (uint32_t)atoi(argv[0]);
+  for (i = 0; i < SERBENCH_LINE - 2; i++)
+    line[i] = (uint8_t)('0' + i % 10);
+  line[SERBENCH_LINE - 2] = '\r';
+  line[SERBENCH_LINE - 1] = '\n';
+  n = kb * 1024 / SERBENCH_LINE;
+  t = host_ns();
+  for (i = 0; i < n; i++)
+    chIOWriteTimeout(chp, line, SERBENCH_LINE, TIME_INFINITE);
+  t = host_ns() - t;
+  sprintf(buf, "%lu bytes in %lu uS, %lu KB/S",
+          (unsigned long)(n * SERBENCH_LINE), (unsigned long)(t / 1000),
+          (unsigned long)((uint64_t)n * SERBENCH_LINE * 1000000 / 1024 /
+                          (t / 1000 + 1)));
+  shellPrintLine(chp, buf);
+}
+
+#if CH_USE_RINGS
+#define RINGSTRESS_SIZE     256
+#define RINGSTRESS_IRQ      0
+
+static Ring ringstress;
+static uint32_t ringstress_buf[RINGSTRESS_SIZE];
+static uint32_t ringstress_n;
+static uint32_t ringstress_doorbells;
+
+/*
+ * Doorbell interrupt handler.
+ */
+static void ringstress_isr(void) {
+
+  ringstress_doorbells++;
+  chRingDoorbellI(&ringstress);
+}
+
+/*
+ * Host thread producer, it writes a sequence of numbers into the ring and
+ * raises the doorbell interrupt on the empty to non-empty transitions.
+ */
+static void *ringstress_producer(void *p) {
+  uint32_t i;
+
+  (void)p;
+  for (i = 1; i <= ringstress_n; i++) {
+    msg_t msg;
+
+    while ((msg = chRingWrite(&ringstress, &i)) == RING_FULL)
+      sched_yield();
+    if (msg == RING_WAS_EMPTY)
+      sim_irq_raise(RINGSTRESS_IRQ);
+  }
+  return NULL;
+}
+
+/*
+ * Ring stress test, a host thread streams the specified amount of records
+ * to the shell thread that verifies the sequence.
+ */
+void cmd_ringstress(BaseChannel *chp, int argc, char *argv[]) {
+  pthread_t producer;
+  uint32_t i, rec, errors = 0;
+  uint64_t t;
+  char buf[64];
+
+  if (argc > 1) {
+    shellPrintLine(chp, "Usage: ringstress [records]");
+    return;
+  }
+  ringstress_n = argc > 0 ? (uint32_t)atoi(argv[0]) : 1000000;
+  ringstress_doorbells = 0;
+  chRingInit(&ringstress, ringstress_buf, sizeof(uint32_t), RINGSTRESS_SIZE);
+  sim_irq_set_handler(RINGSTRESS_IRQ, ringstress_isr);
+  t = host_ns();
+  if (pthread_create(&producer, NULL, ringstress_producer, NULL) != 0) {
+    shellPrintLine(chp, "unable to create the producer");
+    return;
+  }
+  for (i = 1; i <= ringstress_n; i++) {
+    if (chRingGetTimeout(&ringstress, &rec, MS2ST(1000)) != RDY_OK) {
+      shellPrintLine(chp, "timeout");
+      break;
+    }
+    if (rec != i)
+      errors++;
+  }
+  pthread_join(producer, NULL);
+  t = host_ns() - t;
+  sim_irq_set_handler(RINGSTRESS_IRQ, NULL);
+  sprintf(buf, "%lu records, %lu msgs/S",
+          (unsigned long)i - 1,
+          (unsigned long)((uint64_t)(i - 1) * 1000000 / (t / 1000 + 1)));
+  shellPrintLine(chp, buf);
+  sprintf(buf, "errors: %lu, doorbells: %lu",
+          (unsigned long)errors, (unsigned long)ringstress_doorbells);
+  shellPrintLine(chp, buf);
+}
+#endif
+
+#if HAL_USE_MAC
+#define MACBENCH_FRAME      1514
+#define MACBENCH_WINDOW     MAC_RECEIVE_BUFFERS
+
+static const uint8_t macbench_peer[6] = {0x02, 0x52, 0x46, 0x4C, 0x00, 0x00};
+static uint8_t macbench_buf[MACBENCH_FRAME];
+static int macbench_socket;
+
+/*
+ * Host thread attached to the virtual wire, it sends back every received
+ * frame to its originator.
+ */
+static void *macbench_reflector(void *p) {
+  uint8_t frame[MAC_BUFFERS_SIZE];
+  struct sockaddr_un sun;
+  socklen_t len;
+  ssize_t n;
+
+  (void)p;
+  while (TRUE) {
+    len = sizeof(sun);
+    n = recvfrom(macbench_socket, frame, sizeof(frame), 0,
+                 (struct sockaddr *)&sun, &len);
+    if (n <= 0)
+      return NULL;
+    if (n < SIM_MAC_HEADER_SIZE)
+      continue;
+    memcpy(frame, frame + 6, 6);
+    memcpy(frame + 6, macbench_peer, 6);
+    sendto(macbench_socket, frame, (size_t)n, 0, (struct sockaddr *)&sun, len);
+  }
+}
+
+/*
+ * Composes the header and the sequence number of a frame.
+ */
+static void macbench_compose(uint8_t *fp, uint32_t seq) {
+
+  memcpy(fp, macbench_peer, 6);
+  memcpy(fp + 6, ETH1.md_address, 6);
+  fp[12] = 0x88;
+  fp[13] = 0xB5;
+  memcpy(fp + SIM_MAC_HEADER_SIZE, &seq, sizeof(seq));
+}
+
+/*
+ * Virtual wire throughput, full size frames are bounced off a host thread
+ * attached to the wire. Frames are moved through the descriptors streams or,
+ * in zero-copy mode, composed and checked in the driver buffers.
+ */
+void cmd_macbench(BaseChannel *chp, int argc, char *argv[]) {
+  pthread_t reflector;
+  struct sockaddr_un sun;
+  uint32_t n = 100000, sent = 0, recvd = 0, errors = 0, copies;
+  uint32_t txframes, rxframes;
+  bool_t zc = FALSE;
+  unsigned port;
+  uint64_t t;
+  char buf[64];
+
+  if ((argc > 2) ||
+      ((argc > 1) && strcmp(argv[1], "copy") && strcmp(argv[1], "zc"))) {
+    shellPrintLine(chp, "Usage: macbench [frames] [copy|zc]");
+    return;
+  }
+  if (argc > 0)
+    n = (uint32_t)atoi(argv[0]);
+  if (argc > 1)
+    zc = strcmp(argv[1], "zc") == 0;
+#if !MAC_USE_ZERO_COPY
+  if (zc) {
+    shellPrintLine(chp, "zero-copy API not enabled");
+    return;
+  }
+#endif
+  if (!macPollLinkStatus(&ETH1)) {
+    shellPrintLine(chp, "link down");
+    return;
+  }
+
+  macbench_socket = socket(AF_UNIX, SOCK_DGRAM, 0);
+  for (port = 0; port < SIM_MAC_WIRE_PORTS; port++) {
+    if (bind(macbench_socket, (struct sockaddr *)&sun,
+             mac_lld_wire_address(port, &sun)) == 0)
+      break;
+  }
+  if ((port >= SIM_MAC_WIRE_PORTS) ||
+      (pthread_create(&reflector, NULL, macbench_reflector, NULL) != 0)) {
+    close(macbench_socket);
+    shellPrintLine(chp, "unable to attach the reflector");
+    return;
+  }
+
+  memset(macbench_buf, 0x55, sizeof(macbench_buf));
+  copies = ETH1.md_copies;
+  txframes = ETH1.md_txframes;
+  rxframes = ETH1.md_rxframes;
+  t = host_ns();
+  while (recvd < n) {
+    if ((sent < n) && (sent - recvd < MACBENCH_WINDOW)) {
+      MACTransmitDescriptor td;
+
+      if (macWaitTransmitDescriptor(&ETH1, &td, MS2ST(100)) != RDY_OK)
+        break;
+#if MAC_USE_ZERO_COPY
+      if (zc) {
+        size_t size;
+
+        macbench_compose(macGetNextTransmitBuffer(&td, MACBENCH_FRAME, &size),
+                         sent);
+      }
+      else
+#endif
+      {
+        macbench_compose(macbench_buf, sent);
+        macWriteTransmitDescriptor(&td, macbench_buf, MACBENCH_FRAME);
+      }
+      macReleaseTransmitDescriptor(&td);
+      sent++;
+    }
+    else {
+      MACReceiveDescriptor rd;
+      const uint8_t *fp;
+      uint32_t seq;
+
+      if (macWaitReceiveDescriptor(&ETH1, &rd, MS2ST(500)) != RDY_OK)
+        break;
+#if MAC_USE_ZERO_COPY
+      if (zc) {
+        size_t size;
+
+        fp = macGetNextReceiveBuffer(&rd, &size);
+      }
+      else
+#endif
+      {
+        macReadReceiveDescriptor(&rd, macbench_buf, rd.rd_size);
+        fp = macbench_buf;
+      }
+      memcpy(&seq, fp + SIM_MAC_HEADER_SIZE, sizeof(seq));
+      if ((rd.rd_size != MACBENCH_FRAME) || (seq != recvd) ||
+          (memcmp(fp, ETH1.md_address, 6) != 0))
+        errors++;
+      macReleaseReceiveDescriptor(&rd);
+      recvd++;
+    }
+  }
+  t = host_ns() - t;
+  shutdown(macbench_socket, SHUT_RDWR);
+  pthread_join(reflector, NULL);
+  close(macbench_socket);
+
+  sprintf(buf, "%lu frames, %lu frames/S, %lu errors",
+          (unsigned long)recvd,
+          (unsigned long)((uint64_t)recvd * 1000000 / (t / 1000 + 1)),
+          (unsigned long)(errors + n - recvd));
+  shellPrintLine(chp, buf);
+  copies = ETH1.md_copies - copies;
+  txframes = ETH1.md_txframes - txframes;
+  rxframes = ETH1.md_rxframes - rxframes;
+  if (txframes + rxframes == 0)
+    rxframes = 1;
+  sprintf(buf, "copies/frame: %lu.%02lu (%s)",
+          (unsigned long)(copies / (txframes + rxframes)),
+          (unsigned long)(copies * 100 / (txframes + rxframes) % 100),
+          zc ? "zero-copy" : "copy");
+  shellPrintLine(chp, buf);
+}
+#endif
+
+#if HAL_USE_MMC_SPI
+#define MMCBENCH_BLOCKS     4096
+#define MMCBENCH_RANDOM     1024
+
+static MMCDriver MMCD1;
+static const SPIConfig ls_spicfg = {NULL};
+static const SPIConfig hs_spicfg = {NULL};
+static uint8_t mmcbench_buf[MMC_SECTOR_SIZE];
+
+static bool_t mmc_is_inserted(void) {return TRUE;}
+static bool_t mmc_is_protected(void) {return FALSE;}
+
+/*
+ * Connects the card on SPI1.
+ */
+static bool_t mmc_open(BaseChannel *chp) {
+
+  mmcObjectInit(&MMCD1, &SPID1, &ls_spicfg, &hs_spicfg,
+                mmc_is_protected, mmc_is_inserted);
+  mmcStart(&MMCD1, NULL);
+  while (MMCD1.mmc_state != MMC_INSERTED)
+    chThdSleepMilliseconds(MMC_POLLING_DELAY);
+  if (mmcConnect(&MMCD1)) {
+    shellPrintLine(chp, "card initialization failed");
+    mmcStop(&MMCD1);
+    return TRUE;
+  }
+  return FALSE;
+}
+
+static void mmcbench_report(BaseChannel *chp, const char *name, uint32_t n,
+                            uint64_t t) {
+  char buf[64];
+
+  sprintf(buf, "%s: %lu blocks/S", name,
+          (unsigned long)((uint64_t)n * 1000000 / (t / 1000 + 1)));
+  shellPrintLine(chp, buf);
+}
+
+/*
+ * Block device throughput on the simulated card, sequential transfers are
+ * performed as a single multiple blocks command, random transfers as one
+ * command per block. Each block is stamped with its number and verified.
+ */
+void cmd_mmcbench(BaseChannel *chp, int argc, char *argv[]) {
+  uint32_t i, blk, seed = 1, errors = 0;
+  uint64_t t;
+  char buf[64];
+
+  (void)argv;
+  if (argc > 0) {
+    shellPrintLine(chp, "Usage: mmcbench");
+    return;
+  }
+  if (mmc_open(chp))
+    return;
+  memset(mmcbench_buf, 0x55, sizeof(mmcbench_buf));
+
+  t = host_ns();
+  mmcStartSequentialWrite(&MMCD1, 0);
+  for (i = 0; i < MMCBENCH_BLOCKS; i++) {
+    memcpy(mmcbench_buf, &i, sizeof(i));
+    if (mmcSequentialWrite(&MMCD1, mmcbench_buf))
+      errors++;
+  }
+  mmcStopSequentialWrite(&MMCD1);
+  mmcbench_report(chp, "sequential write", MMCBENCH_BLOCKS, host_ns() - t);
+
+  t = host_ns();
+  mmcStartSequentialRead(&MMCD1, 0);
+  for (i = 0; i < MMCBENCH_BLOCKS; i++) {
+    if (mmcSequentialRead(&MMCD1, mmcbench_buf) ||
+        (memcmp(mmcbench_buf, &i, sizeof(i)) != 0))
+      errors++;
+  }
+  mmcStopSequentialRead(&MMCD1);
+  mmcbench_report(chp, "sequential read ", MMCBENCH_BLOCKS, host_ns() - t);
+
+  t = host_ns();
+  for (i = 0; i < MMCBENCH_RANDOM; i++) {
+    seed = seed * 1103515245 + 12345;
+    blk = (seed >> 8) % MMCBENCH_BLOCKS;
+    memcpy(mmcbench_buf, &blk, sizeof(blk));
+    if (mmcStartSequentialWrite(&MMCD1, blk) ||
+        mmcSequentialWrite(&MMCD1, mmcbench_buf) ||
+        mmcStopSequentialWrite(&MMCD1))
+      errors++;
+  }
+  mmcbench_report(chp, "random write    ", MMCBENCH_RANDOM, host_ns() - t);
+
+  t = host_ns();
+  for (i = 0; i < MMCBENCH_RANDOM; i++) {
+    seed = seed * 1103515245 + 12345;
+    blk = (seed >> 8) % MMCBENCH_BLOCKS;
+    if (mmcStartSequentialRead(&MMCD1, blk) ||
+        mmcSequentialRead(&MMCD1, mmcbench_buf) ||
+        mmcStopSequentialRead(&MMCD1) ||
+        (memcmp(mmcbench_buf, &blk, sizeof(blk)) != 0))
+      errors++;
+  }
+  mmcbench_report(chp, "random read     ", MMCBENCH_RANDOM, host_ns() - t);
+
+  sprintf(buf, "errors: %lu", (unsigned long)errors);
+  shellPrintLine(chp, buf);
+  mmcDisconnect(&MMCD1);
+  mmcStop(&MMCD1);
+}
+
+#if MMC_USE_CACHE
+#define MMCCACHE_FAT        1
+#define MMCCACHE_FATSIZE    4
+#define MMCCACHE_DIR        16
+#define MMCCACHE_DIRSIZE    8
+#define MMCCACHE_DATA       1024
+#define MMCCACHE_FILESIZE   4
+#define MMCCACHE_END        8
+
+/*
+ * Reads and writes a single sector through the cache.
+ */
+static uint32_t mmccache_rw(uint32_t blk, bool_t write) {
+
+  if (write) {
+    memcpy(mmcbench_buf, &blk, sizeof(blk));
+    return mmcWrite(&MMCD1, blk, mmcbench_buf, 1) ? 1 : 0;
+  }
+  return mmcRead(&MMCD1, blk, mmcbench_buf, 1) ? 1 : 0;
+}
+
+/*
+ * File system like workload through the sectors cache. For each file the
+ * directory is scanned, the cluster chain is walked in the FAT, the data
+ * sectors are written one at time and the FAT and directory sectors are
+ * updated. The data is then read back bypassing the cache and verified.
+ */
+void cmd_mmccache(BaseChannel *chp, int argc, char *argv[]) {
+  uint32_t files, i, j, nread, nwritten, reads = 0, writes = 0, errors = 0;
+  uint32_t ends;
+  unsigned pass;
+  MMCCacheStats *csp;
+  uint64_t t;
+  char buf[96];
+
+  if (argc > 1) {
+    shellPrintLine(chp, "Usage: mmccache [files]");
+    return;
+  }
+  files = argc > 0 ? (uint32_t)atoi(argv[0]) : 256;
+  if ((files < 1) || (files > 4096)) {
+    shellPrintLine(chp, "files must be 1..4096");
+    return;
+  }
+  if (mmc_open(chp))
+    return;
+  csp = mmcGetCacheStats(&MMCD1);
+  memset(csp, 0, sizeof(*csp));
+  nread = SPID1.spd_mmc.mmc_nread;
+  nwritten = SPID1.spd_mmc.mmc_nwritten;
+
+  t = host_ns();
+  for (i = 0; i < files; i++) {
+    for (j = 0; j < MMCCACHE_DIRSIZE; j++)
+      errors += mmccache_rw(MMCCACHE_DIR + j, FALSE);
+    for (j = 0; j < MMCCACHE_FILESIZE; j++)
+      errors += mmccache_rw(MMCCACHE_FAT + (i + j) % MMCCACHE_FATSIZE, FALSE);
+    for (j = 0; j < MMCCACHE_FILESIZE; j++)
+      errors += mmccache_rw(MMCCACHE_DATA + i * MMCCACHE_FILESIZE + j, TRUE);
+    errors += mmccache_rw(MMCCACHE_FAT + i % MMCCACHE_FATSIZE, FALSE);
+    errors += mmccache_rw(MMCCACHE_FAT + i % MMCCACHE_FATSIZE, TRUE);
+    errors += mmccache_rw(MMCCACHE_DIR + i % MMCCACHE_DIRSIZE, FALSE);
+    errors += mmccache_rw(MMCCACHE_DIR + i % MMCCACHE_DIRSIZE, TRUE);
+    reads += MMCCACHE_DIRSIZE + MMCCACHE_FILESIZE + 2;
+    writes += MMCCACHE_FILESIZE + 2;
+  }
+  if (mmcSync(&MMCD1))
+    errors++;
+  t = host_ns() - t;
+  nread = SPID1.spd_mmc.mmc_nread - nread;
+  nwritten = SPID1.spd_mmc.mmc_nwritten - nwritten;
+
+  if (mmcStartSequentialRead(&MMCD1, MMCCACHE_DATA))
+    errors++;
+  for (i = 0; i < files * MMCCACHE_FILESIZE; i++) {
+    j = MMCCACHE_DATA + i;
+    if (mmcSequentialRead(&MMCD1, mmcbench_buf) ||
+        (memcmp(mmcbench_buf, &j, sizeof(j)) != 0))
+      errors++;
+  }
+  mmcStopSequentialRead(&MMCD1);
+
+  sprintf(buf, "%lu sector reads, %lu sector writes in %lu uS",
+          (unsigned long)reads, (unsigned long)writes,
+          (unsigned long)(t / 1000));
+  shellPrintLine(chp, buf);
+  sprintf(buf, "hits: %lu, misses: %lu, hit ratio: %lu%%, read ahead: %lu",
+          (unsigned long)csp->cs_hits, (unsigned long)csp->cs_misses,
+          (unsigned long)(csp->cs_hits * 100 /
+                          (csp->cs_hits + csp->cs_misses)),
+          (unsigned long)csp->cs_readahead);
+  shellPrintLine(chp, buf);
+  sprintf(buf, "write back: %lu sectors in %lu bursts",
+          (unsigned long)csp->cs_written, (unsigned long)csp->cs_bursts);
+  shellPrintLine(chp, buf);
+
+  /* Card end check, the last sectors are read sequentially twice with the
+     cache flushed in between, the read-ahead must find the card end in the
+     first pass only.*/
+  ends = csp->cs_cardend;
+  for (pass = 0; pass < 2; pass++) {
+    for (i = SPID1.spd_mmc.mmc_blocks - MMCCACHE_END;
+         i < SPID1.spd_mmc.mmc_blocks; i++)
+      errors += mmccache_rw(i, FALSE);
+    for (i = 0; i < MMC_CACHE_SECTORS * 2; i++)
+      errors += mmccache_rw(MMCCACHE_DATA + i, FALSE);
+  }
+  ends = csp->cs_cardend - ends;
+  if (ends != 1)
+    errors++;
+  sprintf(buf, "card: %lu sectors read, %lu sectors written",
+          (unsigned long)nread, (unsigned long)nwritten);
+  shellPrintLine(chp, buf);
+  sprintf(buf, "card end: read ahead stopped %lu time(s), errors: %lu",
+          (unsigned long)ends, (unsigned long)errors);
+  shellPrintLine(chp, buf);
+  mmcDisconnect(&MMCD1);
+  mmcStop(&MMCD1);
+}
+#endif /* MMC_USE_CACHE */
+#endif
+
+#if HAL_USE_ADC
+#define ADCBENCH_CHANNELS   2
+#define ADCBENCH_DEPTH      256
+#define ADCBENCH_MAILBOX    4
+#define ADCBENCH_WA_SIZE    THD_WA_SIZE(1024)
+
+static adcsample_t adcbench_buf[ADCBENCH_CHANNELS * ADCBENCH_DEPTH];
+static msg_t adcbench_mbbuf[ADCBENCH_MAILBOX];
+static Mailbox adcbench_mb;
+static uint32_t adcbench_work;
+static uint32_t adcbench_callbacks;
+static uint32_t adcbench_dropped;
+static uint32_t adcbench_processed;
+static volatile uint32_t adcbench_sum;
+
+/*
+ * Half buffer callback, the buffer is handed to the processing thread, it
+ * is dropped if the thread is lagging.
+ */
+static void adcbench_cb(ADCDriver *adcp, adcsample_t *buffer, size_t n) {
+
+  (void)adcp;
+  (void)n;
+  adcbench_callbacks++;
+  chSysLockFromIsr();
+  if (chMBPostI(&adcbench_mb, (msg_t)buffer) != RDY_OK)
+    adcbench_dropped++;
+  chSysUnlockFromIsr();
+}
+
+static const ADCConversionGroup adcbench_grp = {
+  TRUE,
+  ADCBENCH_CHANNELS,
+  adcbench_cb
+};
+
+/*
+ * Processing thread, each half buffer is scanned as many times as the
+ * requested work units.
+ */
+static msg_t adcbench_thread(void *p) {
+  msg_t msg;
+
+  (void)p;
+  while ((chMBFetch(&adcbench_mb, &msg, TIME_INFINITE) == RDY_OK) &&
+         (msg != 0)) {
+    const adcsample_t *sp = (const adcsample_t *)msg;
+    uint32_t i, j, sum = 0;
+
+    for (j = 0; j < adcbench_work; j++)
+      for (i = 0; i < ADCBENCH_CHANNELS * ADCBENCH_DEPTH / 2; i++)
+        sum += sp[i] ^ j;
+    adcbench_sum += sum;
+    adcbench_processed++;
+  }
+  return 0;
+}
+
+/*
+ * Simulated ADC soak test, the samples file is streamed at the specified
+ * virtual rate through a circular conversion into a processing thread.
+ */
+void cmd_adcbench(BaseChannel *chp, int argc, char *argv[]) {
+  ADCConfig cfg;
+  Thread *tp;
+  uint32_t seconds = 5;
+  uint64_t t, rows;
+  char buf[80];
+
+  if ((argc < 1) || (argc > 4)) {
+    shellPrintLine(chp, "Usage: adcbench file [rate] [seconds] [work]");
+    return;
+  }
+  if (access(argv[0], R_OK) != 0) {
+    shellPrintLine(chp, "unable to read the samples file");
+    return;
+  }
+  cfg.ac_file = argv[0];
+  cfg.ac_rate = argc > 1 ? (uint32_t)atoi(argv[1]) : 0;
+  if (argc > 2)
+    seconds = (uint32_t)atoi(argv[2]);
+  adcbench_work = argc > 3 ? (uint32_t)atoi(argv[3]) : 1;
+  adcbench_callbacks = adcbench_dropped = adcbench_processed = 0;
+  chMBInit(&adcbench_mb, adcbench_mbbuf, ADCBENCH_MAILBOX);
+  tp = chThdCreateFromHeap(NULL, ADCBENCH_WA_SIZE, NORMALPRIO + 10,
+                           adcbench_thread, NULL);
+  if (tp == NULL) {
+    shellPrintLine(chp, "out of memory");
+    return;
+  }
+
+  adcStart(&ADCD1, &cfg);
+  rows = ADCD1.ad_converted;
+  ADCD1.ad_overruns = 0;
+  ADCD1.ad_max_latency = 0;
+  t = host_ns();
+  adcStartConversion(&ADCD1, &adcbench_grp, adcbench_buf, ADCBENCH_DEPTH);
+  chThdSleepSeconds(seconds);
+  adcStopConversion(&ADCD1);
+  t = host_ns() - t;
+  rows = ADCD1.ad_converted - rows;
+  chMBPost(&adcbench_mb, 0, TIME_INFINITE);
+  chThdWait(tp);
+
+  sprintf(buf, "rate: %lu Hz, %lu samples/S",
+          (unsigned long)ADCD1.ad_rate,
+          (unsigned long)(rows * ADCBENCH_CHANNELS * 1000000 /
+                          (t / 1000 + 1)));
+  shellPrintLine(chp, buf);
+  sprintf(buf, "callbacks: %lu, processed: %lu, dropped: %lu",
+          (unsigned long)adcbench_callbacks,
+          (unsigned long)adcbench_processed,
+          (unsigned long)adcbench_dropped);
+  shellPrintLine(chp, buf);
+  sprintf(buf, "overruns: %lu, max latency: %lu nS",
+          (unsigned long)ADCD1.ad_overruns,
+          (unsigned long)ADCD1.ad_max_latency);
+  shellPrintLine(chp, buf);
+  adcStop(&ADCD1);
+}
+#endif
+
+#if HAL_USE_CAN
+#define CANBENCH_BATCH      16
+
+static const CANConfig canbench_cfg = {
+  FALSE
+};
+
+static uint32_t canbench_n;
+static uint32_t canbench_rate;
+
+/*
+ * Host thread node, it sends a sequence of numbered frames on the virtual
+ * bus, paced at the specified rate if not zero.
+ */
+static void *canbench_node(void *p) {
+  CANTxFrame txf;
+  uint64_t t0 = host_ns();
+  uint32_t i;
+
+  (void)p;
+  txf.cf_IDE = CAN_IDE_STD;
+  txf.cf_RTR = CAN_RTR_DATA;
+  txf.cf_SID = 0x123;
+  txf.cf_DLC = 8;
+  txf.cf_data32[1] = 0;
+  for (i = 0; i < canbench_n; i++) {
+    if (canbench_rate > 0) {
+      uint64_t due = t0 + (uint64_t)i * 1000000000 / canbench_rate;
+
+      while (host_ns() < due)
+        sched_yield();
+    }
+    txf.cf_data32[0] = i;
+    can_lld_bus_send(&txf);
+  }
+  return NULL;
+}
+
+/*
+ * Virtual CAN bus receive throughput, a host thread sends the specified
+ * amount of frames to CAN1, the frames are received one at time or in
+ * batches and the lost frames are counted.
+ */
+void cmd_canbench(BaseChannel *chp, int argc, char *argv[]) {
+  CANRxFrame rxf[CANBENCH_BATCH];
+  pthread_t node;
+  uint32_t batch, received = 0, gaps = 0, next = 0, calls = 0;
+  uint64_t t, tlast;
+  char buf[96];
+
+  if (argc > 3) {
+    shellPrintLine(chp, "Usage: canbench [frames] [rate] [batch]");
+    return;
+  }
+  canbench_n = argc > 0 ? (uint32_t)atoi(argv[0]) : 100000;
+  canbench_rate = argc > 1 ? (uint32_t)atoi(argv[1]) : 0;
+  batch = argc > 2 ? (uint32_t)atoi(argv[2]) : 1;
+  if ((batch < 1) || (batch > CANBENCH_BATCH)) {
+    shellPrintLine(chp, "batch must be 1..16");
+    return;
+  }
+  canStart(&CAND1, &canbench_cfg);
+  CAND1.cd_overruns = CAND1.cd_hwoverruns = 0;
+  t = tlast = host_ns();
+  if (pthread_create(&node, NULL, canbench_node, NULL) != 0) {
+    shellPrintLine(chp, "unable to create the bus node");
+    canStop(&CAND1);
+    return;
+  }
+  while (next < canbench_n) {
+    uint32_t i, n;
+
+    if (batch > 1)
+      n = (uint32_t)canReceiveBatch(&CAND1, rxf, batch, MS2ST(500));
+    else
+      n = canReceive(&CAND1, rxf, MS2ST(500)) == RDY_OK ? 1 : 0;
+    if (n == 0)
+      break;
+    calls++;
+    for (i = 0; i < n; i++) {
+      if (rxf[i].cf_data32[0] != next)
+        gaps++;
+      next = rxf[i].cf_data32[0] + 1;
+    }
+    received += n;
+    /* The final timeout is not accounted.*/
+    tlast = host_ns();
+  }
+  t = tlast - t;
+  pthread_join(node, NULL);
+  canStop(&CAND1);
+  sprintf(buf, "%lu frames received, %lu frames/S, %lu calls",
+          (unsigned long)received,
+          (unsigned long)((uint64_t)received * 1000000 / (t / 1000 + 1)),
+          (unsigned long)calls);
+  shellPrintLine(chp, buf);
+  sprintf(buf, "lost: %lu, gaps: %lu, overruns: %lu, hw overruns: %lu",
+          (unsigned long)(canbench_n - received), (unsigned long)gaps,
+          (unsigned long)CAND1.cd_overruns,
+          (unsigned long)CAND1.cd_hwoverruns);
+  shellPrintLine(chp, buf);
+}
+#endif
+
+#if HAL_USE_UART && UART_USE_CONTINUOUS
+#define UARTBENCH_BUFSIZE   256
+#define UARTBENCH_MAILBOX   4
+
+static uint8_t uartbench_buf[2][UARTBENCH_BUFSIZE];
+static msg_t uartbench_mbbuf[UARTBENCH_MAILBOX];
+static Mailbox uartbench_mb;
+static uint32_t uartbench_n;
+static uint32_t uartbench_frame;
+static uint32_t uartbench_rx;
+static uint32_t uartbench_errors;
+static volatile bool_t uartbench_done;
+
+/*
+ * Character callback, the received stream is verified.
+ */
+static void uartbench_rxchar(UARTDriver *uartp, uint16_t c) {
+
+  (void)uartp;
+  if (c != (uartbench_rx & 0xFF))
+    uartbench_errors++;
+  uartbench_rx++;
+}
+
+static const UARTConfig uartbench_char_cfg = {
+  NULL,
+  NULL,
+  NULL,
+  uartbench_rxchar,
+  NULL,
+  NULL
+};
+
+static const UARTConfig uartbench_cont_cfg = {
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL
+};
+
+/*
+ * Host thread sensor, it writes the byte stream on the line in frames of
+ * the specified size.
+ */
+static void *uartbench_sensor(void *p) {
+  uint8_t frame[UARTBENCH_BUFSIZE];
+  uint32_t i, j;
+
+  (void)p;
+  for (i = 0; i < uartbench_n; i += uartbench_frame) {
+    for (j = 0; j < uartbench_frame; j++)
+      frame[j] = (uint8_t)(i + j);
+    if (write(uart_lld_peer(&UARTD1), frame, uartbench_frame) < 0)
+      break;
+  }
+  uartbench_done = TRUE;
+  return NULL;
+}
+
+/*
+ * Simulated UART receive throughput, a host thread streams the specified
+ * amount of KB to UART1, the stream is received one character per
+ * interrupt or in continuous mode and verified.
+ */
+void cmd_uartbench(BaseChannel *chp, int argc, char *argv[]) {
+  pthread_t sensor;
+  bool_t cont;
+  uint32_t irqs, buffers = 0, last = 0;
+  uint64_t t;
+  char buf[96];
+
+  if ((argc < 1) || (argc > 3) ||
+      ((strcmp(argv[0], "char") != 0) && (strcmp(argv[0], "cont") != 0))) {
+    shellPrintLine(chp, "Usage: uartbench char|cont [kbytes] [frame]");
+    return;
+  }
+  cont = strcmp(argv[0], "cont") == 0;
+  uartbench_n = (argc > 1 ? (uint32_t)atoi(argv[1]) : 1024) * 1024;
+  uartbench_frame = argc > 2 ? (uint32_t)atoi(argv[2]) : 64;
+  if ((uartbench_frame < 1) || (uartbench_frame > UARTBENCH_BUFSIZE) ||
+      (uartbench_n % uartbench_frame != 0)) {
+    shellPrintLine(chp, "frame must be 1..256 and divide the stream size");
+    return;
+  }
+  uartbench_rx = uartbench_errors = 0;
+  uartbench_done = FALSE;
+  uartStart(&UARTD1, cont ? &uartbench_cont_cfg : &uartbench_char_cfg);
+  irqs = UARTD1.ud_rxirqs;
+  if (cont) {
+    chMBInit(&uartbench_mb, uartbench_mbbuf, UARTBENCH_MAILBOX);
+    uartStartContinuousReceive(&UARTD1, UARTBENCH_BUFSIZE,
+                               uartbench_buf[0], uartbench_buf[1],
+                               &uartbench_mb);
+  }
+  t = host_ns();
+  if (pthread_create(&sensor, NULL, uartbench_sensor, NULL) != 0) {
+    shellPrintLine(chp, "unable to create the sensor");
+    uartStop(&UARTD1);
+    return;
+  }
+  while (uartbench_rx < uartbench_n) {
+    if (cont) {
+      const UARTRxBuffer *rbp;
+      const uint8_t *p;
+      msg_t msg;
+      size_t i;
+
+      if (chMBFetch(&uartbench_mb, &msg, MS2ST(500)) != RDY_OK)
+        break;
+      rbp = (const UARTRxBuffer *)msg;
+      p = rbp->ub_buf;
+      for (i = 0; i < rbp->ub_n; i++) {
+        if (p[i] != (uint8_t)uartbench_rx)
+          uartbench_errors++;
+        uartbench_rx++;
+      }
+      buffers++;
+    }
+    else {
+      chThdSleepMilliseconds(10);
+      if ((uartbench_rx == last) && (host_ns() - t > 500000000)) {
+        /* No progress, something has been lost.*/
+        break;
+      }
+      last = uartbench_rx;
+    }
+  }
+  t = host_ns() - t;
+  irqs = UARTD1.ud_rxirqs - irqs;
+  if (cont)
+    uartStopReceive(&UARTD1);
+  /* The receiver keeps draining the line until the sensor is done, the
+     simulator must not be blocked meanwhile.*/
+  while (!uartbench_done)
+    chThdSleepMilliseconds(1);
+  pthread_join(sensor, NULL);
+  uartStop(&UARTD1);
+  sprintf(buf, "%lu bytes in %lu uS, %lu KB/S",
+          (unsigned long)uartbench_rx, (unsigned long)(t / 1000),
+          (unsigned long)((uint64_t)uartbench_rx * 1000000 / 1024 /
+                          (t / 1000 + 1)));
+  shellPrintLine(chp, buf);
+  sprintf(buf, "interrupts: %lu, buffers: %lu, errors: %lu, dropped: %lu",
+          (unsigned long)irqs, (unsigned long)buffers,
+          (unsigned long)uartbench_errors,
+          (unsigned long)UARTD1.ud_rxdropped);
+  shellPrintLine(chp, buf);
+}
+#endif
+
+#if HAL_USE_SPI && SPI_USE_JOBS
+#define SPIBENCH_MAXLEN     64
+#define SPIBENCH_MAXBATCH   64
+
+static const SPIConfig spibench_cfg = {NULL};
+static uint8_t spibench_tx[SPIBENCH_MAXBATCH][SPIBENCH_MAXLEN];
+static uint8_t spibench_rx[SPIBENCH_MAXBATCH][SPIBENCH_MAXLEN];
+static SPIJob spibench_jobs[SPIBENCH_MAXBATCH];
+
+/*
+ * Stamps the transmit buffers of a batch of transactions and clears the
+ * receive buffers.
+ */
+static void spibench_fill(uint32_t first, uint32_t batch, uint32_t len) {
+  uint32_t i, j;
+
+  for (i = 0; i < batch; i++) {
+    for (j = 0; j < len; j++)
+      spibench_tx[i][j] = (uint8_t)(first + i + j);
+    memset(spibench_rx[i], 0, len);
+  }
+}
+
+/*
+ * Verifies the looped back data of a batch of transactions.
+ */
+static uint32_t spibench_check(uint32_t batch, uint32_t len) {
+  uint32_t i, errors = 0;
+
+  for (i = 0; i < batch; i++) {
+    if (memcmp(spibench_tx[i], spibench_rx[i], len) != 0)
+      errors++;
+  }
+  return errors;
+}
+
+static void spibench_report(BaseChannel *chp, const char *name, uint32_t n,
+                            uint32_t wakeups, uint32_t errors, uint64_t t) {
+  char buf[96];
+
+  sprintf(buf, "%s: %lu transactions/S, %lu wakeups, %lu errors", name,
+          (unsigned long)((uint64_t)n * 1000000 / (t / 1000 + 1)),
+          (unsigned long)wakeups, (unsigned long)errors);
+  shellPrintLine(chp, buf);
+}
+
+/*
+ * SPI transactions throughput on the SPI2 loopback bus. Each transaction
+ * selects the slave, exchanges the specified number of bytes and unselects
+ * the slave. The transactions are performed one per thread wakeup and then
+ * as jobs lists of the specified size.
+ */
+void cmd_spibench(BaseChannel *chp, int argc, char *argv[]) {
+  uint32_t n, len, batch, i, errors, wakeups;
+  uint64_t t;
+
+  if (argc > 3) {
+    shellPrintLine(chp, "Usage: spibench [transactions] [len] [batch]");
+    return;
+  }
+  n = argc > 0 ? (uint32_t)atoi(argv[0]) : 100000;
+  len = argc > 1 ? (uint32_t)atoi(argv[1]) : 8;
+  batch = argc > 2 ? (uint32_t)atoi(argv[2]) : 16;
+  if ((len < 1) || (len > SPIBENCH_MAXLEN) ||
+      (batch < 1) || (batch > SPIBENCH_MAXBATCH) || (n % batch != 0)) {
+    shellPrintLine(chp, "len and batch must be 1..64, batch must divide "
+                        "the transactions");
+    return;
+  }
+  spiStart(&SPID2, &spibench_cfg);
+
+  errors = 0;
+  t = host_ns();
+  for (i = 0; i < n; i++) {
+    spibench_fill(i, 1, len);
+    spiAcquireBus(&SPID2);
+    spiSelect(&SPID2);
+    spiExchange(&SPID2, len, spibench_tx[0], spibench_rx[0]);
+    spiUnselect(&SPID2);
+    spiReleaseBus(&SPID2);
+    errors += spibench_check(1, len);
+  }
+  spibench_report(chp, "exchange", n, n, errors, host_ns() - t);
+
+  for (i = 0; i < batch; i++) {
+    spiJobObjectInit(&spibench_jobs[i], SPI_JOB_EXCHANGE, len,
+                     spibench_tx[i], spibench_rx[i]);
+    spibench_jobs[i].sj_flags = SPI_JOB_SELECT | SPI_JOB_UNSELECT;
+    if (i > 0)
+      spibench_jobs[i - 1].sj_next = &spibench_jobs[i];
+  }
+  errors = wakeups = 0;
+  t = host_ns();
+  for (i = 0; i < n; i += batch) {
+    spibench_fill(i, batch, len);
+    spiAcquireBus(&SPID2);
+    if (spiRunJobs(&SPID2, spibench_jobs) != NULL)
+      errors++;
+    spiReleaseBus(&SPID2);
+    wakeups++;
+    errors += spibench_check(batch, len);
+  }
+  spibench_report(chp, "jobs    ", n, wakeups, errors, host_ns() - t);
+  spiStop(&SPID2);
+}
+#endif
+
+#if CH_USE_HEAP && !CH_USE_MALLOC_HEAP
+#define HEAPBENCH_SIZE      (256 * 1024)
+#define HEAPBENCH_BLOCKS    512
+#define HEAPBENCH_OPS       1000000
+
+static stkalign_t heapbench_buf[HEAPBENCH_SIZE / sizeof(stkalign_t)];
+static void *heapbench_blocks[HEAPBENCH_BLOCKS];
+
+/*
+ * Randomized heap stress, measures the allocator latency with the host
+ * monotonic clock and reports the worst case and the fragmentation.
+ */
+void cmd_heapbench(BaseChannel *chp, int argc, char *argv[]) {
+  static MemoryHeap heap;
+  uint64_t t, dt, maxa = 0, maxf = 0, suma = 0, sumf = 0;
+  uint32_t na = 0, nf = 0, fails = 0, seed = 1, i;
+  size_t frags, sz, maxfrags = 0;
+  char buf[96];
+
+  (void)argv;
+  if (argc > 0) {
+    shellPrintLine(chp, "Usage: heapbench");
+    return;
+  }
+  /* Touches the buffer so that page faults do not pollute the latency.*/
+  memset(heapbench_buf, 0, sizeof(heapbench_buf));
+  chHeapInit(&heap, heapbench_buf, sizeof(heapbench_buf));
+  for (i = 0; i < HEAPBENCH_BLOCKS; i++)
+    heapbench_blocks[i] = NULL;
+  for (i = 0; i < HEAPBENCH_OPS; i++) {
+    unsigned j;
+
+    seed = seed * 1103515245 + 12345;
+    j = (seed >> 8) % HEAPBENCH_BLOCKS;
+    if (heapbench_blocks[j] == NULL) {
+      /* Mostly small blocks with a tail of large ones.*/
+      size_t size = (seed >> 28) ? 8 + (seed >> 16) % 256 :
+                                   256 + (seed >> 16) % 4096;
+
+      t = host_ns();
+      heapbench_blocks[j] = chHeapAlloc(&heap, size);
+      dt = host_ns() - t;
+      if (heapbench_blocks[j] == NULL)
+        fails++;
+      if (dt > maxa)
+        maxa = dt;
+      suma += dt;
+      na++;
+    }
+    else {
+      t = host_ns();
+      chHeapFree(heapbench_blocks[j]);
+      dt = host_ns() - t;
+      heapbench_blocks[j] = NULL;
+      if (dt > maxf)
+        maxf = dt;
+      sumf += dt;
+      nf++;
+    }
+    if ((i & 1023) == 0) {
+      frags = chHeapStatus(&heap, NULL);
+      if (frags > maxfrags)
+        maxfrags = frags;
+    }
+  }
+  frags = chHeapStatus(&heap, &sz);
+  for (i = 0; i < HEAPBENCH_BLOCKS; i++)
+    if (heapbench_blocks[i] != NULL)
+      chHeapFree(heapbench_blocks[i]);
+
+  sprintf(buf, "allocator: %s", CH_USE_HEAP_TLSF ? "TLSF" : "first-fit");
+  shellPrintLine(chp, buf);
+  sprintf(buf, "alloc: %lu, avg %lu nS, max %lu nS, failed %lu",
+          (unsigned long)na, (unsigned long)(suma / na),
+          (unsigned long)maxa, (unsigned long)fails);
+  shellPrintLine(chp, buf);
+  sprintf(buf, "free : %lu, avg %lu nS, max %lu nS",
+          (unsigned long)nf, (unsigned long)(sumf / nf), (unsigned long)maxf);
+  shellPrintLine(chp, buf);
+  sprintf(buf, "fragments: %lu (max %lu), %lu bytes free",
+          (unsigned long)frags, (unsigned long)maxfrags, (unsigned long)sz);
+  shellPrintLine(chp, buf);
+}
+#endif
+
+#if CH_DBG_ENABLE_TRACE
+/*
+ * Streams the kernel trace on SD2, a shell is not started on SD2 while the
+ * stream is active. The stream can be captured on the host with:
+ *   nc 127.0.0.1 29002 > trace.bin
+ * and converted with tools/chtrace.
+ */
+static void cmd_trace(BaseChannel *chp, int argc, char *argv[]) {
+
+  if ((argc != 1) ||
+      ((strcmp(argv[0], "on") != 0) && (strcmp(argv[0], "off") != 0))) {
+    shellPrintLine(chp, "Usage: trace on|off");
+    return;
+  }
+  if (strcmp(argv[0], "on") == 0) {
+    if (tracetp != NULL) {
+      shellPrintLine(chp, "trace already active");
+      return;
+    }
+    if (shelltp2 != NULL) {
+      shellPrintLine(chp, "SD2 in use by a shell");
+      return;
+    }
+    tracetp = traceStreamCreate((BaseChannel *)&SD2, TRACE_WA_SIZE,
+                                NORMALPRIO + 20);
+    if (tracetp == NULL) {
+      shellPrintLine(chp, "out of memory");
+      return;
+    }
+    shellPrintLine(chp, "trace streaming on SD2");
+  }
+  else {
+    if (tracetp == NULL) {
+      shellPrintLine(chp, "trace not active");
+      return;
+    }
+    traceStreamStop(tracetp);
+    tracetp = NULL;
+    shellPrintLine(chp, "trace stopped");
+  }
+}
+#endif
+
 static const ShellCommand commands[] = {
   {"test", cmd_test},
+  {"idle", cmd_idle},
+  {"serbench", cmd_serbench},
+#if CH_USE_RINGS
+  {"ringstress", cmd_ringstress},
+#endif
+#if HAL_USE_MAC
+  {"macbench", cmd_macbench},
+#endif
+#if HAL_USE_MMC_SPI
+  {"mmcbench", cmd_mmcbench},
+#if MMC_USE_CACHE
+  {"mmccache", cmd_mmccache},
+#endif
+#endif
+#if HAL_USE_ADC
+  {"adcbench", cmd_adcbench},
+#endif
+#if HAL_USE_CAN
+  {"canbench", cmd_canbench},
+#endif
+#if HAL_USE_UART && UART_USE_CONTINUOUS
+  {"uartbench", cmd_uartbench},
+#endif
+#if HAL_USE_SPI && SPI_USE_JOBS
+  {"spibench", cmd_spibench},
+#endif
+#if CH_USE_HEAP && !CH_USE_MALLOC_HEAP
+  {"heapbench", cmd_heapbench},
+#endif
+#if CH_DBG_ENABLE_TRACE
+  {"trace", cmd_trace},
+#endif
   {NULL, NULL}
 };
 
@@ -149,6 +1348,10 @@ static void sd2_handler(eventid_t id) {
 
   (void)id;
   flags = chIOGetAndClearFlags(&SD2);
+#if CH_DBG_ENABLE_TRACE
+  if (tracetp != NULL)
+    flags &= ~IO_CONNECTED;
+#endif
   if ((flags & IO_CONNECTED) && (shelltp2 == NULL)) {
     cputs("Init: connection on SD2");
     shelltp2 = shellCreate(&shell_cfg2, SHELL_WA_SIZE, NORMALPRIO + 10);
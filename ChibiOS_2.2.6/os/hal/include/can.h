@@ -73,6 +73,26 @@
 #define CAN_USE_SLEEP_MODE          TRUE
 #endif
 
+/**
+ * @brief   Software receive FIFO switch.
+ * @details If set to @p TRUE the received frames are moved by the interrupt
+ *          handlers from the hardware mailboxes into a RAM FIFO, this makes
+ *          the reception independent from the receiving threads latency.
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_USE_RINGS.
+ */
+#if !defined(CAN_USE_RX_FIFO) || defined(__DOXYGEN__)
+#define CAN_USE_RX_FIFO             FALSE
+#endif
+
+/**
+ * @brief   Number of frames in the software receive FIFO.
+ * @note    It must be a power of two.
+ */
+#if !defined(CAN_RX_FIFO_SIZE) || defined(__DOXYGEN__)
+#define CAN_RX_FIFO_SIZE            32
+#endif
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
@@ -81,6 +101,14 @@
 #error "CAN driver requires CH_USE_SEMAPHORES and CH_USE_EVENTS"
 #endif
 
+#if CAN_USE_RX_FIFO && !CH_USE_RINGS
+#error "CAN_USE_RX_FIFO requires CH_USE_RINGS"
+#endif
+
+#if CAN_USE_RX_FIFO && ((CAN_RX_FIFO_SIZE & (CAN_RX_FIFO_SIZE - 1)) != 0)
+#error "CAN_RX_FIFO_SIZE must be a power of two"
+#endif
+
 /*===========================================================================*/
 /* Driver data structures and types.                                         */
 /*===========================================================================*/
@@ -112,6 +140,25 @@ typedef enum {
  */
 #define canAddFlagsI(canp, mask) ((canp)->cd_status |= (mask))
 
+/**
+ * @brief   Common ISR code, frames received.
+ * @details This code handles the portable part of the ISR code:
+ *          - Waiting threads wakeup.
+ *          - @p cd_rxfull_event broadcast.
+ *          .
+ * @note    This macro is meant to be used in the low level drivers
+ *          implementation only, when the frames queue becomes non-empty.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ *
+ * @iclass
+ */
+#define _can_rx_isr_code(canp) {                                            \
+  while (chSemGetCounterI(&(canp)->cd_rxsem) < 0)                           \
+    chSemSignalI(&(canp)->cd_rxsem);                                        \
+  chEvtBroadcastI(&(canp)->cd_rxfull_event);                                \
+}
+
 /*===========================================================================*/
 /* External declarations.                                                    */
 /*===========================================================================*/
@@ -125,6 +172,8 @@ extern "C" {
   void canStop(CANDriver *canp);
   msg_t canTransmit(CANDriver *canp, const CANTxFrame *ctfp, systime_t timeout);
   msg_t canReceive(CANDriver *canp, CANRxFrame *crfp, systime_t timeout);
+  size_t canReceiveBatch(CANDriver *canp, CANRxFrame *crfp, size_t n,
+                         systime_t timeout);
   canstatus_t canGetAndClearFlags(CANDriver *canp);
 #if CAN_USE_SLEEP_MODE
   void canSleep(CANDriver *canp);
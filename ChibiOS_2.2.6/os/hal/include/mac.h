@@ -44,6 +44,17 @@
 /* Driver pre-compile time settings.                                         */
 /*===========================================================================*/
 
+/**
+ * @brief   Enables the zero-copy API.
+ * @details If enabled the frames can be composed and parsed directly in
+ *          the driver buffers using @p macGetNextTransmitBuffer() and
+ *          @p macGetNextReceiveBuffer().
+ * @note    The default is @p FALSE.
+ */
+#if !defined(MAC_USE_ZERO_COPY) || defined(__DOXYGEN__)
+#define MAC_USE_ZERO_COPY           FALSE
+#endif
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
@@ -105,6 +116,50 @@
 #define macReadReceiveDescriptor(rdp, buf, size)                            \
     mac_lld_read_receive_descriptor(rdp, buf, size)
 
+#if MAC_USE_ZERO_COPY || defined(__DOXYGEN__)
+/**
+ * @brief   Returns a pointer to the next transmit buffer in the descriptor
+ *          chain.
+ * @note    The API guarantees that enough buffers can be requested to fill
+ *          a whole frame, the buffers are valid until the descriptor is
+ *          released.
+ *
+ * @param[in] tdp       pointer to a @p MACTransmitDescriptor structure
+ * @param[in] size      size of the requested buffer. Specify the frame size
+ *                      on the first call then scale the value down subtracting
+ *                      the amount of data already written into the previous
+ *                      buffers.
+ * @param[out] sizep    pointer to variable receiving the buffer size, it is
+ *                      zero when the last buffer has already been returned.
+ *                      Note that a returned size lower than the amount
+ *                      requested means that more buffers must be requested
+ *                      in order to fill the frame data entirely.
+ * @return              Pointer to the returned buffer.
+ * @retval NULL         if the buffer chain has been entirely scanned.
+ *
+ * @api
+ */
+#define macGetNextTransmitBuffer(tdp, size, sizep)                          \
+    mac_lld_get_next_transmit_buffer(tdp, size, sizep)
+
+/**
+ * @brief   Returns a pointer to the next receive buffer in the descriptor
+ *          chain.
+ * @note    The API guarantees that the descriptor chain contains a whole
+ *          frame, the buffers are valid until the descriptor is released.
+ *
+ * @param[in] rdp       pointer to a @p MACReceiveDescriptor structure
+ * @param[out] sizep    pointer to variable receiving the buffer size, it is
+ *                      zero when the last buffer has already been returned.
+ * @return              Pointer to the returned buffer.
+ * @retval NULL         if the buffer chain has been entirely scanned.
+ *
+ * @api
+ */
+#define macGetNextReceiveBuffer(rdp, sizep)                                 \
+    mac_lld_get_next_receive_buffer(rdp, sizep)
+#endif /* MAC_USE_ZERO_COPY */
+
 /*===========================================================================*/
 /* External declarations.                                                    */
 /*===========================================================================*/
@@ -93,6 +93,34 @@
 #define MMC_POLLING_DELAY           10
 #endif
 
+/**
+ * @brief   Enables the sectors cache.
+ * @details If enabled the @p mmcRead() and @p mmcWrite() functions are
+ *          served by a write-back LRU cache of sectors, the dirty sectors
+ *          are written back in multiple blocks bursts.
+ * @note    The cache is embedded in the @p MMCDriver structure.
+ */
+#if !defined(MMC_USE_CACHE) || defined(__DOXYGEN__)
+#define MMC_USE_CACHE               FALSE
+#endif
+
+/**
+ * @brief   Number of cached sectors.
+ */
+#if !defined(MMC_CACHE_SECTORS) || defined(__DOXYGEN__)
+#define MMC_CACHE_SECTORS           16
+#endif
+
+/**
+ * @brief   Number of sectors read ahead.
+ * @details The sectors following a read request are read ahead into the
+ *          cache when the request continues the previous one. Zero
+ *          disables the read ahead.
+ */
+#if !defined(MMC_CACHE_READ_AHEAD) || defined(__DOXYGEN__)
+#define MMC_CACHE_READ_AHEAD        4
+#endif
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
@@ -101,6 +129,10 @@
 #error "MMC_SPI driver requires HAL_USE_SPI and CH_USE_EVENTS"
 #endif
 
+#if MMC_USE_CACHE && (MMC_CACHE_READ_AHEAD >= MMC_CACHE_SECTORS)
+#error "MMC_CACHE_READ_AHEAD must be lower than MMC_CACHE_SECTORS"
+#endif
+
 /*===========================================================================*/
 /* Driver data structures and types.                                         */
 /*===========================================================================*/
@@ -133,6 +165,64 @@ typedef struct {
   uint8_t               dummy;
 } MMCConfig;
 
+#if MMC_USE_CACHE || defined(__DOXYGEN__)
+/**
+ * @brief   Cached sector.
+ */
+typedef struct {
+  /**
+   * @brief Sector number.
+   */
+  uint32_t              ce_blk;
+  /**
+   * @brief Last use time, for the LRU replacement.
+   */
+  uint32_t              ce_used;
+  /**
+   * @brief The entry contains a sector.
+   */
+  bool_t                ce_valid;
+  /**
+   * @brief The sector has to be written back.
+   */
+  bool_t                ce_dirty;
+  /**
+   * @brief Sector data.
+   */
+  uint8_t               ce_data[MMC_SECTOR_SIZE];
+} MMCCacheEntry;
+
+/**
+ * @brief   Cache statistics.
+ */
+typedef struct {
+  /**
+   * @brief Requested sectors found in the cache.
+   */
+  uint32_t              cs_hits;
+  /**
+   * @brief Requested sectors read from the card.
+   */
+  uint32_t              cs_misses;
+  /**
+   * @brief Sectors read ahead.
+   */
+  uint32_t              cs_readahead;
+  /**
+   * @brief Write back bursts.
+   */
+  uint32_t              cs_bursts;
+  /**
+   * @brief Sectors written back.
+   */
+  uint32_t              cs_written;
+  /**
+   * @brief Read-ahead operations stopped by the card end.
+   */
+  uint32_t              cs_cardend;
+} MMCCacheStats;
+#endif /* MMC_USE_CACHE */
+
 /**
  * @brief   Structure representing a MMC driver.
  */
@@ -181,6 +271,30 @@ typedef struct {
    * @brief Insertion counter.
    */
   uint_fast8_t          mmc_cnt;
+#if MMC_USE_CACHE || defined(__DOXYGEN__)
+  /**
+   * @brief Cached sectors.
+   */
+  MMCCacheEntry         mmc_cache[MMC_CACHE_SECTORS];
+  /**
+   * @brief Cache use counter.
+   */
+  uint32_t              mmc_clock;
+  /**
+   * @brief Sector following the last read request, @p 0xFFFFFFFF if
+   *        there is no previous request.
+   */
+  uint32_t              mmc_nextblk;
+  /**
+   * @brief First sector found beyond the card end, the read-ahead does
+   *        not cross it.
+   */
+  uint32_t              mmc_endblk;
+  /**
+   * @brief Cache statistics.
+   */
+  MMCCacheStats         mmc_stats;
+#endif /* MMC_USE_CACHE */
 } MMCDriver;
 
 /*===========================================================================*/
@@ -209,6 +323,18 @@ typedef struct {
  */
 #define mmcIsWriteProtected(mmcp) ((mmcp)->mmc_is_protected())
 
+#if MMC_USE_CACHE || defined(__DOXYGEN__)
+/**
+ * @brief   Returns the cache statistics.
+ *
+ * @param[in] mmcp      pointer to the @p MMCDriver object
+ * @return              A pointer to the @p MMCCacheStats structure.
+ *
+ * @api
+ */
+#define mmcGetCacheStats(mmcp) (&(mmcp)->mmc_stats)
+#endif /* MMC_USE_CACHE */
+
 /*===========================================================================*/
 /* External declarations.                                                    */
 /*===========================================================================*/
@@ -230,6 +356,11 @@ extern "C" {
   bool_t mmcStartSequentialWrite(MMCDriver *mmcp, uint32_t startblk);
   bool_t mmcSequentialWrite(MMCDriver *mmcp, const uint8_t *buffer);
   bool_t mmcStopSequentialWrite(MMCDriver *mmcp);
+  bool_t mmcRead(MMCDriver *mmcp, uint32_t startblk,
+                 uint8_t *buffer, uint32_t n);
+  bool_t mmcWrite(MMCDriver *mmcp, uint32_t startblk,
+                  const uint8_t *buffer, uint32_t n);
+  bool_t mmcSync(MMCDriver *mmcp);
 #ifdef __cplusplus
 }
 #endif
@@ -61,6 +61,17 @@
 #define SPI_USE_MUTUAL_EXCLUSION    TRUE
 #endif
 
+/**
+ * @brief   Enables the jobs queue APIs.
+ * @details Lists of transfers are executed back to back from the transfer
+ *          complete interrupt, the waiting thread is woken up only at the
+ *          end of the list.
+ * @note    Disabling this option saves both code and data space.
+ */
+#if !defined(SPI_USE_JOBS) || defined(__DOXYGEN__)
+#define SPI_USE_JOBS                FALSE
+#endif
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
@@ -84,8 +95,109 @@ typedef enum {
   SPI_COMPLETE = 4                  /**< Asynchronous operation complete.   */
 } spistate_t;
 
+#if SPI_USE_JOBS || defined(__DOXYGEN__)
+/**
+ * @brief   Job types.
+ */
+typedef enum {
+  SPI_JOB_IGNORE = 0,               /**< Idle words, received data ignored. */
+  SPI_JOB_EXCHANGE = 1,             /**< Simultaneous transmit/receive.     */
+  SPI_JOB_SEND = 2,                 /**< Transmit, received data ignored.   */
+  SPI_JOB_RECEIVE = 3,              /**< Receive, idle words transmitted.   */
+  SPI_JOB_POLL = 4                  /**< Receive frames until a match.      */
+} spijobtype_t;
+
+/**
+ * @brief   Job states.
+ */
+typedef enum {
+  SPI_JOB_PENDING = 0,              /**< Not executed or in progress.       */
+  SPI_JOB_OK = 1,                   /**< Executed.                          */
+  SPI_JOB_TIMEOUT = 2               /**< Poll job without a match.          */
+} spijobstatus_t;
+
+/**
+ * @name    Job flags
+ * @{
+ */
+#define SPI_JOB_SELECT      1       /**< @brief Select before the transfer. */
+#define SPI_JOB_UNSELECT    2       /**< @brief Unselect after the transfer.*/
+#define SPI_JOB_POLL_NOT    4       /**< @brief Poll until a frame differs
+                                                from the match value.       */
+/** @} */
+
+/**
+ * @brief   Type of an SPI job.
+ */
+typedef struct SPIJob SPIJob;
+#endif /* SPI_USE_JOBS */
+
 #include "spi_lld.h"
 
+#if SPI_USE_JOBS || defined(__DOXYGEN__)
+/**
+ * @brief   SPI job notification callback type.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object executing the job
+ * @param[in] jp        pointer to the completed @p SPIJob object
+ */
+typedef void (*spijobcallback_t)(SPIDriver *spip, SPIJob *jp);
+
+/**
+ * @brief   Structure representing an SPI job.
+ * @details A job is a transfer optionally surrounded by the slave selection
+ *          and deselection, jobs are linked in lists executed by the
+ *          driver without thread intervention.
+ */
+struct SPIJob {
+  /**
+   * @brief Next job in the list or @p NULL.
+   */
+  SPIJob                *sj_next;
+  /**
+   * @brief Job type.
+   */
+  spijobtype_t          sj_type;
+  /**
+   * @brief Job flags.
+   */
+  uint8_t               sj_flags;
+  /**
+   * @brief Job status.
+   */
+  spijobstatus_t        sj_status;
+  /**
+   * @brief Number of frames to transfer or, for poll jobs, maximum number
+   *        of frames to poll.
+   */
+  size_t                sj_n;
+  /**
+   * @brief Transmit buffer.
+   */
+  const void            *sj_txbuf;
+  /**
+   * @brief Receive buffer.
+   */
+  void                  *sj_rxbuf;
+  /**
+   * @brief Frame value terminating a poll job.
+   */
+  uint16_t              sj_match;
+  /**
+   * @brief Last frame received by a poll job.
+   */
+  uint16_t              sj_frame;
+  /**
+   * @brief Number of frames received by a poll job.
+   */
+  size_t                sj_polled;
+  /**
+   * @brief Job complete callback or @p NULL.
+   */
+  spijobcallback_t      sj_endcb;
+};
+#endif /* SPI_USE_JOBS */
+
 /*===========================================================================*/
 /* Driver macros.                                                            */
 /*===========================================================================*/
@@ -208,6 +320,44 @@ typedef enum {
  */
 #define spiPolledExchange(spip, frame) spi_lld_polled_exchange(spip, frame)
 
+#if SPI_USE_JOBS || defined(__DOXYGEN__)
+/**
+ * @brief   Starts the execution of a jobs list.
+ * @details This asynchronous function starts the first job of the list, the
+ *          following jobs are started from the transfer complete interrupt.
+ * @post    At the end of the list, or when a poll job fails, the configured
+ *          callback is invoked.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] jp        pointer to the first @p SPIJob object of the list
+ *
+ * @iclass
+ */
+#define spiStartJobsI(spip, jp) {                                           \
+  (spip)->spd_state = SPI_ACTIVE;                                           \
+  (spip)->spd_job = (jp);                                                   \
+  _spi_job_start(spip, jp);                                                 \
+}
+
+/**
+ * @brief   Jobs ISR code.
+ * @details The job in progress, if any, is advanced.
+ * @note    This macro is meant to be used in the low level drivers
+ *          implementation only.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @return              The jobs list state.
+ * @retval TRUE         a transfer of the jobs list has been started.
+ * @retval FALSE        no jobs list in progress or end of the list.
+ *
+ * @notapi
+ */
+#define _spi_job_isr_code(spip)                                             \
+  (((spip)->spd_job != NULL) && _spi_job_serve(spip))
+#else /* !SPI_USE_JOBS */
+#define _spi_job_isr_code(spip) FALSE
+#endif /* !SPI_USE_JOBS */
+
 #if SPI_USE_WAIT || defined(__DOXYGEN__)
 /**
  * @brief   Waits for operation completion.
@@ -252,6 +402,7 @@ typedef enum {
 /**
  * @brief   Common ISR code.
  * @details This code handles the portable part of the ISR code:
+ *          - Jobs list advancement, if any.
  *          - Callback invocation.
  *          - Waiting thread wakeup, if any.
  *          - Driver state transitions.
@@ -264,15 +415,17 @@ typedef enum {
  * @notapi
  */
 #define _spi_isr_code(spip) {                                               \
-  if ((spip)->spd_config->spc_endcb) {                                      \
-    (spip)->spd_state = SPI_COMPLETE;                                       \
-    (spip)->spd_config->spc_endcb(spip);                                    \
-    if ((spip)->spd_state == SPI_COMPLETE)                                  \
+  if (!_spi_job_isr_code(spip)) {                                           \
+    if ((spip)->spd_config->spc_endcb) {                                    \
+      (spip)->spd_state = SPI_COMPLETE;                                     \
+      (spip)->spd_config->spc_endcb(spip);                                  \
+      if ((spip)->spd_state == SPI_COMPLETE)                                \
+        (spip)->spd_state = SPI_READY;                                      \
+    }                                                                       \
+    else                                                                    \
       (spip)->spd_state = SPI_READY;                                        \
+    _spi_wakeup_isr(spip);                                                  \
   }                                                                         \
-  else                                                                      \
-    (spip)->spd_state = SPI_READY;                                          \
-  _spi_wakeup_isr(spip);                                                    \
 }
 
 /*===========================================================================*/
@@ -299,6 +452,16 @@ extern "C" {
   void spiSend(SPIDriver *spip, size_t n, const void *txbuf);
   void spiReceive(SPIDriver *spip, size_t n, void *rxbuf);
 #endif /* SPI_USE_WAIT */
+#if SPI_USE_JOBS
+  void spiJobObjectInit(SPIJob *jp, spijobtype_t type, size_t n,
+                        const void *txbuf, void *rxbuf);
+  void spiStartJobs(SPIDriver *spip, SPIJob *jp);
+#if SPI_USE_WAIT
+  SPIJob *spiRunJobs(SPIDriver *spip, SPIJob *jp);
+#endif
+  void _spi_job_start(SPIDriver *spip, SPIJob *jp);
+  bool_t _spi_job_serve(SPIDriver *spip);
+#endif /* SPI_USE_JOBS */
 #if SPI_USE_MUTUAL_EXCLUSION
   void spiAcquireBus(SPIDriver *spip);
   void spiReleaseBus(SPIDriver *spip);
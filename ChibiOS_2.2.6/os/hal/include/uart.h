@@ -58,10 +58,25 @@
 /* Driver pre-compile time settings.                                         */
 /*===========================================================================*/
 
+/**
+ * @brief   Continuous receive mode switch.
+ * @details If set to @p TRUE the support for the double buffered continuous
+ *          receive mode is included.
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_USE_MAILBOXES.
+ */
+#if !defined(UART_USE_CONTINUOUS) || defined(__DOXYGEN__)
+#define UART_USE_CONTINUOUS         FALSE
+#endif
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
 
+#if UART_USE_CONTINUOUS && !CH_USE_MAILBOXES
+#error "UART_USE_CONTINUOUS requires CH_USE_MAILBOXES"
+#endif
+
 /*===========================================================================*/
 /* Driver data structures and types.                                         */
 /*===========================================================================*/
@@ -90,15 +105,53 @@ typedef enum {
 typedef enum {
   UART_RX_IDLE = 0,                 /**< Not receiving.                     */
   UART_RX_ACTIVE = 1,               /**< Receiving.                         */
-  UART_RX_COMPLETE = 2              /**< Buffer complete.                   */
+  UART_RX_COMPLETE = 2,             /**< Buffer complete.                   */
+  UART_RX_CONTINUOUS = 3            /**< Double buffered receiving.         */
 } uartrxstate_t;
 
+/**
+ * @brief   Continuous receive buffer descriptor.
+ */
+typedef struct {
+  void                      *ub_buf;    /**< @brief Buffer pointer.         */
+  size_t                    ub_n;       /**< @brief Number of data frames
+                                                    received.               */
+} UARTRxBuffer;
+
 #include "uart_lld.h"
 
 /*===========================================================================*/
 /* Driver macros.                                                            */
 /*===========================================================================*/
 
+#if UART_USE_CONTINUOUS || defined(__DOXYGEN__)
+/**
+ * @brief   Common ISR code, continuous receive buffer completed.
+ * @details This code handles the portable part of the ISR code:
+ *          - Buffer callback invocation.
+ *          - Buffer descriptor posting into the mailbox, if any.
+ *          .
+ * @note    This macro is meant to be used in the low level drivers
+ *          implementation only, after the reception has been switched to
+ *          the other buffer.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ * @param[in] rbp       pointer to the completed @p UARTRxBuffer descriptor
+ *
+ * @notapi
+ */
+#define _uart_rx_buffer_isr_code(uartp, rbp) {                              \
+  if ((uartp)->ud_config->uc_rxbuf != NULL)                                 \
+    (uartp)->ud_config->uc_rxbuf(uartp, (rbp)->ub_buf, (rbp)->ub_n);        \
+  if ((uartp)->ud_rxmbox != NULL) {                                         \
+    chSysLockFromIsr();                                                     \
+    if (chMBPostI((uartp)->ud_rxmbox, (msg_t)(rbp)) != RDY_OK)              \
+      (uartp)->ud_rxdropped++;                                              \
+    chSysUnlockFromIsr();                                                   \
+  }                                                                         \
+}
+#endif /* UART_USE_CONTINUOUS */
+
 /*===========================================================================*/
 /* External declarations.                                                    */
 /*===========================================================================*/
@@ -118,6 +171,12 @@ extern "C" {
   void uartStartReceiveI(UARTDriver *uartp, size_t n, void *rxbuf);
   size_t uartStopReceive(UARTDriver *uartp);
   size_t uartStopReceiveI(UARTDriver *uartp);
+#if UART_USE_CONTINUOUS
+  void uartStartContinuousReceive(UARTDriver *uartp, size_t n,
+                                  void *rxbuf0, void *rxbuf1, Mailbox *mbp);
+  void uartStartContinuousReceiveI(UARTDriver *uartp, size_t n,
+                                   void *rxbuf0, void *rxbuf1, Mailbox *mbp);
+#endif
 #ifdef __cplusplus
 }
 #endif
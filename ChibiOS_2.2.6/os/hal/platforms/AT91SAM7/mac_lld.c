@@ -534,6 +534,75 @@ bool_t mac_lld_poll_link_status(MACDriver *macp) {
   return link_up = TRUE;
 }
 
+#if MAC_USE_ZERO_COPY || defined(__DOXYGEN__)
+/**
+ * @brief   Returns a pointer to the next transmit buffer in the descriptor
+ *          chain.
+ * @note    The frame is stored in a single buffer so the whole available
+ *          space is returned by the first call.
+ *
+ * @param[in] tdp       the pointer to the @p MACTransmitDescriptor structure
+ * @param[in] size      size of the requested buffer. Specify the frame size
+ *                      on the first call then scale the value down subtracting
+ *                      the amount of data already copied into the previous
+ *                      buffers.
+ * @param[out] sizep    pointer to variable receiving the buffer size, it is
+ *                      zero when the last buffer has already been returned.
+ * @return              Pointer to the returned buffer.
+ * @retval NULL         if the buffer chain has been entirely scanned.
+ *
+ * @notapi
+ */
+uint8_t *mac_lld_get_next_transmit_buffer(MACTransmitDescriptor *tdp,
+                                          size_t size,
+                                          size_t *sizep) {
+  uint8_t *p;
+
+  if (size > tdp->td_size - tdp->td_offset)
+    size = tdp->td_size - tdp->td_offset;
+  *sizep = size;
+  if (size == 0)
+    return NULL;
+  p = (uint8_t *)(tdp->td_physdesc->w1 & W1_T_ADDRESS_MASK) + tdp->td_offset;
+  tdp->td_offset += size;
+  return p;
+}
+
+/**
+ * @brief   Returns a pointer to the next receive buffer in the descriptor
+ *          chain.
+ * @note    The frame is split only where the receive buffers ring wraps
+ *          around so at most two buffers are returned.
+ *
+ * @param[in] rdp       the pointer to the @p MACReceiveDescriptor structure
+ * @param[out] sizep    pointer to variable receiving the buffer size, it is
+ *                      zero when the last buffer has already been returned.
+ * @return              Pointer to the returned buffer.
+ * @retval NULL         if the buffer chain has been entirely scanned.
+ *
+ * @notapi
+ */
+const uint8_t *mac_lld_get_next_receive_buffer(MACReceiveDescriptor *rdp,
+                                               size_t *sizep) {
+  size_t size = rdp->rd_size - rdp->rd_offset;
+  uint8_t *src, *limit;
+
+  *sizep = 0;
+  if (size == 0)
+    return NULL;
+  src = (uint8_t *)(rdp->rd_physdesc->w1 & W1_R_ADDRESS_MASK) +
+        rdp->rd_offset;
+  limit = &rb[EMAC_RECEIVE_DESCRIPTORS * EMAC_RECEIVE_BUFFERS_SIZE];
+  if (src >= limit)
+    src -= EMAC_RECEIVE_DESCRIPTORS * EMAC_RECEIVE_BUFFERS_SIZE;
+  if (src + size > limit)
+    size = (size_t)(limit - src);
+  rdp->rd_offset += size;
+  *sizep = size;
+  return src;
+}
+#endif /* MAC_USE_ZERO_COPY */
+
 #endif /* HAL_USE_MAC */
 
 /** @} */
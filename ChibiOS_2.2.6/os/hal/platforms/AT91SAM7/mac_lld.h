@@ -197,6 +197,13 @@ extern "C" {
                                          size_t size);
   void mac_lld_release_receive_descriptor(MACReceiveDescriptor *rdp);
   bool_t mac_lld_poll_link_status(MACDriver *macp);
+#if MAC_USE_ZERO_COPY
+  uint8_t *mac_lld_get_next_transmit_buffer(MACTransmitDescriptor *tdp,
+                                            size_t size,
+                                            size_t *sizep);
+  const uint8_t *mac_lld_get_next_receive_buffer(MACReceiveDescriptor *rdp,
+                                                 size_t *sizep);
+#endif
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,455 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,2011 Giovanni Di Sirio.
+
+    This file is part of ChibiOS/RT.
+
+    ChibiOS/RT is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/RT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+                                      ---
+
+    A special exception to the GPL can be applied should you wish to distribute
+    a combined work that includes ChibiOS/RT, without being obliged to provide
+    the source code for any proprietary components. See the file exception.txt
+    for full details of how and when the exception can be applied.
+*/
+
+/**
+ * @file    Posix/adc_lld.c
+ * @brief   Posix low level simulated ADC driver code.
+ * @details The samples file is read through a private memory mapping and
+ *          restarted from its beginning when exhausted. The conversion
+ *          sequences are paced by the host monotonic clock at the virtual
+ *          sample rate, the buffer rows are filled when the corresponding
+ *          half or full transfer interrupt is served by
+ *          @p ChkIntSources().<br>
+ *          In circular mode a transfer interrupt served after the next one
+ *          became due is an overrun, the samples of the lost half buffers
+ *          are skipped as a DMA channel overwriting them would do.
+ *
+ * @addtogroup POSIX_ADC
+ * @{
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/timerfd.h>
+
+#include "ch.h"
+#include "hal.h"
+
+#if HAL_USE_ADC || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/** @brief ADC1 driver identifier.*/
+#if USE_SIM_ADC1 || defined(__DOXYGEN__)
+ADCDriver ADCD1;
+#endif
+
+/*===========================================================================*/
+/* Driver local variables.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Host monotonic clock in nanoseconds.
+ */
+static uint64_t host_ns(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief   Reads a little endian 16 bits value.
+ */
+static uint16_t le16(const uint8_t *p) {
+
+  return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+/**
+ * @brief   Reads a little endian 32 bits value.
+ */
+static uint32_t le32(const uint8_t *p) {
+
+  return (uint32_t)le16(p) | ((uint32_t)le16(p + 2) << 16);
+}
+
+/**
+ * @brief   Locates the samples of a WAV file.
+ * @details Only 16 bits PCM files are accepted.
+ *
+ * @param[in] adcp      pointer to the @p ADCDriver object
+ * @param[out] ratep    sample rate recorded into the file
+ * @return              The file format.
+ * @retval TRUE         valid WAV file.
+ * @retval FALSE        not a WAV file or unsupported format.
+ */
+static bool_t wav_parse(ADCDriver *adcp, uint32_t *ratep) {
+  const uint8_t *p = adcp->ad_map;
+  size_t pos = 12, len;
+  uint16_t format = 0, bits = 0;
+
+  if ((adcp->ad_mapsize < 12) || (memcmp(p, "RIFF", 4) != 0) ||
+      (memcmp(p + 8, "WAVE", 4) != 0))
+    return FALSE;
+  while (pos + 8 <= adcp->ad_mapsize) {
+    len = le32(p + pos + 4);
+    if ((memcmp(p + pos, "fmt ", 4) == 0) && (len >= 16) &&
+        (pos + 8 + 16 <= adcp->ad_mapsize)) {
+      format = le16(p + pos + 8);
+      adcp->ad_channels = le16(p + pos + 10);
+      *ratep = le32(p + pos + 12);
+      bits = le16(p + pos + 22);
+    }
+    else if (memcmp(p + pos, "data", 4) == 0) {
+      /* Truncated recordings are accepted.*/
+      if (len > adcp->ad_mapsize - pos - 8)
+        len = adcp->ad_mapsize - pos - 8;
+      if (((format != 1) && (format != 0xFFFE)) || (bits != 16) ||
+          (adcp->ad_channels == 0))
+        return FALSE;
+      adcp->ad_data = p + pos + 8;
+      adcp->ad_rows = (uint32_t)(len / (adcp->ad_channels * 2U));
+      return adcp->ad_rows > 0;
+    }
+    /* Chunks are word aligned.*/
+    pos += 8 + len + (len & 1);
+  }
+  return FALSE;
+}
+
+/**
+ * @brief   Maps the samples file.
+ *
+ * @param[in] adcp      pointer to the @p ADCDriver object
+ */
+static void file_map(ADCDriver *adcp) {
+  const ADCConfig *cfg = adcp->ad_config;
+  const char *file = (cfg != NULL) && (cfg->ac_file != NULL) ?
+                     cfg->ac_file : SIM_ADC1_FILE;
+  uint32_t rate = 0;
+  struct stat st;
+  void *p;
+  int fd;
+
+  fd = open(file, O_RDONLY);
+  if (fd < 0) {
+    printf("%s: Error opening the samples file\n", file);
+    exit(1);
+  }
+  if ((fstat(fd, &st) != 0) || (st.st_size == 0)) {
+    printf("%s: Error reading the samples file size\n", file);
+    goto abort;
+  }
+  p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (p == MAP_FAILED) {
+    printf("%s: Error mapping the samples file\n", file);
+    goto abort;
+  }
+  close(fd);
+  adcp->ad_map = p;
+  adcp->ad_mapsize = (size_t)st.st_size;
+  adcp->ad_channels = 0;
+  if ((adcp->ad_mapsize >= 4) && (memcmp(p, "RIFF", 4) == 0)) {
+    if (!wav_parse(adcp, &rate)) {
+      printf("%s: Unsupported WAV file, 16 bits PCM required\n", file);
+      exit(1);
+    }
+  }
+  else {
+    /* Raw file, the rows size depends on the conversion group.*/
+    adcp->ad_data = adcp->ad_map;
+    adcp->ad_rows = 0;
+  }
+  if ((cfg != NULL) && (cfg->ac_rate != 0))
+    rate = cfg->ac_rate;
+  adcp->ad_rate = rate != 0 ? rate : SIM_ADC1_RATE;
+  adcp->ad_row = 0;
+  return;
+
+abort:
+  close(fd);
+  exit(1);
+}
+
+/**
+ * @brief   Releases the samples file mapping.
+ *
+ * @param[in] adcp      pointer to the @p ADCDriver object
+ */
+static void file_unmap(ADCDriver *adcp) {
+
+  if (adcp->ad_map != NULL) {
+    munmap(adcp->ad_map, adcp->ad_mapsize);
+    adcp->ad_map = NULL;
+  }
+}
+
+/**
+ * @brief   Rows of the transfer interrupt period.
+ *
+ * @param[in] adcp      pointer to the @p ADCDriver object
+ */
+static size_t period_rows(ADCDriver *adcp) {
+
+  return adcp->ad_depth > 1 ? adcp->ad_depth / 2 : 1;
+}
+
+/**
+ * @brief   Host time of the transfer interrupt @p n after the conversion
+ *          start, in nanoseconds from the start.
+ *
+ * @param[in] adcp      pointer to the @p ADCDriver object
+ * @param[in] n         the transfer interrupt number, starting from one
+ */
+static uint64_t period_ns(ADCDriver *adcp, uint64_t n) {
+  uint64_t rows = n * period_rows(adcp);
+
+  return (rows / adcp->ad_rate) * 1000000000ULL +
+         ((rows % adcp->ad_rate) * 1000000000ULL + adcp->ad_rate - 1) /
+         adcp->ad_rate;
+}
+
+/**
+ * @brief   Converts rows reading them from the samples file.
+ *
+ * @param[in] adcp      pointer to the @p ADCDriver object
+ * @param[out] bp       pointer to the first buffer row
+ * @param[in] n         number of rows
+ */
+static void rows_fill(ADCDriver *adcp, adcsample_t *bp, size_t n) {
+  adc_channels_num_t c, nch = adcp->ad_grpp->acg_num_channels;
+  uint32_t row = adcp->ad_row;
+
+  adcp->ad_converted += n;
+  while (n-- > 0) {
+    if (adcp->ad_channels == 0)
+      memcpy(bp, adcp->ad_data + (size_t)row * nch * sizeof(adcsample_t),
+             nch * sizeof(adcsample_t));
+    else {
+      const uint8_t *rp = adcp->ad_data + (size_t)row * adcp->ad_channels * 2;
+
+      for (c = 0; c < nch; c++) {
+        const uint8_t *sp = rp + (c % adcp->ad_channels) * 2;
+
+        bp[c] = (adcsample_t)((le16(sp) ^ 0x8000) >>
+                              (16 - SIM_ADC_RESOLUTION));
+      }
+    }
+    bp += nch;
+    if (++row >= adcp->ad_rows)
+      row = 0;
+  }
+  adcp->ad_row = row;
+}
+
+/*===========================================================================*/
+/* Driver interrupt handlers.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Low level ADC driver initialization.
+ *
+ * @notapi
+ */
+void adc_lld_init(void) {
+
+#if USE_SIM_ADC1
+  adcObjectInit(&ADCD1);
+  ADCD1.ad_map = NULL;
+  ADCD1.ad_converted = 0;
+  ADCD1.ad_overruns = 0;
+  ADCD1.ad_max_latency = 0;
+  ADCD1.ad_tfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
+  if (ADCD1.ad_tfd < 0) {
+    puts("Unable to create the ADC timerfd");
+    exit(1);
+  }
+#endif
+}
+
+/**
+ * @brief   Configures and activates the ADC peripheral.
+ * @details The samples file of the configuration is mapped, a file
+ *          previously mapped is released.
+ *
+ * @param[in] adcp      pointer to the @p ADCDriver object
+ *
+ * @notapi
+ */
+void adc_lld_start(ADCDriver *adcp) {
+
+  file_unmap(adcp);
+  file_map(adcp);
+}
+
+/**
+ * @brief   Deactivates the ADC peripheral.
+ *
+ * @param[in] adcp      pointer to the @p ADCDriver object
+ *
+ * @notapi
+ */
+void adc_lld_stop(ADCDriver *adcp) {
+
+  if (adcp->ad_state == ADC_READY)
+    file_unmap(adcp);
+}
+
+/**
+ * @brief   Starts an ADC conversion.
+ * @details The conversion continues from the file position reached by the
+ *          previous one.
+ *
+ * @param[in] adcp      pointer to the @p ADCDriver object
+ *
+ * @notapi
+ */
+void adc_lld_start_conversion(ADCDriver *adcp) {
+  adc_channels_num_t nch = adcp->ad_grpp->acg_num_channels;
+
+  chDbgAssert((nch > 0) && (nch <= SIM_ADC_MAX_CHANNELS),
+              "adc_lld_start_conversion(), #1", "invalid channels number");
+  if (adcp->ad_channels == 0) {
+    adcp->ad_rows = (uint32_t)(adcp->ad_mapsize / (nch * sizeof(adcsample_t)));
+    chDbgAssert(adcp->ad_rows > 0,
+                "adc_lld_start_conversion(), #2", "samples file too small");
+  }
+  if (adcp->ad_row >= adcp->ad_rows)
+    adcp->ad_row = 0;
+  adcp->ad_periods = 0;
+  adcp->ad_start = host_ns();
+}
+
+/**
+ * @brief   Stops an ongoing conversion.
+ *
+ * @param[in] adcp      pointer to the @p ADCDriver object
+ *
+ * @notapi
+ */
+void adc_lld_stop_conversion(ADCDriver *adcp) {
+  struct itimerspec its = {{0, 0}, {0, 0}};
+
+  timerfd_settime(adcp->ad_tfd, 0, &its, NULL);
+}
+
+/**
+ * @brief   Serves the pending transfer interrupts.
+ * @details One transfer interrupt is served for each invocation, the rows
+ *          of its half of the buffer are converted before the callback.
+ *
+ * @return              The interrupts state.
+ * @retval TRUE         an interrupt has been served.
+ * @retval FALSE        no interrupts pending.
+ */
+bool_t adc_lld_interrupt_pending(void) {
+#if USE_SIM_ADC1
+  ADCDriver *adcp = &ADCD1;
+  uint64_t ns, due, late;
+  size_t half;
+
+  if (adcp->ad_state != ADC_ACTIVE)
+    return FALSE;
+  ns = host_ns() - adcp->ad_start;
+  due = ((ns / 1000000000ULL) * adcp->ad_rate +
+         ((ns % 1000000000ULL) * adcp->ad_rate) / 1000000000ULL) /
+        period_rows(adcp);
+  if (due <= adcp->ad_periods)
+    return FALSE;
+  late = ns - period_ns(adcp, adcp->ad_periods + 1);
+  if (late > adcp->ad_max_latency)
+    adcp->ad_max_latency = late > 0xFFFFFFFFULL ? 0xFFFFFFFF : (uint32_t)late;
+  if (adcp->ad_grpp->acg_circular && (due - adcp->ad_periods > 1)) {
+    uint64_t lost = due - adcp->ad_periods - 1;
+
+    adcp->ad_overruns += (uint32_t)lost;
+    adcp->ad_row = (uint32_t)((adcp->ad_row + lost * period_rows(adcp)) %
+                              adcp->ad_rows);
+    adcp->ad_periods += lost;
+  }
+
+  half = adcp->ad_depth / 2;
+  if ((adcp->ad_depth > 1) && ((adcp->ad_periods++ & 1) == 0)) {
+    rows_fill(adcp, adcp->ad_samples, half);
+    _adc_isr_half_code(adcp);
+  }
+  else {
+    if (adcp->ad_depth > 1)
+      rows_fill(adcp, adcp->ad_samples +
+                      half * adcp->ad_grpp->acg_num_channels, half);
+    else {
+      adcp->ad_periods++;
+      rows_fill(adcp, adcp->ad_samples, 1);
+    }
+    _adc_isr_full_code(adcp);
+  }
+  return TRUE;
+#else
+  return FALSE;
+#endif
+}
+
+/**
+ * @brief   Collects the descriptors to be waited for while idle.
+ * @details During a conversion the wakeup timer is programmed at the next
+ *          transfer interrupt.
+ *
+ * @param[out] fds      array of @p pollfd structures, it must be able to
+ *                      contain one element
+ * @return              The number of descriptors written into @p fds.
+ */
+int adc_lld_poll_setup(struct pollfd *fds) {
+#if USE_SIM_ADC1
+  ADCDriver *adcp = &ADCD1;
+  struct itimerspec its = {{0, 0}, {0, 0}};
+  uint64_t ns;
+
+  if (adcp->ad_state != ADC_ACTIVE)
+    return 0;
+  ns = adcp->ad_start + period_ns(adcp, adcp->ad_periods + 1);
+  its.it_value.tv_sec = (time_t)(ns / 1000000000ULL);
+  its.it_value.tv_nsec = (long)(ns % 1000000000ULL);
+  timerfd_settime(adcp->ad_tfd, TFD_TIMER_ABSTIME, &its, NULL);
+  fds->fd = adcp->ad_tfd;
+  fds->events = POLLIN;
+  fds->revents = 0;
+  return 1;
+#else
+  (void)fds;
+  return 0;
+#endif
+}
+
+#endif /* HAL_USE_ADC */
+
+/** @} */
@@ -0,0 +1,308 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,2011 Giovanni Di Sirio.
+
+    This file is part of ChibiOS/RT.
+
+    ChibiOS/RT is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/RT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+                                      ---
+
+    A special exception to the GPL can be applied should you wish to distribute
+    a combined work that includes ChibiOS/RT, without being obliged to provide
+    the source code for any proprietary components. See the file exception.txt
+    for full details of how and when the exception can be applied.
+*/
+
+/**
+ * @file    Posix/adc_lld.h
+ * @brief   Posix low level simulated ADC driver header.
+ * @details The simulated ADC1 replays the samples recorded into a memory
+ *          mapped file at a virtual sample rate, the buffer is filled and
+ *          the half and full buffer interrupts are raised as a circular DMA
+ *          channel would do.
+ *
+ * @addtogroup POSIX_ADC
+ * @{
+ */
+
+#ifndef _ADC_LLD_H_
+#define _ADC_LLD_H_
+
+#if HAL_USE_ADC || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Maximum number of channels in a conversion group.
+ */
+#define SIM_ADC_MAX_CHANNELS        16
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   ADC1 driver enable switch.
+ * @details If set to @p TRUE the support for ADC1 is included.
+ * @note    The default is @p TRUE.
+ */
+#if !defined(USE_SIM_ADC1) || defined(__DOXYGEN__)
+#define USE_SIM_ADC1                TRUE
+#endif
+
+/**
+ * @brief   Default samples file of ADC1.
+ * @details The file is used when the configuration does not specify one.
+ */
+#if !defined(SIM_ADC1_FILE) || defined(__DOXYGEN__)
+#define SIM_ADC1_FILE               "adc.wav"
+#endif
+
+/**
+ * @brief   Default virtual sample rate of ADC1.
+ * @details Conversion sequences per second, used when neither the
+ *          configuration nor the samples file specify a rate.
+ */
+#if !defined(SIM_ADC1_RATE) || defined(__DOXYGEN__)
+#define SIM_ADC1_RATE               10000
+#endif
+
+/**
+ * @brief   Resolution of the simulated converter in bits.
+ * @details The 16 bits signed samples of WAV files are converted into
+ *          unsigned samples of this resolution, the samples of raw files are
+ *          used as they are.
+ */
+#if !defined(SIM_ADC_RESOLUTION) || defined(__DOXYGEN__)
+#define SIM_ADC_RESOLUTION          12
+#endif
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if !defined(__linux__)
+#error "the simulated ADC driver requires a Linux host"
+#endif
+
+#if !USE_SIM_ADC1
+#error "ADC driver activated but no ADC peripheral assigned"
+#endif
+
+#if (SIM_ADC_RESOLUTION < 1) || (SIM_ADC_RESOLUTION > 16)
+#error "invalid SIM_ADC_RESOLUTION value"
+#endif
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   ADC sample data type.
+ */
+typedef uint16_t adcsample_t;
+
+/**
+ * @brief   Channels number in a conversion group.
+ */
+typedef uint16_t adc_channels_num_t;
+
+/**
+ * @brief   Type of a structure representing an ADC driver.
+ */
+typedef struct ADCDriver ADCDriver;
+
+/**
+ * @brief   ADC notification callback type.
+ *
+ * @param[in] adcp      pointer to the @p ADCDriver object triggering the
+ *                      callback
+ * @param[in] buffer    pointer to the most recent samples data
+ * @param[in] n         number of buffer rows available starting from @p buffer
+ */
+typedef void (*adccallback_t)(ADCDriver *adcp, adcsample_t *buffer, size_t n);
+
+/**
+ * @brief   Conversion group configuration structure.
+ * @details The channel @p n of the group samples the channel @p n of the
+ *          file, modulo the number of channels recorded into the file.
+ */
+typedef struct {
+  /**
+   * @brief   Enables the circular buffer mode for the group.
+   */
+  bool_t                    acg_circular;
+  /**
+   * @brief   Number of the analog channels belonging to the conversion group.
+   */
+  adc_channels_num_t        acg_num_channels;
+  /**
+   * @brief   Callback function associated to the group or @p NULL.
+   */
+  adccallback_t             acg_endcb;
+  /* End of the mandatory fields.*/
+} ADCConversionGroup;
+
+/**
+ * @brief   Driver configuration structure.
+ */
+typedef struct {
+  /**
+   * @brief   Samples file or @p NULL for @p SIM_ADC1_FILE.
+   * @details A WAV file with 16 bits PCM samples or a raw file of
+   *          @p adcsample_t values, in the latter case the file is made of
+   *          rows of as many samples as the channels of the conversion
+   *          group.
+   */
+  const char                *ac_file;
+  /**
+   * @brief   Virtual sample rate in conversion sequences per second, zero
+   *          for the rate of the WAV file or @p SIM_ADC1_RATE.
+   */
+  uint32_t                  ac_rate;
+} ADCConfig;
+
+/**
+ * @brief   Structure representing an ADC driver.
+ */
+struct ADCDriver {
+  /**
+   * @brief Driver state.
+   */
+  adcstate_t                ad_state;
+  /**
+   * @brief Current configuration data.
+   */
+  const ADCConfig           *ad_config;
+  /**
+   * @brief Current samples buffer pointer or @p NULL.
+   */
+  adcsample_t               *ad_samples;
+  /**
+   * @brief Current samples buffer depth or @p 0.
+   */
+  size_t                    ad_depth;
+  /**
+   * @brief Current conversion group pointer or @p NULL.
+   */
+  const ADCConversionGroup  *ad_grpp;
+#if ADC_USE_WAIT || defined(__DOXYGEN__)
+  /**
+   * @brief Waiting thread.
+   */
+  Thread                    *ad_thread;
+#endif
+#if ADC_USE_MUTUAL_EXCLUSION || defined(__DOXYGEN__)
+#if CH_USE_MUTEXES || defined(__DOXYGEN__)
+  /**
+   * @brief Mutex protecting the peripheral.
+   */
+  Mutex                     ad_mutex;
+#elif CH_USE_SEMAPHORES
+  Semaphore                 ad_semaphore;
+#endif
+#endif /* ADC_USE_MUTUAL_EXCLUSION */
+#if defined(ADC_DRIVER_EXT_FIELDS)
+  ADC_DRIVER_EXT_FIELDS
+#endif
+  /* End of the mandatory fields.*/
+  /**
+   * @brief Memory mapped samples file or @p NULL.
+   */
+  uint8_t                   *ad_map;
+  /**
+   * @brief Size of the mapping.
+   */
+  size_t                    ad_mapsize;
+  /**
+   * @brief First sample of the file.
+   */
+  const uint8_t             *ad_data;
+  /**
+   * @brief Number of rows in the file.
+   */
+  uint32_t                  ad_rows;
+  /**
+   * @brief Channels recorded into the file or zero for a raw file.
+   */
+  uint16_t                  ad_channels;
+  /**
+   * @brief Virtual sample rate.
+   */
+  uint32_t                  ad_rate;
+  /**
+   * @brief Next row of the file to be converted.
+   */
+  uint32_t                  ad_row;
+  /**
+   * @brief Host time of the conversion start in nanoseconds.
+   */
+  uint64_t                  ad_start;
+  /**
+   * @brief Number of DMA transfer interrupts since the conversion start.
+   */
+  uint64_t                  ad_periods;
+  /**
+   * @brief Idle wakeup timer descriptor.
+   */
+  int                       ad_tfd;
+  /**
+   * @brief Number of rows converted.
+   */
+  uint64_t                  ad_converted;
+  /**
+   * @brief Number of transfer interrupts lost because served too late,
+   *          each one is half buffer of samples.
+   */
+  uint32_t                  ad_overruns;
+  /**
+   * @brief Worst delay between a transfer interrupt and its service, in
+   *          nanoseconds.
+   */
+  uint32_t                  ad_max_latency;
+};
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#if USE_SIM_ADC1 && !defined(__DOXYGEN__)
+extern ADCDriver ADCD1;
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void adc_lld_init(void);
+  void adc_lld_start(ADCDriver *adcp);
+  void adc_lld_stop(ADCDriver *adcp);
+  void adc_lld_start_conversion(ADCDriver *adcp);
+  void adc_lld_stop_conversion(ADCDriver *adcp);
+  bool_t adc_lld_interrupt_pending(void);
+  int adc_lld_poll_setup(struct pollfd *fds);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HAL_USE_ADC */
+
+#endif /* _ADC_LLD_H_ */
+
+/** @} */
@@ -0,0 +1,381 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,2011 Giovanni Di Sirio.
+
+    This file is part of ChibiOS/RT.
+
+    ChibiOS/RT is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/RT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+                                      ---
+
+    A special exception to the GPL can be applied should you wish to distribute
+    a combined work that includes ChibiOS/RT, without being obliged to provide
+    the source code for any proprietary components. See the file exception.txt
+    for full details of how and when the exception can be applied.
+*/
+
+/**
+ * @file    Posix/can_lld.c
+ * @brief   Posix low level simulated CAN driver code.
+ * @details The bus is serialized by a host mutex, a frame sent on the bus
+ *          is stored into the receive FIFO of CAN1 by the sending thread
+ *          itself, as the controller hardware would do, then the CAN1
+ *          interrupt line is raised in order to wake up the receiving
+ *          threads.<br>
+ *          Without @p CAN_USE_RX_FIFO the frames are stored into a three
+ *          frames deep FIFO like the STM32 bxCAN one and the frames arriving
+ *          while it is full are lost. With @p CAN_USE_RX_FIFO the frames are
+ *          stored directly into the driver software FIFO, this models an
+ *          interrupt handler emptying the hardware FIFO as soon as a frame
+ *          arrives.
+ *
+ * @addtogroup POSIX_CAN
+ * @{
+ */
+
+#include <time.h>
+#include <pthread.h>
+
+#include "ch.h"
+#include "hal.h"
+
+#if HAL_USE_CAN || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/** @brief CAN1 driver identifier.*/
+#if USE_SIM_CAN1 || defined(__DOXYGEN__)
+CANDriver CAND1;
+#endif
+
+/*===========================================================================*/
+/* Driver local variables.                                                   */
+/*===========================================================================*/
+
+/**
+ * @name    Pending interrupt sources
+ * @{
+ */
+#define SIM_CAN_TX                  1U
+#define SIM_CAN_RX                  2U
+#define SIM_CAN_OVERRUN             4U
+/** @} */
+
+/**
+ * @brief   Bus lock, only one frame at time is on the bus.
+ */
+static pthread_mutex_t bus_mtx = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief   Listener of the frames transmitted by CAN1.
+ */
+static simcanlistener_t bus_listener;
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Host monotonic clock in microseconds.
+ */
+static uint32_t host_us(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint32_t)ts.tv_sec * 1000000U + (uint32_t)(ts.tv_nsec / 1000);
+}
+
+/**
+ * @brief   Signals pending interrupt sources.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ * @param[in] mask      the sources to be signaled
+ */
+static void irq_pend(CANDriver *canp, uint32_t mask) {
+
+  __atomic_fetch_or(&canp->cd_pending, mask, __ATOMIC_ACQ_REL);
+  sim_irq_raise(SIM_CAN1_IRQ);
+}
+
+/**
+ * @brief   Stores a frame of the bus into the receive FIFO.
+ * @pre     The bus must be locked, the bus lock serializes the producers of
+ *          the receive FIFO.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ * @param[in] ctfp      pointer to the frame on the bus
+ */
+static void bus_deliver(CANDriver *canp, const CANTxFrame *ctfp) {
+  CANRxFrame rxf;
+  msg_t msg;
+
+  if (!canp->cd_attached)
+    return;
+  rxf.cf_FMI = 0;
+  rxf.cf_TIME = (uint16_t)host_us();
+  rxf.cf_DLC = ctfp->cf_DLC;
+  rxf.cf_RTR = ctfp->cf_RTR;
+  rxf.cf_IDE = ctfp->cf_IDE;
+  if (ctfp->cf_IDE)
+    rxf.cf_EID = ctfp->cf_EID;
+  else
+    rxf.cf_SID = ctfp->cf_SID;
+  rxf.cf_data32[0] = ctfp->cf_data32[0];
+  rxf.cf_data32[1] = ctfp->cf_data32[1];
+  canp->cd_rxframes++;
+#if CAN_USE_RX_FIFO
+  msg = chRingWrite(&canp->cd_rxfifo, &rxf);
+  if (msg == RING_FULL) {
+    __atomic_fetch_add(&canp->cd_overruns, 1, __ATOMIC_RELAXED);
+    irq_pend(canp, SIM_CAN_OVERRUN);
+    return;
+  }
+#else
+  if (chRingGetUsed(&canp->cd_hwfifo) >= SIM_CAN_HW_FIFO_SIZE) {
+    __atomic_fetch_add(&canp->cd_hwoverruns, 1, __ATOMIC_RELAXED);
+    irq_pend(canp, SIM_CAN_OVERRUN);
+    return;
+  }
+  msg = chRingWrite(&canp->cd_hwfifo, &rxf);
+#endif
+  if (msg == RING_WAS_EMPTY)
+    irq_pend(canp, SIM_CAN_RX);
+}
+
+/*===========================================================================*/
+/* Driver interrupt handlers.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   CAN1 interrupt handler.
+ *
+ * @isr
+ */
+static void can1_isr(void) {
+  uint32_t pending;
+
+  pending = __atomic_exchange_n(&CAND1.cd_pending, 0, __ATOMIC_ACQ_REL);
+  if (pending & SIM_CAN_TX) {
+    while (chSemGetCounterI(&CAND1.cd_txsem) < 0)
+      chSemSignalI(&CAND1.cd_txsem);
+    chEvtBroadcastI(&CAND1.cd_txempty_event);
+  }
+  if (pending & SIM_CAN_RX)
+    _can_rx_isr_code(&CAND1);
+  if (pending & SIM_CAN_OVERRUN) {
+    canAddFlagsI(&CAND1, CAN_OVERFLOW_ERROR);
+    chEvtBroadcastI(&CAND1.cd_error_event);
+  }
+}
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Low level CAN driver initialization.
+ *
+ * @notapi
+ */
+void can_lld_init(void) {
+
+#if USE_SIM_CAN1
+  canObjectInit(&CAND1);
+  CAND1.cd_attached = FALSE;
+  CAND1.cd_pending = 0;
+  CAND1.cd_rxframes = 0;
+#endif
+}
+
+/**
+ * @brief   Configures and activates the CAN peripheral.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ *
+ * @notapi
+ */
+void can_lld_start(CANDriver *canp) {
+
+#if !CAN_USE_RX_FIFO
+  chRingInit(&canp->cd_hwfifo, canp->cd_hwbuf, sizeof(CANRxFrame),
+             sizeof(canp->cd_hwbuf) / sizeof(CANRxFrame));
+#endif
+  canp->cd_pending = 0;
+  sim_irq_set_handler(SIM_CAN1_IRQ, can1_isr);
+  pthread_mutex_lock(&bus_mtx);
+  canp->cd_attached = TRUE;
+  pthread_mutex_unlock(&bus_mtx);
+}
+
+/**
+ * @brief   Deactivates the CAN peripheral.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ *
+ * @notapi
+ */
+void can_lld_stop(CANDriver *canp) {
+
+  /* If in ready state then disables the CAN peripheral.*/
+  if (canp->cd_state == CAN_READY) {
+    pthread_mutex_lock(&bus_mtx);
+    canp->cd_attached = FALSE;
+    pthread_mutex_unlock(&bus_mtx);
+    sim_irq_set_handler(SIM_CAN1_IRQ, NULL);
+    canp->cd_pending = 0;
+  }
+}
+
+/**
+ * @brief   Determines whether a frame can be transmitted.
+ * @note    The transmission is immediate, the slot is always available.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ *
+ * @return The queue space availability.
+ * @retval FALSE        no space in the transmit queue.
+ * @retval TRUE         transmit slot available.
+ *
+ * @notapi
+ */
+bool_t can_lld_can_transmit(CANDriver *canp) {
+
+  (void)canp;
+  return TRUE;
+}
+
+/**
+ * @brief   Inserts a frame into the transmit queue.
+ * @details The frame is passed to the bus listener and, in loopback mode,
+ *          received back.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ * @param[in] ctfp      pointer to the CAN frame to be transmitted
+ *
+ * @notapi
+ */
+void can_lld_transmit(CANDriver *canp, const CANTxFrame *ctfp) {
+
+  pthread_mutex_lock(&bus_mtx);
+  if (bus_listener != NULL)
+    bus_listener(ctfp);
+  if (canp->cd_config->cc_loopback)
+    bus_deliver(canp, ctfp);
+  pthread_mutex_unlock(&bus_mtx);
+  irq_pend(canp, SIM_CAN_TX);
+}
+
+/**
+ * @brief   Determines whether a frame has been received.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ *
+ * @return The queue space availability.
+ * @retval FALSE        no space in the transmit queue.
+ * @retval TRUE         transmit slot available.
+ *
+ * @notapi
+ */
+bool_t can_lld_can_receive(CANDriver *canp) {
+
+#if CAN_USE_RX_FIFO
+  (void)canp;
+  return FALSE;
+#else
+  if (chRingGetUsed(&canp->cd_hwfifo) > 0)
+    return TRUE;
+  /* Pairs with the fence in chRingWrite(), a frame written after the
+     check finds the FIFO empty and raises the interrupt.*/
+  RING_FENCE();
+  return chRingGetUsed(&canp->cd_hwfifo) > 0;
+#endif
+}
+
+/**
+ * @brief   Receives a frame from the input queue.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ * @param[out] crfp     pointer to the buffer where the CAN frame is copied
+ *
+ * @notapi
+ */
+void can_lld_receive(CANDriver *canp, CANRxFrame *crfp) {
+
+#if CAN_USE_RX_FIFO
+  (void)canp;
+  (void)crfp;
+#else
+  chRingRead(&canp->cd_hwfifo, crfp);
+#endif
+}
+
+#if CAN_USE_SLEEP_MODE || defined(__DOXYGEN__)
+/**
+ * @brief   Enters the sleep mode.
+ * @note    The simulated controller keeps receiving while sleeping.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ *
+ * @notapi
+ */
+void can_lld_sleep(CANDriver *canp) {
+
+  (void)canp;
+}
+
+/**
+ * @brief   Enforces leaving the sleep mode.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ *
+ * @notapi
+ */
+void can_lld_wakeup(CANDriver *canp) {
+
+  (void)canp;
+}
+#endif /* CAN_USE_SLEEP_MODE */
+
+/**
+ * @brief   Sends a frame on the virtual bus.
+ * @details The frame is received by CAN1 if it is active, the frame is lost
+ *          if the receive FIFO of CAN1 is full.
+ * @note    This function can be invoked from any host thread, it does not
+ *          access the kernel.
+ *
+ * @param[in] ctfp      pointer to the frame to be sent
+ */
+void can_lld_bus_send(const CANTxFrame *ctfp) {
+
+  pthread_mutex_lock(&bus_mtx);
+  bus_deliver(&CAND1, ctfp);
+  pthread_mutex_unlock(&bus_mtx);
+}
+
+/**
+ * @brief   Sets the listener of the frames transmitted by CAN1.
+ *
+ * @param[in] listener  the listener or @p NULL
+ */
+void can_lld_bus_listen(simcanlistener_t listener) {
+
+  pthread_mutex_lock(&bus_mtx);
+  bus_listener = listener;
+  pthread_mutex_unlock(&bus_mtx);
+}
+
+#endif /* HAL_USE_CAN */
+
+/** @} */
@@ -0,0 +1,322 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,2011 Giovanni Di Sirio.
+
+    This file is part of ChibiOS/RT.
+
+    ChibiOS/RT is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/RT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+                                      ---
+
+    A special exception to the GPL can be applied should you wish to distribute
+    a combined work that includes ChibiOS/RT, without being obliged to provide
+    the source code for any proprietary components. See the file exception.txt
+    for full details of how and when the exception can be applied.
+*/
+
+/**
+ * @file    Posix/can_lld.h
+ * @brief   Posix low level simulated CAN driver header.
+ * @details The simulated CAN1 controller is attached to an in-process
+ *          virtual bus, the other nodes of the bus are host threads that
+ *          send frames with @p can_lld_bus_send() and receive the frames
+ *          transmitted by CAN1 through a listener.
+ *
+ * @addtogroup POSIX_CAN
+ * @{
+ */
+
+#ifndef _CAN_LLD_H_
+#define _CAN_LLD_H_
+
+#if HAL_USE_CAN || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   This switch defines whether the driver implementation supports
+ *          a low power switch mode with automatic an wakeup feature.
+ */
+#define CAN_SUPPORTS_SLEEP          TRUE
+
+/**
+ * @brief   Depth of the simulated hardware receive FIFO.
+ */
+#define SIM_CAN_HW_FIFO_SIZE        3
+
+#define CAN_IDE_STD                 0           /**< @brief Standard id.    */
+#define CAN_IDE_EXT                 1           /**< @brief Extended id.    */
+
+#define CAN_RTR_DATA                0           /**< @brief Data frame.     */
+#define CAN_RTR_REMOTE              1           /**< @brief Remote frame.   */
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   CAN1 driver enable switch.
+ * @details If set to @p TRUE the support for CAN1 is included.
+ * @note    The default is @p TRUE.
+ */
+#if !defined(USE_SIM_CAN1) || defined(__DOXYGEN__)
+#define USE_SIM_CAN1                TRUE
+#endif
+
+/**
+ * @brief   Simulated interrupt line of CAN1.
+ */
+#if !defined(SIM_CAN1_IRQ) || defined(__DOXYGEN__)
+#define SIM_CAN1_IRQ                1
+#endif
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if !USE_SIM_CAN1
+#error "CAN driver activated but no CAN peripheral assigned"
+#endif
+
+#if SIM_CAN1_IRQ >= SIM_IRQ_LINES
+#error "invalid SIM_CAN1_IRQ value"
+#endif
+
+#if !CH_USE_RINGS
+#error "the simulated CAN driver requires CH_USE_RINGS"
+#endif
+
+#if CAN_USE_SLEEP_MODE && !CAN_SUPPORTS_SLEEP
+#error "CAN sleep mode not supported in this architecture"
+#endif
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   CAN status flags.
+ */
+typedef uint32_t canstatus_t;
+
+/**
+ * @brief   CAN transmission frame.
+ * @note    Accessing the frame data as word16 or word32 is not portable
+ *          because machine data endianness, it can be still useful for a
+ *          quick filling.
+ */
+typedef struct {
+  struct {
+    uint8_t                 cf_DLC:4;       /**< @brief Data length.        */
+    uint8_t                 cf_RTR:1;       /**< @brief Frame type.         */
+    uint8_t                 cf_IDE:1;       /**< @brief Identifier type.    */
+  };
+  union {
+    struct {
+      uint32_t              cf_SID:11;      /**< @brief Standard identifier.*/
+    };
+    struct {
+      uint32_t              cf_EID:29;      /**< @brief Extended identifier.*/
+    };
+  };
+  union {
+    uint8_t                 cf_data8[8];    /**< @brief Frame data.         */
+    uint16_t                cf_data16[4];   /**< @brief Frame data.         */
+    uint32_t                cf_data32[2];   /**< @brief Frame data.         */
+  };
+} CANTxFrame;
+
+/**
+ * @brief   CAN received frame.
+ * @note    Accessing the frame data as word16 or word32 is not portable
+ *          because machine data endianness, it can be still useful for a
+ *          quick filling.
+ */
+typedef struct {
+  struct {
+    uint8_t                 cf_FMI;         /**< @brief Filter id.          */
+    uint16_t                cf_TIME;        /**< @brief Time stamp.         */
+  };
+  struct {
+    uint8_t                 cf_DLC:4;       /**< @brief Data length.        */
+    uint8_t                 cf_RTR:1;       /**< @brief Frame type.         */
+    uint8_t                 cf_IDE:1;       /**< @brief Identifier type.    */
+  };
+  union {
+    struct {
+      uint32_t              cf_SID:11;      /**< @brief Standard identifier.*/
+    };
+    struct {
+      uint32_t              cf_EID:29;      /**< @brief Extended identifier.*/
+    };
+  };
+  union {
+    uint8_t                 cf_data8[8];    /**< @brief Frame data.         */
+    uint16_t                cf_data16[4];   /**< @brief Frame data.         */
+    uint32_t                cf_data32[2];   /**< @brief Frame data.         */
+  };
+} CANRxFrame;
+
+/**
+ * @brief   Virtual bus listener type.
+ * @details The listener is invoked for each frame transmitted by CAN1, it
+ *          is invoked in the kernel context with the bus locked so it must
+ *          not block.
+ */
+typedef void (*simcanlistener_t)(const CANTxFrame *ctfp);
+
+/**
+ * @brief   Driver configuration structure.
+ */
+typedef struct {
+  /**
+   * @brief Loopback mode, the transmitted frames are also received.
+   */
+  bool_t                    cc_loopback;
+} CANConfig;
+
+/**
+ * @brief   Structure representing an CAN driver.
+ */
+typedef struct {
+  /**
+   * @brief Driver state.
+   */
+  canstate_t                cd_state;
+  /**
+   * @brief Current configuration data.
+   */
+  const CANConfig           *cd_config;
+  /**
+   * @brief Transmission queue semaphore.
+   */
+  Semaphore                 cd_txsem;
+  /**
+   * @brief Receive queue semaphore.
+   */
+  Semaphore                 cd_rxsem;
+  /**
+   * @brief One or more frames become available.
+   * @note  After broadcasting this event it will not be broadcasted again
+   *        until the received frames queue has been completely emptied. It
+   *        is <b>not</b> broadcasted for each received frame. It is
+   *        responsibility of the application to empty the queue by repeatedly
+   *        invoking @p chReceive() when listening to this event. This behavior
+   *        minimizes the interrupt served by the system because CAN traffic.
+   */
+  EventSource               cd_rxfull_event;
+  /**
+   * @brief One or more transmission slots become available.
+   */
+  EventSource               cd_txempty_event;
+  /**
+   * @brief A CAN bus error happened.
+   */
+  EventSource               cd_error_event;
+  /**
+   * @brief Error flags set when an error event is broadcasted.
+   */
+  canstatus_t               cd_status;
+#if CAN_USE_SLEEP_MODE || defined (__DOXYGEN__)
+  /**
+   * @brief Entering sleep state event.
+   */
+  EventSource               cd_sleep_event;
+  /**
+   * @brief Exiting sleep state event.
+   */
+  EventSource               cd_wakeup_event;
+#endif /* CAN_USE_SLEEP_MODE */
+#if CAN_USE_RX_FIFO || defined(__DOXYGEN__)
+  /**
+   * @brief Software receive FIFO.
+   */
+  Ring                      cd_rxfifo;
+  /**
+   * @brief Software receive FIFO buffer.
+   */
+  CANRxFrame                cd_rxbuf[CAN_RX_FIFO_SIZE];
+#endif /* CAN_USE_RX_FIFO */
+  /**
+   * @brief Frames lost because the software receive FIFO was full.
+   */
+  uint32_t                  cd_overruns;
+  /**
+   * @brief Overruns of the hardware receive FIFOs.
+   */
+  uint32_t                  cd_hwoverruns;
+  /* End of the mandatory fields.*/
+#if !CAN_USE_RX_FIFO || defined(__DOXYGEN__)
+  /**
+   * @brief Simulated hardware receive FIFO.
+   */
+  Ring                      cd_hwfifo;
+  /**
+   * @brief Simulated hardware receive FIFO buffer.
+   */
+  CANRxFrame                cd_hwbuf[4];
+#endif /* !CAN_USE_RX_FIFO */
+  /**
+   * @brief Controller attached to the bus.
+   */
+  bool_t                    cd_attached;
+  /**
+   * @brief Pending interrupt sources.
+   */
+  uint32_t                  cd_pending;
+  /**
+   * @brief Number of frames received from the bus, including the lost
+   *        ones.
+   */
+  uint32_t                  cd_rxframes;
+} CANDriver;
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#if USE_SIM_CAN1 && !defined(__DOXYGEN__)
+extern CANDriver CAND1;
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void can_lld_init(void);
+  void can_lld_start(CANDriver *canp);
+  void can_lld_stop(CANDriver *canp);
+  bool_t can_lld_can_transmit(CANDriver *canp);
+  void can_lld_transmit(CANDriver *canp, const CANTxFrame *crfp);
+  bool_t can_lld_can_receive(CANDriver *canp);
+  void can_lld_receive(CANDriver *canp, CANRxFrame *ctfp);
+#if CAN_USE_SLEEP_MODE
+  void can_lld_sleep(CANDriver *canp);
+  void can_lld_wakeup(CANDriver *canp);
+#endif /* CAN_USE_SLEEP_MODE */
+  void can_lld_bus_send(const CANTxFrame *ctfp);
+  void can_lld_bus_listen(simcanlistener_t listener);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HAL_USE_CAN */
+
+#endif /* _CAN_LLD_H_ */
+
+/** @} */
@@ -32,9 +32,19 @@
  * @{
  */
 
+#if defined(__linux__)
+#define _GNU_SOURCE
+#endif
+
 #include <stdio.h>
 #include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
 #include <sys/time.h>
+#if defined(__linux__)
+#include <sys/timerfd.h>
+#endif
 
 #include "ch.h"
 #include "hal.h"
@@ -43,17 +53,288 @@
 /* Driver exported variables.                                                */
 /*===========================================================================*/
 
+/**
+ * @brief   Simulator idle statistics.
+ */
+SimStats sim_stats;
+
 /*===========================================================================*/
 /* Driver local variables.                                                   */
 /*===========================================================================*/
 
+#if !CH_USE_TICKLESS
 static struct timeval nextcnt;
 static struct timeval tick = {0, 1000000 / CH_FREQUENCY};
+#endif
+
+#if POSIX_IDLE_USE_TIMERFD || CH_USE_TICKLESS
+static int idle_tfd = -1;
+#endif
+
+/**
+ * @brief   Simulated interrupt handlers.
+ */
+static simisr_t irq_handlers[SIM_IRQ_LINES];
+
+/**
+ * @brief   Mask of the raised simulated interrupt lines.
+ */
+static uint32_t irq_pending;
+
+/**
+ * @brief   Pipe waking up the idle process when a line is raised.
+ */
+static int irq_pipe[2] = {-1, -1};
+
+#if CH_USE_TICKLESS
+/**
+ * @brief   Host time of the counter zero.
+ */
+static struct timespec origin;
+
+/**
+ * @brief   Alarm deadline in nanoseconds from @p origin.
+ */
+static uint64_t alarm_ns;
+
+/**
+ * @brief   Alarm armed flag.
+ */
+static bool_t alarm_armed;
+#endif
 
 /*===========================================================================*/
 /* Driver local functions.                                                   */
 /*===========================================================================*/
 
+/**
+ * @brief   Serves the raised simulated interrupt lines.
+ *
+ * @return              The lines state.
+ * @retval TRUE         at least a line has been served.
+ * @retval FALSE        no lines raised.
+ */
+static bool_t irq_check(void) {
+  uint32_t mask;
+  unsigned n;
+  char buf[16];
+
+  if (__atomic_load_n(&irq_pending, __ATOMIC_ACQUIRE) == 0)
+    return FALSE;
+  /* The pipe is drained before taking the mask, a line raised after the
+     exchange finds an empty mask and writes a new wakeup byte.*/
+  while (read(irq_pipe[0], buf, sizeof(buf)) > 0)
+    ;
+  mask = __atomic_exchange_n(&irq_pending, 0, __ATOMIC_ACQ_REL);
+  for (n = 0; n < SIM_IRQ_LINES; n++) {
+    if ((mask & (1U << n)) && (irq_handlers[n] != NULL)) {
+      chDbgTraceIsr(TRACE_EV_ISR_ENTER, n);
+      irq_handlers[n]();
+      chDbgTraceIsr(TRACE_EV_ISR_LEAVE, n);
+    }
+  }
+  return TRUE;
+}
+
+#if CH_USE_TICKLESS || defined(__DOXYGEN__)
+/**
+ * @brief   Nanoseconds elapsed since @p origin.
+ */
+static uint64_t elapsed_ns(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)(ts.tv_sec - origin.tv_sec) * 1000000000ULL +
+         (uint64_t)ts.tv_nsec - (uint64_t)origin.tv_nsec;
+}
+
+/**
+ * @brief   Converts nanoseconds into counter ticks, rounding down.
+ */
+static uint64_t ns2ticks(uint64_t ns) {
+
+  return (ns / 1000000000ULL) * CH_FREQUENCY +
+         ((ns % 1000000000ULL) * CH_FREQUENCY) / 1000000000ULL;
+}
+
+/**
+ * @brief   Converts counter ticks into nanoseconds, rounding up.
+ */
+static uint64_t ticks2ns(uint64_t ticks) {
+
+  return (ticks / CH_FREQUENCY) * 1000000000ULL +
+         ((ticks % CH_FREQUENCY) * 1000000000ULL + CH_FREQUENCY - 1) /
+         CH_FREQUENCY;
+}
+
+/**
+ * @brief   Serves the alarm if its deadline has been reached.
+ *
+ * @return              The alarm state.
+ * @retval TRUE         the alarm has been served.
+ * @retval FALSE        the alarm is not armed or not yet expired.
+ */
+static bool_t alarm_check(void) {
+  uint64_t ns;
+
+  if (!alarm_armed)
+    return FALSE;
+  ns = elapsed_ns();
+  if (ns < alarm_ns)
+    return FALSE;
+  if (ns - alarm_ns > sim_stats.max_latency)
+    sim_stats.max_latency = (uint32_t)(ns - alarm_ns);
+  sim_stats.alarms++;
+  /* The alarm is re-armed by the virtual timers code if required.*/
+  alarm_armed = FALSE;
+  chDbgTraceIsr(TRACE_EV_ISR_ENTER, SIM_IRQ_TIMER);
+  chSysTimerHandlerI();
+  chDbgTraceIsr(TRACE_EV_ISR_LEAVE, SIM_IRQ_TIMER);
+  if (chSchIsRescRequiredExI())
+    chSchDoRescheduleI();
+  return TRUE;
+}
+#endif /* CH_USE_TICKLESS */
+
+#if POSIX_IDLE_BLOCKING || defined(__DOXYGEN__)
+#if !CH_USE_TICKLESS || defined(__DOXYGEN__)
+/**
+ * @brief   Computes the time of the next tick having something to do.
+ * @details The deadline is the next periodic tick advanced to the
+ *          expiration of the first armed virtual timer.
+ *
+ * @param[out] tvp      the deadline, absolute host time
+ * @return              The deadline existence.
+ * @retval FALSE        no timers armed, the deadline is infinite.
+ */
+static bool_t idle_deadline(struct timeval *tvp) {
+  uint64_t usec;
+#if CH_USE_VT_WHEEL
+  systime_t delta = vt_wheel_next();
+
+  if (delta == 0)
+    return FALSE;
+#else
+  systime_t delta;
+
+  if (&vtlist == (VTList *)vtlist.vt_next)
+    return FALSE;
+  delta = vtlist.vt_next->vt_time;
+#endif
+
+  /* The first timer expires on its n-th tick, the first tick is at
+     nextcnt.*/
+  usec = (uint64_t)(delta - 1) * (uint64_t)tick.tv_usec +
+         (uint64_t)nextcnt.tv_usec;
+  tvp->tv_sec = nextcnt.tv_sec + (time_t)(usec / 1000000);
+  tvp->tv_usec = (suseconds_t)(usec % 1000000);
+  return TRUE;
+}
+#endif /* !CH_USE_TICKLESS */
+
+/**
+ * @brief   Suspends the host process until an interrupt source is ready.
+ * @details Waits for activity on the simulated serial ports, Ethernet
+ *          wire or UART line, for the next simulated ADC transfer, for a
+ *          simulated interrupt line or for the idle deadline, whichever
+ *          comes first.
+ *
+ * @param[in] now       current host time
+ */
+#if !CH_USE_TICKLESS || defined(__DOXYGEN__)
+static void idle_wait(const struct timeval *now) {
+#else
+static void idle_wait(void) {
+#endif
+  struct pollfd fds[8];
+  nfds_t n = 0;
+#if !CH_USE_TICKLESS
+  struct timeval deadline;
+  bool_t timed;
+#endif
+
+#if HAL_USE_SERIAL
+  n = (nfds_t)sd_lld_poll_setup(fds);
+#endif
+#if HAL_USE_MAC
+  n += (nfds_t)mac_lld_poll_setup(&fds[n]);
+#endif
+#if HAL_USE_ADC
+  n += (nfds_t)adc_lld_poll_setup(&fds[n]);
+#endif
+#if HAL_USE_UART
+  n += (nfds_t)uart_lld_poll_setup(&fds[n]);
+#endif
+  fds[n].fd = irq_pipe[0];
+  fds[n].events = POLLIN;
+  fds[n].revents = 0;
+  n++;
+
+#if CH_USE_TICKLESS
+  /* The alarm is programmed into the timerfd only when going idle, while
+     threads are running it is checked by polling the host clock.*/
+  {
+    struct itimerspec its = {{0, 0}, {0, 0}};
+
+    if (alarm_armed) {
+      uint64_t ns = (uint64_t)origin.tv_nsec + alarm_ns;
+
+      its.it_value.tv_sec = origin.tv_sec + (time_t)(ns / 1000000000ULL);
+      its.it_value.tv_nsec = (long)(ns % 1000000000ULL);
+    }
+    timerfd_settime(idle_tfd, TFD_TIMER_ABSTIME, &its, NULL);
+    fds[n].fd = idle_tfd;
+    fds[n].events = POLLIN;
+    fds[n].revents = 0;
+    poll(fds, n + 1, -1);
+  }
+#elif POSIX_IDLE_USE_TIMERFD
+  timed = idle_deadline(&deadline);
+  {
+    struct itimerspec its = {{0, 0}, {0, 0}};
+
+    (void)now;
+    if (timed) {
+      its.it_value.tv_sec = deadline.tv_sec;
+      its.it_value.tv_nsec = deadline.tv_usec * 1000;
+    }
+    timerfd_settime(idle_tfd, TFD_TIMER_ABSTIME, &its, NULL);
+    fds[n].fd = idle_tfd;
+    fds[n].events = POLLIN;
+    fds[n].revents = 0;
+    if (poll(fds, n + 1, -1) > 0 && (fds[n].revents & POLLIN)) {
+      uint64_t expirations;
+
+      (void)read(idle_tfd, &expirations, sizeof(expirations));
+    }
+  }
+#else /* !POSIX_IDLE_USE_TIMERFD */
+  timed = idle_deadline(&deadline);
+  if (timed) {
+    struct timeval tv;
+
+    if (!timercmp(&deadline, now, >))
+      return;
+    timersub(&deadline, now, &tv);
+#if defined(__linux__)
+    {
+      struct timespec ts;
+
+      ts.tv_sec = tv.tv_sec;
+      ts.tv_nsec = tv.tv_usec * 1000;
+      ppoll(fds, n, &ts, NULL);
+    }
+#else
+    poll(fds, n, (int)(tv.tv_sec * 1000 + (tv.tv_usec + 999) / 1000));
+#endif
+  }
+  else
+    poll(fds, n, -1);
+#endif /* !POSIX_IDLE_USE_TIMERFD */
+  sim_stats.wakeups++;
+}
+#endif /* POSIX_IDLE_BLOCKING */
+
 /*===========================================================================*/
 /* Driver interrupt handlers.                                                */
 /*===========================================================================*/
@@ -72,15 +353,111 @@ void hal_lld_init(void) {
 #else
   puts("ChibiOS/RT simulator (Linux)\n");
 #endif
+#if !CH_USE_TICKLESS
   gettimeofday(&nextcnt, NULL);
   timeradd(&nextcnt, &tick, &nextcnt);
+#else
+  clock_gettime(CLOCK_MONOTONIC, &origin);
+#endif
+#if POSIX_IDLE_USE_TIMERFD || CH_USE_TICKLESS
+#if CH_USE_TICKLESS
+  idle_tfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
+#else
+  idle_tfd = timerfd_create(CLOCK_REALTIME, TFD_NONBLOCK);
+#endif
+  if (idle_tfd < 0) {
+    puts("Unable to create the idle timerfd");
+    exit(1);
+  }
+#endif
+  if (pipe(irq_pipe) < 0) {
+    puts("Unable to create the interrupt lines pipe");
+    exit(1);
+  }
+  fcntl(irq_pipe[0], F_SETFL, O_NONBLOCK);
+  fcntl(irq_pipe[1], F_SETFL, O_NONBLOCK);
+}
+
+/**
+ * @brief   Sets the handler of a simulated interrupt line.
+ * @details The handler is invoked in the simulated interrupt context, it
+ *          can use the I-class APIs and the rescheduling is performed on
+ *          exit.
+ *
+ * @param[in] n         the interrupt line, it must be lower than
+ *                      @p SIM_IRQ_LINES
+ * @param[in] isr       the handler or @p NULL
+ */
+void sim_irq_set_handler(unsigned n, simisr_t isr) {
+
+  chDbgCheck(n < SIM_IRQ_LINES, "sim_irq_set_handler");
+
+  irq_handlers[n] = isr;
+}
+
+/**
+ * @brief   Raises a simulated interrupt line.
+ * @details The line is served on the next interrupt sources check, if the
+ *          simulator is idle the host process is woken up.
+ * @note    This function can be invoked from any host thread, it does not
+ *          access the kernel.
+ *
+ * @param[in] n         the interrupt line, it must be lower than
+ *                      @p SIM_IRQ_LINES
+ */
+void sim_irq_raise(unsigned n) {
+
+  if (__atomic_fetch_or(&irq_pending, 1U << n, __ATOMIC_ACQ_REL) == 0) {
+    char c = 0;
+
+    (void)write(irq_pipe[1], &c, 1);
+  }
 }
 
 /**
  * @brief Interrupt simulation.
  */
 void ChkIntSources(void) {
+#if !CH_USE_TICKLESS
   struct timeval tv;
+#endif
+
+  if (irq_check()) {
+    if (chSchIsRescRequiredExI())
+      chSchDoRescheduleI();
+    return;
+  }
+
+#if HAL_USE_SPI
+  if (spi_lld_interrupt_pending()) {
+    if (chSchIsRescRequiredExI())
+      chSchDoRescheduleI();
+    return;
+  }
+#endif
+
+#if HAL_USE_ADC
+  if (adc_lld_interrupt_pending()) {
+    if (chSchIsRescRequiredExI())
+      chSchDoRescheduleI();
+    return;
+  }
+#endif
+#if HAL_USE_UART
+  if (uart_lld_interrupt_pending()) {
+    if (chSchIsRescRequiredExI())
+      chSchDoRescheduleI();
+    return;
+  }
+#endif
+
+#if HAL_USE_MAC
+  if (mac_lld_interrupt_pending()) {
+    if (chSchIsRescRequiredExI())
+      chSchDoRescheduleI();
+    return;
+  }
+#endif
 
 #if HAL_USE_SERIAL
   if (sd_lld_interrupt_pending()) {
@@ -90,13 +467,159 @@ void ChkIntSources(void) {
   }
 #endif
 
+#if !CH_USE_TICKLESS
   gettimeofday(&tv, NULL);
   if (timercmp(&tv, &nextcnt, >=)) {
     timeradd(&nextcnt, &tick, &nextcnt);
+    chDbgTraceIsr(TRACE_EV_ISR_ENTER, SIM_IRQ_TIMER);
     chSysTimerHandlerI();
+    chDbgTraceIsr(TRACE_EV_ISR_LEAVE, SIM_IRQ_TIMER);
     if (chSchIsRescRequiredExI())
       chSchDoRescheduleI();
   }
+#else
+  (void)alarm_check();
+#endif
+}
+
+/**
+ * @brief Idle interrupt simulation.
+ * @details Same as @p ChkIntSources() but, when there is nothing to do, the
+ *          host process is suspended until the next interrupt source is
+ *          ready, the ticks elapsed meanwhile are processed on wakeup.
+ * @note    Must be invoked from the idle thread only, time is frozen while
+ *          the process is suspended.
+ */
+void WaitIntSources(void) {
+#if POSIX_IDLE_BLOCKING
+#if !CH_USE_TICKLESS
+  struct timeval tv;
+#endif
+
+  if (irq_check()) {
+    if (chSchIsRescRequiredExI())
+      chSchDoRescheduleI();
+    return;
+  }
+
+#if HAL_USE_SPI
+  if (spi_lld_interrupt_pending()) {
+    if (chSchIsRescRequiredExI())
+      chSchDoRescheduleI();
+    return;
+  }
+#endif
+
+#if HAL_USE_ADC
+  if (adc_lld_interrupt_pending()) {
+    if (chSchIsRescRequiredExI())
+      chSchDoRescheduleI();
+    return;
+  }
+#endif
+#if HAL_USE_UART
+  if (uart_lld_interrupt_pending()) {
+    if (chSchIsRescRequiredExI())
+      chSchDoRescheduleI();
+    return;
+  }
+#endif
+
+#if HAL_USE_MAC
+  if (mac_lld_interrupt_pending()) {
+    if (chSchIsRescRequiredExI())
+      chSchDoRescheduleI();
+    return;
+  }
+#endif
+
+#if HAL_USE_SERIAL
+  if (sd_lld_interrupt_pending()) {
+    if (chSchIsRescRequiredExI())
+      chSchDoRescheduleI();
+    return;
+  }
+#endif
+
+#if !CH_USE_TICKLESS
+  gettimeofday(&tv, NULL);
+  if (!timercmp(&tv, &nextcnt, >=)) {
+    idle_wait(&tv);
+    gettimeofday(&tv, NULL);
+  }
+  /* Elapsed ticks are processed until a thread becomes ready, the
+     remaining ones are recovered in the next idle passes.*/
+  while (timercmp(&tv, &nextcnt, >=)) {
+    timeradd(&nextcnt, &tick, &nextcnt);
+    chDbgTraceIsr(TRACE_EV_ISR_ENTER, SIM_IRQ_TIMER);
+    chSysTimerHandlerI();
+    chDbgTraceIsr(TRACE_EV_ISR_LEAVE, SIM_IRQ_TIMER);
+    if (chSchIsRescRequiredExI()) {
+      chSchDoRescheduleI();
+      return;
+    }
+  }
+#else /* CH_USE_TICKLESS */
+  if (!alarm_check()) {
+    idle_wait();
+    (void)alarm_check();
+  }
+#endif /* CH_USE_TICKLESS */
+#else /* !POSIX_IDLE_BLOCKING */
+  ChkIntSources();
+#endif /* !POSIX_IDLE_BLOCKING */
+}
+
+/**
+ * @brief   Returns the realtime counter value.
+ * @details The counter is the host monotonic clock in nanoseconds.
+ *
+ * @return              The current counter value.
+ */
+rtcnt_t port_rt_get_counter_value(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (rtcnt_t)ts.tv_sec * 1000000000 + (rtcnt_t)ts.tv_nsec;
+}
+
+#if CH_USE_TICKLESS || defined(__DOXYGEN__)
+/**
+ * @brief   Returns the system time.
+ * @details The counter is the host monotonic clock scaled to
+ *          @p CH_FREQUENCY.
+ *
+ * @return              The current counter value.
+ */
+systime_t port_timer_get_time(void) {
+
+  return (systime_t)ns2ticks(elapsed_ns());
+}
+
+/**
+ * @brief   Programs the one-shot system alarm.
+ * @details The alarm is served when the host clock reaches the instant
+ *          the counter takes the @p time value, a deadline already in the
+ *          past is served on the next interrupt sources check.
+ *
+ * @param[in] time      the absolute counter value of the alarm
+ */
+void port_timer_set_alarm(systime_t time) {
+  uint64_t ns = elapsed_ns();
+  uint64_t now = ns2ticks(ns);
+  int32_t delta = (int32_t)(systime_t)(time - (systime_t)now);
+
+  alarm_ns = delta <= 0 ? ns : ticks2ns(now + (uint64_t)delta);
+  alarm_armed = TRUE;
+}
+
+/**
+ * @brief   Stops the one-shot system alarm.
+ */
+void port_timer_stop_alarm(void) {
+
+  alarm_armed = FALSE;
 }
+#endif /* CH_USE_TICKLESS */
 
 /** @} */
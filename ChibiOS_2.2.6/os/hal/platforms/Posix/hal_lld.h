@@ -38,6 +38,7 @@
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <netdb.h>
+#include <poll.h>
 
 /*===========================================================================*/
 /* Driver constants.                                                         */
@@ -51,18 +52,86 @@
 #define SOCKET int
 #define INVALID_SOCKET -1
 
+/**
+ * @brief   Number of simulated interrupt lines.
+ */
+#define SIM_IRQ_LINES   8
+
+/**
+ * @brief   Trace identifier of the simulated timer interrupt.
+ * @details The simulated interrupt lines use their number as identifier.
+ */
+#define SIM_IRQ_TIMER   SIM_IRQ_LINES
+
 /*===========================================================================*/
 /* Driver pre-compile time settings.                                         */
 /*===========================================================================*/
 
+/**
+ * @brief   Blocking idle switch.
+ * @details If set to @p TRUE the idle thread suspends the host process until
+ *          the next virtual timer expiration or simulated serial activity,
+ *          ticks with nothing to do are skipped and recovered on wakeup.
+ *          If set to @p FALSE the idle thread keeps polling the interrupt
+ *          sources and the host clock.
+ * @note    The default is @p TRUE.
+ */
+#if !defined(POSIX_IDLE_BLOCKING) || defined(__DOXYGEN__)
+#define POSIX_IDLE_BLOCKING         TRUE
+#endif
+
+/**
+ * @brief   Idle wakeup through a @p timerfd.
+ * @details If set to @p TRUE the idle deadline is programmed into a
+ *          @p timerfd that is waited together with the serial sockets,
+ *          otherwise the deadline is the @p ppoll() timeout.
+ * @note    The default is @p FALSE.
+ * @note    Linux only.
+ */
+#if !defined(POSIX_IDLE_USE_TIMERFD) || defined(__DOXYGEN__)
+#define POSIX_IDLE_USE_TIMERFD      FALSE
+#endif
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
 
+#if POSIX_IDLE_USE_TIMERFD && !defined(__linux__)
+#error "POSIX_IDLE_USE_TIMERFD requires a Linux host"
+#endif
+
+#if CH_USE_TICKLESS && !defined(__linux__)
+#error "CH_USE_TICKLESS requires a Linux host in the simulator"
+#endif
+
 /*===========================================================================*/
 /* Driver data structures and types.                                         */
 /*===========================================================================*/
 
+/**
+ * @brief   Simulator idle statistics.
+ */
+typedef struct {
+  /**
+   * @brief   Number of wakeups of the host process from the idle state.
+   */
+  uint32_t                  wakeups;
+  /**
+   * @brief   Number of alarms served (tickless mode only).
+   */
+  uint32_t                  alarms;
+  /**
+   * @brief   Worst delay between an alarm deadline and its service, in
+   *          nanoseconds (tickless mode only).
+   */
+  uint32_t                  max_latency;
+} SimStats;
+
+/**
+ * @brief   Simulated interrupt handler type.
+ */
+typedef void (*simisr_t)(void);
+
 /*===========================================================================*/
 /* Driver macros.                                                            */
 /*===========================================================================*/
@@ -71,11 +140,16 @@
 /* External declarations.                                                    */
 /*===========================================================================*/
 
+extern SimStats sim_stats;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
   void hal_lld_init(void);
   void ChkIntSources(void);
+  void WaitIntSources(void);
+  void sim_irq_set_handler(unsigned n, simisr_t isr);
+  void sim_irq_raise(unsigned n);
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,576 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,2011 Giovanni Di Sirio.
+
+    This file is part of ChibiOS/RT.
+
+    ChibiOS/RT is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/RT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+                                      ---
+
+    A special exception to the GPL can be applied should you wish to distribute
+    a combined work that includes ChibiOS/RT, without being obliged to provide
+    the source code for any proprietary components. See the file exception.txt
+    for full details of how and when the exception can be applied.
+*/
+
+
+/**
+ * @file    Posix/mac_lld.c
+ * @brief   Posix low level simulated MAC driver code.
+ *
+ * @addtogroup POSIX_MAC
+ * @{
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <stddef.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include "ch.h"
+#include "hal.h"
+
+#if HAL_USE_MAC || defined(__DOXYGEN__)
+
+/**
+ * @brief   Number of entries in the stations table.
+ */
+#define STATIONS                    16
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Ethernet driver 1.
+ */
+MACDriver ETH1;
+
+/*===========================================================================*/
+/* Driver local variables.                                                   */
+/*===========================================================================*/
+
+#ifndef __DOXYGEN__
+/* The last byte is replaced by the wire port number.*/
+static const uint8_t default_mac[] = {0x02, 0x43, 0x48, 0x00, 0x00, 0x00};
+
+static uint8_t tb[MAC_TRANSMIT_BUFFERS][MAC_BUFFERS_SIZE];
+static bool_t tlocked[MAC_TRANSMIT_BUFFERS];
+static uint8_t rb[MAC_RECEIVE_BUFFERS][MAC_BUFFERS_SIZE];
+static size_t rsize[MAC_RECEIVE_BUFFERS];
+static unsigned rxwr, rxrd, rxcnt;
+
+/* Stations learned from the received frames, used in order to send the
+   unicast frames to a single port instead of flooding the wire.*/
+static struct {
+  uint8_t               address[6];
+  int                   port;
+} stations[STATIONS];
+static unsigned stnext;
+#endif
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Finds the wire port of a socket address.
+ *
+ * @param[in] sunp      the socket address
+ * @param[in] len       the socket address length
+ * @return              The port number or -1 if not a wire port.
+ */
+static int wire_port(const struct sockaddr_un *sunp, socklen_t len) {
+  struct sockaddr_un sun;
+  unsigned port;
+
+  for (port = 0; port < SIM_MAC_WIRE_PORTS; port++) {
+    if ((mac_lld_wire_address(port, &sun) == len) &&
+        (memcmp(sun.sun_path, sunp->sun_path,
+                len - offsetof(struct sockaddr_un, sun_path)) == 0))
+      return (int)port;
+  }
+  return -1;
+}
+
+/**
+ * @brief   Records the port a station is attached to.
+ *
+ * @param[in] address   the station address
+ * @param[in] port      the wire port
+ */
+static void station_learn(const uint8_t *address, int port) {
+  unsigned i;
+
+  for (i = 0; i < STATIONS; i++) {
+    if ((stations[i].port >= 0) &&
+        (memcmp(stations[i].address, address, 6) == 0)) {
+      stations[i].port = port;
+      return;
+    }
+  }
+  memcpy(stations[stnext].address, address, 6);
+  stations[stnext].port = port;
+  stnext = (stnext + 1) % STATIONS;
+}
+
+/**
+ * @brief   Returns the port a station is attached to.
+ *
+ * @param[in] address   the station address
+ * @return              The port number or -1 if not known.
+ */
+static int station_lookup(const uint8_t *address) {
+  unsigned i;
+
+  for (i = 0; i < STATIONS; i++) {
+    if ((stations[i].port >= 0) &&
+        (memcmp(stations[i].address, address, 6) == 0))
+      return stations[i].port;
+  }
+  return -1;
+}
+
+/**
+ * @brief   Sends a frame to a wire port.
+ *
+ * @param[in] port      the wire port
+ * @param[in] fp        pointer to the frame
+ * @param[in] n         frame size
+ * @return              The delivery state.
+ * @retval FALSE        the destination port is congested.
+ */
+static bool_t wire_send(unsigned port, const uint8_t *fp, size_t n) {
+  struct sockaddr_un sun;
+  socklen_t len = mac_lld_wire_address(port, &sun);
+
+  if (sendto(ETH1.md_socket, fp, n, MSG_DONTWAIT,
+             (struct sockaddr *)&sun, len) < 0)
+    return errno != EAGAIN;
+  return TRUE;
+}
+
+/*===========================================================================*/
+/* Driver interrupt handlers.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Low level MAC initialization.
+ * @details The driver is attached to the first free port of the virtual
+ *          wire, if there are no free ports the link stays down.
+ *
+ * @notapi
+ */
+void mac_lld_init(void) {
+  struct sockaddr_un sun;
+  unsigned i;
+
+  macObjectInit(&ETH1);
+  for (i = 0; i < STATIONS; i++)
+    stations[i].port = -1;
+
+  ETH1.md_socket = socket(AF_UNIX, SOCK_DGRAM, 0);
+  if (ETH1.md_socket < 0) {
+    printf("ETH1: Error creating simulator socket\n");
+    return;
+  }
+  for (i = 0; i < SIM_MAC_WIRE_PORTS; i++) {
+    if (bind(ETH1.md_socket, (struct sockaddr *)&sun,
+             mac_lld_wire_address(i, &sun)) == 0)
+      break;
+  }
+  if (i >= SIM_MAC_WIRE_PORTS) {
+    printf("ETH1: No free ports on the virtual wire %s\n", SIM_MAC_WIRE);
+    close(ETH1.md_socket);
+    ETH1.md_socket = -1;
+    return;
+  }
+  ETH1.md_port = i;
+  mac_lld_set_address(&ETH1, NULL);
+  printf("ETH1: Attached to port %u of the virtual wire %s\n",
+         i, SIM_MAC_WIRE);
+}
+
+/**
+ * @brief   Low level MAC address setup.
+ * @details Only the frames addressed to the station, broadcast or multicast
+ *          are received.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @param[in] p         pointer to a six bytes buffer containing the MAC
+ *                      address. If this parameter is set to @p NULL then
+ *                      a system default MAC, including the wire port
+ *                      number, is used. The MAC address must be aligned
+ *                      with the most significant byte first.
+ *
+ * @notapi
+ */
+void mac_lld_set_address(MACDriver *macp, const uint8_t *p) {
+
+  if (p == NULL) {
+    memcpy(macp->md_address, default_mac, 6);
+    macp->md_address[5] = (uint8_t)macp->md_port;
+  }
+  else
+    memcpy(macp->md_address, p, 6);
+}
+
+/**
+ * @brief   Returns a transmission descriptor.
+ * @details One of the available transmission descriptors is locked and
+ *          returned.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @param[out] tdp      pointer to a @p MACTransmitDescriptor structure
+ * @return              The operation status.
+ * @retval RDY_OK       the descriptor has been obtained.
+ * @retval RDY_TIMEOUT  descriptor not available.
+ *
+ * @notapi
+ */
+msg_t max_lld_get_transmit_descriptor(MACDriver *macp,
+                                      MACTransmitDescriptor *tdp) {
+  unsigned i;
+
+  if (macp->md_socket < 0)
+    return RDY_TIMEOUT;
+
+  chSysLock();
+  for (i = 0; i < MAC_TRANSMIT_BUFFERS; i++) {
+    if (!tlocked[i]) {
+      tlocked[i] = TRUE;
+      chSysUnlock();
+      tdp->td_offset = 0;
+      tdp->td_size = MAC_BUFFERS_SIZE;
+      tdp->td_index = i;
+      return RDY_OK;
+    }
+  }
+  chSysUnlock();
+  return RDY_TIMEOUT;
+}
+
+/**
+ * @brief   Writes to a transmit descriptor's stream.
+ *
+ * @param[in] tdp       pointer to a @p MACTransmitDescriptor structure
+ * @param[in] buf       pointer to the buffer cointaining the data to be
+ *                      written
+ * @param[in] size      number of bytes to be written
+ * @return              The number of bytes written into the descriptor's
+ *                      stream, this value can be less than the amount
+ *                      specified in the parameter @p size if the maximum
+ *                      frame size is reached.
+ *
+ * @notapi
+ */
+size_t mac_lld_write_transmit_descriptor(MACTransmitDescriptor *tdp,
+                                         uint8_t *buf,
+                                         size_t size) {
+
+  if (size > tdp->td_size - tdp->td_offset)
+    size = tdp->td_size - tdp->td_offset;
+  if (size > 0) {
+    memcpy(&tb[tdp->td_index][tdp->td_offset], buf, size);
+    tdp->td_offset += size;
+    ETH1.md_copies++;
+  }
+  return size;
+}
+
+/**
+ * @brief   Releases a transmit descriptor and starts the transmission of the
+ *          enqueued data as a single frame.
+ * @details Unicast frames addressed to a known station are sent to its
+ *          port only, the other frames are sent to all the wire ports.
+ *
+ * @param[in] tdp       the pointer to the @p MACTransmitDescriptor structure
+ *
+ * @notapi
+ */
+void mac_lld_release_transmit_descriptor(MACTransmitDescriptor *tdp) {
+  const uint8_t *fp = tb[tdp->td_index];
+  size_t n = tdp->td_offset;
+
+  if (n >= SIM_MAC_HEADER_SIZE) {
+    bool_t delivered = TRUE;
+    int port = (fp[0] & 1) ? -1 : station_lookup(fp);
+
+    if (port >= 0)
+      delivered = wire_send((unsigned)port, fp, n);
+    else {
+      unsigned i;
+
+      for (i = 0; i < SIM_MAC_WIRE_PORTS; i++) {
+        if ((i != ETH1.md_port) && !wire_send(i, fp, n))
+          delivered = FALSE;
+      }
+    }
+    ETH1.md_txframes++;
+    if (!delivered)
+      ETH1.md_txdropped++;
+  }
+
+  chSysLock();
+  tlocked[tdp->td_index] = FALSE;
+  chSemResetI(&ETH1.md_tdsem, 0);
+  chSchRescheduleS();
+  chSysUnlock();
+}
+
+/**
+ * @brief   Returns a receive descriptor.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @param[out] rdp      pointer to a @p MACReceiveDescriptor structure
+ * @return              The operation status.
+ * @retval RDY_OK       the descriptor has been obtained.
+ * @retval RDY_TIMEOUT  descriptor not available.
+ *
+ * @notapi
+ */
+msg_t max_lld_get_receive_descriptor(MACDriver *macp,
+                                     MACReceiveDescriptor *rdp) {
+
+  (void)macp;
+
+  chSysLock();
+  if (rxcnt == 0) {
+    chSysUnlock();
+    return RDY_TIMEOUT;
+  }
+  rdp->rd_offset = 0;
+  rdp->rd_size = rsize[rxrd];
+  rdp->rd_index = rxrd;
+  chSysUnlock();
+  return RDY_OK;
+}
+
+/**
+ * @brief   Reads from a receive descriptor's stream.
+ *
+ * @param[in] rdp       pointer to a @p MACReceiveDescriptor structure
+ * @param[in] buf       pointer to the buffer that will receive the read data
+ * @param[in] size      number of bytes to be read
+ * @return              The number of bytes read from the descriptor's
+ *                      stream, this value can be less than the amount
+ *                      specified in the parameter @p size if there are
+ *                      no more bytes to read.
+ *
+ * @notapi
+ */
+size_t mac_lld_read_receive_descriptor(MACReceiveDescriptor *rdp,
+                                       uint8_t *buf,
+                                       size_t size) {
+
+  if (size > rdp->rd_size - rdp->rd_offset)
+    size = rdp->rd_size - rdp->rd_offset;
+  if (size > 0) {
+    memcpy(buf, &rb[rdp->rd_index][rdp->rd_offset], size);
+    rdp->rd_offset += size;
+    ETH1.md_copies++;
+  }
+  return size;
+}
+
+/**
+ * @brief   Releases a receive descriptor.
+ * @details The descriptor and its buffer are made available for more incoming
+ *          frames.
+ *
+ * @param[in] rdp       the pointer to the @p MACReceiveDescriptor structure
+ *
+ * @notapi
+ */
+void mac_lld_release_receive_descriptor(MACReceiveDescriptor *rdp) {
+
+  chDbgAssert(rdp->rd_index == rxrd,
+              "mac_lld_release_receive_descriptor(), #1",
+              "not the oldest descriptor");
+  (void)rdp;
+
+  chSysLock();
+  rxrd = (rxrd + 1) % MAC_RECEIVE_BUFFERS;
+  rxcnt--;
+  chSysUnlock();
+}
+
+/**
+ * @brief   Updates and returns the link status.
+ * @details The link is up if the driver is attached to the wire.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @return              The link status.
+ * @retval TRUE         if the link is active.
+ * @retval FALSE        if the link is down.
+ *
+ * @notapi
+ */
+bool_t mac_lld_poll_link_status(MACDriver *macp) {
+
+  return macp->md_socket >= 0;
+}
+
+#if MAC_USE_ZERO_COPY || defined(__DOXYGEN__)
+/**
+ * @brief   Returns a pointer to the next transmit buffer in the descriptor
+ *          chain.
+ * @note    The frame is stored in a single buffer so the whole available
+ *          space is returned by the first call.
+ *
+ * @param[in] tdp       the pointer to the @p MACTransmitDescriptor structure
+ * @param[in] size      size of the requested buffer. Specify the frame size
+ *                      on the first call then scale the value down subtracting
+ *                      the amount of data already copied into the previous
+ *                      buffers.
+ * @param[out] sizep    pointer to variable receiving the buffer size, it is
+ *                      zero when the last buffer has already been returned.
+ * @return              Pointer to the returned buffer.
+ * @retval NULL         if the buffer chain has been entirely scanned.
+ *
+ * @notapi
+ */
+uint8_t *mac_lld_get_next_transmit_buffer(MACTransmitDescriptor *tdp,
+                                          size_t size,
+                                          size_t *sizep) {
+  uint8_t *p;
+
+  if (size > tdp->td_size - tdp->td_offset)
+    size = tdp->td_size - tdp->td_offset;
+  *sizep = size;
+  if (size == 0)
+    return NULL;
+  p = &tb[tdp->td_index][tdp->td_offset];
+  tdp->td_offset += size;
+  return p;
+}
+
+/**
+ * @brief   Returns a pointer to the next receive buffer in the descriptor
+ *          chain.
+ * @note    The frame is stored in a single buffer so the whole frame is
+ *          returned by the first call.
+ *
+ * @param[in] rdp       the pointer to the @p MACReceiveDescriptor structure
+ * @param[out] sizep    pointer to variable receiving the buffer size, it is
+ *                      zero when the last buffer has already been returned.
+ * @return              Pointer to the returned buffer.
+ * @retval NULL         if the buffer chain has been entirely scanned.
+ *
+ * @notapi
+ */
+const uint8_t *mac_lld_get_next_receive_buffer(MACReceiveDescriptor *rdp,
+                                               size_t *sizep) {
+  const uint8_t *p;
+
+  *sizep = rdp->rd_size - rdp->rd_offset;
+  if (*sizep == 0)
+    return NULL;
+  p = &rb[rdp->rd_index][rdp->rd_offset];
+  rdp->rd_offset = rdp->rd_size;
+  return p;
+}
+#endif /* MAC_USE_ZERO_COPY */
+
+/**
+ * @brief   Composes the socket address of a wire port.
+ * @details The wire ports are bound in the Linux abstract sockets
+ *          namespace so no files are left behind.
+ *
+ * @param[in] port      the wire port
+ * @param[out] sunp     the socket address
+ * @return              The socket address length.
+ */
+socklen_t mac_lld_wire_address(unsigned port, struct sockaddr_un *sunp) {
+  int n;
+
+  memset(sunp, 0, sizeof(*sunp));
+  sunp->sun_family = AF_UNIX;
+  n = snprintf(&sunp->sun_path[1], sizeof(sunp->sun_path) - 1, "%s.%u",
+               SIM_MAC_WIRE, port);
+  return (socklen_t)(offsetof(struct sockaddr_un, sun_path) + 1 + n);
+}
+
+/**
+ * @brief   Receive interrupt simulation.
+ * @details A frame is moved from the wire socket into a free receive
+ *          buffer, frames not addressed to the station are discarded.
+ *          While the receive buffers are full the frames are left queued
+ *          in the socket.
+ *
+ * @return              The interrupt state.
+ * @retval TRUE         a frame has been served.
+ * @retval FALSE        no frames pending.
+ */
+bool_t mac_lld_interrupt_pending(void) {
+  struct sockaddr_un sun;
+  socklen_t len = sizeof(sun);
+  uint8_t *fp;
+  ssize_t n;
+  int port;
+
+  if ((ETH1.md_socket < 0) || (rxcnt >= MAC_RECEIVE_BUFFERS))
+    return FALSE;
+
+  fp = rb[rxwr];
+  n = recvfrom(ETH1.md_socket, fp, MAC_BUFFERS_SIZE, MSG_DONTWAIT,
+               (struct sockaddr *)&sun, &len);
+  if (n < 0)
+    return FALSE;
+  if (n < SIM_MAC_HEADER_SIZE)
+    return TRUE;
+  if ((port = wire_port(&sun, len)) >= 0)
+    station_learn(fp + 6, port);
+  if (!(fp[0] & 1) && (memcmp(fp, ETH1.md_address, 6) != 0))
+    return TRUE;
+
+  rsize[rxwr] = (size_t)n;
+  rxwr = (rxwr + 1) % MAC_RECEIVE_BUFFERS;
+  rxcnt++;
+  ETH1.md_rxframes++;
+  chSemResetI(&ETH1.md_rdsem, 0);
+#if CH_USE_EVENTS
+  chEvtBroadcastI(&ETH1.md_rdevent);
+#endif
+  return TRUE;
+}
+
+/**
+ * @brief   Collects the descriptors to be waited for while idle.
+ * @details The wire socket is waited for input if there is a free receive
+ *          buffer.
+ *
+ * @param[out] fds      array of @p pollfd structures, it must be able to
+ *                      contain one element
+ * @return              The number of descriptors written into @p fds.
+ */
+int mac_lld_poll_setup(struct pollfd *fds) {
+
+  if ((ETH1.md_socket < 0) || (rxcnt >= MAC_RECEIVE_BUFFERS))
+    return 0;
+  fds->fd = ETH1.md_socket;
+  fds->events = POLLIN;
+  fds->revents = 0;
+  return 1;
+}
+
+#endif /* HAL_USE_MAC */
+
+/** @} */
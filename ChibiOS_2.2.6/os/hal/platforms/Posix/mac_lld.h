@@ -0,0 +1,202 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,2011 Giovanni Di Sirio.
+
+    This file is part of ChibiOS/RT.
+
+    ChibiOS/RT is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/RT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+                                      ---
+
+    A special exception to the GPL can be applied should you wish to distribute
+    a combined work that includes ChibiOS/RT, without being obliged to provide
+    the source code for any proprietary components. See the file exception.txt
+    for full details of how and when the exception can be applied.
+*/
+
+
+/**
+ * @file    Posix/mac_lld.h
+ * @brief   Posix low level simulated MAC driver header.
+ * @details The simulated Ethernet interface exchanges frames over a virtual
+ *          wire made of UNIX domain datagram sockets, each simulator
+ *          instance attached to the wire occupies one of its ports.
+ *
+ * @addtogroup POSIX_MAC
+ * @{
+ */
+
+#ifndef _MAC_LLD_H_
+#define _MAC_LLD_H_
+
+#if HAL_USE_MAC || defined(__DOXYGEN__)
+
+#include <sys/un.h>
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Size of the Ethernet frame header.
+ */
+#define SIM_MAC_HEADER_SIZE         14
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Number of available transmit buffers.
+ */
+#if !defined(MAC_TRANSMIT_BUFFERS) || defined(__DOXYGEN__)
+#define MAC_TRANSMIT_BUFFERS        2
+#endif
+
+/**
+ * @brief   Number of available receive buffers.
+ */
+#if !defined(MAC_RECEIVE_BUFFERS) || defined(__DOXYGEN__)
+#define MAC_RECEIVE_BUFFERS         4
+#endif
+
+/**
+ * @brief   Maximum supported frame size.
+ */
+#if !defined(MAC_BUFFERS_SIZE) || defined(__DOXYGEN__)
+#define MAC_BUFFERS_SIZE            1518
+#endif
+
+/**
+ * @brief   Name of the virtual wire.
+ * @details Instances attached to wires with different names cannot
+ *          communicate.
+ */
+#if !defined(SIM_MAC_WIRE) || defined(__DOXYGEN__)
+#define SIM_MAC_WIRE                "chibios-wire"
+#endif
+
+/**
+ * @brief   Number of ports of the virtual wire.
+ */
+#if !defined(SIM_MAC_WIRE_PORTS) || defined(__DOXYGEN__)
+#define SIM_MAC_WIRE_PORTS          8
+#endif
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if !defined(__linux__)
+#error "the simulated MAC driver requires a Linux host"
+#endif
+
+#if MAC_BUFFERS_SIZE < SIM_MAC_HEADER_SIZE
+#error "MAC_BUFFERS_SIZE too small"
+#endif
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Structure representing a MAC driver.
+ */
+typedef struct {
+  Semaphore             md_tdsem;       /**< Transmit semaphore.        */
+  Semaphore             md_rdsem;       /**< Receive semaphore.         */
+#if CH_USE_EVENTS
+  EventSource           md_rdevent;     /**< Receive event source.      */
+#endif
+  /* End of the mandatory fields.*/
+  int                   md_socket;      /**< Wire socket.               */
+  unsigned              md_port;        /**< Wire port.                 */
+  uint8_t               md_address[6];  /**< Station address.           */
+  uint32_t              md_txframes;    /**< Transmitted frames.        */
+  uint32_t              md_rxframes;    /**< Received frames.           */
+  uint32_t              md_txdropped;   /**< Frames not delivered
+                                             because of a congested
+                                             destination port.          */
+  uint32_t              md_copies;      /**< Copies performed through
+                                             the descriptors streams.   */
+} MACDriver;
+
+/**
+ * @brief   Structure representing a transmit descriptor.
+ */
+typedef struct {
+  size_t                td_offset;      /**< Current write offset.      */
+  size_t                td_size;        /**< Available space size.      */
+  /* End of the mandatory fields.*/
+  unsigned              td_index;       /**< Transmit buffer index.     */
+} MACTransmitDescriptor;
+
+/**
+ * @brief   Structure representing a receive descriptor.
+ */
+typedef struct {
+  size_t                rd_offset;      /**< Current read offset.       */
+  size_t                rd_size;        /**< Available data size.       */
+  /* End of the mandatory fields.*/
+  unsigned              rd_index;       /**< Receive buffer index.      */
+} MACReceiveDescriptor;
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#if !defined(__DOXYGEN__)
+extern MACDriver ETH1;
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void mac_lld_init(void);
+  void mac_lld_set_address(MACDriver *macp, const uint8_t *p);
+  msg_t max_lld_get_transmit_descriptor(MACDriver *macp,
+                                        MACTransmitDescriptor *tdp);
+  size_t mac_lld_write_transmit_descriptor(MACTransmitDescriptor *tdp,
+                                           uint8_t *buf,
+                                           size_t size);
+  void mac_lld_release_transmit_descriptor(MACTransmitDescriptor *tdp);
+  msg_t max_lld_get_receive_descriptor(MACDriver *macp,
+                                       MACReceiveDescriptor *rdp);
+  size_t mac_lld_read_receive_descriptor(MACReceiveDescriptor *rdp,
+                                         uint8_t *buf,
+                                         size_t size);
+  void mac_lld_release_receive_descriptor(MACReceiveDescriptor *rdp);
+  bool_t mac_lld_poll_link_status(MACDriver *macp);
+#if MAC_USE_ZERO_COPY
+  uint8_t *mac_lld_get_next_transmit_buffer(MACTransmitDescriptor *tdp,
+                                            size_t size,
+                                            size_t *sizep);
+  const uint8_t *mac_lld_get_next_receive_buffer(MACReceiveDescriptor *rdp,
+                                                 size_t *sizep);
+#endif
+  socklen_t mac_lld_wire_address(unsigned port, struct sockaddr_un *sunp);
+  bool_t mac_lld_interrupt_pending(void);
+  int mac_lld_poll_setup(struct pollfd *fds);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HAL_USE_MAC */
+
+#endif /* _MAC_LLD_H_ */
+
+/** @} */
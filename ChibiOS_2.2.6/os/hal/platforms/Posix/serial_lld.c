@@ -38,6 +38,7 @@
 #include <unistd.h>
 #include <errno.h>
 #include <sys/ioctl.h>
+#include <sys/uio.h>
 
 #include "ch.h"
 #include "hal.h"
@@ -138,16 +139,53 @@ abort:
   exit(1);
 }
 
+/*
+ * Fills the iovec array with the contiguous regions of a queue buffer
+ * starting from the pointer @p p and @p n bytes long, returns the number
+ * of used elements.
+ */
+static int qregions(GenericQueue *qp, uint8_t *p, size_t n,
+                    struct iovec *iov) {
+
+  iov[0].iov_base = p;
+  iov[0].iov_len = qp->q_top - p;
+  if (iov[0].iov_len >= n) {
+    iov[0].iov_len = n;
+    return 1;
+  }
+  iov[1].iov_base = qp->q_buffer;
+  iov[1].iov_len = n - iov[0].iov_len;
+  return 2;
+}
+
+/*
+ * Readies up to @p n threads waiting on a queue after @p n bytes have been
+ * moved in or out of it.
+ */
+static void qwakeup(GenericQueue *qp, size_t n) {
+
+  while ((n-- > 0) && notempty(&qp->q_waiting))
+    chSchReadyI(fifo_remove(&qp->q_waiting))->p_u.rdymsg = Q_OK;
+}
+
 static bool_t inint(SerialDriver *sdp) {
 
   if (sdp->com_data != INVALID_SOCKET) {
-    int i;
-    uint8_t data[32];
+    InputQueue *iqp = &sdp->iqueue;
+    struct iovec iov[2];
+    size_t empty;
+    int cnt;
 
     /*
-     * Input.
+     * Input, all the data available on the socket that fits in the queue
+     * is read directly into the queue buffer with a single system call,
+     * the excess is left in the socket until there is space again.
      */
-    int n = recv(sdp->com_data, data, sizeof(data), 0);
+    empty = chIQGetEmptyI(iqp);
+    if (empty == 0)
+      return FALSE;
+    cnt = qregions(iqp, iqp->q_wrptr, empty, iov);
+    ssize_t n = readv(sdp->com_data, iov, cnt);
     switch (n) {
     case 0:
       close(sdp->com_data);
@@ -161,8 +199,13 @@ static bool_t inint(SerialDriver *sdp) {
       sdp->com_data = INVALID_SOCKET;
       return FALSE;
     }
-    for (i = 0; i < n; i++)
-      sdIncomingDataI(sdp, data[i]);
+    if (chIQIsEmptyI(iqp))
+      chIOAddFlagsI(sdp, IO_INPUT_AVAILABLE);
+    iqp->q_counter += n;
+    iqp->q_wrptr += n;
+    if (iqp->q_wrptr >= iqp->q_top)
+      iqp->q_wrptr -= chQSizeI(iqp);
+    qwakeup(iqp, n);
     return TRUE;
   }
   return FALSE;
@@ -171,17 +214,20 @@ static bool_t inint(SerialDriver *sdp) {
 static bool_t outint(SerialDriver *sdp) {
 
   if (sdp->com_data != INVALID_SOCKET) {
-    int n;
-    uint8_t data[1];
+    OutputQueue *oqp = &sdp->oqueue;
+    struct iovec iov[2];
+    size_t full;
+    int cnt;
 
     /*
-     * Input.
+     * Output, the whole queue content is sent with a single system call,
+     * a wrapped buffer is sent as two vectors.
      */
-    n = sdRequestDataI(sdp);
-    if (n < 0)
+    full = chOQGetFullI(oqp);
+    if (full == 0)
       return FALSE;
-    data[0] = (uint8_t)n;
-    n = send(sdp->com_data, data, sizeof(data), 0);
+    cnt = qregions(oqp, oqp->q_rdptr, full, iov);
+    ssize_t n = writev(sdp->com_data, iov, cnt);
     switch (n) {
     case 0:
       close(sdp->com_data);
@@ -195,11 +241,38 @@ static bool_t outint(SerialDriver *sdp) {
       sdp->com_data = INVALID_SOCKET;
       return FALSE;
     }
+    oqp->q_counter += n;
+    oqp->q_rdptr += n;
+    if (oqp->q_rdptr >= oqp->q_top)
+      oqp->q_rdptr -= chQSizeI(oqp);
+    qwakeup(oqp, n);
+    if (chOQIsEmptyI(oqp))
+      chIOAddFlagsI(sdp, IO_OUTPUT_EMPTY);
     return TRUE;
   }
   return FALSE;
 }
 
+static int pollint(SerialDriver *sdp, struct pollfd *pfd) {
+
+  if (sdp->com_data != INVALID_SOCKET) {
+    pfd->fd = sdp->com_data;
+    pfd->events = 0;
+    if (!chIQIsFullI(&sdp->iqueue))
+      pfd->events |= POLLIN;
+    if (!chOQIsEmptyI(&sdp->oqueue))
+      pfd->events |= POLLOUT;
+  }
+  else if (sdp->com_listen != INVALID_SOCKET) {
+    pfd->fd = sdp->com_listen;
+    pfd->events = POLLIN;
+  }
+  else
+    return 0;
+  pfd->revents = 0;
+  return 1;
+}
+
 /*===========================================================================*/
 /* Driver interrupt handlers.                                                */
 /*===========================================================================*/
@@ -268,6 +341,28 @@ bool_t sd_lld_interrupt_pending(void) {
          outint(&SD1)  || outint(&SD2);
 }
 
+/**
+ * @brief   Collects the descriptors to be waited for while idle.
+ * @details Listening sockets are waited for connections, data sockets are
+ *          waited for input, if there is space in the input queue, and for
+ *          space, if there is pending output.
+ *
+ * @param[out] fds      array of @p pollfd structures, it must be able to
+ *                      contain one element for each simulated port
+ * @return              The number of descriptors written into @p fds.
+ */
+int sd_lld_poll_setup(struct pollfd *fds) {
+  int n = 0;
+
+#if USE_SIM_SERIAL1
+  n += pollint(&SD1, &fds[n]);
+#endif
+#if USE_SIM_SERIAL2
+  n += pollint(&SD2, &fds[n]);
+#endif
+  return n;
+}
+
 #endif /* HAL_USE_SERIAL */
 
 /** @} */
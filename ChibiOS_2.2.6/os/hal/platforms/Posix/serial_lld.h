@@ -150,6 +150,7 @@ extern "C" {
   void sd_lld_start(SerialDriver *sdp, const SerialConfig *config);
   void sd_lld_stop(SerialDriver *sdp);
   bool_t sd_lld_interrupt_pending(void);
+  int sd_lld_poll_setup(struct pollfd *fds);
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,660 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,2011 Giovanni Di Sirio.
+
+    This file is part of ChibiOS/RT.
+
+    ChibiOS/RT is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/RT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+                                      ---
+
+    A special exception to the GPL can be applied should you wish to distribute
+    a combined work that includes ChibiOS/RT, without being obliged to provide
+    the source code for any proprietary components. See the file exception.txt
+    for full details of how and when the exception can be applied.
+*/
+
+/**
+ * @file    Posix/spi_lld.c
+ * @brief   Posix low level simulated SPI driver code.
+ * @details The card emulates the SPI mode command set used by the MMC over
+ *          SPI driver: CMD0, CMD1, ACMD41, CMD12, CMD16, single and multiple
+ *          blocks reads (CMD17, CMD18) and writes (CMD24, CMD25) with the
+ *          data tokens, the data response and the busy signaling. Byte
+ *          addressing is used, as in MMC and SDSC cards.<br>
+ *          The SPI2 bus has no slaves, the transmitted frames are received
+ *          back, idle frames are received as all ones.<br>
+ *          Transfers are performed immediately while the completion is
+ *          signaled as an interrupt by @p ChkIntSources(), as a DMA
+ *          controller would do.
+ *
+ * @addtogroup POSIX_SPI
+ * @{
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "ch.h"
+#include "hal.h"
+
+#if HAL_USE_SPI || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/** @brief SPI1 driver identifier.*/
+#if USE_SIM_SPI1 || defined(__DOXYGEN__)
+SPIDriver SPID1;
+#endif
+
+/** @brief SPI2 driver identifier.*/
+#if USE_SIM_SPI2 || defined(__DOXYGEN__)
+SPIDriver SPID2;
+#endif
+
+/*===========================================================================*/
+/* Driver local variables.                                                   */
+/*===========================================================================*/
+
+/* Commands.*/
+#define CMD_GO_IDLE             0
+#define CMD_INIT                1
+#define CMD_STOP                12
+#define CMD_SET_BLOCKLEN        16
+#define CMD_READ                17
+#define CMD_READ_MULTIPLE       18
+#define CMD_WRITE               24
+#define CMD_WRITE_MULTIPLE      25
+#define ACMD_SD_INIT            41
+#define CMD_APP                 55
+
+/* R1 response bits.*/
+#define R1_IDLE                 0x01
+#define R1_ILLEGAL              0x04
+#define R1_ADDRESS              0x20
+#define R1_PARAMETER            0x40
+
+/* Data tokens and responses.*/
+#define TOKEN_SINGLE            0xFE
+#define TOKEN_MULTIPLE          0xFC
+#define TOKEN_STOP              0xFD
+#define DATA_ACCEPTED           0x05
+#define DATA_WRITE_ERROR        0x0D
+
+/* Positions within a read data frame: gap, token, data block, CRC.*/
+#define READ_DATA               2
+#define READ_END                (READ_DATA + SIM_MMC_BLOCK_SIZE + 2)
+
+/* Positions within a write data frame: data block, CRC.*/
+#define WRITE_END               (SIM_MMC_BLOCK_SIZE + 2)
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Maps the disk image file.
+ * @details The file is created if it does not exist or is empty, the mapping
+ *          is kept until the process termination so that the card content
+ *          survives to the driver stops.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] size      size of the image if it has to be created
+ */
+static void image_map(SPIDriver *spip, off_t size) {
+  SimMMC *cp = &spip->spd_mmc;
+  struct stat st;
+  void *p;
+  int fd;
+
+  fd = open(spip->spd_image, O_RDWR | O_CREAT, 0644);
+  if (fd < 0) {
+    printf("%s: Error opening the disk image\n", spip->spd_image);
+    exit(1);
+  }
+  if (fstat(fd, &st) != 0) {
+    printf("%s: Error reading the disk image size\n", spip->spd_image);
+    goto abort;
+  }
+  if (st.st_size < SIM_MMC_BLOCK_SIZE) {
+    if (ftruncate(fd, size) != 0) {
+      printf("%s: Error creating the disk image\n", spip->spd_image);
+      goto abort;
+    }
+    st.st_size = size;
+  }
+  st.st_size -= st.st_size % SIM_MMC_BLOCK_SIZE;
+  p = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+           fd, 0);
+  if (p == MAP_FAILED) {
+    printf("%s: Error mapping the disk image\n", spip->spd_image);
+    goto abort;
+  }
+  close(fd);
+  cp->mmc_image = p;
+  cp->mmc_blocks = (uint32_t)(st.st_size / SIM_MMC_BLOCK_SIZE);
+  printf("Simulated MMC on %s, %lu blocks\n", spip->spd_image,
+         (unsigned long)cp->mmc_blocks);
+  return;
+
+abort:
+  close(fd);
+  exit(1);
+}
+
+/**
+ * @brief   Queues a two bytes response, a stuff byte and the R1 byte or a
+ *          data response and a busy byte.
+ *
+ * @param[in] cp        pointer to the @p SimMMC object
+ * @param[in] b1        first byte
+ * @param[in] b2        second byte
+ */
+static void mmc_respond(SimMMC *cp, uint8_t b1, uint8_t b2) {
+
+  cp->mmc_resp[0] = b1;
+  cp->mmc_resp[1] = b2;
+  cp->mmc_resprd = 0;
+  cp->mmc_respn = 2;
+}
+
+/**
+ * @brief   Executes a completely received command.
+ *
+ * @param[in] cp        pointer to the @p SimMMC object
+ */
+static void mmc_command(SimMMC *cp) {
+  uint8_t cmd = cp->mmc_cmd[0] & 0x3F;
+  uint32_t arg = ((uint32_t)cp->mmc_cmd[1] << 24) |
+                 ((uint32_t)cp->mmc_cmd[2] << 16) |
+                 ((uint32_t)cp->mmc_cmd[3] << 8) |
+                 (uint32_t)cp->mmc_cmd[4];
+  bool_t acmd = cp->mmc_acmd;
+  uint8_t r1;
+
+  /* Any command terminates a data transfer.*/
+  cp->mmc_state = SIM_MMC_IDLE;
+  cp->mmc_acmd = FALSE;
+  r1 = cp->mmc_idle ? R1_IDLE : 0;
+  switch (cmd) {
+  case CMD_GO_IDLE:
+    cp->mmc_idle = TRUE;
+    r1 = R1_IDLE;
+    break;
+  case CMD_INIT:
+    cp->mmc_idle = FALSE;
+    r1 = 0;
+    break;
+  case ACMD_SD_INIT:
+    if (!acmd) {
+      r1 |= R1_ILLEGAL;
+      break;
+    }
+    cp->mmc_idle = FALSE;
+    r1 = 0;
+    break;
+  case CMD_APP:
+    cp->mmc_acmd = TRUE;
+    break;
+  case CMD_STOP:
+    break;
+  case CMD_SET_BLOCKLEN:
+    if (arg != SIM_MMC_BLOCK_SIZE)
+      r1 |= R1_PARAMETER;
+    break;
+  case CMD_READ:
+  case CMD_READ_MULTIPLE:
+  case CMD_WRITE:
+  case CMD_WRITE_MULTIPLE:
+    if (cp->mmc_idle) {
+      r1 |= R1_ILLEGAL;
+      break;
+    }
+    if ((arg % SIM_MMC_BLOCK_SIZE) != 0) {
+      r1 |= R1_ADDRESS;
+      break;
+    }
+    if (arg / SIM_MMC_BLOCK_SIZE >= cp->mmc_blocks) {
+      r1 |= R1_PARAMETER;
+      break;
+    }
+    cp->mmc_block = arg / SIM_MMC_BLOCK_SIZE;
+    cp->mmc_pos = 0;
+    cp->mmc_multi = (cmd == CMD_READ_MULTIPLE) ||
+                    (cmd == CMD_WRITE_MULTIPLE);
+    if ((cmd == CMD_READ) || (cmd == CMD_READ_MULTIPLE))
+      cp->mmc_state = SIM_MMC_READ;
+    else
+      cp->mmc_state = SIM_MMC_WAIT_TOKEN;
+    break;
+  default:
+    r1 |= R1_ILLEGAL;
+  }
+  mmc_respond(cp, 0xFF, r1);
+}
+
+/**
+ * @brief   Returns the next byte of a read data frame.
+ *
+ * @param[in] cp        pointer to the @p SimMMC object
+ * @return              The data frame byte.
+ */
+static uint8_t mmc_read_next(SimMMC *cp) {
+  unsigned pos = cp->mmc_pos++;
+
+  if (pos == READ_DATA - 1)
+    return TOKEN_SINGLE;
+  if ((pos >= READ_DATA) && (pos < READ_DATA + SIM_MMC_BLOCK_SIZE))
+    return cp->mmc_image[cp->mmc_block * SIM_MMC_BLOCK_SIZE +
+                         pos - READ_DATA];
+  if (cp->mmc_pos == READ_END) {
+    /* End of the frame, the next block follows in multiple reads.*/
+    cp->mmc_nread++;
+    cp->mmc_pos = 0;
+    if (!cp->mmc_multi || (++cp->mmc_block >= cp->mmc_blocks))
+      cp->mmc_state = SIM_MMC_IDLE;
+  }
+  /* Gap and CRC.*/
+  return 0xFF;
+}
+
+/**
+ * @brief   Stores the next byte of a write data frame.
+ *
+ * @param[in] cp        pointer to the @p SimMMC object
+ * @param[in] b         the received byte
+ */
+static void mmc_write_next(SimMMC *cp, uint8_t b) {
+  unsigned pos = cp->mmc_pos++;
+
+  if ((pos < SIM_MMC_BLOCK_SIZE) && (cp->mmc_block < cp->mmc_blocks))
+    cp->mmc_image[cp->mmc_block * SIM_MMC_BLOCK_SIZE + pos] = b;
+  if (cp->mmc_pos == WRITE_END) {
+    /* CRC received, data response followed by a busy byte.*/
+    if (cp->mmc_block < cp->mmc_blocks) {
+      mmc_respond(cp, DATA_ACCEPTED, 0x00);
+      cp->mmc_nwritten++;
+      cp->mmc_block++;
+    }
+    else
+      mmc_respond(cp, DATA_WRITE_ERROR, 0x00);
+    cp->mmc_state = cp->mmc_multi ? SIM_MMC_WAIT_TOKEN : SIM_MMC_IDLE;
+  }
+}
+
+/**
+ * @brief   Exchanges one byte with the card.
+ * @details The output byte is determined before processing the input byte,
+ *          responses are sent starting from the byte after the command or
+ *          data frame end.
+ *
+ * @param[in] cp        pointer to the @p SimMMC object
+ * @param[in] b         the byte sent by the host
+ * @return              The byte sent by the card.
+ */
+static uint8_t mmc_exchange(SimMMC *cp, uint8_t b) {
+  uint8_t out;
+
+  if (cp->mmc_resprd < cp->mmc_respn)
+    out = cp->mmc_resp[cp->mmc_resprd++];
+  else if (cp->mmc_state == SIM_MMC_READ)
+    out = mmc_read_next(cp);
+  else
+    out = 0xFF;
+
+  switch (cp->mmc_state) {
+  case SIM_MMC_CMD:
+    cp->mmc_cmd[cp->mmc_cmdcnt++] = b;
+    if (cp->mmc_cmdcnt == sizeof(cp->mmc_cmd))
+      mmc_command(cp);
+    break;
+  case SIM_MMC_WRITE:
+    mmc_write_next(cp, b);
+    break;
+  case SIM_MMC_WAIT_TOKEN:
+    if ((b == TOKEN_SINGLE) && !cp->mmc_multi) {
+      cp->mmc_state = SIM_MMC_WRITE;
+      cp->mmc_pos = 0;
+      break;
+    }
+    if (cp->mmc_multi) {
+      if (b == TOKEN_MULTIPLE) {
+        cp->mmc_state = SIM_MMC_WRITE;
+        cp->mmc_pos = 0;
+        break;
+      }
+      if (b == TOKEN_STOP) {
+        /* Stuff byte then busy.*/
+        mmc_respond(cp, 0xFF, 0x00);
+        cp->mmc_state = SIM_MMC_IDLE;
+        break;
+      }
+    }
+    /* falls through */
+  default:
+    /* Commands are accepted also while sending data, CMD12 is sent this
+       way to stop a multiple blocks read.*/
+    if ((b & 0xC0) == 0x40) {
+      cp->mmc_prev = cp->mmc_state;
+      cp->mmc_state = SIM_MMC_CMD;
+      cp->mmc_cmd[0] = b;
+      cp->mmc_cmdcnt = 1;
+    }
+  }
+  return out;
+}
+
+/**
+ * @brief   Receives bytes from the card.
+ * @details Data blocks are copied from the image in a single operation.
+ *
+ * @param[in] cp        pointer to the @p SimMMC object
+ * @param[in] n         number of bytes
+ * @param[out] rxbuf    the receive buffer or @p NULL
+ */
+static void mmc_receive(SimMMC *cp, size_t n, uint8_t *rxbuf) {
+
+  while (n > 0) {
+    size_t k = 1;
+
+    if ((cp->mmc_resprd >= cp->mmc_respn) &&
+        (cp->mmc_state == SIM_MMC_READ) &&
+        (cp->mmc_pos >= READ_DATA) &&
+        (cp->mmc_pos < READ_DATA + SIM_MMC_BLOCK_SIZE)) {
+      k = READ_DATA + SIM_MMC_BLOCK_SIZE - cp->mmc_pos;
+      if (k > n)
+        k = n;
+      if (rxbuf != NULL) {
+        memcpy(rxbuf, &cp->mmc_image[cp->mmc_block * SIM_MMC_BLOCK_SIZE +
+                                     cp->mmc_pos - READ_DATA], k);
+        rxbuf += k;
+      }
+      cp->mmc_pos += k;
+    }
+    else {
+      uint8_t b = mmc_exchange(cp, 0xFF);
+
+      if (rxbuf != NULL)
+        *rxbuf++ = b;
+    }
+    n -= k;
+  }
+}
+
+/**
+ * @brief   Sends bytes to the card.
+ * @details Data blocks are copied into the image in a single operation.
+ *
+ * @param[in] cp        pointer to the @p SimMMC object
+ * @param[in] n         number of bytes
+ * @param[in] txbuf     the transmit buffer
+ * @param[out] rxbuf    the receive buffer or @p NULL
+ */
+static void mmc_send(SimMMC *cp, size_t n, const uint8_t *txbuf,
+                     uint8_t *rxbuf) {
+
+  while (n > 0) {
+    size_t k = 1;
+
+    if ((rxbuf == NULL) &&
+        (cp->mmc_resprd >= cp->mmc_respn) &&
+        (cp->mmc_state == SIM_MMC_WRITE) &&
+        (cp->mmc_pos < SIM_MMC_BLOCK_SIZE) &&
+        (cp->mmc_block < cp->mmc_blocks)) {
+      k = SIM_MMC_BLOCK_SIZE - cp->mmc_pos;
+      if (k > n)
+        k = n;
+      memcpy(&cp->mmc_image[cp->mmc_block * SIM_MMC_BLOCK_SIZE +
+                            cp->mmc_pos], txbuf, k);
+      cp->mmc_pos += k;
+    }
+    else {
+      uint8_t b = mmc_exchange(cp, *txbuf);
+
+      if (rxbuf != NULL)
+        *rxbuf++ = b;
+    }
+    txbuf += k;
+    n -= k;
+  }
+}
+
+/*===========================================================================*/
+/* Driver interrupt handlers.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Low level SPI driver initialization.
+ *
+ * @notapi
+ */
+void spi_lld_init(void) {
+
+#if USE_SIM_SPI1
+  spiObjectInit(&SPID1);
+  SPID1.spd_image = SIM_SPI1_IMAGE;
+  SPID1.spd_selected = FALSE;
+  SPID1.spd_pending = FALSE;
+  memset(&SPID1.spd_mmc, 0, sizeof(SPID1.spd_mmc));
+  SPID1.spd_mmc.mmc_idle = TRUE;
+#endif
+
+#if USE_SIM_SPI2
+  spiObjectInit(&SPID2);
+  SPID2.spd_image = NULL;
+  SPID2.spd_selected = FALSE;
+  SPID2.spd_pending = FALSE;
+  memset(&SPID2.spd_mmc, 0, sizeof(SPID2.spd_mmc));
+#endif
+}
+
+/**
+ * @brief   Configures and activates the SPI peripheral.
+ * @details The disk image is mapped on the first activation.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ *
+ * @notapi
+ */
+void spi_lld_start(SPIDriver *spip) {
+
+  if (spip->spd_mmc.mmc_image == NULL) {
+#if USE_SIM_SPI1
+    if (&SPID1 == spip)
+      image_map(spip, SIM_SPI1_IMAGE_SIZE);
+#endif
+  }
+}
+
+/**
+ * @brief   Deactivates the SPI peripheral.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ *
+ * @notapi
+ */
+void spi_lld_stop(SPIDriver *spip) {
+
+  (void)spip;
+}
+
+/**
+ * @brief   Asserts the slave select signal and prepares for transfers.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ *
+ * @notapi
+ */
+void spi_lld_select(SPIDriver *spip) {
+
+  spip->spd_selected = TRUE;
+}
+
+/**
+ * @brief   Deasserts the slave select signal.
+ * @details The previously selected peripheral is unselected, a partially
+ *          received command is discarded.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ *
+ * @notapi
+ */
+void spi_lld_unselect(SPIDriver *spip) {
+
+  spip->spd_selected = FALSE;
+  if (spip->spd_mmc.mmc_state == SIM_MMC_CMD)
+    spip->spd_mmc.mmc_state = spip->spd_mmc.mmc_prev;
+}
+
+/**
+ * @brief   Ignores data on the SPI bus.
+ * @details This asynchronous function starts the transmission of a series of
+ *          idle words on the SPI bus and ignores the received data.
+ * @post    At the end of the operation the configured callback is invoked.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] n         number of words to be ignored
+ *
+ * @notapi
+ */
+void spi_lld_ignore(SPIDriver *spip, size_t n) {
+
+  if (spip->spd_selected && (spip->spd_image != NULL))
+    mmc_receive(&spip->spd_mmc, n, NULL);
+  spip->spd_pending = TRUE;
+}
+
+/**
+ * @brief   Exchanges data on the SPI bus.
+ * @details This asynchronous function starts a simultaneous transmit/receive
+ *          operation.
+ * @post    At the end of the operation the configured callback is invoked.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] n         number of words to be exchanged
+ * @param[in] txbuf     the pointer to the transmit buffer
+ * @param[out] rxbuf    the pointer to the receive buffer
+ *
+ * @notapi
+ */
+void spi_lld_exchange(SPIDriver *spip, size_t n,
+                      const void *txbuf, void *rxbuf) {
+
+  if (spip->spd_image == NULL)
+    memmove(rxbuf, txbuf, n);
+  else if (spip->spd_selected)
+    mmc_send(&spip->spd_mmc, n, txbuf, rxbuf);
+  else
+    memset(rxbuf, 0xFF, n);
+  spip->spd_pending = TRUE;
+}
+
+/**
+ * @brief   Sends data over the SPI bus.
+ * @details This asynchronous function starts a transmit operation.
+ * @post    At the end of the operation the configured callback is invoked.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] n         number of words to send
+ * @param[in] txbuf     the pointer to the transmit buffer
+ *
+ * @notapi
+ */
+void spi_lld_send(SPIDriver *spip, size_t n, const void *txbuf) {
+
+  if (spip->spd_selected && (spip->spd_image != NULL))
+    mmc_send(&spip->spd_mmc, n, txbuf, NULL);
+  spip->spd_pending = TRUE;
+}
+
+/**
+ * @brief   Receives data from the SPI bus.
+ * @details This asynchronous function starts a receive operation.
+ * @post    At the end of the operation the configured callback is invoked.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] n         number of words to receive
+ * @param[out] rxbuf    the pointer to the receive buffer
+ *
+ * @notapi
+ */
+void spi_lld_receive(SPIDriver *spip, size_t n, void *rxbuf) {
+
+  if (spip->spd_selected && (spip->spd_image != NULL))
+    mmc_receive(&spip->spd_mmc, n, rxbuf);
+  else
+    memset(rxbuf, 0xFF, n);
+  spip->spd_pending = TRUE;
+}
+
+/**
+ * @brief   Exchanges one frame using a polled wait.
+ * @details This synchronous function exchanges one frame using a polled
+ *          synchronization method. This function is useful when exchanging
+ *          small amount of data on high speed channels, usually in this
+ *          situation is much more efficient just wait for completion using
+ *          polling than suspending the thread waiting for an interrupt.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] frame     the data frame to send over the SPI bus
+ * @return              The received data frame from the SPI bus.
+ */
+uint16_t spi_lld_polled_exchange(SPIDriver *spip, uint16_t frame) {
+
+  if (spip->spd_image == NULL)
+    return frame;
+  if (spip->spd_selected)
+    return mmc_exchange(&spip->spd_mmc, (uint8_t)frame);
+  return 0xFF;
+}
+
+/**
+ * @brief   Serves the pending transfer completions.
+ *
+ * @return              The interrupt state.
+ * @retval TRUE         a completion has been served.
+ * @retval FALSE        no completions pending.
+ */
+bool_t spi_lld_interrupt_pending(void) {
+
+#if USE_SIM_SPI1
+  if (SPID1.spd_pending) {
+    SPID1.spd_pending = FALSE;
+    _spi_isr_code(&SPID1);
+    return TRUE;
+  }
+#endif
+#if USE_SIM_SPI2
+  if (SPID2.spd_pending) {
+    SPID2.spd_pending = FALSE;
+    _spi_isr_code(&SPID2);
+    return TRUE;
+  }
+#endif
+  return FALSE;
+}
+
+#endif /* HAL_USE_SPI */
+
+/** @} */
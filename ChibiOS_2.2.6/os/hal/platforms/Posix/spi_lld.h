@@ -0,0 +1,303 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,2011 Giovanni Di Sirio.
+
+    This file is part of ChibiOS/RT.
+
+    ChibiOS/RT is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/RT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+                                      ---
+
+    A special exception to the GPL can be applied should you wish to distribute
+    a combined work that includes ChibiOS/RT, without being obliged to provide
+    the source code for any proprietary components. See the file exception.txt
+    for full details of how and when the exception can be applied.
+*/
+
+/**
+ * @file    Posix/spi_lld.h
+ * @brief   Posix low level simulated SPI driver header.
+ * @details The simulated SPI1 bus has a single slave, an SPI mode MMC/SD
+ *          card whose content is a memory mapped disk image file. The
+ *          simulated SPI2 bus has the MOSI line looped back to MISO.
+ *
+ * @addtogroup POSIX_SPI
+ * @{
+ */
+
+#ifndef _SPI_LLD_H_
+#define _SPI_LLD_H_
+
+#if HAL_USE_SPI || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Block size of the simulated card.
+ */
+#define SIM_MMC_BLOCK_SIZE          512
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   SPI1 driver enable switch.
+ * @details If set to @p TRUE the support for SPI1 is included.
+ * @note    The default is @p TRUE.
+ */
+#if !defined(USE_SIM_SPI1) || defined(__DOXYGEN__)
+#define USE_SIM_SPI1                TRUE
+#endif
+
+/**
+ * @brief   SPI2 driver enable switch.
+ * @details If set to @p TRUE the support for the SPI2 loopback bus is
+ *          included.
+ * @note    The default is @p TRUE.
+ */
+#if !defined(USE_SIM_SPI2) || defined(__DOXYGEN__)
+#define USE_SIM_SPI2                TRUE
+#endif
+
+/**
+ * @brief   Disk image file of the card on SPI1.
+ */
+#if !defined(SIM_SPI1_IMAGE) || defined(__DOXYGEN__)
+#define SIM_SPI1_IMAGE              "mmc.img"
+#endif
+
+/**
+ * @brief   Size of the disk image file when it has to be created.
+ * @details An existing image keeps its size, rounded down to a multiple of
+ *          the block size.
+ */
+#if !defined(SIM_SPI1_IMAGE_SIZE) || defined(__DOXYGEN__)
+#define SIM_SPI1_IMAGE_SIZE         (16 * 1024 * 1024)
+#endif
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if (SIM_SPI1_IMAGE_SIZE % SIM_MMC_BLOCK_SIZE) != 0
+#error "SIM_SPI1_IMAGE_SIZE must be a multiple of the block size"
+#endif
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Type of a structure representing an SPI driver.
+ */
+typedef struct SPIDriver SPIDriver;
+
+/**
+ * @brief   SPI notification callback type.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object triggering the
+ *                      callback
+ */
+typedef void (*spicallback_t)(SPIDriver *spip);
+
+/**
+ * @brief   Simulated card states.
+ */
+typedef enum {
+  SIM_MMC_IDLE = 0,                 /**< Waiting for a command.             */
+  SIM_MMC_CMD = 1,                  /**< Receiving a command.               */
+  SIM_MMC_READ = 2,                 /**< Sending data blocks.               */
+  SIM_MMC_WAIT_TOKEN = 3,           /**< Waiting for a data token.          */
+  SIM_MMC_WRITE = 4                 /**< Receiving a data block.            */
+} simmmcstate_t;
+
+/**
+ * @brief   Simulated SPI mode MMC/SD card.
+ */
+typedef struct {
+  /**
+   * @brief Memory mapped disk image.
+   */
+  uint8_t               *mmc_image;
+  /**
+   * @brief Number of blocks in the image.
+   */
+  uint32_t              mmc_blocks;
+  /**
+   * @brief Card state.
+   */
+  simmmcstate_t         mmc_state;
+  /**
+   * @brief Card in the idle state, not yet initialized.
+   */
+  bool_t                mmc_idle;
+  /**
+   * @brief Next command is an application specific command.
+   */
+  bool_t                mmc_acmd;
+  /**
+   * @brief Multiple blocks transfer in progress.
+   */
+  bool_t                mmc_multi;
+  /**
+   * @brief Command being received.
+   */
+  uint8_t               mmc_cmd[6];
+  /**
+   * @brief Number of command bytes received.
+   */
+  unsigned              mmc_cmdcnt;
+  /**
+   * @brief State before the command reception.
+   */
+  simmmcstate_t         mmc_prev;
+  /**
+   * @brief Pending response bytes.
+   */
+  uint8_t               mmc_resp[4];
+  /**
+   * @brief Next pending response byte.
+   */
+  unsigned              mmc_resprd;
+  /**
+   * @brief Number of pending response bytes.
+   */
+  unsigned              mmc_respn;
+  /**
+   * @brief Current block of the data transfer.
+   */
+  uint32_t              mmc_block;
+  /**
+   * @brief Position within the current data block frame.
+   */
+  unsigned              mmc_pos;
+  /**
+   * @brief Number of blocks read.
+   */
+  uint32_t              mmc_nread;
+  /**
+   * @brief Number of blocks written.
+   */
+  uint32_t              mmc_nwritten;
+} SimMMC;
+
+/**
+ * @brief   Driver configuration structure.
+ */
+typedef struct {
+  /**
+   * @brief Operation complete callback or @p NULL.
+   */
+  spicallback_t         spc_endcb;
+  /* End of the mandatory fields.*/
+} SPIConfig;
+
+/**
+ * @brief   Structure representing a SPI driver.
+ */
+struct SPIDriver {
+  /**
+   * @brief Driver state.
+   */
+  spistate_t            spd_state;
+  /**
+   * @brief Current configuration data.
+   */
+  const SPIConfig       *spd_config;
+#if SPI_USE_WAIT || defined(__DOXYGEN__)
+  /**
+   * @brief Waiting thread.
+   */
+  Thread                *spd_thread;
+#endif /* SPI_USE_WAIT */
+#if SPI_USE_MUTUAL_EXCLUSION || defined(__DOXYGEN__)
+#if CH_USE_MUTEXES || defined(__DOXYGEN__)
+  /**
+   * @brief Mutex protecting the bus.
+   */
+  Mutex                 spd_mutex;
+#elif CH_USE_SEMAPHORES
+  Semaphore             spd_semaphore;
+#endif
+#endif /* SPI_USE_MUTUAL_EXCLUSION */
+#if SPI_USE_JOBS || defined(__DOXYGEN__)
+  /**
+   * @brief Job in progress or @p NULL.
+   */
+  SPIJob                *spd_job;
+#endif /* SPI_USE_JOBS */
+#if defined(SPI_DRIVER_EXT_FIELDS)
+  SPI_DRIVER_EXT_FIELDS
+#endif
+  /* End of the mandatory fields.*/
+  /**
+   * @brief Disk image file name, @p NULL on a loopback bus.
+   */
+  const char            *spd_image;
+  /**
+   * @brief Slave selected flag.
+   */
+  bool_t                spd_selected;
+  /**
+   * @brief Transfer completion interrupt pending.
+   */
+  bool_t                spd_pending;
+  /**
+   * @brief The simulated card.
+   */
+  SimMMC                spd_mmc;
+};
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#if USE_SIM_SPI1 && !defined(__DOXYGEN__)
+extern SPIDriver SPID1;
+#endif
+
+#if USE_SIM_SPI2 && !defined(__DOXYGEN__)
+extern SPIDriver SPID2;
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void spi_lld_init(void);
+  void spi_lld_start(SPIDriver *spip);
+  void spi_lld_stop(SPIDriver *spip);
+  void spi_lld_select(SPIDriver *spip);
+  void spi_lld_unselect(SPIDriver *spip);
+  void spi_lld_ignore(SPIDriver *spip, size_t n);
+  void spi_lld_exchange(SPIDriver *spip, size_t n,
+                        const void *txbuf, void *rxbuf);
+  void spi_lld_send(SPIDriver *spip, size_t n, const void *txbuf);
+  void spi_lld_receive(SPIDriver *spip, size_t n, void *rxbuf);
+  uint16_t spi_lld_polled_exchange(SPIDriver *spip, uint16_t frame);
+  bool_t spi_lld_interrupt_pending(void);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HAL_USE_SPI */
+
+#endif /* _SPI_LLD_H_ */
+
+/** @} */
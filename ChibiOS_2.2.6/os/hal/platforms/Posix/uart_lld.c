@@ -0,0 +1,400 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,2011 Giovanni Di Sirio.
+
+    This file is part of ChibiOS/RT.
+
+    ChibiOS/RT is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/RT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+                                      ---
+
+    A special exception to the GPL can be applied should you wish to distribute
+    a combined work that includes ChibiOS/RT, without being obliged to provide
+    the source code for any proprietary components. See the file exception.txt
+    for full details of how and when the exception can be applied.
+*/
+
+/**
+ * @file    Posix/uart_lld.c
+ * @brief   Posix low level simulated UART driver code.
+ * @details The line is read when the UART interrupt sources are checked,
+ *          the reads model the DMA transfers:
+ *          - Receiver idle, one character is read for each interrupt and
+ *            passed to the @p uc_rxchar callback. Without callback the
+ *            received data is discarded.
+ *          - Receive operation, the data is read into the buffer and the
+ *            @p uc_rxend callback is invoked when the buffer is full.
+ *          - Continuous receive operation, a single read fills the current
+ *            buffer as far as possible, the buffers are switched when the
+ *            read fills the buffer or empties the line, an empty line is
+ *            the idle line condition.
+ *          .
+ *          Transmissions are written to the line immediately, the
+ *          completion interrupt is served on the next sources check.
+ *
+ * @addtogroup POSIX_UART
+ * @{
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include "ch.h"
+#include "hal.h"
+
+#if HAL_USE_UART || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/** @brief UART1 driver identifier.*/
+#if USE_SIM_UART1 || defined(__DOXYGEN__)
+UARTDriver UARTD1;
+#endif
+
+/*===========================================================================*/
+/* Driver local variables.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Reads the available data from the line.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ * @param[out] buf      pointer to the receive buffer
+ * @param[in] n         maximum number of bytes to be read
+ * @return              The number of bytes read, zero if the line is
+ *                      empty.
+ */
+static size_t line_read(UARTDriver *uartp, void *buf, size_t n) {
+  ssize_t cnt = recv(uartp->ud_fd, buf, n, MSG_DONTWAIT);
+
+  return cnt > 0 ? (size_t)cnt : 0;
+}
+
+/**
+ * @brief   RX common service routine.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ */
+static void serve_rx_end_irq(UARTDriver *uartp) {
+
+  uartp->ud_rxstate = UART_RX_COMPLETE;
+  if (uartp->ud_config->uc_rxend != NULL)
+    uartp->ud_config->uc_rxend(uartp);
+  /* If the callback didn't explicitly change state then the receiver
+     automatically returns to the idle state.*/
+  if (uartp->ud_rxstate == UART_RX_COMPLETE)
+    uartp->ud_rxstate = UART_RX_IDLE;
+}
+
+/**
+ * @brief   TX common service routine.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ */
+static void serve_tx_end_irq(UARTDriver *uartp) {
+
+  /* A callback is generated, if enabled, after a completed transfer.*/
+  uartp->ud_txstate = UART_TX_COMPLETE;
+  if (uartp->ud_config->uc_txend1 != NULL)
+    uartp->ud_config->uc_txend1(uartp);
+  /* If the callback didn't explicitly change state then the transmitter
+     automatically returns to the idle state.*/
+  if (uartp->ud_txstate == UART_TX_COMPLETE)
+    uartp->ud_txstate = UART_TX_IDLE;
+  /* The data is already on the line.*/
+  if (uartp->ud_config->uc_txend2 != NULL)
+    uartp->ud_config->uc_txend2(uartp);
+}
+
+/**
+ * @brief   RX interrupt sources check.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ * @return              The interrupt state.
+ * @retval TRUE         an interrupt has been served.
+ * @retval FALSE        no interrupt pending.
+ */
+static bool_t serve_rx(UARTDriver *uartp) {
+  size_t n;
+
+  switch (uartp->ud_rxstate) {
+  case UART_RX_ACTIVE:
+    n = line_read(uartp, uartp->ud_rxbuf + uartp->ud_rxcnt,
+                  uartp->ud_rxn - uartp->ud_rxcnt);
+    uartp->ud_rxcnt += n;
+    if (uartp->ud_rxcnt < uartp->ud_rxn)
+      return FALSE;
+    uartp->ud_rxirqs++;
+    serve_rx_end_irq(uartp);
+    return TRUE;
+#if UART_USE_CONTINUOUS
+  case UART_RX_CONTINUOUS:
+    {
+      UARTRxBuffer *rbp = &uartp->ud_rxdesc[uartp->ud_rxcur];
+
+      n = line_read(uartp, rbp->ub_buf, uartp->ud_rxsize);
+      if (n == 0)
+        return FALSE;
+      /* Buffer full or idle line, the reception continues into the other
+         buffer.*/
+      rbp->ub_n = n;
+      uartp->ud_rxcur ^= 1;
+      uartp->ud_rxirqs++;
+      _uart_rx_buffer_isr_code(uartp, rbp);
+      return TRUE;
+    }
+#endif
+  default:
+    if (uartp->ud_config->uc_rxchar == NULL) {
+      uint8_t buf[64];
+
+      /* Data lost without interrupts, as in the hardware idle loop.*/
+      while (line_read(uartp, buf, sizeof(buf)) > 0)
+        ;
+      return FALSE;
+    }
+    else {
+      uint8_t c;
+
+      if (line_read(uartp, &c, 1) == 0)
+        return FALSE;
+      uartp->ud_rxirqs++;
+      uartp->ud_config->uc_rxchar(uartp, c);
+      return TRUE;
+    }
+  }
+}
+
+/*===========================================================================*/
+/* Driver interrupt handlers.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Low level UART driver initialization.
+ *
+ * @notapi
+ */
+void uart_lld_init(void) {
+
+#if USE_SIM_UART1
+  int sv[2];
+
+  uartObjectInit(&UARTD1);
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0) {
+    printf("UART1: Error creating the line socket pair\n");
+    exit(1);
+  }
+  UARTD1.ud_fd = sv[0];
+  UARTD1.ud_peer = sv[1];
+  UARTD1.ud_rxirqs = 0;
+#endif
+}
+
+/**
+ * @brief   Configures and activates the UART peripheral.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ *
+ * @notapi
+ */
+void uart_lld_start(UARTDriver *uartp) {
+
+  uartp->ud_rxstate = UART_RX_IDLE;
+  uartp->ud_txstate = UART_TX_IDLE;
+  uartp->ud_txpending = FALSE;
+}
+
+/**
+ * @brief   Deactivates the UART peripheral.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ *
+ * @notapi
+ */
+void uart_lld_stop(UARTDriver *uartp) {
+
+  uartp->ud_txpending = FALSE;
+}
+
+/**
+ * @brief   Starts a transmission on the UART peripheral.
+ * @details The data is written to the line before returning, the host end
+ *          of the line must be read in order to not block the simulator.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ * @param[in] n         number of data frames to send
+ * @param[in] txbuf     the pointer to the transmit buffer
+ *
+ * @notapi
+ */
+void uart_lld_start_send(UARTDriver *uartp, size_t n, const void *txbuf) {
+  const uint8_t *p = txbuf;
+
+  while (n > 0) {
+    ssize_t cnt = send(uartp->ud_fd, p, n, 0);
+
+    if (cnt < 0) {
+      if (errno == EINTR)
+        continue;
+      break;
+    }
+    p += cnt;
+    n -= (size_t)cnt;
+  }
+  uartp->ud_txpending = TRUE;
+}
+
+/**
+ * @brief   Stops any ongoing transmission.
+ * @note    Stopping a transmission also suppresses the transmission callbacks.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ *
+ * @return              The number of data frames not transmitted by the
+ *                      stopped transmit operation, always zero.
+ *
+ * @notapi
+ */
+size_t uart_lld_stop_send(UARTDriver *uartp) {
+
+  uartp->ud_txpending = FALSE;
+  return 0;
+}
+
+/**
+ * @brief   Starts a receive operation on the UART peripheral.
+ * @note    The buffers are organized as uint8_t arrays for data sizes below
+ *          or equal to 8 bits else it is organized as uint16_t arrays.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ * @param[in] n         number of data frames to send
+ * @param[out] rxbuf    the pointer to the receive buffer
+ *
+ * @notapi
+ */
+void uart_lld_start_receive(UARTDriver *uartp, size_t n, void *rxbuf) {
+
+  uartp->ud_rxbuf = rxbuf;
+  uartp->ud_rxn = n;
+  uartp->ud_rxcnt = 0;
+}
+
+/**
+ * @brief   Stops any ongoing receive operation.
+ * @note    Stopping a receive operation also suppresses the receive callbacks.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ *
+ * @return              The number of data frames not received by the
+ *                      stopped receive operation.
+ *
+ * @notapi
+ */
+size_t uart_lld_stop_receive(UARTDriver *uartp) {
+
+  if (uartp->ud_rxstate == UART_RX_ACTIVE)
+    return uartp->ud_rxn - uartp->ud_rxcnt;
+  return 0;
+}
+
+#if UART_USE_CONTINUOUS || defined(__DOXYGEN__)
+/**
+ * @brief   Starts a continuous receive operation on the UART peripheral.
+ * @details The reception starts into the buffer @p ud_rxcur, the buffers
+ *          are described by the @p ud_rxdesc and @p ud_rxsize fields.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ *
+ * @notapi
+ */
+void uart_lld_start_continuous_receive(UARTDriver *uartp) {
+
+  (void)uartp;
+}
+#endif /* UART_USE_CONTINUOUS */
+
+/**
+ * @brief   Returns the host end of the line.
+ * @details Host threads write the data to be received by the UART into the
+ *          returned descriptor and read the data it transmits from it.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ * @return              The socket descriptor.
+ */
+int uart_lld_peer(UARTDriver *uartp) {
+
+  return uartp->ud_peer;
+}
+
+/**
+ * @brief   Interrupt simulation.
+ *
+ * @return              The interrupt state.
+ * @retval TRUE         an interrupt has been served.
+ * @retval FALSE        no interrupt pending.
+ */
+bool_t uart_lld_interrupt_pending(void) {
+#if USE_SIM_UART1
+  UARTDriver *uartp = &UARTD1;
+
+  if (uartp->ud_state != UART_READY)
+    return FALSE;
+  if (uartp->ud_txpending) {
+    uartp->ud_txpending = FALSE;
+    serve_tx_end_irq(uartp);
+    return TRUE;
+  }
+  return serve_rx(uartp);
+#else
+  return FALSE;
+#endif
+}
+
+/**
+ * @brief   Collects the descriptors to be waited for while idle.
+ * @details The driver end of the line is waited for input while the driver
+ *          is active.
+ *
+ * @param[out] fds      array of @p pollfd structures, it must be able to
+ *                      contain one element
+ * @return              The number of descriptors written into @p fds.
+ */
+int uart_lld_poll_setup(struct pollfd *fds) {
+#if USE_SIM_UART1
+  if (UARTD1.ud_state != UART_READY)
+    return 0;
+  fds->fd = UARTD1.ud_fd;
+  fds->events = POLLIN;
+  fds->revents = 0;
+  return 1;
+#else
+  (void)fds;
+  return 0;
+#endif
+}
+
+#endif /* HAL_USE_UART */
+
+/** @} */
@@ -0,0 +1,262 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,2011 Giovanni Di Sirio.
+
+    This file is part of ChibiOS/RT.
+
+    ChibiOS/RT is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/RT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+                                      ---
+
+    A special exception to the GPL can be applied should you wish to distribute
+    a combined work that includes ChibiOS/RT, without being obliged to provide
+    the source code for any proprietary components. See the file exception.txt
+    for full details of how and when the exception can be applied.
+*/
+
+/**
+ * @file    Posix/uart_lld.h
+ * @brief   Posix low level simulated UART driver header.
+ * @details The line of the simulated UART1 is one end of a host socket
+ *          pair, host threads exchange data with the UART through the
+ *          other end.
+ *
+ * @addtogroup POSIX_UART
+ * @{
+ */
+
+#ifndef _UART_LLD_H_
+#define _UART_LLD_H_
+
+#if HAL_USE_UART || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   UART1 driver enable switch.
+ * @details If set to @p TRUE the support for UART1 is included.
+ * @note    The default is @p TRUE.
+ */
+#if !defined(USE_SIM_UART1) || defined(__DOXYGEN__)
+#define USE_SIM_UART1               TRUE
+#endif
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if !USE_SIM_UART1
+#error "UART driver activated but no UART peripheral assigned"
+#endif
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   UART driver condition flags type.
+ */
+typedef uint32_t uartflags_t;
+
+/**
+ * @brief   Structure representing an UART driver.
+ */
+typedef struct UARTDriver UARTDriver;
+
+/**
+ * @brief   Generic UART notification callback type.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ */
+typedef void (*uartcb_t)(UARTDriver *uartp);
+
+/**
+ * @brief   Character received UART notification callback type.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ * @param[in] c         received character
+ */
+typedef void (*uartccb_t)(UARTDriver *uartp, uint16_t c);
+
+/**
+ * @brief   Receive error UART notification callback type.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ * @param[in] e         receive error mask
+ */
+typedef void (*uartecb_t)(UARTDriver *uartp, uartflags_t e);
+
+/**
+ * @brief   Continuous receive buffer UART notification callback type.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ * @param[in] buffer    pointer to the completed buffer
+ * @param[in] n         number of data frames in the buffer
+ */
+typedef void (*uartbcb_t)(UARTDriver *uartp, void *buffer, size_t n);
+
+/**
+ * @brief   Driver configuration structure.
+ * @note    The simulated line transfers 8 bits data frames, there is no
+ *          bit rate.
+ */
+typedef struct {
+  /**
+   * @brief End of transmission buffer callback.
+   */
+  uartcb_t                  uc_txend1;
+  /**
+   * @brief Physical end of transmission callback.
+   */
+  uartcb_t                  uc_txend2;
+  /**
+   * @brief Receive buffer filled callback.
+   */
+  uartcb_t                  uc_rxend;
+  /**
+   * @brief Character received while out if the @p UART_RECEIVE state.
+   */
+  uartccb_t                 uc_rxchar;
+  /**
+   * @brief Receive error callback.
+   */
+  uartecb_t                 uc_rxerr;
+#if UART_USE_CONTINUOUS || defined(__DOXYGEN__)
+  /**
+   * @brief Continuous receive buffer completed callback.
+   * @note  Present only if @p UART_USE_CONTINUOUS is enabled.
+   */
+  uartbcb_t                 uc_rxbuf;
+#endif /* UART_USE_CONTINUOUS */
+  /* End of the mandatory fields.*/
+} UARTConfig;
+
+/**
+ * @brief   Structure representing an UART driver.
+ */
+struct UARTDriver {
+  /**
+   * @brief Driver state.
+   */
+  uartstate_t               ud_state;
+  /**
+   * @brief Transmitter state.
+   */
+  uarttxstate_t             ud_txstate;
+  /**
+   * @brief Receiver state.
+   */
+  uartrxstate_t             ud_rxstate;
+  /**
+   * @brief Current configuration data.
+   */
+  const UARTConfig          *ud_config;
+#if UART_USE_CONTINUOUS || defined(__DOXYGEN__)
+  /**
+   * @brief Continuous receive buffers descriptors.
+   */
+  UARTRxBuffer              ud_rxdesc[2];
+  /**
+   * @brief Size of the continuous receive buffers.
+   */
+  size_t                    ud_rxsize;
+  /**
+   * @brief Continuous receive buffer being filled.
+   */
+  unsigned                  ud_rxcur;
+  /**
+   * @brief Mailbox receiving the completed buffers descriptors or @p NULL.
+   */
+  Mailbox                   *ud_rxmbox;
+  /**
+   * @brief Descriptors not posted because the mailbox was full.
+   */
+  uint32_t                  ud_rxdropped;
+#endif /* UART_USE_CONTINUOUS */
+#if defined(UART_DRIVER_EXT_FIELDS)
+  UART_DRIVER_EXT_FIELDS
+#endif
+  /* End of the mandatory fields.*/
+  /**
+   * @brief Driver end of the line.
+   */
+  int                       ud_fd;
+  /**
+   * @brief Host end of the line.
+   */
+  int                       ud_peer;
+  /**
+   * @brief Transmission completion interrupt pending.
+   */
+  bool_t                    ud_txpending;
+  /**
+   * @brief Receive buffer of the current receive operation.
+   */
+  uint8_t                   *ud_rxbuf;
+  /**
+   * @brief Size of the current receive operation.
+   */
+  size_t                    ud_rxn;
+  /**
+   * @brief Data frames received by the current receive operation.
+   */
+  size_t                    ud_rxcnt;
+  /**
+   * @brief Number of receive interrupts served.
+   */
+  uint32_t                  ud_rxirqs;
+};
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#if USE_SIM_UART1 && !defined(__DOXYGEN__)
+extern UARTDriver UARTD1;
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void uart_lld_init(void);
+  void uart_lld_start(UARTDriver *uartp);
+  void uart_lld_stop(UARTDriver *uartp);
+  void uart_lld_start_send(UARTDriver *uartp, size_t n, const void *txbuf);
+  size_t uart_lld_stop_send(UARTDriver *uartp);
+  void uart_lld_start_receive(UARTDriver *uartp, size_t n, void *rxbuf);
+  size_t uart_lld_stop_receive(UARTDriver *uartp);
+#if UART_USE_CONTINUOUS
+  void uart_lld_start_continuous_receive(UARTDriver *uartp);
+#endif
+  int uart_lld_peer(UARTDriver *uartp);
+  bool_t uart_lld_interrupt_pending(void);
+  int uart_lld_poll_setup(struct pollfd *fds);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HAL_USE_UART */
+
+#endif /* _UART_LLD_H_ */
+
+/** @} */
@@ -54,6 +54,93 @@ CANDriver CAND1;
 /* Driver local functions.                                                   */
 /*===========================================================================*/
 
+/**
+ * @brief   Reads a frame from a receive FIFO and releases its mailbox.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ * @param[in] fifo      the receive FIFO, 0 or 1
+ * @param[out] crfp     pointer to the buffer where the CAN frame is copied
+ */
+static void rx_mailbox_read(CANDriver *canp, unsigned fifo,
+                            CANRxFrame *crfp) {
+  CAN_FIFOMailBox_TypeDef *mbp = &canp->cd_can->sFIFOMailBox[fifo];
+  uint32_t r;
+
+  /* Fetches the message.*/
+  r = mbp->RIR;
+  crfp->cf_RTR = (r & CAN_RI0R_RTR) >> 1;
+  crfp->cf_IDE = (r & CAN_RI0R_IDE) >> 2;
+  if (crfp->cf_IDE)
+    crfp->cf_EID = r >> 3;
+  else
+    crfp->cf_SID = r >> 21;
+  r = mbp->RDTR;
+  crfp->cf_DLC = r & CAN_RDT0R_DLC;
+  crfp->cf_FMI = (uint8_t)(r >> 8);
+  crfp->cf_TIME = (uint16_t)(r >> 16);
+  crfp->cf_data32[0] = mbp->RDLR;
+  crfp->cf_data32[1] = mbp->RDHR;
+
+  /* Releases the mailbox.*/
+  if (fifo == 0)
+    canp->cd_can->RF0R = CAN_RF0R_RFOM0;
+  else
+    canp->cd_can->RF1R = CAN_RF1R_RFOM1;
+}
+
+/**
+ * @brief   Hardware receive FIFO overrun handling.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ */
+static void rx_hw_overrun(CANDriver *canp) {
+
+  canp->cd_hwoverruns++;
+  chSysLockFromIsr();
+  canAddFlagsI(canp, CAN_OVERFLOW_ERROR);
+  chEvtBroadcastI(&canp->cd_error_event);
+  chSysUnlockFromIsr();
+}
+
+#if CAN_USE_RX_FIFO || defined(__DOXYGEN__)
+/**
+ * @brief   Moves the frames of a receive FIFO into the software FIFO.
+ * @details The frames are discarded if the software FIFO is full.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ * @param[in] fifo      the receive FIFO, 0 or 1
+ */
+static void rx_fifo_fill(CANDriver *canp, unsigned fifo) {
+  volatile uint32_t *rfrp = fifo == 0 ? &canp->cd_can->RF0R :
+                                        &canp->cd_can->RF1R;
+  bool_t notify = FALSE, overrun = FALSE;
+  CANRxFrame rxf;
+
+  /* The FIFO is emptied so that the hardware can keep receiving, the
+     waiting threads are served once at the end.*/
+  while ((*rfrp & CAN_RF0R_FMP0) > 0) {
+    msg_t msg;
+
+    rx_mailbox_read(canp, fifo, &rxf);
+    msg = chRingWrite(&canp->cd_rxfifo, &rxf);
+    if (msg == RING_WAS_EMPTY)
+      notify = TRUE;
+    else if (msg == RING_FULL) {
+      canp->cd_overruns++;
+      overrun = TRUE;
+    }
+  }
+  chSysLockFromIsr();
+  if (notify)
+    _can_rx_isr_code(canp);
+  if (overrun) {
+    canAddFlagsI(canp, CAN_OVERFLOW_ERROR);
+    chEvtBroadcastI(&canp->cd_error_event);
+  }
+  chSysUnlockFromIsr();
+}
+#endif /* CAN_USE_RX_FIFO */
+
 /*===========================================================================*/
 /* Driver interrupt handlers.                                                */
 /*===========================================================================*/
@@ -90,21 +177,20 @@ CH_IRQ_HANDLER(CAN1_RX0_IRQHandler) {
 
   rf0r = CAN1->RF0R;
   if ((rf0r & CAN_RF0R_FMP0) > 0) {
+#if CAN_USE_RX_FIFO
+    rx_fifo_fill(&CAND1, 0);
+#else
     /* No more receive events until the queue 0 has been emptied.*/
     CAN1->IER &= ~CAN_IER_FMPIE0;
     chSysLockFromIsr();
-    while (chSemGetCounterI(&CAND1.cd_rxsem) < 0)
-      chSemSignalI(&CAND1.cd_rxsem);
-    chEvtBroadcastI(&CAND1.cd_rxfull_event);
+    _can_rx_isr_code(&CAND1);
     chSysUnlockFromIsr();
+#endif
   }
   if ((rf0r & CAN_RF0R_FOVR0) > 0) {
     /* Overflow events handling.*/
     CAN1->RF0R = CAN_RF0R_FOVR0;
-    canAddFlagsI(&CAND1, CAN_OVERFLOW_ERROR);
-    chSysLockFromIsr();
-    chEvtBroadcastI(&CAND1.cd_error_event);
-    chSysUnlockFromIsr();
+    rx_hw_overrun(&CAND1);
   }
 
   CH_IRQ_EPILOGUE();
@@ -116,12 +202,29 @@ CH_IRQ_HANDLER(CAN1_RX0_IRQHandler) {
  * @isr
  */
 CH_IRQ_HANDLER(CAN1_RX1_IRQHandler) {
+#if CAN_USE_RX_FIFO
+  uint32_t rf1r;
 
   CH_IRQ_PROLOGUE();
 
-  chSysHalt(); /* Not supported (yet).*/
+  rf1r = CAN1->RF1R;
+  if ((rf1r & CAN_RF1R_FMP1) > 0)
+    rx_fifo_fill(&CAND1, 1);
+  if ((rf1r & CAN_RF1R_FOVR1) > 0) {
+    /* Overflow events handling.*/
+    CAN1->RF1R = CAN_RF1R_FOVR1;
+    rx_hw_overrun(&CAND1);
+  }
 
   CH_IRQ_EPILOGUE();
+#else /* !CAN_USE_RX_FIFO */
+
+  CH_IRQ_PROLOGUE();
+
+  chSysHalt(); /* Not supported without the software FIFO.*/
+
+  CH_IRQ_EPILOGUE();
+#endif /* !CAN_USE_RX_FIFO */
 }
 
 /**
@@ -360,25 +463,8 @@ bool_t can_lld_can_receive(CANDriver *canp) {
  * @notapi
  */
 void can_lld_receive(CANDriver *canp, CANRxFrame *crfp) {
-  uint32_t r;
-
-  /* Fetches the message.*/
-  r = canp->cd_can->sFIFOMailBox[0].RIR;
-  crfp->cf_RTR = (r & CAN_RI0R_RTR) >> 1;
-  crfp->cf_IDE = (r & CAN_RI0R_IDE) >> 2;
-  if (crfp->cf_IDE)
-    crfp->cf_EID = r >> 3;
-  else
-    crfp->cf_SID = r >> 21;
-  r = canp->cd_can->sFIFOMailBox[0].RDTR;
-  crfp->cf_DLC = r & CAN_RDT0R_DLC;
-  crfp->cf_FMI = (uint8_t)(r >> 8);
-  crfp->cf_TIME = (uint16_t)(r >> 16);
-  crfp->cf_data32[0] = canp->cd_can->sFIFOMailBox[0].RDLR;
-  crfp->cf_data32[1] = canp->cd_can->sFIFOMailBox[0].RDHR;
 
-  /* Releases the mailbox.*/
-  canp->cd_can->RF0R = CAN_RF0R_RFOM0;
+  rx_mailbox_read(canp, 0, crfp);
 
   /* If the queue is empty re-enables the interrupt in order to generate
      events again.*/
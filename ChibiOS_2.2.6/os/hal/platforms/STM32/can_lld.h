@@ -197,7 +197,8 @@ typedef struct {
   /**
    * @brief Filter mode.
    * @note  This bit represent the CAN_FFA1R register bit associated to this
-   *        filter, must be set to zero in this version of the driver.
+   *        filter, it can be set to one only if @p CAN_USE_RX_FIFO is
+   *        enabled.
    */
   uint32_t                  cf_assignment:1;
   /**
@@ -292,6 +293,24 @@ typedef struct {
    */
   EventSource               cd_wakeup_event;
 #endif /* CAN_USE_SLEEP_MODE */
+#if CAN_USE_RX_FIFO || defined(__DOXYGEN__)
+  /**
+   * @brief Software receive FIFO.
+   */
+  Ring                      cd_rxfifo;
+  /**
+   * @brief Software receive FIFO buffer.
+   */
+  CANRxFrame                cd_rxbuf[CAN_RX_FIFO_SIZE];
+#endif /* CAN_USE_RX_FIFO */
+  /**
+   * @brief Frames lost because the software receive FIFO was full.
+   */
+  uint32_t                  cd_overruns;
+  /**
+   * @brief Overruns of the hardware receive FIFOs.
+   */
+  uint32_t                  cd_hwoverruns;
   /* End of the mandatory fields.*/
   /**
    * @brief Pointer to the CAN registers.
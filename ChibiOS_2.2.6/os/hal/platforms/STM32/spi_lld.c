@@ -89,6 +89,9 @@ static uint16_t dummyrx;
 
 /**
  * @brief   Shared end-of-transfer service routine.
+ * @note    The DMA interrupt flags must be cleared before invoking this
+ *          function because the next transfer of a jobs list is started
+ *          from here and could complete before the handler exit.
  *
  * @param[in] spip      pointer to the @p SPIDriver object
  */
@@ -119,8 +122,8 @@ CH_IRQ_HANDLER(DMA1_Ch2_IRQHandler) {
   if ((STM32_DMA1->ISR & DMA_ISR_TEIF2) != 0) {
     STM32_SPI_SPI1_DMA_ERROR_HOOK();
   }
-  serve_interrupt(&SPID1);
   dmaClearChannel(STM32_DMA1, STM32_DMA_CHANNEL_2);
+  serve_interrupt(&SPID1);
 
   CH_IRQ_EPILOGUE();
 }
@@ -154,8 +157,8 @@ CH_IRQ_HANDLER(DMA1_Ch4_IRQHandler) {
   if ((STM32_DMA1->ISR & DMA_ISR_TEIF4) != 0) {
     STM32_SPI_SPI2_DMA_ERROR_HOOK();
   }
-  serve_interrupt(&SPID2);
   dmaClearChannel(STM32_DMA1, STM32_DMA_CHANNEL_4);
+  serve_interrupt(&SPID2);
 
   CH_IRQ_EPILOGUE();
 }
@@ -189,8 +192,8 @@ CH_IRQ_HANDLER(DMA2_Ch1_IRQHandler) {
   if ((STM32_DMA2->ISR & DMA_ISR_TEIF1) != 0) {
     STM32_SPI_SPI3_DMA_ERROR_HOOK();
   }
-  serve_interrupt(&SPID3);
   dmaClearChannel(STM32_DMA2, STM32_DMA_CHANNEL_1);
+  serve_interrupt(&SPID3);
 
   CH_IRQ_EPILOGUE();
 }
@@ -238,6 +238,12 @@ struct SPIDriver{
   Semaphore             spd_semaphore;
 #endif
 #endif /* SPI_USE_MUTUAL_EXCLUSION */
+#if SPI_USE_JOBS || defined(__DOXYGEN__)
+  /**
+   * @brief Job in progress or @p NULL.
+   */
+  SPIJob                *spd_job;
+#endif /* SPI_USE_JOBS */
 #if defined(SPI_DRIVER_EXT_FIELDS)
   SPI_DRIVER_EXT_FIELDS
 #endif
@@ -106,6 +106,49 @@ static void set_rx_idle_loop(UARTDriver *uartp) {
   dmaEnableChannel(uartp->ud_dmap, uartp->ud_dmarx);
 }
 
+#if UART_USE_CONTINUOUS || defined(__DOXYGEN__)
+/**
+ * @brief   Starts the reception into the current continuous buffer.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ */
+static void set_rx_continuous(UARTDriver *uartp) {
+
+  dmaSetupChannel(uartp->ud_dmap, uartp->ud_dmarx, uartp->ud_rxsize,
+                  uartp->ud_rxdesc[uartp->ud_rxcur].ub_buf,
+                  uartp->ud_dmaccr | DMA_CCR1_MINC |
+                  DMA_CCR1_TEIE | DMA_CCR1_TCIE);
+  dmaEnableChannel(uartp->ud_dmap, uartp->ud_dmarx);
+}
+
+/**
+ * @brief   Continuous receive buffers switch.
+ * @details Invoked on buffer full and on idle line, the reception is
+ *          restarted into the other buffer before the completed one is
+ *          handed over. Nothing is done if the current buffer is empty, this
+ *          happens when the line becomes idle right after a buffer full
+ *          event.
+ * @note    On buffer full the switch must happen within two characters
+ *          time, the USART data register is the only receive buffering
+ *          while the DMA channel is reprogrammed.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ */
+static void serve_rx_buffer_irq(UARTDriver *uartp) {
+  UARTRxBuffer *rbp = &uartp->ud_rxdesc[uartp->ud_rxcur];
+
+  if (uartp->ud_dmap->channels[uartp->ud_dmarx].CNDTR == uartp->ud_rxsize)
+    return;
+  dmaDisableChannel(uartp->ud_dmap, uartp->ud_dmarx);
+  dmaClearChannel(uartp->ud_dmap, uartp->ud_dmarx);
+  rbp->ub_n = uartp->ud_rxsize -
+              (size_t)uartp->ud_dmap->channels[uartp->ud_dmarx].CNDTR;
+  uartp->ud_rxcur ^= 1;
+  set_rx_continuous(uartp);
+  _uart_rx_buffer_isr_code(uartp, rbp);
+}
+#endif /* UART_USE_CONTINUOUS */
+
 /**
  * @brief   USART de-initialization.
  * @details This function must be invoked with interrupts disabled.
@@ -223,6 +266,12 @@ static void serve_usart_irq(UARTDriver *uartp) {
     if (uartp->ud_config->uc_txend2 != NULL)
       uartp->ud_config->uc_txend2(uartp);
   }
+#if UART_USE_CONTINUOUS
+  /* Idle line, the received frames are handed over. The IDLE flag has
+     already been cleared by the SR and DR reads.*/
+  if ((sr & USART_SR_IDLE) && (uartp->ud_rxstate == UART_RX_CONTINUOUS))
+    serve_rx_buffer_irq(uartp);
+#endif
 }
 
 /*===========================================================================*/
@@ -252,6 +301,17 @@ CH_IRQ_HANDLER(DMA1_Ch5_IRQHandler) {
     if (uartp->ud_config->uc_rxchar != NULL)
       uartp->ud_config->uc_rxchar(uartp, uartp->ud_rxbuf);
   }
+#if UART_USE_CONTINUOUS
+  else if (uartp->ud_rxstate == UART_RX_CONTINUOUS) {
+    /* Continuous receive buffer full, switching to the other buffer. The
+       flag could have been already served by an idle line interrupt, the
+       channel flags are cleared anyway so that an error or an already
+       served flag does not retrigger the interrupt.*/
+    if ((STM32_DMA1->ISR & DMA_ISR_TCIF5) != 0)
+      serve_rx_buffer_irq(uartp);
+    dmaClearChannel(STM32_DMA1, STM32_DMA_CHANNEL_5);
+  }
+#endif
   else {
     /* Receiver in active state, a callback is generated, if enabled, after
        a completed transfer.*/
@@ -320,6 +380,17 @@ CH_IRQ_HANDLER(DMA1_Ch6_IRQHandler) {
     if (uartp->ud_config->uc_rxchar != NULL)
       uartp->ud_config->uc_rxchar(uartp, uartp->ud_rxbuf);
   }
+#if UART_USE_CONTINUOUS
+  else if (uartp->ud_rxstate == UART_RX_CONTINUOUS) {
+    /* Continuous receive buffer full, switching to the other buffer. The
+       flag could have been already served by an idle line interrupt, the
+       channel flags are cleared anyway so that an error or an already
+       served flag does not retrigger the interrupt.*/
+    if ((STM32_DMA1->ISR & DMA_ISR_TCIF6) != 0)
+      serve_rx_buffer_irq(uartp);
+    dmaClearChannel(STM32_DMA1, STM32_DMA_CHANNEL_6);
+  }
+#endif
   else {
     /* Receiver in active state, a callback is generated, if enabled, after
        a completed transfer.*/
@@ -388,6 +459,17 @@ CH_IRQ_HANDLER(DMA1_Ch3_IRQHandler) {
     if (uartp->ud_config->uc_rxchar != NULL)
       uartp->ud_config->uc_rxchar(uartp, uartp->ud_rxbuf);
   }
+#if UART_USE_CONTINUOUS
+  else if (uartp->ud_rxstate == UART_RX_CONTINUOUS) {
+    /* Continuous receive buffer full, switching to the other buffer. The
+       flag could have been already served by an idle line interrupt, the
+       channel flags are cleared anyway so that an error or an already
+       served flag does not retrigger the interrupt.*/
+    if ((STM32_DMA1->ISR & DMA_ISR_TCIF3) != 0)
+      serve_rx_buffer_irq(uartp);
+    dmaClearChannel(STM32_DMA1, STM32_DMA_CHANNEL_3);
+  }
+#endif
   else {
     /* Receiver in active state, a callback is generated, if enabled, after
        a completed transfer.*/
@@ -670,10 +752,36 @@ size_t uart_lld_stop_receive(UARTDriver *uartp) {
   dmaDisableChannel(uartp->ud_dmap, uartp->ud_dmarx);
   dmaClearChannel(uartp->ud_dmap, uartp->ud_dmarx);
   n = (size_t)uartp->ud_dmap->channels[uartp->ud_dmarx].CNDTR;
+#if UART_USE_CONTINUOUS
+  uartp->ud_usart->CR1 &= ~USART_CR1_IDLEIE;
+#endif
   set_rx_idle_loop(uartp);
   return n;
 }
 
+#if UART_USE_CONTINUOUS || defined(__DOXYGEN__)
+/**
+ * @brief   Starts a continuous receive operation on the UART peripheral.
+ * @details The reception starts into the buffer @p ud_rxcur, the buffers
+ *          are described by the @p ud_rxdesc and @p ud_rxsize fields. The
+ *          USART idle line interrupt is enabled for the whole operation.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ *
+ * @notapi
+ */
+void uart_lld_start_continuous_receive(UARTDriver *uartp) {
+
+  /* Stopping previous activity (idle state).*/
+  dmaDisableChannel(uartp->ud_dmap, uartp->ud_dmarx);
+  dmaClearChannel(uartp->ud_dmap, uartp->ud_dmarx);
+
+  /* A stale idle condition finds an empty buffer and is ignored.*/
+  uartp->ud_usart->CR1 |= USART_CR1_IDLEIE;
+  set_rx_continuous(uartp);
+}
+#endif /* UART_USE_CONTINUOUS */
+
 #endif /* HAL_USE_UART */
 
 /** @} */
@@ -211,6 +211,15 @@ typedef void (*uartccb_t)(UARTDriver *uartp, uint16_t c);
  */
 typedef void (*uartecb_t)(UARTDriver *uartp, uartflags_t e);
 
+/**
+ * @brief   Continuous receive buffer UART notification callback type.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ * @param[in] buffer    pointer to the completed buffer
+ * @param[in] n         number of data frames in the buffer
+ */
+typedef void (*uartbcb_t)(UARTDriver *uartp, void *buffer, size_t n);
+
 /**
  * @brief   Driver configuration structure.
  * @note    It could be empty on some architectures.
@@ -236,6 +245,13 @@ typedef struct {
    * @brief Receive error callback.
    */
   uartecb_t                 uc_rxerr;
+#if UART_USE_CONTINUOUS || defined(__DOXYGEN__)
+  /**
+   * @brief Continuous receive buffer completed callback.
+   * @note  Present only if @p UART_USE_CONTINUOUS is enabled.
+   */
+  uartbcb_t                 uc_rxbuf;
+#endif /* UART_USE_CONTINUOUS */
   /* End of the mandatory fields.*/
   /**
    * @brief Bit rate.
@@ -275,6 +291,28 @@ struct UARTDriver {
    * @brief Current configuration data.
    */
   const UARTConfig          *ud_config;
+#if UART_USE_CONTINUOUS || defined(__DOXYGEN__)
+  /**
+   * @brief Continuous receive buffers descriptors.
+   */
+  UARTRxBuffer              ud_rxdesc[2];
+  /**
+   * @brief Size of the continuous receive buffers.
+   */
+  size_t                    ud_rxsize;
+  /**
+   * @brief Continuous receive buffer being filled.
+   */
+  unsigned                  ud_rxcur;
+  /**
+   * @brief Mailbox receiving the completed buffers descriptors or @p NULL.
+   */
+  Mailbox                   *ud_rxmbox;
+  /**
+   * @brief Descriptors not posted because the mailbox was full.
+   */
+  uint32_t                  ud_rxdropped;
+#endif /* UART_USE_CONTINUOUS */
 #if defined(UART_DRIVER_EXT_FIELDS)
   UART_DRIVER_EXT_FIELDS
 #endif
@@ -335,6 +373,9 @@ extern "C" {
   size_t uart_lld_stop_send(UARTDriver *uartp);
   void uart_lld_start_receive(UARTDriver *uartp, size_t n, void *rxbuf);
   size_t uart_lld_stop_receive(UARTDriver *uartp);
+#if UART_USE_CONTINUOUS
+  void uart_lld_start_continuous_receive(UARTDriver *uartp);
+#endif
 #ifdef __cplusplus
 }
 #endif
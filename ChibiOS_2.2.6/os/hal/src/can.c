@@ -86,6 +86,12 @@ void canObjectInit(CANDriver *canp) {
   chEvtInit(&canp->cd_sleep_event);
   chEvtInit(&canp->cd_wakeup_event);
 #endif /* CAN_USE_SLEEP_MODE */
+#if CAN_USE_RX_FIFO
+  chRingInit(&canp->cd_rxfifo, canp->cd_rxbuf, sizeof(CANRxFrame),
+             CAN_RX_FIFO_SIZE);
+#endif /* CAN_USE_RX_FIFO */
+  canp->cd_overruns = 0;
+  canp->cd_hwoverruns = 0;
 }
 
 /**
@@ -134,6 +140,11 @@ void canStop(CANDriver *canp) {
   chDbgAssert((canp->cd_state == CAN_STOP) || (canp->cd_state == CAN_READY),
               "canStop(), #1", "invalid state");
   can_lld_stop(canp);
+#if CAN_USE_RX_FIFO
+  /* The frames still in the FIFO are discarded.*/
+  chRingInit(&canp->cd_rxfifo, canp->cd_rxbuf, sizeof(CANRxFrame),
+             CAN_RX_FIFO_SIZE);
+#endif /* CAN_USE_RX_FIFO */
   chSemResetI(&canp->cd_rxsem, 0);
   chSemResetI(&canp->cd_txsem, 0);
   chSchRescheduleS();
@@ -185,6 +196,8 @@ msg_t canTransmit(CANDriver *canp, const CANTxFrame *ctfp, systime_t timeout) {
  * @brief   Can frame receive.
  * @details The function waits until a frame is received.
  * @note    Trying to receive while in sleep mode simply enqueues the thread.
+ * @note    If @p CAN_USE_RX_FIFO is enabled the frame is taken from the
+ *          software receive FIFO.
  *
  * @param[in] canp      pointer to the @p CANDriver object
  * @param[out] crfp     pointer to the buffer where the CAN frame is copied
@@ -209,18 +222,79 @@ msg_t canReceive(CANDriver *canp, CANRxFrame *crfp, systime_t timeout) {
   chSysLock();
   chDbgAssert((canp->cd_state == CAN_READY) || (canp->cd_state == CAN_SLEEP),
               "canReceive(), #1", "invalid state");
+#if CAN_USE_RX_FIFO
+  while ((canp->cd_state == CAN_SLEEP) ||
+         !chRingRead(&canp->cd_rxfifo, crfp)) {
+#else
   while ((canp->cd_state == CAN_SLEEP) || !can_lld_can_receive(canp)) {
+#endif
     msg_t msg = chSemWaitTimeoutS(&canp->cd_rxsem, timeout);
     if (msg != RDY_OK) {
       chSysUnlock();
       return msg;
     }
   }
+#if !CAN_USE_RX_FIFO
   can_lld_receive(canp, crfp);
+#endif
   chSysUnlock();
   return RDY_OK;
 }
 
+/**
+ * @brief   Can frames batch receive.
+ * @details The function waits until at least a frame is received then it
+ *          returns all the frames already available, up to @p n.
+ * @note    Trying to receive while in sleep mode simply enqueues the thread.
+ * @note    The frames are copied within a single critical section, the
+ *          batch size should be kept small when the CAN driver shares the
+ *          system with hard realtime tasks.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ * @param[out] crfp     pointer to an array of @p n frames
+ * @param[in] n         maximum number of frames to be received
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The number of frames received, zero if the operation
+ *                      has timed out or the driver has been stopped while
+ *                      waiting.
+ *
+ * @api
+ */
+size_t canReceiveBatch(CANDriver *canp, CANRxFrame *crfp, size_t n,
+                       systime_t timeout) {
+  size_t i = 0;
+
+  chDbgCheck((canp != NULL) && (crfp != NULL) && (n > 0), "canReceiveBatch");
+
+  chSysLock();
+  chDbgAssert((canp->cd_state == CAN_READY) || (canp->cd_state == CAN_SLEEP),
+              "canReceiveBatch(), #1", "invalid state");
+  while (i < n) {
+    if (canp->cd_state != CAN_SLEEP) {
+#if CAN_USE_RX_FIFO
+      if (chRingRead(&canp->cd_rxfifo, &crfp[i])) {
+        i++;
+        continue;
+      }
+#else
+      if (can_lld_can_receive(canp)) {
+        can_lld_receive(canp, &crfp[i++]);
+        continue;
+      }
+#endif
+    }
+    /* Waiting only if nothing has been received yet.*/
+    if ((i > 0) || (chSemWaitTimeoutS(&canp->cd_rxsem, timeout) != RDY_OK))
+      break;
+  }
+  chSysUnlock();
+  return i;
+}
+
 /**
  * @brief   Returns the current status mask and clears it.
  *
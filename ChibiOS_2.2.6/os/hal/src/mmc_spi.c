@@ -32,6 +32,8 @@
  * @{
  */
 
+#include <string.h>
+
 #include "ch.h"
 #include "hal.h"
 
@@ -87,14 +89,23 @@ static void tmrfunc(void *p) {
  * @notapi
  */
 static void wait(MMCDriver *mmcp) {
-  int i;
   uint8_t buf[4];
+#if SPI_USE_JOBS
+  SPIJob job;
+
+  spiJobObjectInit(&job, SPI_JOB_POLL, 16, NULL, NULL);
+  job.sj_match = 0xFF;
+  if (spiRunJobs(mmcp->mmc_spip, &job) == NULL)
+    return;
+#else /* !SPI_USE_JOBS */
+  int i;
 
   for (i = 0; i < 16; i++) {
     spiReceive(mmcp->mmc_spip, 1, buf);
     if (buf[0] == 0xFF)
       break;
   }
+#endif /* !SPI_USE_JOBS */
   /* Looks like it is a long wait.*/
   while (TRUE) {
     spiReceive(mmcp->mmc_spip, 1, buf);
@@ -141,6 +152,16 @@ static void send_hdr(MMCDriver *mmcp, uint8_t cmd, uint32_t arg) {
  * @notapi
  */
 static uint8_t recvr1(MMCDriver *mmcp) {
+#if SPI_USE_JOBS
+  SPIJob job;
+
+  /* On timeout the last polled frame is 0xFF.*/
+  spiJobObjectInit(&job, SPI_JOB_POLL, 9, NULL, NULL);
+  job.sj_flags = SPI_JOB_POLL_NOT;
+  job.sj_match = 0xFF;
+  spiRunJobs(mmcp->mmc_spip, &job);
+  return (uint8_t)job.sj_frame;
+#else /* !SPI_USE_JOBS */
   int i;
   uint8_t r1[1];
 
@@ -150,6 +171,7 @@ static uint8_t recvr1(MMCDriver *mmcp) {
       return r1[0];
   }
   return 0xFF;
+#endif /* !SPI_USE_JOBS */
 }
 
 /**
@@ -195,6 +217,270 @@ static void sync(MMCDriver *mmcp) {
   spiUnselect(mmcp->mmc_spip);
 }
 
+/**
+ * @brief   Terminates a multiple blocks read.
+ * @details The stop command is sent and the card is deselected.
+ *
+ * @param[in] mmcp      pointer to the @p MMCDriver object
+ *
+ * @notapi
+ */
+static void stop_read(MMCDriver *mmcp) {
+  static const uint8_t stopcmd[] = {0x40 | MMC_CMDSTOP, 0, 0, 0, 0, 1, 0xFF};
+
+  spiSend(mmcp->mmc_spip, sizeof(stopcmd), stopcmd);
+/*  result = recvr1(mmcp) != 0x00;*/
+  /* Note, ignored r1 response, it can be not zero, unknown issue.*/
+  recvr1(mmcp);
+  spiUnselect(mmcp->mmc_spip);
+}
+
+#if MMC_USE_CACHE || defined(__DOXYGEN__)
+/**
+ * @brief   Invalidates the cache.
+ *
+ * @param[in] mmcp      pointer to the @p MMCDriver object
+ *
+ * @notapi
+ */
+static void cache_invalidate(MMCDriver *mmcp) {
+  unsigned i;
+
+  for (i = 0; i < MMC_CACHE_SECTORS; i++) {
+    mmcp->mmc_cache[i].ce_valid = FALSE;
+    mmcp->mmc_cache[i].ce_dirty = FALSE;
+  }
+  /* No previous request, a first read of sector zero is not sequential.*/
+  mmcp->mmc_nextblk = 0xFFFFFFFF;
+  mmcp->mmc_endblk = 0xFFFFFFFF;
+}
+
+/**
+ * @brief   Looks up a sector in the cache.
+ *
+ * @param[in] mmcp      pointer to the @p MMCDriver object
+ * @param[in] blk       the sector number
+ * @return              The cache entry containing the sector.
+ * @retval NULL         if the sector is not cached.
+ *
+ * @notapi
+ */
+static MMCCacheEntry *cache_lookup(MMCDriver *mmcp, uint32_t blk) {
+  unsigned i;
+
+  for (i = 0; i < MMC_CACHE_SECTORS; i++) {
+    if (mmcp->mmc_cache[i].ce_valid && (mmcp->mmc_cache[i].ce_blk == blk))
+      return &mmcp->mmc_cache[i];
+  }
+  return NULL;
+}
+
+/**
+ * @brief   Writes back the dirty sectors.
+ * @details The dirty sectors are written in ascending order, each run of
+ *          consecutive sectors is written by a single multiple blocks
+ *          command.
+ *
+ * @param[in] mmcp      pointer to the @p MMCDriver object
+ * @return              The operation status.
+ * @retval FALSE        the operation succeeded.
+ * @retval TRUE         the operation failed.
+ *
+ * @notapi
+ */
+static bool_t cache_sync(MMCDriver *mmcp) {
+  MMCCacheEntry *dirty[MMC_CACHE_SECTORS];
+  unsigned i, j, n = 0;
+
+  for (i = 0; i < MMC_CACHE_SECTORS; i++) {
+    MMCCacheEntry *cep = &mmcp->mmc_cache[i];
+
+    if (cep->ce_valid && cep->ce_dirty) {
+      for (j = n; (j > 0) && (dirty[j - 1]->ce_blk > cep->ce_blk); j--)
+        dirty[j] = dirty[j - 1];
+      dirty[j] = cep;
+      n++;
+    }
+  }
+  for (i = 0; i < n; i = j) {
+    if (mmcStartSequentialWrite(mmcp, dirty[i]->ce_blk))
+      return TRUE;
+    mmcp->mmc_stats.cs_bursts++;
+    j = i;
+    do {
+      if (mmcSequentialWrite(mmcp, dirty[j]->ce_data))
+        return TRUE;
+      dirty[j]->ce_dirty = FALSE;
+      mmcp->mmc_stats.cs_written++;
+      j++;
+    } while ((j < n) && (dirty[j]->ce_blk == dirty[j - 1]->ce_blk + 1));
+    if (mmcStopSequentialWrite(mmcp))
+      return TRUE;
+  }
+  return FALSE;
+}
+
+/**
+ * @brief   Allocates a cache entry for a sector.
+ * @details A free entry is used if available, else the least recently used
+ *          one is replaced. If the replaced sector is dirty then all the
+ *          dirty sectors are written back.
+ *
+ * @param[in] mmcp      pointer to the @p MMCDriver object
+ * @param[in] blk       the sector number
+ * @return              The allocated cache entry, its data is undefined.
+ * @retval NULL         if the write back failed.
+ *
+ * @notapi
+ */
+static MMCCacheEntry *cache_alloc(MMCDriver *mmcp, uint32_t blk) {
+  MMCCacheEntry *cep = &mmcp->mmc_cache[0];
+  unsigned i;
+
+  for (i = 0; i < MMC_CACHE_SECTORS; i++) {
+    if (!mmcp->mmc_cache[i].ce_valid) {
+      cep = &mmcp->mmc_cache[i];
+      break;
+    }
+    if (mmcp->mmc_cache[i].ce_used < cep->ce_used)
+      cep = &mmcp->mmc_cache[i];
+  }
+  if (cep->ce_valid && cep->ce_dirty && cache_sync(mmcp))
+    return NULL;
+  cep->ce_blk = blk;
+  cep->ce_used = ++mmcp->mmc_clock;
+  cep->ce_valid = TRUE;
+  cep->ce_dirty = FALSE;
+  return cep;
+}
+
+/**
+ * @brief   Reads sectors through the cache.
+ * @details Each run of missing sectors is read by a single multiple blocks
+ *          command. Single sector requests, usually file system metadata,
+ *          are inserted in the cache while multiple sectors requests are
+ *          transferred directly. If the request continues the previous one
+ *          the following sectors are read ahead into the cache within the
+ *          same command.
+ *
+ * @param[in] mmcp      pointer to the @p MMCDriver object
+ * @param[in] startblk  first sector to read
+ * @param[out] buffer   pointer to the read buffer
+ * @param[in] n         number of sectors to read
+ * @return              The operation status.
+ * @retval FALSE        the operation succeeded.
+ * @retval TRUE         the operation failed.
+ *
+ * @notapi
+ */
+static bool_t cache_read(MMCDriver *mmcp, uint32_t startblk,
+                         uint8_t *buffer, uint32_t n) {
+  MMCCacheEntry *entries[MMC_CACHE_READ_AHEAD + 1];
+  MMCCacheEntry *cep;
+  uint32_t endblk = startblk + n, m;
+  bool_t sequential = startblk == mmcp->mmc_nextblk;
+  unsigned i, k;
+
+  mmcp->mmc_nextblk = endblk;
+  while (startblk < endblk) {
+    cep = cache_lookup(mmcp, startblk);
+    if (cep != NULL) {
+      cep->ce_used = ++mmcp->mmc_clock;
+      memcpy(buffer, cep->ce_data, MMC_SECTOR_SIZE);
+      mmcp->mmc_stats.cs_hits++;
+      buffer += MMC_SECTOR_SIZE;
+      startblk++;
+      continue;
+    }
+
+    /* Run of missing sectors and entries to be filled.*/
+    m = 1;
+    while ((startblk + m < endblk) &&
+           (cache_lookup(mmcp, startblk + m) == NULL))
+      m++;
+    mmcp->mmc_stats.cs_misses += m;
+    k = 0;
+    if (n == 1) {
+      entries[0] = cache_alloc(mmcp, startblk);
+      if (entries[0] == NULL)
+        return TRUE;
+      k = 1;
+    }
+    if (sequential && (startblk + m == endblk)) {
+      for (i = 0; i < MMC_CACHE_READ_AHEAD; i++) {
+        if ((endblk + i >= mmcp->mmc_endblk) ||
+            (cache_lookup(mmcp, endblk + i) != NULL))
+          break;
+        if ((entries[k] = cache_alloc(mmcp, endblk + i)) == NULL)
+          goto error;
+        k++;
+      }
+    }
+
+    if (mmcStartSequentialRead(mmcp, startblk))
+      goto error;
+    for (i = 0; i < m; i++) {
+      if (mmcSequentialRead(mmcp, buffer))
+        goto error;
+      buffer += MMC_SECTOR_SIZE;
+    }
+    i = 0;
+    if (n == 1)
+      memcpy(entries[i++]->ce_data, buffer - MMC_SECTOR_SIZE, MMC_SECTOR_SIZE);
+    for ( ; i < k; i++) {
+      if (mmcSequentialRead(mmcp, entries[i]->ce_data)) {
+        /* Read ahead beyond the card end, the card is still in the data
+           transfer state and must be stopped. The end is remembered so
+           that the next read-ahead operations do not cross it.*/
+        spiSelect(mmcp->mmc_spip);
+        stop_read(mmcp);
+        mmcp->mmc_endblk = entries[i]->ce_blk;
+        mmcp->mmc_stats.cs_cardend++;
+        while (i < k)
+          entries[i++]->ce_valid = FALSE;
+        return FALSE;
+      }
+      mmcp->mmc_stats.cs_readahead++;
+    }
+    if (mmcStopSequentialRead(mmcp))
+      return TRUE;
+    startblk += m;
+  }
+  return FALSE;
+
+error:
+  for (i = 0; i < k; i++)
+    entries[i]->ce_valid = FALSE;
+  return TRUE;
+}
+#endif /* MMC_USE_CACHE */
+
+/**
+ * @brief   Writes sectors using a single multiple blocks command.
+ *
+ * @param[in] mmcp      pointer to the @p MMCDriver object
+ * @param[in] startblk  first sector to write
+ * @param[in] buffer    pointer to the write buffer
+ * @param[in] n         number of sectors to write
+ * @return              The operation status.
+ * @retval FALSE        the operation succeeded.
+ * @retval TRUE         the operation failed.
+ *
+ * @notapi
+ */
+static bool_t write_blocks(MMCDriver *mmcp, uint32_t startblk,
+                           const uint8_t *buffer, uint32_t n) {
+
+  if (mmcStartSequentialWrite(mmcp, startblk))
+    return TRUE;
+  while (n-- > 0) {
+    if (mmcSequentialWrite(mmcp, buffer))
+      return TRUE;
+    buffer += MMC_SECTOR_SIZE;
+  }
+  return mmcStopSequentialWrite(mmcp);
+}
+
 /*===========================================================================*/
 /* Driver exported functions.                                                */
 /*===========================================================================*/
@@ -237,6 +523,11 @@ void mmcObjectInit(MMCDriver *mmcp, SPIDriver *spip,
   mmcp->mmc_is_inserted = is_inserted;
   chEvtInit(&mmcp->mmc_inserted_event);
   chEvtInit(&mmcp->mmc_removed_event);
+#if MMC_USE_CACHE
+  cache_invalidate(mmcp);
+  mmcp->mmc_clock = 0;
+  memset(&mmcp->mmc_stats, 0, sizeof(mmcp->mmc_stats));
+#endif
 }
 
 /**
@@ -347,6 +638,11 @@ bool_t mmcConnect(MMCDriver *mmcp) {
     if (send_command(mmcp, MMC_CMDSETBLOCKLEN, MMC_SECTOR_SIZE) != 0x00)
       return TRUE;
 
+#if MMC_USE_CACHE
+    /* The card could have been replaced.*/
+    cache_invalidate(mmcp);
+#endif
+
     /* Transition to MMC_READY state (if not extracted).*/
     chSysLock();
     if (mmcp->mmc_state == MMC_INSERTED) {
@@ -386,14 +682,22 @@ bool_t mmcDisconnect(MMCDriver *mmcp) {
               "invalid state");
   switch (mmcp->mmc_state) {
   case MMC_READY:
+#if MMC_USE_CACHE
+    /* Dirty sectors written back, they are lost on failure.*/
+    status = cache_sync(mmcp);
+#else
+    status = FALSE;
+#endif
     /* Wait for the pending write operations to complete.*/
     sync(mmcp);
     chSysLock();
     if (mmcp->mmc_state == MMC_READY)
       mmcp->mmc_state = MMC_INSERTED;
     chSysUnlock();
+    break;
   case MMC_INSERTED:
     status = FALSE;
+    break;
   default:
     status = TRUE;
   }
@@ -450,7 +754,11 @@ bool_t mmcStartSequentialRead(MMCDriver *mmcp, uint32_t startblk) {
  * @api
  */
 bool_t mmcSequentialRead(MMCDriver *mmcp, uint8_t *buffer) {
+#if SPI_USE_JOBS
+  SPIJob jobs[3];
+#else
   int i;
+#endif
 
   chDbgCheck((mmcp != NULL) && (buffer != NULL), "mmcSequentialRead");
 
@@ -461,6 +769,17 @@ bool_t mmcSequentialRead(MMCDriver *mmcp, uint8_t *buffer) {
   }
   chSysUnlock();
 
+#if SPI_USE_JOBS
+  /* Start token, data and CRC (ignored) with a single wakeup.*/
+  spiJobObjectInit(&jobs[0], SPI_JOB_POLL, MMC_WAIT_DATA, NULL, NULL);
+  jobs[0].sj_match = 0xFE;
+  jobs[0].sj_next = &jobs[1];
+  spiJobObjectInit(&jobs[1], SPI_JOB_RECEIVE, MMC_SECTOR_SIZE, NULL, buffer);
+  jobs[1].sj_next = &jobs[2];
+  spiJobObjectInit(&jobs[2], SPI_JOB_IGNORE, 2, NULL, NULL);
+  if (spiRunJobs(mmcp->mmc_spip, jobs) == NULL)
+    return FALSE;
+#else /* !SPI_USE_JOBS */
   for (i = 0; i < MMC_WAIT_DATA; i++) {
     spiReceive(mmcp->mmc_spip, 1, buffer);
     if (buffer[0] == 0xFE) {
@@ -470,6 +789,7 @@ bool_t mmcSequentialRead(MMCDriver *mmcp, uint8_t *buffer) {
       return FALSE;
     }
   }
+#endif /* !SPI_USE_JOBS */
   /* Timeout.*/
   spiUnselect(mmcp->mmc_spip);
   chSysLock();
@@ -490,8 +810,6 @@ bool_t mmcSequentialRead(MMCDriver *mmcp, uint8_t *buffer) {
  * @api
  */
 bool_t mmcStopSequentialRead(MMCDriver *mmcp) {
-  static const uint8_t stopcmd[] = {0x40 | MMC_CMDSTOP, 0, 0, 0, 0, 1, 0xFF};
-  bool_t result;
 
   chDbgCheck(mmcp != NULL, "mmcStopSequentialRead");
 
@@ -502,18 +820,13 @@ bool_t mmcStopSequentialRead(MMCDriver *mmcp) {
   }
   chSysUnlock();
 
-  spiSend(mmcp->mmc_spip, sizeof(stopcmd), stopcmd);
-/*  result = recvr1(mmcp) != 0x00;*/
-  /* Note, ignored r1 response, it can be not zero, unknown issue.*/
-  recvr1(mmcp);
-  result = FALSE;
-  spiUnselect(mmcp->mmc_spip);
+  stop_read(mmcp);
 
   chSysLock();
   if (mmcp->mmc_state == MMC_READING)
     mmcp->mmc_state = MMC_READY;
   chSysUnlock();
-  return result;
+  return FALSE;
 }
 
 /**
@@ -567,6 +880,9 @@ bool_t mmcStartSequentialWrite(MMCDriver *mmcp, uint32_t startblk) {
 bool_t mmcSequentialWrite(MMCDriver *mmcp, const uint8_t *buffer) {
   static const uint8_t start[] = {0xFF, 0xFC};
   uint8_t b[1];
+#if SPI_USE_JOBS
+  SPIJob jobs[4];
+#endif
 
   chDbgCheck((mmcp != NULL) && (buffer != NULL), "mmcSequentialWrite");
 
@@ -577,10 +893,21 @@ bool_t mmcSequentialWrite(MMCDriver *mmcp, const uint8_t *buffer) {
   }
   chSysUnlock();
 
+#if SPI_USE_JOBS
+  spiJobObjectInit(&jobs[0], SPI_JOB_SEND, sizeof(start), start, NULL);
+  jobs[0].sj_next = &jobs[1];
+  spiJobObjectInit(&jobs[1], SPI_JOB_SEND, MMC_SECTOR_SIZE, buffer, NULL);
+  jobs[1].sj_next = &jobs[2];
+  spiJobObjectInit(&jobs[2], SPI_JOB_IGNORE, 2, NULL, NULL);
+  jobs[2].sj_next = &jobs[3];
+  spiJobObjectInit(&jobs[3], SPI_JOB_RECEIVE, 1, NULL, b);
+  spiRunJobs(mmcp->mmc_spip, jobs);
+#else /* !SPI_USE_JOBS */
   spiSend(mmcp->mmc_spip, sizeof(start), start);    /* Data prologue.       */
   spiSend(mmcp->mmc_spip, MMC_SECTOR_SIZE, buffer); /* Data.                */
   spiIgnore(mmcp->mmc_spip, 2);                     /* CRC ignored.         */
   spiReceive(mmcp->mmc_spip, 1, b);
+#endif /* !SPI_USE_JOBS */
   if ((b[0] & 0x1F) == 0x05) {
     wait(mmcp);
     return FALSE;
@@ -630,6 +957,129 @@ bool_t mmcStopSequentialWrite(MMCDriver *mmcp) {
   return TRUE;
 }
 
+/**
+ * @brief   Reads sectors.
+ * @details The sectors are read using a single multiple blocks command or,
+ *          if @p MMC_USE_CACHE is enabled, through the sectors cache.
+ * @note    The sequential APIs bypass the cache, @p mmcSync() must be
+ *          invoked before using them on sectors written by @p mmcWrite().
+ *
+ * @param[in] mmcp      pointer to the @p MMCDriver object
+ * @param[in] startblk  first sector to read
+ * @param[out] buffer   pointer to the read buffer
+ * @param[in] n         number of sectors to read
+ * @return              The operation status.
+ * @retval FALSE        the operation succeeded.
+ * @retval TRUE         the operation failed.
+ *
+ * @api
+ */
+bool_t mmcRead(MMCDriver *mmcp, uint32_t startblk,
+               uint8_t *buffer, uint32_t n) {
+
+  chDbgCheck((mmcp != NULL) && (buffer != NULL) && (n > 0), "mmcRead");
+
+  if (mmcp->mmc_state != MMC_READY)
+    return TRUE;
+#if MMC_USE_CACHE
+  return cache_read(mmcp, startblk, buffer, n);
+#else
+  if (mmcStartSequentialRead(mmcp, startblk))
+    return TRUE;
+  while (n-- > 0) {
+    if (mmcSequentialRead(mmcp, buffer))
+      return TRUE;
+    buffer += MMC_SECTOR_SIZE;
+  }
+  return mmcStopSequentialRead(mmcp);
+#endif
+}
+
+/**
+ * @brief   Writes sectors.
+ * @details The sectors are written using a single multiple blocks command.
+ *          If @p MMC_USE_CACHE is enabled the single sector writes are
+ *          delayed in the cache until the sector is replaced or
+ *          @p mmcSync() is invoked, the cached copies of the sectors
+ *          written by multiple sectors writes are updated.
+ *
+ * @param[in] mmcp      pointer to the @p MMCDriver object
+ * @param[in] startblk  first sector to write
+ * @param[in] buffer    pointer to the write buffer
+ * @param[in] n         number of sectors to write
+ * @return              The operation status.
+ * @retval FALSE        the operation succeeded.
+ * @retval TRUE         the operation failed.
+ *
+ * @api
+ */
+bool_t mmcWrite(MMCDriver *mmcp, uint32_t startblk,
+                const uint8_t *buffer, uint32_t n) {
+#if MMC_USE_CACHE
+  MMCCacheEntry *cep;
+  uint32_t i;
+#endif
+
+  chDbgCheck((mmcp != NULL) && (buffer != NULL) && (n > 0), "mmcWrite");
+
+  if (mmcp->mmc_state != MMC_READY)
+    return TRUE;
+#if MMC_USE_CACHE
+  if (n == 1) {
+    cep = cache_lookup(mmcp, startblk);
+    if (cep == NULL) {
+      cep = cache_alloc(mmcp, startblk);
+      if (cep == NULL)
+        return TRUE;
+    }
+    else
+      cep->ce_used = ++mmcp->mmc_clock;
+    memcpy(cep->ce_data, buffer, MMC_SECTOR_SIZE);
+    cep->ce_dirty = TRUE;
+    return FALSE;
+  }
+  if (write_blocks(mmcp, startblk, buffer, n))
+    return TRUE;
+  for (i = 0; i < n; i++) {
+    cep = cache_lookup(mmcp, startblk + i);
+    if (cep != NULL) {
+      memcpy(cep->ce_data, buffer + i * MMC_SECTOR_SIZE, MMC_SECTOR_SIZE);
+      cep->ce_dirty = FALSE;
+    }
+  }
+  return FALSE;
+#else
+  return write_blocks(mmcp, startblk, buffer, n);
+#endif
+}
+
+/**
+ * @brief   Writes back the cached sectors.
+ * @details The dirty sectors are written in ascending order, each run of
+ *          consecutive sectors is written by a single multiple blocks
+ *          command.
+ * @note    Without @p MMC_USE_CACHE the function does nothing.
+ *
+ * @param[in] mmcp      pointer to the @p MMCDriver object
+ * @return              The operation status.
+ * @retval FALSE        the operation succeeded.
+ * @retval TRUE         the operation failed.
+ *
+ * @api
+ */
+bool_t mmcSync(MMCDriver *mmcp) {
+
+  chDbgCheck(mmcp != NULL, "mmcSync");
+
+  if (mmcp->mmc_state != MMC_READY)
+    return TRUE;
+#if MMC_USE_CACHE
+  return cache_sync(mmcp);
+#else
+  return FALSE;
+#endif
+}
+
 #endif /* HAL_USE_MMC_SPI */
 
 /** @} */
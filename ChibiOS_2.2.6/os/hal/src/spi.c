@@ -79,6 +79,9 @@ void spiObjectInit(SPIDriver *spip) {
 #if SPI_USE_WAIT
   spip->spd_thread = NULL;
 #endif /* SPI_USE_WAIT */
+#if SPI_USE_JOBS
+  spip->spd_job = NULL;
+#endif /* SPI_USE_JOBS */
 #if SPI_USE_MUTUAL_EXCLUSION
 #if CH_USE_MUTEXES
   chMtxInit(&spip->spd_mutex);
@@ -405,6 +408,188 @@ void spiReceive(SPIDriver *spip, size_t n, void *rxbuf) {
 }
 #endif /* SPI_USE_WAIT */
 
+#if SPI_USE_JOBS || defined(__DOXYGEN__)
+/**
+ * @brief   Initializes an @p SPIJob object.
+ * @details The job is initialized unlinked, without flags and without
+ *          callback.
+ *
+ * @param[out] jp       pointer to the @p SPIJob object
+ * @param[in] type      the job type
+ * @param[in] n         number of words to be transferred or, for poll jobs,
+ *                      maximum number of words to be polled
+ * @param[in] txbuf     the pointer to the transmit buffer or @p NULL
+ * @param[out] rxbuf    the pointer to the receive buffer or @p NULL
+ *
+ * @init
+ */
+void spiJobObjectInit(SPIJob *jp, spijobtype_t type, size_t n,
+                      const void *txbuf, void *rxbuf) {
+
+  jp->sj_next = NULL;
+  jp->sj_type = type;
+  jp->sj_flags = 0;
+  jp->sj_status = SPI_JOB_PENDING;
+  jp->sj_n = n;
+  jp->sj_txbuf = txbuf;
+  jp->sj_rxbuf = rxbuf;
+  jp->sj_match = 0;
+  jp->sj_frame = 0;
+  jp->sj_polled = 0;
+  jp->sj_endcb = NULL;
+}
+
+/**
+ * @brief   Starts the execution of a jobs list.
+ * @details This asynchronous function starts the first job of the list, the
+ *          following jobs are started from the transfer complete interrupt
+ *          without thread intervention.
+ * @post    At the end of the list, or when a poll job fails, the configured
+ *          callback is invoked.
+ * @note    The slave selection is performed by the jobs, see the
+ *          @p SPI_JOB_SELECT and @p SPI_JOB_UNSELECT flags.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] jp        pointer to the first @p SPIJob object of the list
+ *
+ * @api
+ */
+void spiStartJobs(SPIDriver *spip, SPIJob *jp) {
+
+  chDbgCheck((spip != NULL) && (jp != NULL), "spiStartJobs");
+
+  chSysLock();
+  chDbgAssert(spip->spd_state == SPI_READY,
+              "spiStartJobs(), #1", "not ready");
+  spiStartJobsI(spip, jp);
+  chSysUnlock();
+}
+
+#if SPI_USE_WAIT || defined(__DOXYGEN__)
+/**
+ * @brief   Executes a jobs list.
+ * @details This synchronous function executes the jobs of the list back to
+ *          back, the invoking thread is woken up once at the end of the
+ *          list.
+ * @pre     In order to use this function the option @p SPI_USE_WAIT must be
+ *          enabled.
+ * @pre     In order to use this function the driver must have been configured
+ *          without callbacks (@p spc_endcb = @p NULL).
+ * @note    When a poll job fails the following jobs are not executed, the
+ *          slave is left selected unless the failed job has the
+ *          @p SPI_JOB_UNSELECT flag.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] jp        pointer to the first @p SPIJob object of the list
+ * @return              The failed job.
+ * @retval NULL         if all the jobs have been executed.
+ *
+ * @api
+ */
+SPIJob *spiRunJobs(SPIDriver *spip, SPIJob *jp) {
+
+  chDbgCheck((spip != NULL) && (jp != NULL), "spiRunJobs");
+
+  chSysLock();
+  chDbgAssert(spip->spd_state == SPI_READY,
+              "spiRunJobs(), #1", "not ready");
+  chDbgAssert(spip->spd_config->spc_endcb == NULL,
+              "spiRunJobs(), #2", "has callback");
+  spiStartJobsI(spip, jp);
+  _spi_wait_s(spip);
+  chSysUnlock();
+
+  /* The executed jobs have been marked as done, the list ends at the
+     first job that is not.*/
+  while ((jp != NULL) && (jp->sj_status == SPI_JOB_OK))
+    jp = jp->sj_next;
+  return jp;
+}
+#endif /* SPI_USE_WAIT */
+
+/**
+ * @brief   Starts a job.
+ * @details The slave is selected if required then the transfer is started,
+ *          poll jobs receive a single frame at time.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] jp        pointer to the @p SPIJob object
+ *
+ * @notapi
+ */
+void _spi_job_start(SPIDriver *spip, SPIJob *jp) {
+
+  jp->sj_status = SPI_JOB_PENDING;
+  if ((jp->sj_flags & SPI_JOB_SELECT) != 0)
+    spi_lld_select(spip);
+  switch (jp->sj_type) {
+  case SPI_JOB_IGNORE:
+    spi_lld_ignore(spip, jp->sj_n);
+    break;
+  case SPI_JOB_EXCHANGE:
+    spi_lld_exchange(spip, jp->sj_n, jp->sj_txbuf, jp->sj_rxbuf);
+    break;
+  case SPI_JOB_SEND:
+    spi_lld_send(spip, jp->sj_n, jp->sj_txbuf);
+    break;
+  case SPI_JOB_RECEIVE:
+    spi_lld_receive(spip, jp->sj_n, jp->sj_rxbuf);
+    break;
+  default:
+    jp->sj_polled = 0;
+    jp->sj_frame = 0;
+    spi_lld_receive(spip, 1, &jp->sj_frame);
+  }
+}
+
+/**
+ * @brief   Serves the completion of the current job transfer.
+ * @details Poll jobs are continued until a match or the polls limit, then
+ *          the slave is unselected if required, the job callback is invoked
+ *          and the next job of the list is started.
+ * @note    The job callback is invoked from ISR context before the next job
+ *          is started, it is allowed to append jobs to the list.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @return              The jobs list state.
+ * @retval TRUE         a transfer of the jobs list has been started.
+ * @retval FALSE        end of the list or failed poll job.
+ *
+ * @notapi
+ */
+bool_t _spi_job_serve(SPIDriver *spip) {
+  SPIJob *jp = spip->spd_job;
+  spijobstatus_t status = SPI_JOB_OK;
+
+  if (jp->sj_type == SPI_JOB_POLL) {
+    jp->sj_polled++;
+    if ((jp->sj_frame == jp->sj_match) ==
+        ((jp->sj_flags & SPI_JOB_POLL_NOT) != 0)) {
+      /* No match, polling again if allowed.*/
+      if (jp->sj_polled < jp->sj_n) {
+        jp->sj_frame = 0;
+        spi_lld_receive(spip, 1, &jp->sj_frame);
+        return TRUE;
+      }
+      status = SPI_JOB_TIMEOUT;
+    }
+  }
+  jp->sj_status = status;
+  if ((jp->sj_flags & SPI_JOB_UNSELECT) != 0)
+    spi_lld_unselect(spip);
+  if (jp->sj_endcb != NULL)
+    jp->sj_endcb(spip, jp);
+  if ((status != SPI_JOB_OK) || (jp->sj_next == NULL)) {
+    spip->spd_job = NULL;
+    return FALSE;
+  }
+  jp = jp->sj_next;
+  spip->spd_job = jp;
+  _spi_job_start(spip, jp);
+  return TRUE;
+}
+#endif /* SPI_USE_JOBS */
+
 #if SPI_USE_MUTUAL_EXCLUSION || defined(__DOXYGEN__)
 /**
  * @brief   Gains exclusive access to the SPI bus.
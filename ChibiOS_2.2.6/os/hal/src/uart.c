@@ -298,9 +298,88 @@ void uartStartReceiveI(UARTDriver *uartp, size_t n, void *rxbuf) {
   uartp->ud_rxstate = UART_RX_ACTIVE;
 }
 
+#if UART_USE_CONTINUOUS || defined(__DOXYGEN__)
+/**
+ * @brief   Starts a continuous receive operation on the UART peripheral.
+ * @details The data frames are received alternately into two buffers, the
+ *          driver switches buffer when the current one is full or when the
+ *          line becomes idle after at least a frame has been received. Each
+ *          completed buffer is passed to the @p uc_rxbuf callback and its
+ *          @p UARTRxBuffer descriptor is posted into the mailbox, if any.
+ * @note    The buffers are organized as uint8_t arrays for data sizes below
+ *          or equal to 8 bits else it is organized as uint16_t arrays.
+ * @note    A completed buffer is overwritten as soon as the other one is
+ *          completed, the data must be consumed within that time. The
+ *          descriptors not posted because the mailbox was full are counted
+ *          in @p ud_rxdropped.
+ * @note    The operation lasts until @p uartStopReceive() is invoked.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ * @param[in] n         number of data frames of each buffer
+ * @param[out] rxbuf0   the pointer to the first receive buffer
+ * @param[out] rxbuf1   the pointer to the second receive buffer
+ * @param[in] mbp       the mailbox receiving the completed buffers
+ *                      descriptors or @p NULL
+ *
+ * @api
+ */
+void uartStartContinuousReceive(UARTDriver *uartp, size_t n,
+                                void *rxbuf0, void *rxbuf1, Mailbox *mbp) {
+
+  chDbgCheck((uartp != NULL) && (n > 0) &&
+             (rxbuf0 != NULL) && (rxbuf1 != NULL),
+             "uartStartContinuousReceive");
+
+  chSysLock();
+  uartStartContinuousReceiveI(uartp, n, rxbuf0, rxbuf1, mbp);
+  chSysUnlock();
+}
+
+/**
+ * @brief   Starts a continuous receive operation on the UART peripheral.
+ * @note    The buffers are organized as uint8_t arrays for data sizes below
+ *          or equal to 8 bits else it is organized as uint16_t arrays.
+ * @note    This function has to be invoked from a lock zone.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ * @param[in] n         number of data frames of each buffer
+ * @param[out] rxbuf0   the pointer to the first receive buffer
+ * @param[out] rxbuf1   the pointer to the second receive buffer
+ * @param[in] mbp       the mailbox receiving the completed buffers
+ *                      descriptors or @p NULL
+ *
+ * @iclass
+ */
+void uartStartContinuousReceiveI(UARTDriver *uartp, size_t n,
+                                 void *rxbuf0, void *rxbuf1, Mailbox *mbp) {
+
+  chDbgCheck((uartp != NULL) && (n > 0) &&
+             (rxbuf0 != NULL) && (rxbuf1 != NULL),
+             "uartStartContinuousReceiveI");
+
+  chDbgAssert((uartp->ud_state == UART_READY) &&
+              (uartp->ud_rxstate == UART_RX_IDLE),
+              "uartStartContinuousReceiveI(), #1",
+              "not active");
+
+  uartp->ud_rxdesc[0].ub_buf = rxbuf0;
+  uartp->ud_rxdesc[0].ub_n = 0;
+  uartp->ud_rxdesc[1].ub_buf = rxbuf1;
+  uartp->ud_rxdesc[1].ub_n = 0;
+  uartp->ud_rxsize = n;
+  uartp->ud_rxcur = 0;
+  uartp->ud_rxmbox = mbp;
+  uartp->ud_rxdropped = 0;
+  uart_lld_start_continuous_receive(uartp);
+  uartp->ud_rxstate = UART_RX_CONTINUOUS;
+}
+#endif /* UART_USE_CONTINUOUS */
+
 /**
  * @brief   Stops any ongoing receive operation.
  * @note    Stopping a receive operation also suppresses the receive callbacks.
+ * @note    Stopping a continuous receive operation discards the data frames
+ *          in the current buffer.
  *
  * @param[in] uartp     pointer to the @p UARTDriver object
  *
@@ -320,7 +399,8 @@ size_t uartStopReceive(UARTDriver *uartp) {
               "uartStopReceive(), #1",
               "not active");
 
-  if (uartp->ud_rxstate == UART_RX_ACTIVE) {
+  if ((uartp->ud_rxstate == UART_RX_ACTIVE) ||
+      (uartp->ud_rxstate == UART_RX_CONTINUOUS)) {
     n = uart_lld_stop_receive(uartp);
     uartp->ud_rxstate = UART_RX_IDLE;
   }
@@ -350,7 +430,8 @@ size_t uartStopReceiveI(UARTDriver *uartp) {
               "uartStopReceiveI(), #1",
               "not active");
 
-  if (uartp->ud_rxstate == UART_RX_ACTIVE) {
+  if ((uartp->ud_rxstate == UART_RX_ACTIVE) ||
+      (uartp->ud_rxstate == UART_RX_CONTINUOUS)) {
     size_t n = uart_lld_stop_receive(uartp);
     uartp->ud_rxstate = UART_RX_IDLE;
     return n;
@@ -134,6 +134,20 @@
 #define CAN_USE_SLEEP_MODE          TRUE
 #endif
 
+/**
+ * @brief   Software receive FIFO switch.
+ */
+#if !defined(CAN_USE_RX_FIFO) || defined(__DOXYGEN__)
+#define CAN_USE_RX_FIFO             FALSE
+#endif
+
+/**
+ * @brief   Number of frames in the software receive FIFO.
+ */
+#if !defined(CAN_RX_FIFO_SIZE) || defined(__DOXYGEN__)
+#define CAN_RX_FIFO_SIZE            32
+#endif
+
 /*===========================================================================*/
 /* I2C driver related settings.                                              */
 /*===========================================================================*/
@@ -149,6 +163,14 @@
 /* MAC driver related settings.                                              */
 /*===========================================================================*/
 
+/**
+ * @brief   Enables the zero-copy API.
+ * @note    Disabling this option saves both code and data space.
+ */
+#if !defined(MAC_USE_ZERO_COPY) || defined(__DOXYGEN__)
+#define MAC_USE_ZERO_COPY           FALSE
+#endif
+
 /*===========================================================================*/
 /* MMC_SPI driver related settings.                                          */
 /*===========================================================================*/
@@ -198,6 +220,27 @@
 #define MMC_USE_SPI_POLLING         TRUE
 #endif
 
+/**
+ * @brief   Enables the sectors cache.
+ */
+#if !defined(MMC_USE_CACHE) || defined(__DOXYGEN__)
+#define MMC_USE_CACHE               FALSE
+#endif
+
+/**
+ * @brief   Number of cached sectors.
+ */
+#if !defined(MMC_CACHE_SECTORS) || defined(__DOXYGEN__)
+#define MMC_CACHE_SECTORS           16
+#endif
+
+/**
+ * @brief   Number of sectors read ahead on sequential reads.
+ */
+#if !defined(MMC_CACHE_READ_AHEAD) || defined(__DOXYGEN__)
+#define MMC_CACHE_READ_AHEAD        4
+#endif
+
 /*===========================================================================*/
 /* PAL driver related settings.                                              */
 /*===========================================================================*/
@@ -250,10 +293,25 @@
 #define SPI_USE_MUTUAL_EXCLUSION    TRUE
 #endif
 
+/**
+ * @brief   Enables the jobs queue APIs.
+ * @note    Disabling this option saves both code and data space.
+ */
+#if !defined(SPI_USE_JOBS) || defined(__DOXYGEN__)
+#define SPI_USE_JOBS                FALSE
+#endif
+
 /*===========================================================================*/
 /* UART driver related settings.                                             */
 /*===========================================================================*/
 
+/**
+ * @brief   Continuous receive mode related APIs inclusion switch.
+ */
+#if !defined(UART_USE_CONTINUOUS) || defined(__DOXYGEN__)
+#define UART_USE_CONTINUOUS         FALSE
+#endif
+
 #endif /* _HALCONF_H_ */
 
 /** @} */
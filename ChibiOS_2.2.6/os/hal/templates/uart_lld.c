@@ -152,6 +152,21 @@ size_t uart_lld_stop_receive(UARTDriver *uartp) {
 
 }
 
+#if UART_USE_CONTINUOUS || defined(__DOXYGEN__)
+/**
+ * @brief   Starts a continuous receive operation on the UART peripheral.
+ * @details The reception starts into the buffer @p ud_rxcur, the buffers
+ *          are described by the @p ud_rxdesc and @p ud_rxsize fields.
+ *
+ * @param[in] uartp     pointer to the @p UARTDriver object
+ *
+ * @notapi
+ */
+void uart_lld_start_continuous_receive(UARTDriver *uartp) {
+
+}
+#endif /* UART_USE_CONTINUOUS */
+
 #endif /* HAL_USE_UART */
 
 /** @} */
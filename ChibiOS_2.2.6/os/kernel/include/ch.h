@@ -95,6 +95,7 @@
 #include "chregistry.h"
 #include "chinline.h"
 #include "chqueues.h"
+#include "chrings.h"
 #include "chstreams.h"
 #include "chioch.h"
 #include "chfiles.h"
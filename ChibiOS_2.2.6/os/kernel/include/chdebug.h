@@ -35,8 +35,11 @@
 #ifndef _CHDEBUG_H_
 #define _CHDEBUG_H_
 
+#include "chtrace.h"
+
 /**
  * @brief Trace buffer entries.
+ * @note  Must be a power of two.
  */
 #ifndef TRACE_BUFFER_SIZE
 #define TRACE_BUFFER_SIZE       64
@@ -61,18 +64,44 @@
 #endif
 
 #if CH_DBG_ENABLE_TRACE || defined(__DOXYGEN__)
+#if (TRACE_BUFFER_SIZE & (TRACE_BUFFER_SIZE - 1)) != 0
+#error "TRACE_BUFFER_SIZE must be a power of two"
+#endif
+
+/**
+ * @brief   Trace timestamp type.
+ * @details The port realtime counter is used when its frequency is known,
+ *          else the timestamps have the system tick resolution.
+ */
+#if (PORT_SUPPORTS_RT && defined(PORT_RT_FREQUENCY)) || defined(__DOXYGEN__)
+typedef rtcnt_t tracetime_t;
+#define TRACE_TIMESTAMP()       port_rt_get_counter_value()
+#define TRACE_FREQUENCY         PORT_RT_FREQUENCY
+#else
+typedef systime_t tracetime_t;
+#define TRACE_TIMESTAMP()       chTimeNow()
+#define TRACE_FREQUENCY         CH_FREQUENCY
+#endif
+
+/**
+ * @brief   Converts a pointer in a trace identifier.
+ */
+#define TRACE_ID(p)             ((uint32_t)(size_t)(p))
+
 /**
  * @brief Trace buffer record.
  */
 typedef struct {
-  void                  *cse_wtobjp;    /**< @brief Object where going to
-                                                    sleep.                  */
-  systime_t             cse_time;       /**< @brief Time of the switch
-                                                    event.                  */
-  uint16_t              cse_state: 4;   /**< @brief Switched out thread
-                                                    state.                  */
-  uint16_t              cse_tid: 12;    /**< @brief Switched in thread id.  */
-} CtxSwcEvent;
+  uint8_t               te_type;        /**< @brief Event type.             */
+  uint8_t               te_state;       /**< @brief Event specific state.   */
+  uint16_t              te_lost;        /**< @brief Records lost before this
+                                                    one.                    */
+  Thread                *te_tp;         /**< @brief Current thread.         */
+  const void            *te_objp;       /**< @brief Event object.           */
+  uint32_t              te_arg;         /**< @brief Event specific
+                                                    argument.               */
+  tracetime_t           te_time;        /**< @brief Event timestamp.        */
+} TraceEvent;
 
 /**
  * @brief Trace buffer header.
@@ -80,11 +109,36 @@ typedef struct {
 typedef struct {
   unsigned              tb_size;        /**< @brief Trace buffer size
                                                     (entries).              */
-  CtxSwcEvent           *tb_ptr;        /**< @brief Pointer to the ring buffer
-                                                    front.                  */
+  uint32_t              tb_head;        /**< @brief Write index, free
+                                                    running.                */
+  uint32_t              tb_tail;        /**< @brief Read index, free
+                                                    running.                */
+  uint16_t              tb_lost;        /**< @brief Records lost since the
+                                                    last recorded one.      */
+  bool_t                tb_stream;      /**< @brief Streaming mode, the
+                                                    records are dropped
+                                                    instead of overwritten
+                                                    when the buffer is
+                                                    full.                   */
   /** @brief Ring buffer.*/
-  CtxSwcEvent           tb_buffer[TRACE_BUFFER_SIZE];
+  TraceEvent            tb_buffer[TRACE_BUFFER_SIZE];
 } TraceBuffer;
+
+/**
+ * @brief   Inserts in the trace buffer a record from an ISR.
+ * @details The record has the interrupted thread as current thread.
+ *
+ * @param[in] type      the event type, @p TRACE_EV_ISR_ENTER or
+ *                      @p TRACE_EV_ISR_LEAVE
+ * @param[in] id        an interrupt source identifier
+ *
+ * @special
+ */
+#define chDbgTraceIsr(type, id) {                                       \
+  chSysLockFromIsr();                                                   \
+  chDbgTraceEventI(type, id, NULL, 0);                                  \
+  chSysUnlockFromIsr();                                                 \
+}
 #endif /* CH_DBG_ENABLE_TRACE */
 
 #define __QUOTE_THIS(p) #p
@@ -146,9 +200,11 @@ typedef struct {
 #endif
 
 #if !CH_DBG_ENABLE_TRACE
-/* When the trace feature is disabled this function is replaced by an empty
-   macro.*/
+/* When the trace feature is disabled these functions are replaced by empty
+   macros.*/
 #define chDbgTrace(otp) {}
+#define chDbgTraceEventI(type, state, objp, arg) {}
+#define chDbgTraceIsr(type, id) {}
 #endif
 
 #if !defined(__DOXYGEN__)
@@ -159,6 +215,10 @@ extern "C" {
   extern TraceBuffer trace_buffer;
   void trace_init(void);
   void chDbgTrace(Thread *otp);
+  void chDbgTraceEventI(unsigned type, unsigned state,
+                        const void *objp, uint32_t arg);
+  void chDbgTraceStream(bool_t enable);
+  cnt_t chDbgTraceFetch(TraceEvent *tep, cnt_t n);
 #endif
 #if CH_DBG_ENABLE_ASSERTS || CH_DBG_ENABLE_CHECKS || CH_DBG_ENABLE_STACK_CHECK
   extern char *panic_msg;
@@ -48,6 +48,47 @@
 #error "CH_USE_HEAP requires CH_USE_MUTEXES and/or CH_USE_SEMAPHORES"
 #endif
 
+#if CH_USE_HEAP_TLSF && CH_USE_MALLOC_HEAP
+#error "CH_USE_HEAP_TLSF is not compatible with CH_USE_MALLOC_HEAP"
+#endif
+
+#if CH_USE_HEAP_TLSF || defined(__DOXYGEN__)
+/**
+ * @brief   Number of TLSF first level classes.
+ * @details Each first level class covers a power of two range of block
+ *          sizes, the largest manageable block is
+ *          2^(HEAP_TLSF_FL + HEAP_TLSF_SL_BITS - 1) bytes.
+ * @note    The default value allows blocks up to 4MB.
+ */
+#if !defined(HEAP_TLSF_FL) || defined(__DOXYGEN__)
+#define HEAP_TLSF_FL            20
+#endif
+
+/**
+ * @brief   Number of bits of TLSF second level index.
+ * @details Each first level class is divided in 2^HEAP_TLSF_SL_BITS linear
+ *          sub-classes.
+ */
+#if !defined(HEAP_TLSF_SL_BITS) || defined(__DOXYGEN__)
+#define HEAP_TLSF_SL_BITS       3
+#endif
+
+/**
+ * @brief   Number of TLSF second level classes.
+ */
+#define HEAP_TLSF_SL            (1 << HEAP_TLSF_SL_BITS)
+
+/**
+ * @brief   Size limit of a TLSF block, exclusive.
+ */
+#define HEAP_TLSF_LIMIT         ((size_t)1 << (HEAP_TLSF_FL +               \
+                                               HEAP_TLSF_SL_BITS - 1))
+
+#if (HEAP_TLSF_FL > 32) || (HEAP_TLSF_SL_BITS > 5)
+#error "invalid TLSF configuration"
+#endif
+#endif /* CH_USE_HEAP_TLSF */
+
 typedef struct memory_heap MemoryHeap;
 
 /**
@@ -61,6 +102,12 @@ union heap_header {
       MemoryHeap        *heap;      /**< @brief Block owner heap.           */
     } u;                            /**< @brief Overlapped fields.          */
     size_t              size;       /**< @brief Size of the memory block.   */
+#if CH_USE_HEAP_TLSF || defined(__DOXYGEN__)
+    union heap_header   *prev;      /**< @brief Previous physical block.    */
+    union heap_header   *pfree;     /**< @brief Previous block in free list,
+                                                points to the block itself
+                                                when it is allocated.       */
+#endif
   } h;
 };
 
@@ -70,7 +117,18 @@ union heap_header {
 struct memory_heap {
   memgetfunc_t          h_provider; /**< @brief Memory blocks provider for
                                                 this heap.                  */
+#if !CH_USE_HEAP_TLSF || defined(__DOXYGEN__)
   union heap_header     h_free;     /**< @brief Free blocks list header.    */
+#endif
+#if CH_USE_HEAP_TLSF || defined(__DOXYGEN__)
+  uint32_t              h_flmap;    /**< @brief Non-empty first level
+                                                classes.                    */
+  uint32_t              h_slmap[HEAP_TLSF_FL];
+                                    /**< @brief Non-empty second level
+                                                classes.                    */
+  union heap_header     *h_lists[HEAP_TLSF_FL][HEAP_TLSF_SL];
+                                    /**< @brief Free blocks lists.          */
+#endif
 #if CH_USE_MUTEXES
   Mutex                 h_mtx;      /**< @brief Heap access mutex.          */
 #else
@@ -74,6 +74,11 @@ extern "C" {
   msg_t chMBFetch(Mailbox *mbp, msg_t *msgp, systime_t timeout);
   msg_t chMBFetchS(Mailbox *mbp, msg_t *msgp, systime_t timeout);
   msg_t chMBFetchI(Mailbox *mbp, msg_t *msgp);
+  cnt_t chMBPostBatch(Mailbox *mbp, const msg_t *msgs, cnt_t n,
+                      systime_t timeout);
+  cnt_t chMBPostBatchI(Mailbox *mbp, const msg_t *msgs, cnt_t n);
+  cnt_t chMBFetchBatch(Mailbox *mbp, msg_t *msgs, cnt_t n, systime_t timeout);
+  cnt_t chMBFetchBatchI(Mailbox *mbp, msg_t *msgs, cnt_t n);
 #ifdef __cplusplus
 }
 #endif
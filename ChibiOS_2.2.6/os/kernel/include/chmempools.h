@@ -35,6 +35,13 @@
 #ifndef _CHMEMPOOLS_H_
 #define _CHMEMPOOLS_H_
 
+/*
+ * Module dependencies check.
+ */
+#if CH_USE_POOL_MAGAZINES && !CH_USE_MEMPOOLS
+#error "CH_USE_POOL_MAGAZINES requires CH_USE_MEMPOOLS"
+#endif
+
 #if CH_USE_MEMPOOLS || defined(__DOXYGEN__)
 
 /**
@@ -56,6 +63,35 @@ typedef struct {
                                                     this pool.              */
 } MemoryPool;
 
+#if CH_USE_POOL_MAGAZINES || defined(__DOXYGEN__)
+/**
+ * @brief   Number of objects in a memory pool magazine.
+ * @details The magazine is refilled or drained half a magazine at time.
+ */
+#if !defined(POOL_MAGAZINE_SIZE) || defined(__DOXYGEN__)
+#define POOL_MAGAZINE_SIZE      8
+#endif
+
+#if POOL_MAGAZINE_SIZE < 2
+#error "invalid POOL_MAGAZINE_SIZE value"
+#endif
+
+/**
+ * @brief   Memory pool magazine.
+ * @details A magazine is a small cache of objects of a memory pool owned
+ *          by a single thread, objects are exchanged with the pool in
+ *          batches so that most allocations and releases do not enter
+ *          the kernel critical section.
+ */
+typedef struct {
+  MemoryPool            *mg_pool;       /**< @brief Cached memory pool.     */
+  size_t                mg_count;       /**< @brief Objects in the
+                                                    magazine.               */
+  void                  *mg_objs[POOL_MAGAZINE_SIZE];
+                                        /**< @brief Cached objects.         */
+} PoolMagazine;
+#endif /* CH_USE_POOL_MAGAZINES */
+
 /**
  * @brief   Data part of a static memory pool initializer.
  * @details This macro should be used when statically initializing a
@@ -89,10 +125,36 @@ extern "C" {
   void *chPoolAlloc(MemoryPool *mp);
   void chPoolFreeI(MemoryPool *mp, void *objp);
   void chPoolFree(MemoryPool *mp, void *objp);
+  size_t chPoolAllocBatchI(MemoryPool *mp, void *objs[], size_t n);
+  size_t chPoolAllocBatch(MemoryPool *mp, void *objs[], size_t n);
+  void chPoolFreeBatchI(MemoryPool *mp, void *objs[], size_t n);
+  void chPoolFreeBatch(MemoryPool *mp, void *objs[], size_t n);
+#if CH_USE_POOL_MAGAZINES
+  void chPoolMagazineInit(PoolMagazine *mgp, MemoryPool *mp);
+  void *chPoolMagazineAlloc(PoolMagazine *mgp);
+  void chPoolMagazineFree(PoolMagazine *mgp, void *objp);
+  void chPoolMagazineFlush(PoolMagazine *mgp);
+#endif
 #ifdef __cplusplus
 }
 #endif
 
+#if CH_USE_POOL_MAGAZINES || defined(__DOXYGEN__)
+/**
+ * @brief   Attaches a magazine to the current thread.
+ * @details The dynamic threads APIs use the magazine attached to the
+ *          calling thread when allocating or releasing working areas from
+ *          or to the magazine's pool.
+ * @note    The magazine must be flushed before the owner thread terminates
+ *          or the cached objects are lost.
+ *
+ * @param[in] mgp       pointer to a @p PoolMagazine structure or @p NULL
+ *
+ * @api
+ */
+#define chPoolMagazineAttach(mgp) (chThdSelf()->p_magazine = (mgp))
+#endif /* CH_USE_POOL_MAGAZINES */
+
 #endif /* CH_USE_MEMPOOLS */
 
 #endif /* _CHMEMPOOLS_H_ */
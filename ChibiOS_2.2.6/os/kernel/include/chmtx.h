@@ -47,12 +47,20 @@ typedef struct Mutex {
                                                 @p NULL.                    */
   struct Mutex          *m_next;    /**< @brief Next @p Mutex into an
                                                 owner-list or @p NULL.      */
+#if CH_USE_MUTEXES_CEILING || defined(__DOXYGEN__)
+  tprio_t               m_ceiling;  /**< @brief Priority ceiling or zero for
+                                                a priority inheritance
+                                                mutex.                      */
+#endif
 } Mutex;
 
 #ifdef __cplusplus
 extern "C" {
 #endif
   void chMtxInit(Mutex *mp);
+#if CH_USE_MUTEXES_CEILING
+  void chMtxInitCeiling(Mutex *mp, tprio_t ceiling);
+#endif
   void chMtxLock(Mutex *mp);
   void chMtxLockS(Mutex *mp);
   bool_t chMtxTryLock(Mutex *mp);
@@ -71,7 +79,11 @@ extern "C" {
  *
  * @param[in] name      the name of the mutex variable
  */
+#if !CH_USE_MUTEXES_CEILING || defined(__DOXYGEN__)
 #define _MUTEX_DATA(name) {_THREADSQUEUE_DATA(name.m_queue), NULL, NULL}
+#else
+#define _MUTEX_DATA(name) {_THREADSQUEUE_DATA(name.m_queue), NULL, NULL, 0}
+#endif
 
 /**
  * @brief   Static mutex initializer.
@@ -82,6 +94,30 @@ extern "C" {
  */
 #define MUTEX_DECL(name) Mutex name = _MUTEX_DATA(name)
 
+#if CH_USE_MUTEXES_CEILING || defined(__DOXYGEN__)
+/**
+ * @brief   Data part of a static priority ceiling mutex initializer.
+ * @details This macro should be used when statically initializing a
+ *          priority ceiling mutex that is part of a bigger structure.
+ *
+ * @param[in] name      the name of the mutex variable
+ * @param[in] ceiling   the priority ceiling
+ */
+#define _MUTEX_CEILING_DATA(name, ceiling)                                  \
+  {_THREADSQUEUE_DATA(name.m_queue), NULL, NULL, ceiling}
+
+/**
+ * @brief   Static priority ceiling mutex initializer.
+ * @details Statically initialized mutexes require no explicit initialization
+ *          using @p chMtxInitCeiling().
+ *
+ * @param[in] name      the name of the mutex variable
+ * @param[in] ceiling   the priority ceiling
+ */
+#define MUTEX_CEILING_DECL(name, ceiling)                                   \
+  Mutex name = _MUTEX_CEILING_DATA(name, ceiling)
+#endif /* CH_USE_MUTEXES_CEILING */
+
 /**
  * @brief   Returns @p TRUE if the mutex queue contains at least a waiting
  *          thread.
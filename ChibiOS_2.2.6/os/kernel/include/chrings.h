@@ -0,0 +1,142 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,2011 Giovanni Di Sirio.
+
+    This file is part of ChibiOS/RT.
+
+    ChibiOS/RT is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/RT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+                                      ---
+
+    A special exception to the GPL can be applied should you wish to distribute
+    a combined work that includes ChibiOS/RT, without being obliged to provide
+    the source code for any proprietary components. See the file exception.txt
+    for full details of how and when the exception can be applied.
+*/
+
+/**
+ * @file    chrings.h
+ * @brief   Single producer single consumer rings macros and structures.
+ *
+ * @addtogroup rings
+ * @{
+ */
+
+#ifndef _CHRINGS_H_
+#define _CHRINGS_H_
+
+#if CH_USE_RINGS || defined(__DOXYGEN__)
+
+/*
+ * Module dependencies check.
+ */
+#if !CH_USE_SEMAPHORES
+#error "CH_USE_RINGS requires CH_USE_SEMAPHORES"
+#endif
+
+/**
+ * @name    Ring write results
+ * @{
+ */
+#define RING_OK         0       /**< @brief Record written.                 */
+#define RING_WAS_EMPTY  1       /**< @brief Record written into an empty
+                                            ring, the doorbell must be
+                                            rung.                           */
+#define RING_FULL       -1      /**< @brief Ring full, record not written.  */
+/** @} */
+
+/**
+ * @brief   Loads a ring index with acquire semantic.
+ * @note    The default implementations use the GCC atomic builtins, on
+ *          other compilers a volatile access is performed, this is adequate
+ *          on single core processors only.
+ */
+#if !defined(RING_LOAD_ACQUIRE) || defined(__DOXYGEN__)
+#if (defined(__GNUC__) &&                                                   \
+     ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ >= 7)))) ||     \
+    defined(__DOXYGEN__)
+#define RING_LOAD_ACQUIRE(p)        __atomic_load_n(p, __ATOMIC_ACQUIRE)
+#define RING_STORE_RELEASE(p, v)    __atomic_store_n(p, v, __ATOMIC_RELEASE)
+#define RING_FENCE()                __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#else
+#define RING_LOAD_ACQUIRE(p)        (*(volatile uint32_t *)(p))
+#define RING_STORE_RELEASE(p, v)    (*(volatile uint32_t *)(p) = (v))
+#define RING_FENCE()
+#endif
+#endif
+
+/**
+ * @brief   Structure representing a single producer single consumer ring.
+ * @details The ring contains fixed size records, the write index is only
+ *          modified by the producer and the read index only by the consumer
+ *          so no locking is required in order to transfer records.
+ */
+typedef struct {
+  uint8_t               *r_buffer;      /**< @brief Records buffer.         */
+  size_t                r_size;         /**< @brief Size of a record.       */
+  uint32_t              r_mask;         /**< @brief Number of records minus
+                                                    one.                    */
+  uint32_t              r_head;         /**< @brief Write index, free
+                                                    running.                */
+  uint32_t              r_tail;         /**< @brief Read index, free
+                                                    running.                */
+  BinarySemaphore       r_doorbell;     /**< @brief Semaphore signaled on
+                                                    the empty to non-empty
+                                                    transitions.            */
+#if CH_USE_EVENTS || defined(__DOXYGEN__)
+  EventSource           r_event;        /**< @brief Event source broadcast
+                                                    on the empty to
+                                                    non-empty transitions.  */
+#endif
+} Ring;
+
+/**
+ * @brief   Returns the number of records in the ring.
+ * @note    The value can be outdated when returned if invoked outside the
+ *          producer or the consumer context.
+ *
+ * @param[in] rp        pointer to a @p Ring structure
+ * @return              The number of queued records.
+ */
+#define chRingGetUsed(rp)                                                   \
+  (RING_LOAD_ACQUIRE(&(rp)->r_head) - RING_LOAD_ACQUIRE(&(rp)->r_tail))
+
+#if CH_USE_EVENTS || defined(__DOXYGEN__)
+/**
+ * @brief   Returns the ring event source.
+ *
+ * @param[in] rp        pointer to a @p Ring structure
+ * @return              A pointer to the @p EventSource broadcast on the
+ *                      empty to non-empty transitions.
+ */
+#define chRingGetEventSource(rp) (&(rp)->r_event)
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void chRingInit(Ring *rp, void *buf, size_t size, cnt_t n);
+  msg_t chRingWrite(Ring *rp, const void *recp);
+  bool_t chRingRead(Ring *rp, void *recp);
+  void chRingDoorbellI(Ring *rp);
+  msg_t chRingPutI(Ring *rp, const void *recp);
+  msg_t chRingGetTimeout(Ring *rp, void *recp, systime_t time);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CH_USE_RINGS */
+
+#endif /* _CHRINGS_H_ */
+
+/** @} */
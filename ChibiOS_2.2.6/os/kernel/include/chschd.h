@@ -70,6 +70,19 @@
  */
 #define firstprio(rlp)  ((rlp)->p_next->p_prio)
 
+#if CH_OPTIMIZED_READYLIST || defined(__DOXYGEN__)
+#if defined(PORT_OPTIMIZED_READYLIST_STRUCT)
+#error "CH_OPTIMIZED_READYLIST not supported by this port"
+#endif
+
+/**
+ * @brief   Number of words in the ready list priorities bitmap.
+ * @note    The index covers the priorities from @p NOPRIO to @p HIGHPRIO,
+ *          the bitmap summary word must be able to hold one bit per word.
+ */
+#define RL_BITMAP_WORDS ((HIGHPRIO + 32) / 32)
+#endif /* CH_OPTIMIZED_READYLIST */
+
 /**
  * @extends ThreadsQueue
  *
@@ -94,6 +107,18 @@ typedef struct {
   Thread                *r_current; /**< @brief The currently running
                                                 thread.                     */
 #endif
+#if CH_DBG_THREADS_ACCOUNTING || defined(__DOXYGEN__)
+  rtcnt_t               r_switched; /**< @brief Realtime counter value at
+                                                the last context switch.    */
+#endif
+#if CH_OPTIMIZED_READYLIST || defined(__DOXYGEN__)
+  uint32_t              r_summary;  /**< @brief Non-empty bitmap words.     */
+  uint32_t              r_bitmap[RL_BITMAP_WORDS];
+                                    /**< @brief Non-empty priority levels.  */
+  Thread                *r_last[HIGHPRIO + 1];
+                                    /**< @brief Last ready thread of each
+                                                priority level.             */
+#endif
 } ReadyList;
 #endif /* !defined(PORT_OPTIMIZED_READYLIST_STRUCT) */
 
@@ -127,6 +152,21 @@ register Thread *currp asm(CH_CURRP_REGISTER_CACHE);
 #define setcurrp(tp) (currp = (tp))
 #endif /* !defined(PORT_OPTIMIZED_SETCURRP) */
 
+/**
+ * @brief   Removes the first thread from the ready list.
+ * @note    When the ready list index is enabled the index is updated too,
+ *          ports capturing the scheduler functions must use this macro
+ *          instead of operating on @p rlist.r_queue directly.
+ *
+ * @notapi
+ */
+#if CH_OPTIMIZED_READYLIST || defined(__DOXYGEN__)
+#define readylist_fifo_remove()                                             \
+  readylist_remove(rlist.r_queue.p_next, rlist.r_queue.p_next->p_prio)
+#else
+#define readylist_fifo_remove() fifo_remove(&rlist.r_queue)
+#endif
+
 /*
  * Scheduler APIs.
  */
@@ -134,6 +174,10 @@ register Thread *currp asm(CH_CURRP_REGISTER_CACHE);
 extern "C" {
 #endif
   void scheduler_init(void);
+#if CH_OPTIMIZED_READYLIST
+  Thread *readylist_insert(Thread *tp);
+  Thread *readylist_remove(Thread *tp, tprio_t prio);
+#endif
 #if !defined(PORT_OPTIMIZED_READYI)
   Thread *chSchReadyI(Thread *tp);
 #endif
@@ -35,6 +35,10 @@
 #ifndef _CHSYS_H_
 #define _CHSYS_H_
 
+#if CH_DBG_THREADS_ACCOUNTING && !PORT_SUPPORTS_RT
+#error "CH_DBG_THREADS_ACCOUNTING not supported by this port"
+#endif
+
 #if !CH_NO_IDLE_THREAD || defined(__DOXYGEN__)
 /**
  * @brief   Returns a pointer to the idle thread.
@@ -79,7 +83,14 @@
  *
  * @special
  */
+#if !CH_DBG_THREADS_ACCOUNTING || defined(__DOXYGEN__)
 #define chSysSwitchI(ntp, otp) port_switch(ntp, otp)
+#else
+#define chSysSwitchI(ntp, otp) {                                            \
+  _sys_switch_accounting(ntp, otp);                                         \
+  port_switch(ntp, otp);                                                    \
+}
+#endif
 
 /**
  * @brief   Raises the system interrupt priority mask to the maximum level.
@@ -187,7 +198,13 @@
  * @note    Usually IRQ handlers functions are also declared naked.
  * @note    On some architectures this macro can be empty.
  */
+#if !CH_DBG_ENABLE_TRACE || defined(__DOXYGEN__)
 #define CH_IRQ_PROLOGUE() PORT_IRQ_PROLOGUE()
+#else
+#define CH_IRQ_PROLOGUE()                                                   \
+  PORT_IRQ_PROLOGUE();                                                      \
+  chDbgTraceIsr(TRACE_EV_ISR_ENTER, 0)
+#endif
 
 /**
  * @brief   IRQ handler exit code.
@@ -195,7 +212,13 @@
  * @note    This macro usually performs the final reschedule by using
  *          @p chSchRescRequiredI() and @p chSchDoRescheduleI().
  */
+#if !CH_DBG_ENABLE_TRACE || defined(__DOXYGEN__)
 #define CH_IRQ_EPILOGUE() PORT_IRQ_EPILOGUE()
+#else
+#define CH_IRQ_EPILOGUE()                                                   \
+  chDbgTraceIsr(TRACE_EV_ISR_LEAVE, 0);                                     \
+  PORT_IRQ_EPILOGUE()
+#endif
 
 /**
  * @brief   Standard normal IRQ handler declaration.
@@ -214,6 +237,9 @@
 
 #ifdef __cplusplus
 extern "C" {
+#endif
+#if CH_DBG_THREADS_ACCOUNTING
+  void _sys_switch_accounting(Thread *ntp, Thread *otp);
 #endif
   void chSysInit(void);
   void chSysTimerHandlerI(void);
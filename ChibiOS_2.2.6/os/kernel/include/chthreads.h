@@ -81,6 +81,21 @@ struct Thread {
    * @note This field can overflow.
    */
   volatile systime_t    p_time;
+#endif
+#if CH_DBG_THREADS_ACCOUNTING || defined(__DOXYGEN__)
+  /**
+   * @brief Thread consumed time in realtime counter units.
+   * @note  The current run burst of the running thread is not included.
+   */
+  uint64_t              p_runtime;
+  /**
+   * @brief Number of times the thread has been switched in.
+   */
+  uint32_t              p_switches;
+  /**
+   * @brief Longest uninterrupted run in realtime counter units.
+   */
+  rtcnt_t               p_maxburst;
 #endif
   /**
    * @brief State-specific fields.
@@ -157,6 +172,12 @@ struct Thread {
    */
   void                  *p_mpool;
 #endif
+#if CH_USE_POOL_MAGAZINES
+  /**
+   * @brief Memory pool magazine attached to the thread.
+   */
+  PoolMagazine          *p_magazine;
+#endif
 #if defined(THREAD_EXT_FIELDS)
   /* Extra fields defined in chconf.h.*/
   THREAD_EXT_FIELDS
@@ -257,6 +278,42 @@ extern "C" {
  */
 #define chThdGetTicks(tp) ((tp)->p_time)
 
+/**
+ * @brief   Returns the time consumed by the specified thread.
+ * @note    This function is only available when the
+ *          @p CH_DBG_THREADS_ACCOUNTING configuration option is enabled.
+ *
+ * @param[in] tp        pointer to the thread
+ * @return              The time in realtime counter units.
+ *
+ * @api
+ */
+#define chThdGetRuntime(tp) ((tp)->p_runtime)
+
+/**
+ * @brief   Returns the number of times the specified thread has been
+ *          switched in.
+ * @note    This function is only available when the
+ *          @p CH_DBG_THREADS_ACCOUNTING configuration option is enabled.
+ *
+ * @param[in] tp        pointer to the thread
+ *
+ * @api
+ */
+#define chThdGetSwitches(tp) ((tp)->p_switches)
+
+/**
+ * @brief   Returns the longest uninterrupted run of the specified thread.
+ * @note    This function is only available when the
+ *          @p CH_DBG_THREADS_ACCOUNTING configuration option is enabled.
+ *
+ * @param[in] tp        pointer to the thread
+ * @return              The time in realtime counter units.
+ *
+ * @api
+ */
+#define chThdGetMaxBurst(tp) ((tp)->p_maxburst)
+
 /**
  * @brief   Returns the pointer to the @p Thread local storage area, if any.
  *
@@ -0,0 +1,116 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,2011 Giovanni Di Sirio.
+
+    This file is part of ChibiOS/RT.
+
+    ChibiOS/RT is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/RT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+                                      ---
+
+    A special exception to the GPL can be applied should you wish to distribute
+    a combined work that includes ChibiOS/RT, without being obliged to provide
+    the source code for any proprietary components. See the file exception.txt
+    for full details of how and when the exception can be applied.
+*/
+
+
+/**
+ * @file    chtrace.h
+ * @brief   Trace stream format.
+ * @details This header only contains constants, it is included by the
+ *          kernel and by the host tools decoding the trace stream.
+ *
+ * @addtogroup debug
+ * @{
+ */
+
+#ifndef _CHTRACE_H_
+#define _CHTRACE_H_
+
+/**
+ * @name    Trace event types
+ * @{
+ */
+#define TRACE_EV_HEADER         0x00    /**< @brief Stream header.          */
+#define TRACE_EV_NAME           0x01    /**< @brief Thread name.            */
+#define TRACE_EV_SWITCH         0x02    /**< @brief Context switch.         */
+#define TRACE_EV_ISR_ENTER      0x03    /**< @brief ISR entry.              */
+#define TRACE_EV_ISR_LEAVE      0x04    /**< @brief ISR exit.               */
+#define TRACE_EV_SEM_WAIT       0x05    /**< @brief Wait on a semaphore.    */
+#define TRACE_EV_SEM_SIGNAL     0x06    /**< @brief Semaphore signal waking
+                                                    a thread.               */
+#define TRACE_EV_MTX_WAIT       0x07    /**< @brief Wait on a mutex.        */
+#define TRACE_EV_MTX_UNLOCK     0x08    /**< @brief Mutex unlock waking a
+                                                    thread.                 */
+#define TRACE_EV_MB_POST        0x09    /**< @brief Mailbox post.           */
+#define TRACE_EV_MB_FETCH       0x0A    /**< @brief Mailbox fetch.          */
+#define TRACE_EV_VT_FIRE        0x0B    /**< @brief Virtual timer fired.    */
+/** @} */
+
+/**
+ * @name    Stream record layout
+ * @details The stream is a sequence of fixed size records, all the fields
+ *          are little endian. Pointers are truncated to their lower 32 bits
+ *          and are used as identifiers only.
+ *          - <b>0</b>: Event type, 8 bits.
+ *          - <b>1</b>: Event specific state, 8 bits.
+ *          - <b>2</b>: Records lost before this one, 16 bits, saturated.
+ *          - <b>4</b>: Current thread, 32 bits.
+ *          - <b>8</b>: Object, 32 bits.
+ *          - <b>12</b>: Event specific argument, 32 bits.
+ *          - <b>16</b>: Timestamp, 64 bits.
+ *          .
+ *          The argument of the wake up events is the readied thread, the
+ *          argument of the switch event is the thread switched out and its
+ *          state is the state of the thread switched out.<br>
+ *          The header record has the magic number in the thread field, the
+ *          timestamp frequency in the object field, the format version in
+ *          the lost field and the timestamp width in bits in the state
+ *          field.<br>
+ *          The name record has the thread in the thread field and the
+ *          thread name, zero padded, in the last 16 bytes.
+ * @{
+ */
+#define TRACE_RECORD_SIZE       24
+#define TRACE_OFF_TYPE          0
+#define TRACE_OFF_STATE         1
+#define TRACE_OFF_LOST          2
+#define TRACE_OFF_THREAD        4
+#define TRACE_OFF_OBJECT        8
+#define TRACE_OFF_ARG           12
+#define TRACE_OFF_TIME          16
+#define TRACE_OFF_NAME          8
+#define TRACE_NAME_SIZE         16
+/** @} */
+
+/**
+ * @brief   Stream magic number, "CHTR" little endian.
+ */
+#define TRACE_MAGIC             0x52544843
+
+/**
+ * @brief   Stream format version.
+ */
+#define TRACE_VERSION           1
+
+/**
+ * @brief   Mailbox batch operation flag in the state field.
+ * @details When set the argument is the number of messages instead of the
+ *          message.
+ */
+#define TRACE_MB_BATCH          0x01
+
+#endif /* _CHTRACE_H_ */
+
+/** @} */
@@ -35,6 +35,44 @@
 #ifndef _CHVT_H_
 #define _CHVT_H_
 
+#if CH_USE_TICKLESS && !PORT_SUPPORTS_TICKLESS
+#error "CH_USE_TICKLESS not supported by this port"
+#endif
+
+#if CH_USE_TICKLESS && (CH_TIME_QUANTUM > 0)
+#error "CH_USE_TICKLESS requires CH_TIME_QUANTUM == 0"
+#endif
+
+#if CH_USE_TICKLESS && CH_DBG_THREADS_PROFILING
+#error "CH_USE_TICKLESS is not compatible with CH_DBG_THREADS_PROFILING"
+#endif
+
+#if CH_USE_VT_WHEEL && CH_USE_TICKLESS
+#error "CH_USE_VT_WHEEL is not compatible with CH_USE_TICKLESS"
+#endif
+
+#if CH_USE_VT_WHEEL || defined(__DOXYGEN__)
+/**
+ * @brief   Bits of system time covered by each timer wheel level.
+ * @note    Each level has 2^VT_WHEEL_BITS slots.
+ */
+#if !defined(VT_WHEEL_BITS) || defined(__DOXYGEN__)
+#define VT_WHEEL_BITS       6
+#endif
+
+/**
+ * @brief   Number of slots in each timer wheel level.
+ */
+#define VT_WHEEL_SLOTS      (1 << VT_WHEEL_BITS)
+
+/**
+ * @brief   Number of timer wheel levels.
+ * @note    The levels cover a 32 bits @p systime_t, with a narrower type
+ *          the upper levels are simply never used.
+ */
+#define VT_WHEEL_LEVELS     ((32 + VT_WHEEL_BITS - 1) / VT_WHEEL_BITS)
+#endif /* CH_USE_VT_WHEEL */
+
 /**
  * @brief   Time conversion utility.
  * @details Converts from seconds to system ticks number.
@@ -76,30 +114,65 @@ struct VirtualTimer {
                                                 list.                       */
   VirtualTimer          *vt_prev;   /**< @brief Previous timer in the delta
                                                 list.                       */
-  systime_t             vt_time;    /**< @brief Time delta before timeout.  */
+  systime_t             vt_time;    /**< @brief Time delta before timeout,
+                                                absolute expiration time
+                                                when the timer wheel is
+                                                used.                       */
   vtfunc_t              vt_func;    /**< @brief Timer callback function
                                                 pointer.                    */
   void                  *vt_par;    /**< @brief Timer callback function
                                                 parameter.                  */
 };
 
+#if CH_USE_VT_WHEEL || defined(__DOXYGEN__)
+/**
+ * @brief   Timer wheel slot header.
+ * @note    The structure layout matches the first fields of
+ *          @p VirtualTimer, the slots are circular lists of timers.
+ */
+typedef struct {
+  VirtualTimer          *vt_next;   /**< @brief First timer in the slot.    */
+  VirtualTimer          *vt_prev;   /**< @brief Last timer in the slot.     */
+} VTSlot;
+#endif /* CH_USE_VT_WHEEL */
+
 /**
  * @brief   Virtual timers list header.
  * @note    The delta list is implemented as a double link bidirectional list
  *          in order to make the unlink time constant, the reset of a virtual
  *          timer is often used in the code.
+ * @note    In tickless mode the delta of the first timer is relative to
+ *          @p vt_lasttime instead of the current system time.
+ * @note    When @p CH_USE_VT_WHEEL is enabled the delta list is replaced by
+ *          a hierarchical timer wheel, the timers are hashed into the slots
+ *          by their absolute expiration time and both set and reset
+ *          operations take a constant time.
  */
 typedef struct {
+#if !CH_USE_VT_WHEEL || defined(__DOXYGEN__)
   VirtualTimer          *vt_next;   /**< @brief Next timer in the delta
                                                 list.                       */
   VirtualTimer          *vt_prev;   /**< @brief Last timer in the delta
                                                 list.                       */
   systime_t             vt_time;    /**< @brief Must be initialized to -1.  */
+#endif
+#if CH_USE_VT_WHEEL || defined(__DOXYGEN__)
+  VTSlot                vt_wheel[VT_WHEEL_LEVELS][VT_WHEEL_SLOTS];
+                                    /**< @brief Timer wheel slots.          */
+  cnt_t                 vt_armed;   /**< @brief Number of armed timers.     */
+#endif
+#if !CH_USE_TICKLESS || defined(__DOXYGEN__)
   volatile systime_t    vt_systime; /**< @brief System Time counter.        */
+#endif
+#if CH_USE_TICKLESS || defined(__DOXYGEN__)
+  systime_t             vt_lasttime;/**< @brief System time of the last
+                                                served deadline.            */
+#endif
 } VTList;
 
 extern VTList vtlist;
 
+#if (!CH_USE_TICKLESS && !CH_USE_VT_WHEEL) || defined(__DOXYGEN__)
 /**
  * @brief   Virtual timers ticker.
  *
@@ -116,10 +189,12 @@ extern VTList vtlist;
       vtp->vt_func = (vtfunc_t)NULL;                                    \
       vtp->vt_next->vt_prev = (void *)&vtlist;                          \
       (&vtlist)->vt_next = vtp->vt_next;                                \
+      chDbgTraceEventI(TRACE_EV_VT_FIRE, 0, vtp, TRACE_ID(fn));         \
       fn(vtp->vt_par);                                                  \
     }                                                                   \
   }                                                                     \
 }
+#endif /* !CH_USE_TICKLESS && !CH_USE_VT_WHEEL */
 
 /*
  * Virtual Timers APIs.
@@ -128,6 +203,12 @@ extern VTList vtlist;
 extern "C" {
 #endif
   void vt_init(void);
+#if CH_USE_TICKLESS || CH_USE_VT_WHEEL
+  void chVTDoTickI(void);
+#endif
+#if CH_USE_VT_WHEEL
+  systime_t vt_wheel_next(void);
+#endif
   void chVTSetI(VirtualTimer *vtp, systime_t time, vtfunc_t vtfunc, void *par);
   void chVTResetI(VirtualTimer *vtp);
   bool_t chTimeIsWithin(systime_t start, systime_t end);
@@ -148,12 +229,18 @@ extern "C" {
  *          invocation.
  * @note    The counter can reach its maximum and then restart from zero.
  * @note    This function is designed to work with the @p chThdSleepUntil().
+ * @note    In tickless mode the time is read from the port free-running
+ *          counter.
  *
  * @return              The system time in ticks.r
  *
  * @api
  */
+#if !CH_USE_TICKLESS || defined(__DOXYGEN__)
 #define chTimeNow() (vtlist.vt_systime)
+#else
+#define chTimeNow() port_timer_get_time()
+#endif
 
 #endif /* _CHVT_H_ */
 
@@ -30,7 +30,7 @@
  *
  * @addtogroup debug
  * @details Debug APIs and services:
- *          - Trace buffer.
+ *          - Trace buffer, optionally streamed.
  *          - Parameters check.
  *          - Kernel assertions.
  *          .
@@ -55,11 +55,51 @@ TraceBuffer trace_buffer;
 void trace_init(void) {
 
   trace_buffer.tb_size = TRACE_BUFFER_SIZE;
-  trace_buffer.tb_ptr = &trace_buffer.tb_buffer[0];
+  trace_buffer.tb_head = trace_buffer.tb_tail = 0;
+  trace_buffer.tb_lost = 0;
+  trace_buffer.tb_stream = FALSE;
+}
+
+/**
+ * @brief   Inserts a record in the trace buffer.
+ * @details When the buffer is full the oldest record is overwritten, in
+ *          streaming mode the new record is dropped instead and counted
+ *          in the lost field of the next inserted record.
+ *
+ * @param[in] type      the event type
+ * @param[in] state     the event specific state
+ * @param[in] objp      the event object
+ * @param[in] arg       the event specific argument
+ *
+ * @iclass
+ */
+void chDbgTraceEventI(unsigned type, unsigned state,
+                      const void *objp, uint32_t arg) {
+  TraceEvent *tep;
+
+  if (trace_buffer.tb_head - trace_buffer.tb_tail >= TRACE_BUFFER_SIZE) {
+    if (trace_buffer.tb_stream) {
+      if (trace_buffer.tb_lost < 0xFFFF)
+        trace_buffer.tb_lost++;
+      return;
+    }
+    trace_buffer.tb_tail++;
+  }
+  tep = &trace_buffer.tb_buffer[trace_buffer.tb_head & (TRACE_BUFFER_SIZE - 1)];
+  tep->te_type = (uint8_t)type;
+  tep->te_state = (uint8_t)state;
+  tep->te_lost = trace_buffer.tb_lost;
+  tep->te_tp = currp;
+  tep->te_objp = objp;
+  tep->te_arg = arg;
+  tep->te_time = TRACE_TIMESTAMP();
+  trace_buffer.tb_lost = 0;
+  trace_buffer.tb_head++;
 }
 
 /**
  * @brief   Inserts in the circular debug trace buffer a context switch record.
+ * @details The current thread is the thread being switched in.
  *
  * @param[in] otp       the thread being switched out
  *
@@ -67,12 +107,50 @@ void trace_init(void) {
  */
 void chDbgTrace(Thread *otp) {
 
-  trace_buffer.tb_ptr->cse_wtobjp = otp->p_u.wtobjp;
-  trace_buffer.tb_ptr->cse_time = chTimeNow();
-  trace_buffer.tb_ptr->cse_state = otp->p_state;
-  trace_buffer.tb_ptr->cse_tid = (unsigned)currp >> 6;
-  if (++trace_buffer.tb_ptr >= &trace_buffer.tb_buffer[TRACE_BUFFER_SIZE])
-    trace_buffer.tb_ptr = &trace_buffer.tb_buffer[0];
+  chDbgTraceEventI(TRACE_EV_SWITCH, otp->p_state, otp->p_u.wtobjp,
+                   TRACE_ID(otp));
+}
+
+/**
+ * @brief   Enables or disables the streaming mode.
+ * @details In streaming mode a reader is expected to fetch the records
+ *          using @p chDbgTraceFetch(), the buffer is never overwritten
+ *          and the records not fitting are counted as lost.
+ *
+ * @param[in] enable    the new mode
+ *
+ * @api
+ */
+void chDbgTraceStream(bool_t enable) {
+
+  chSysLock();
+  trace_buffer.tb_stream = enable;
+  trace_buffer.tb_lost = 0;
+  chSysUnlock();
+}
+
+/**
+ * @brief   Fetches records from the trace buffer.
+ * @details The records are copied starting from the oldest one and then
+ *          removed from the buffer.
+ *
+ * @param[out] tep      pointer to the records buffer
+ * @param[in] n         maximum number of records to fetch
+ * @return              The number of fetched records.
+ *
+ * @api
+ */
+cnt_t chDbgTraceFetch(TraceEvent *tep, cnt_t n) {
+  cnt_t i;
+
+  chDbgCheck((tep != NULL) && (n > 0), "chDbgTraceFetch");
+
+  chSysLock();
+  for (i = 0; (i < n) && (trace_buffer.tb_tail != trace_buffer.tb_head); i++)
+    *tep++ = trace_buffer.tb_buffer[trace_buffer.tb_tail++ &
+                                    (TRACE_BUFFER_SIZE - 1)];
+  chSysUnlock();
+  return i;
 }
 #endif /* CH_DBG_ENABLE_TRACE */
 
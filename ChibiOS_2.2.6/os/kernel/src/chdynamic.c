@@ -65,6 +65,9 @@ Thread *chThdAddRef(Thread *tp) {
  * @pre     The configuration option @p CH_USE_DYNAMIC must be enabled in order
  *          to use this function.
  * @note    Static threads are not affected.
+ * @note    The working area of a thread created from a memory pool is
+ *          returned to the magazine attached to the calling thread if it
+ *          caches the same memory pool.
  *
  * @param[in] tp        pointer to the thread
  *
@@ -95,6 +98,13 @@ void chThdRelease(Thread *tp) {
     case THD_MEM_MODE_MEMPOOL:
 #if CH_USE_REGISTRY
       REG_REMOVE(tp);
+#endif
+#if CH_USE_POOL_MAGAZINES
+      if ((currp->p_magazine != NULL) &&
+          (currp->p_magazine->mg_pool == tp->p_mpool)) {
+        chPoolMagazineFree(currp->p_magazine, tp);
+        break;
+      }
 #endif
       chPoolFree(tp->p_mpool, tp);
       break;
@@ -163,6 +173,8 @@ Thread *chThdCreateFromHeap(MemoryHeap *heapp, size_t size,
  *          returning from its main function.
  * @note    The memory allocated for the thread is not released when the thread
  *          terminates but when a @p chThdWait() is performed.
+ * @note    If the calling thread has a magazine of the same memory pool
+ *          attached then the working area is taken from the magazine.
  *
  * @param[in] mp        pointer to the memory pool object
  * @param[in] prio      the priority level for the new thread
@@ -182,6 +194,11 @@ Thread *chThdCreateFromMemoryPool(MemoryPool *mp, tprio_t prio,
 
   chDbgCheck(mp != NULL, "chThdCreateFromMemoryPool");
 
+#if CH_USE_POOL_MAGAZINES
+  if ((currp->p_magazine != NULL) && (currp->p_magazine->mg_pool == mp))
+    wsp = chPoolMagazineAlloc(currp->p_magazine);
+  else
+#endif
   wsp = chPoolAlloc(mp);
   if (wsp == NULL)
     return NULL;
@@ -35,6 +35,10 @@
  *          are functionally equivalent to the usual @p malloc() and @p free()
  *          library functions. The main difference is that the OS heap APIs
  *          are guaranteed to be thread safe.<br>
+ *          By enabling the @p CH_USE_HEAP_TLSF option the first-fit strategy
+ *          is replaced by a two-level segregated fit allocator, free blocks
+ *          are kept in lists indexed by size class and both allocation and
+ *          release take a bounded time.<br>
  *          By enabling the @p CH_USE_MALLOC_HEAP option the heap manager
  *          will use the runtime-provided @p malloc() and @p free() as
  *          backend for the heap APIs instead of the system provided
@@ -66,6 +70,383 @@
  */
 static MemoryHeap default_heap;
 
+#if CH_USE_HEAP_TLSF || defined(__DOXYGEN__)
+/*
+ * Bit scan helpers, the argument must be non-zero.
+ */
+#if defined(__GNUC__)
+#define tlsf_fls(n) ((unsigned)(sizeof(unsigned long) * 8 - 1 -             \
+                                __builtin_clzl((unsigned long)(n))))
+#define tlsf_ffs(n) ((unsigned)__builtin_ctzl((unsigned long)(n)))
+#else
+static unsigned tlsf_fls(size_t n) {
+  unsigned i = 0;
+
+  while (n >>= 1)
+    i++;
+  return i;
+}
+
+static unsigned tlsf_ffs(uint32_t n) {
+  unsigned i = 0;
+
+  while ((n & 1) == 0) {
+    n >>= 1;
+    i++;
+  }
+  return i;
+}
+#endif
+
+/*
+ * Block following a block in memory.
+ */
+#define NEXT(p) ((union heap_header *)((uint8_t *)(p) + \
+                                        sizeof(union heap_header) + \
+                                        (p)->h.size))
+
+/*
+ * Allocated blocks mark, the free blocks never point to themselves.
+ */
+#define IS_FREE(p)  ((p)->h.pfree != (p))
+#define SET_USED(p) ((p)->h.pfree = (p))
+
+/**
+ * @brief   Size class of a block.
+ *
+ * @param[in] size      the block size
+ * @param[out] flp      first level index
+ * @param[out] slp      second level index
+ */
+static void tlsf_mapping(size_t size, unsigned *flp, unsigned *slp) {
+
+  if (size < HEAP_TLSF_SL) {
+    *flp = 0;
+    *slp = (unsigned)size;
+  }
+  else {
+    unsigned fl = tlsf_fls(size);
+
+    *slp = (unsigned)(size >> (fl - HEAP_TLSF_SL_BITS)) ^ HEAP_TLSF_SL;
+    *flp = fl - HEAP_TLSF_SL_BITS + 1;
+  }
+}
+
+/**
+ * @brief   Inserts a block in the free list of its size class.
+ *
+ * @param[in] heapp     pointer to the heap descriptor
+ * @param[in] hp        the block to be inserted
+ */
+static void tlsf_insert(MemoryHeap *heapp, union heap_header *hp) {
+  union heap_header **lp;
+  unsigned fl, sl;
+
+  tlsf_mapping(hp->h.size, &fl, &sl);
+  lp = &heapp->h_lists[fl][sl];
+  hp->h.pfree = NULL;
+  if ((hp->h.u.next = *lp) != NULL)
+    (*lp)->h.pfree = hp;
+  *lp = hp;
+  heapp->h_flmap |= (uint32_t)1 << fl;
+  heapp->h_slmap[fl] |= (uint32_t)1 << sl;
+}
+
+/**
+ * @brief   Removes a block from the free list of its size class.
+ *
+ * @param[in] heapp     pointer to the heap descriptor
+ * @param[in] hp        the block to be removed
+ */
+static void tlsf_remove(MemoryHeap *heapp, union heap_header *hp) {
+  unsigned fl, sl;
+
+  tlsf_mapping(hp->h.size, &fl, &sl);
+  if (hp->h.pfree != NULL)
+    hp->h.pfree->h.u.next = hp->h.u.next;
+  else
+    heapp->h_lists[fl][sl] = hp->h.u.next;
+  if (hp->h.u.next != NULL)
+    hp->h.u.next->h.pfree = hp->h.pfree;
+  if (heapp->h_lists[fl][sl] == NULL) {
+    heapp->h_slmap[fl] &= ~((uint32_t)1 << sl);
+    if (heapp->h_slmap[fl] == 0)
+      heapp->h_flmap &= ~((uint32_t)1 << fl);
+  }
+}
+
+/**
+ * @brief   Finds a free block of at least the specified size.
+ * @details The size is rounded up to the next size class boundary so that
+ *          any block in the first non-empty list found is big enough, if
+ *          no such block exists then the list of the exact size class is
+ *          also checked for a fitting block.
+ *
+ * @param[in] heapp     pointer to the heap descriptor
+ * @param[in] size      the requested size
+ * @return              The found block, still in its free list.
+ * @retval NULL         if there is no fitting block.
+ */
+static union heap_header *tlsf_find(MemoryHeap *heapp, size_t size) {
+  union heap_header *hp;
+  unsigned fl, sl;
+  uint32_t map;
+
+  if (size >= HEAP_TLSF_SL)
+    tlsf_mapping(size + ((size_t)1 << (tlsf_fls(size) - HEAP_TLSF_SL_BITS)) - 1,
+                 &fl, &sl);
+  else
+    tlsf_mapping(size, &fl, &sl);
+  if (fl < HEAP_TLSF_FL) {
+    map = heapp->h_slmap[fl] & (~(uint32_t)0 << sl);
+    if (map == 0) {
+      map = fl + 1 < 32 ? heapp->h_flmap & (~(uint32_t)0 << (fl + 1)) : 0;
+      if (map != 0) {
+        fl = tlsf_ffs(map);
+        map = heapp->h_slmap[fl];
+      }
+    }
+    if (map != 0)
+      return heapp->h_lists[fl][tlsf_ffs(map)];
+  }
+
+  /* Last chance, the first block of the exact size class.*/
+  tlsf_mapping(size, &fl, &sl);
+  hp = heapp->h_lists[fl][sl];
+  if ((hp != NULL) && (hp->h.size >= size))
+    return hp;
+  return NULL;
+}
+
+/**
+ * @brief   Initializes the TLSF free lists of a heap.
+ *
+ * @param[out] heapp    pointer to the heap descriptor
+ */
+static void tlsf_init(MemoryHeap *heapp) {
+  unsigned fl, sl;
+
+  heapp->h_flmap = 0;
+  for (fl = 0; fl < HEAP_TLSF_FL; fl++) {
+    heapp->h_slmap[fl] = 0;
+    for (sl = 0; sl < HEAP_TLSF_SL; sl++)
+      heapp->h_lists[fl][sl] = NULL;
+  }
+}
+
+/**
+ * @brief   Initializes the default heap.
+ *
+ * @notapi
+ */
+void heap_init(void) {
+  default_heap.h_provider = chCoreAlloc;
+  tlsf_init(&default_heap);
+#if CH_USE_MUTEXES || defined(__DOXYGEN__)
+  chMtxInit(&default_heap.h_mtx);
+#else
+  chSemInit(&default_heap.h_sem, 1);
+#endif
+}
+
+/**
+ * @brief   Initializes a memory heap from a static memory area.
+ * @pre     Both the heap buffer base and the heap size must be aligned to
+ *          the @p stkalign_t type size.
+ * @pre     In order to use this function the option @p CH_USE_MALLOC_HEAP
+ *          must be disabled.
+ * @note    The buffer space exceeding @p HEAP_TLSF_LIMIT is not used.
+ *
+ * @param[out] heapp    pointer to the memory heap descriptor to be initialized
+ * @param[in] buf       heap buffer base
+ * @param[in] size      heap size
+ *
+ * @init
+ */
+void chHeapInit(MemoryHeap *heapp, void *buf, size_t size) {
+  union heap_header *hp = buf, *ep;
+
+  chDbgCheck(MEM_IS_ALIGNED(buf) && MEM_IS_ALIGNED(size) &&
+             (size >= 2 * sizeof(union heap_header)), "chHeapInit");
+
+  heapp->h_provider = (memgetfunc_t)NULL;
+  tlsf_init(heapp);
+  /* A single free block followed by an allocated, zero sized, block that
+     stops the merging at the end of the buffer.*/
+  size -= 2 * sizeof(union heap_header);
+  if (size >= HEAP_TLSF_LIMIT)
+    size = MEM_ALIGN_PREV(HEAP_TLSF_LIMIT - 1);
+  hp->h.prev = NULL;
+  hp->h.size = size;
+  ep = NEXT(hp);
+  ep->h.u.heap = heapp;
+  ep->h.size = 0;
+  ep->h.prev = hp;
+  SET_USED(ep);
+  tlsf_insert(heapp, hp);
+#if CH_USE_MUTEXES || defined(__DOXYGEN__)
+  chMtxInit(&heapp->h_mtx);
+#else
+  chSemInit(&heapp->h_sem, 1);
+#endif
+}
+
+/**
+ * @brief   Allocates a block of memory from the heap by using the TLSF
+ *          algorithm.
+ * @details The allocated block is guaranteed to be properly aligned for a
+ *          pointer data type (@p stkalign_t).
+ *
+ * @param[in] heapp     pointer to a heap descriptor or @p NULL in order to
+ *                      access the default heap.
+ * @param[in] size      the size of the block to be allocated. Note that the
+ *                      allocated block may be a bit bigger than the requested
+ *                      size for alignment and fragmentation reasons.
+ * @return              A pointer to the allocated block.
+ * @retval NULL         if the block cannot be allocated.
+ *
+ * @api
+ */
+void *chHeapAlloc(MemoryHeap *heapp, size_t size) {
+  union heap_header *hp, *fp;
+
+  if (heapp == NULL)
+    heapp = &default_heap;
+
+  if (size >= HEAP_TLSF_LIMIT)
+    return NULL;
+  size = size ? MEM_ALIGN_NEXT(size) : MEM_ALIGN_SIZE;
+  H_LOCK(heapp);
+
+  hp = tlsf_find(heapp, size);
+  if (hp != NULL) {
+    tlsf_remove(heapp, hp);
+    if (hp->h.size >= size + sizeof(union heap_header) + MEM_ALIGN_SIZE) {
+      /* Block bigger enough, must split it, the block after hp is not free
+         because adjacent free blocks are always merged.*/
+      fp = (void *)((uint8_t *)(hp) + sizeof(union heap_header) + size);
+      fp->h.size = hp->h.size - sizeof(union heap_header) - size;
+      fp->h.prev = hp;
+      NEXT(fp)->h.prev = fp;
+      hp->h.size = size;
+      tlsf_insert(heapp, fp);
+    }
+    hp->h.u.heap = heapp;
+    SET_USED(hp);
+
+    H_UNLOCK(heapp);
+    return (void *)(hp + 1);
+  }
+
+  H_UNLOCK(heapp);
+
+  /* More memory is required, tries to get it from the associated provider
+     else fails. The block is terminated by a zero sized block in order to
+     prevent merging with memory not belonging to the heap.*/
+  if (heapp->h_provider) {
+    hp = heapp->h_provider(size + 2 * sizeof(union heap_header));
+    if (hp != NULL) {
+      hp->h.u.heap = heapp;
+      hp->h.size = size;
+      hp->h.prev = NULL;
+      SET_USED(hp);
+      fp = NEXT(hp);
+      fp->h.u.heap = heapp;
+      fp->h.size = 0;
+      fp->h.prev = hp;
+      SET_USED(fp);
+      hp++;
+      return (void *)hp;
+    }
+  }
+  return NULL;
+}
+
+/**
+ * @brief   Frees a previously allocated memory block.
+ * @details The block is merged with the adjacent free blocks, if any,
+ *          unless the resulting block would exceed @p HEAP_TLSF_LIMIT.
+ *
+ * @param[in] p         pointer to the memory block to be freed
+ *
+ * @api
+ */
+void chHeapFree(void *p) {
+  union heap_header *hp, *np;
+  MemoryHeap *heapp;
+
+  chDbgCheck(p != NULL, "chHeapFree");
+
+  hp = (union heap_header *)p - 1;
+  heapp = hp->h.u.heap;
+  chDbgAssert(!IS_FREE(hp), "chHeapFree(), #1", "not allocated");
+  H_LOCK(heapp);
+
+  np = NEXT(hp);
+  if (IS_FREE(np) &&
+      (hp->h.size + sizeof(union heap_header) + np->h.size <
+       HEAP_TLSF_LIMIT)) {
+    /* Merge with the next block.*/
+    tlsf_remove(heapp, np);
+    hp->h.size += np->h.size + sizeof(union heap_header);
+    NEXT(hp)->h.prev = hp;
+  }
+  np = hp->h.prev;
+  if ((np != NULL) && IS_FREE(np) &&
+      (np->h.size + sizeof(union heap_header) + hp->h.size <
+       HEAP_TLSF_LIMIT)) {
+    /* Merge with the previous block.*/
+    tlsf_remove(heapp, np);
+    np->h.size += hp->h.size + sizeof(union heap_header);
+    NEXT(np)->h.prev = np;
+    hp = np;
+  }
+  tlsf_insert(heapp, hp);
+
+  H_UNLOCK(heapp);
+  return;
+}
+
+/**
+ * @brief   Reports the heap status.
+ * @note    This function is meant to be used in the test suite, it should
+ *          not be really useful for the application code.
+ * @note    This function is not implemented when the @p CH_USE_MALLOC_HEAP
+ *          configuration option is used (it always returns zero).
+ *
+ * @param[in] heapp     pointer to a heap descriptor or @p NULL in order to
+ *                      access the default heap.
+ * @param[in] sizep     pointer to a variable that will receive the total
+ *                      fragmented free space
+ * @return              The number of fragments in the heap.
+ *
+ * @api
+ */
+size_t chHeapStatus(MemoryHeap *heapp, size_t *sizep) {
+  union heap_header *qp;
+  unsigned fl, sl;
+  size_t n, sz;
+
+  if (heapp == NULL)
+    heapp = &default_heap;
+
+  H_LOCK(heapp);
+
+  n = sz = 0;
+  for (fl = 0; fl < HEAP_TLSF_FL; fl++)
+    for (sl = 0; sl < HEAP_TLSF_SL; sl++)
+      for (qp = heapp->h_lists[fl][sl]; qp != NULL; qp = qp->h.u.next) {
+        sz += qp->h.size;
+        n++;
+      }
+  if (sizep)
+    *sizep = sz;
+
+  H_UNLOCK(heapp);
+  return n;
+}
+
+#else /* !CH_USE_HEAP_TLSF */
 /**
  * @brief   Initializes the default heap.
  *
@@ -265,6 +646,8 @@ size_t chHeapStatus(MemoryHeap *heapp, size_t *sizep) {
   return n;
 }
 
+#endif /* !CH_USE_HEAP_TLSF */
+
 #else /* CH_USE_MALLOC_HEAP */
 
 #include <stdlib.h>
@@ -38,6 +38,10 @@
  *            priority.
  *          - <b>Fetch</b>: A message is fetched from the mailbox and removed
  *            from the queue.
+ *          - <b>Post Batch</b>: Posts up to N messages in FIFO order with a
+ *            single critical section and reschedule.
+ *          - <b>Fetch Batch</b>: Up to N messages are fetched from the mailbox
+ *            with a single critical section and reschedule.
  *          - <b>Reset</b>: The mailbox is emptied and all the stored messages
  *            are lost.
  *          .
@@ -59,6 +63,38 @@
 #include "ch.h"
 
 #if CH_USE_MAILBOXES || defined(__DOXYGEN__)
+/**
+ * @brief   Copies messages into the mailbox buffer at the write pointer.
+ *
+ * @param[in] mbp       the pointer to an initialized Mailbox object
+ * @param[in] msgs      the messages to be copied
+ * @param[in] n         the number of messages, slots must be available
+ */
+static void mb_write(Mailbox *mbp, const msg_t *msgs, cnt_t n) {
+
+  while (n-- > 0) {
+    *mbp->mb_wrptr++ = *msgs++;
+    if (mbp->mb_wrptr >= mbp->mb_top)
+      mbp->mb_wrptr = mbp->mb_buffer;
+  }
+}
+
+/**
+ * @brief   Copies messages out of the mailbox buffer at the read pointer.
+ *
+ * @param[in] mbp       the pointer to an initialized Mailbox object
+ * @param[out] msgs     the buffer for the messages
+ * @param[in] n         the number of messages, messages must be available
+ */
+static void mb_read(Mailbox *mbp, msg_t *msgs, cnt_t n) {
+
+  while (n-- > 0) {
+    *msgs++ = *mbp->mb_rdptr++;
+    if (mbp->mb_rdptr >= mbp->mb_top)
+      mbp->mb_rdptr = mbp->mb_buffer;
+  }
+}
+
 /**
  * @brief   Initializes a Mailbox object.
  *
@@ -156,6 +192,7 @@ msg_t chMBPostS(Mailbox *mbp, msg_t msg, systime_t time) {
     *mbp->mb_wrptr++ = msg;
     if (mbp->mb_wrptr >= mbp->mb_top)
       mbp->mb_wrptr = mbp->mb_buffer;
+    chDbgTraceEventI(TRACE_EV_MB_POST, 0, mbp, (uint32_t)msg);
     chSemSignalI(&mbp->mb_fullsem);
     chSchRescheduleS();
   }
@@ -186,6 +223,7 @@ msg_t chMBPostI(Mailbox *mbp, msg_t msg) {
   *mbp->mb_wrptr++ = msg;
   if (mbp->mb_wrptr >= mbp->mb_top)
     mbp->mb_wrptr = mbp->mb_buffer;
+  chDbgTraceEventI(TRACE_EV_MB_POST, 0, mbp, (uint32_t)msg);
   chSemSignalI(&mbp->mb_fullsem);
   return RDY_OK;
 }
@@ -247,6 +285,7 @@ msg_t chMBPostAheadS(Mailbox *mbp, msg_t msg, systime_t time) {
     if (--mbp->mb_rdptr < mbp->mb_buffer)
       mbp->mb_rdptr = mbp->mb_top - 1;
     *mbp->mb_rdptr = msg;
+    chDbgTraceEventI(TRACE_EV_MB_POST, 0, mbp, (uint32_t)msg);
     chSemSignalI(&mbp->mb_fullsem);
     chSchRescheduleS();
   }
@@ -277,6 +316,7 @@ msg_t chMBPostAheadI(Mailbox *mbp, msg_t msg) {
   if (--mbp->mb_rdptr < mbp->mb_buffer)
     mbp->mb_rdptr = mbp->mb_top - 1;
   *mbp->mb_rdptr = msg;
+  chDbgTraceEventI(TRACE_EV_MB_POST, 0, mbp, (uint32_t)msg);
   chSemSignalI(&mbp->mb_fullsem);
   return RDY_OK;
 }
@@ -338,6 +378,7 @@ msg_t chMBFetchS(Mailbox *mbp, msg_t *msgp, systime_t time) {
     *msgp = *mbp->mb_rdptr++;
     if (mbp->mb_rdptr >= mbp->mb_top)
       mbp->mb_rdptr = mbp->mb_buffer;
+    chDbgTraceEventI(TRACE_EV_MB_FETCH, 0, mbp, (uint32_t)*msgp);
     chSemSignalI(&mbp->mb_emptysem);
     chSchRescheduleS();
   }
@@ -367,9 +408,165 @@ msg_t chMBFetchI(Mailbox *mbp, msg_t *msgp) {
   *msgp = *mbp->mb_rdptr++;
   if (mbp->mb_rdptr >= mbp->mb_top)
     mbp->mb_rdptr = mbp->mb_buffer;
+  chDbgTraceEventI(TRACE_EV_MB_FETCH, 0, mbp, (uint32_t)*msgp);
   chSemSignalI(&mbp->mb_emptysem);
   return RDY_OK;
 }
+
+/**
+ * @brief   Posts a batch of messages into a mailbox.
+ * @details The invoking thread waits until at least an empty slot in the
+ *          mailbox becomes available or the specified time runs out, then
+ *          up to @p n messages are posted, as many as the empty slots.
+ *          The semaphores are adjusted once for the whole batch and a single
+ *          reschedule is performed.
+ *
+ * @param[in] mbp       the pointer to an initialized Mailbox object
+ * @param[in] msgs      the messages to be posted on the mailbox
+ * @param[in] n         the number of messages
+ * @param[in] time      the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The number of posted messages, zero if the mailbox
+ *                      has been reset while waiting or the operation timed
+ *                      out.
+ *
+ * @api
+ */
+cnt_t chMBPostBatch(Mailbox *mbp, const msg_t *msgs, cnt_t n,
+                    systime_t time) {
+  cnt_t k;
+
+  chDbgCheck((mbp != NULL) && (msgs != NULL) && (n > 0), "chMBPostBatch");
+
+  chSysLock();
+  if (chSemWaitTimeoutS(&mbp->mb_emptysem, time) != RDY_OK) {
+    chSysUnlock();
+    return 0;
+  }
+  /* One slot is owned after the wait, more are taken if available.*/
+  k = chSemGetCounterI(&mbp->mb_emptysem);
+  if (k < 0)
+    k = 0;
+  if (k > n - 1)
+    k = n - 1;
+  mbp->mb_emptysem.s_cnt -= k++;
+  mb_write(mbp, msgs, k);
+  chDbgTraceEventI(TRACE_EV_MB_POST, TRACE_MB_BATCH, mbp, (uint32_t)k);
+  chSemAddCounterI(&mbp->mb_fullsem, k);
+  chSchRescheduleS();
+  chSysUnlock();
+  return k;
+}
+
+/**
+ * @brief   Posts a batch of messages into a mailbox.
+ * @details This variant is non-blocking, up to @p n messages are posted,
+ *          as many as the empty slots.
+ *
+ * @param[in] mbp       the pointer to an initialized Mailbox object
+ * @param[in] msgs      the messages to be posted on the mailbox
+ * @param[in] n         the number of messages
+ * @return              The number of posted messages, zero if the mailbox
+ *                      is full.
+ *
+ * @iclass
+ */
+cnt_t chMBPostBatchI(Mailbox *mbp, const msg_t *msgs, cnt_t n) {
+  cnt_t k;
+
+  chDbgCheck((mbp != NULL) && (msgs != NULL) && (n > 0), "chMBPostBatchI");
+
+  k = chSemGetCounterI(&mbp->mb_emptysem);
+  if (k <= 0)
+    return 0;
+  if (k > n)
+    k = n;
+  mbp->mb_emptysem.s_cnt -= k;
+  mb_write(mbp, msgs, k);
+  chDbgTraceEventI(TRACE_EV_MB_POST, TRACE_MB_BATCH, mbp, (uint32_t)k);
+  chSemAddCounterI(&mbp->mb_fullsem, k);
+  return k;
+}
+
+/**
+ * @brief   Retrieves a batch of messages from a mailbox.
+ * @details The invoking thread waits until at least a message is posted in
+ *          the mailbox or the specified time runs out, then up to @p n
+ *          messages are fetched, as many as the queued ones.
+ *          The semaphores are adjusted once for the whole batch and a single
+ *          reschedule is performed.
+ *
+ * @param[in] mbp       the pointer to an initialized Mailbox object
+ * @param[out] msgs     the buffer for the received messages
+ * @param[in] n         the maximum number of messages
+ * @param[in] time      the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The number of fetched messages, zero if the mailbox
+ *                      has been reset while waiting or the operation timed
+ *                      out.
+ *
+ * @api
+ */
+cnt_t chMBFetchBatch(Mailbox *mbp, msg_t *msgs, cnt_t n, systime_t time) {
+  cnt_t k;
+
+  chDbgCheck((mbp != NULL) && (msgs != NULL) && (n > 0), "chMBFetchBatch");
+
+  chSysLock();
+  if (chSemWaitTimeoutS(&mbp->mb_fullsem, time) != RDY_OK) {
+    chSysUnlock();
+    return 0;
+  }
+  /* One message is owned after the wait, more are taken if available.*/
+  k = chSemGetCounterI(&mbp->mb_fullsem);
+  if (k < 0)
+    k = 0;
+  if (k > n - 1)
+    k = n - 1;
+  mbp->mb_fullsem.s_cnt -= k++;
+  mb_read(mbp, msgs, k);
+  chDbgTraceEventI(TRACE_EV_MB_FETCH, TRACE_MB_BATCH, mbp, (uint32_t)k);
+  chSemAddCounterI(&mbp->mb_emptysem, k);
+  chSchRescheduleS();
+  chSysUnlock();
+  return k;
+}
+
+/**
+ * @brief   Retrieves a batch of messages from a mailbox.
+ * @details This variant is non-blocking, up to @p n messages are fetched,
+ *          as many as the queued ones.
+ *
+ * @param[in] mbp       the pointer to an initialized Mailbox object
+ * @param[out] msgs     the buffer for the received messages
+ * @param[in] n         the maximum number of messages
+ * @return              The number of fetched messages, zero if the mailbox
+ *                      is empty.
+ *
+ * @iclass
+ */
+cnt_t chMBFetchBatchI(Mailbox *mbp, msg_t *msgs, cnt_t n) {
+  cnt_t k;
+
+  chDbgCheck((mbp != NULL) && (msgs != NULL) && (n > 0), "chMBFetchBatchI");
+
+  k = chSemGetCounterI(&mbp->mb_fullsem);
+  if (k <= 0)
+    return 0;
+  if (k > n)
+    k = n;
+  mbp->mb_fullsem.s_cnt -= k;
+  mb_read(mbp, msgs, k);
+  chDbgTraceEventI(TRACE_EV_MB_FETCH, TRACE_MB_BATCH, mbp, (uint32_t)k);
+  chSemAddCounterI(&mbp->mb_emptysem, k);
+  return k;
+}
 #endif /* CH_USE_MAILBOXES */
 
 /** @} */
@@ -145,6 +145,203 @@ void chPoolFree(MemoryPool *mp, void *objp) {
   chPoolFreeI(mp, objp);
   chSysUnlock();
 }
+
+/**
+ * @brief   Allocates a batch of objects from a memory pool.
+ * @details The objects are taken from the pool free list, the provider is
+ *          invoked for a single object only if the free list is empty.
+ *
+ * @param[in] mp        pointer to a @p MemoryPool structure
+ * @param[out] objs     array receiving the pointers to the allocated objects
+ * @param[in] n         number of objects to be allocated
+ * @return              The number of allocated objects.
+ *
+ * @iclass
+ */
+size_t chPoolAllocBatchI(MemoryPool *mp, void *objs[], size_t n) {
+  struct pool_header *php;
+  size_t i;
+
+  chDbgCheck((mp != NULL) && (objs != NULL), "chPoolAllocBatchI");
+
+  php = mp->mp_next;
+  for (i = 0; (i < n) && (php != NULL); i++) {
+    objs[i] = php;
+    php = php->ph_next;
+  }
+  mp->mp_next = php;
+  if ((i == 0) && (n > 0) && (mp->mp_provider != NULL)) {
+    if ((objs[0] = mp->mp_provider(mp->mp_object_size)) != NULL)
+      i = 1;
+  }
+  return i;
+}
+
+/**
+ * @brief   Allocates a batch of objects from a memory pool.
+ * @details The objects are taken from the pool free list, the provider is
+ *          invoked for a single object only if the free list is empty.
+ * @note    A single critical section is used for the whole batch.
+ *
+ * @param[in] mp        pointer to a @p MemoryPool structure
+ * @param[out] objs     array receiving the pointers to the allocated objects
+ * @param[in] n         number of objects to be allocated
+ * @return              The number of allocated objects.
+ *
+ * @api
+ */
+size_t chPoolAllocBatch(MemoryPool *mp, void *objs[], size_t n) {
+
+  chSysLock();
+  n = chPoolAllocBatchI(mp, objs, n);
+  chSysUnlock();
+  return n;
+}
+
+/**
+ * @brief   Releases (or adds) a batch of objects into (to) a memory pool.
+ * @pre     The freed objects must be of the right size for the specified
+ *          memory pool.
+ * @pre     The freed objects must be memory aligned to the size of
+ *          @p stkalign_t type.
+ *
+ * @param[in] mp        pointer to a @p MemoryPool structure
+ * @param[in] objs      array of pointers to the objects to be released
+ * @param[in] n         number of objects to be released
+ *
+ * @iclass
+ */
+void chPoolFreeBatchI(MemoryPool *mp, void *objs[], size_t n) {
+
+  chDbgCheck((mp != NULL) && (objs != NULL), "chPoolFreeBatchI");
+
+  while (n > 0) {
+    struct pool_header *php = objs[--n];
+
+    chDbgCheck((php != NULL) && MEM_IS_ALIGNED(php), "chPoolFreeBatchI");
+    php->ph_next = mp->mp_next;
+    mp->mp_next = php;
+  }
+}
+
+/**
+ * @brief   Releases (or adds) a batch of objects into (to) a memory pool.
+ * @details The objects are linked together outside the critical section,
+ *          the resulting chain is then inserted in the pool free list in
+ *          constant time.
+ * @pre     The freed objects must be of the right size for the specified
+ *          memory pool.
+ * @pre     The freed objects must be memory aligned to the size of
+ *          @p stkalign_t type.
+ *
+ * @param[in] mp        pointer to a @p MemoryPool structure
+ * @param[in] objs      array of pointers to the objects to be released
+ * @param[in] n         number of objects to be released
+ *
+ * @api
+ */
+void chPoolFreeBatch(MemoryPool *mp, void *objs[], size_t n) {
+  struct pool_header *first, *last;
+  size_t i;
+
+  chDbgCheck((mp != NULL) && (objs != NULL), "chPoolFreeBatch");
+
+  if (n == 0)
+    return;
+  for (i = 0; i < n; i++)
+    chDbgCheck((objs[i] != NULL) && MEM_IS_ALIGNED(objs[i]),
+               "chPoolFreeBatch");
+  first = last = objs[0];
+  for (i = 1; i < n; i++)
+    last = last->ph_next = objs[i];
+
+  chSysLock();
+  last->ph_next = mp->mp_next;
+  mp->mp_next = first;
+  chSysUnlock();
+}
+
+#if CH_USE_POOL_MAGAZINES || defined(__DOXYGEN__)
+/**
+ * @brief   Initializes an empty magazine for a memory pool.
+ *
+ * @param[out] mgp      pointer to a @p PoolMagazine structure
+ * @param[in] mp        pointer to the cached @p MemoryPool
+ *
+ * @init
+ */
+void chPoolMagazineInit(PoolMagazine *mgp, MemoryPool *mp) {
+
+  chDbgCheck((mgp != NULL) && (mp != NULL), "chPoolMagazineInit");
+
+  mgp->mg_pool = mp;
+  mgp->mg_count = 0;
+}
+
+/**
+ * @brief   Allocates an object through a magazine.
+ * @details If the magazine is empty then it is refilled with half a
+ *          magazine of objects from the pool.
+ * @note    A magazine must only be used by its owner thread.
+ *
+ * @param[in] mgp       pointer to a @p PoolMagazine structure
+ * @return              The pointer to the allocated object.
+ * @retval NULL         if both the magazine and the pool are empty.
+ *
+ * @api
+ */
+void *chPoolMagazineAlloc(PoolMagazine *mgp) {
+
+  chDbgCheck(mgp != NULL, "chPoolMagazineAlloc");
+
+  if (mgp->mg_count == 0) {
+    mgp->mg_count = chPoolAllocBatch(mgp->mg_pool, mgp->mg_objs,
+                                     POOL_MAGAZINE_SIZE / 2);
+    if (mgp->mg_count == 0)
+      return NULL;
+  }
+  return mgp->mg_objs[--mgp->mg_count];
+}
+
+/**
+ * @brief   Releases an object through a magazine.
+ * @details If the magazine is full then half of its objects are returned
+ *          to the pool.
+ * @note    A magazine must only be used by its owner thread.
+ *
+ * @param[in] mgp       pointer to a @p PoolMagazine structure
+ * @param[in] objp      the pointer to the object to be released
+ *
+ * @api
+ */
+void chPoolMagazineFree(PoolMagazine *mgp, void *objp) {
+
+  chDbgCheck((mgp != NULL) && (objp != NULL) && MEM_IS_ALIGNED(objp),
+             "chPoolMagazineFree");
+
+  if (mgp->mg_count == POOL_MAGAZINE_SIZE) {
+    mgp->mg_count -= POOL_MAGAZINE_SIZE / 2;
+    chPoolFreeBatch(mgp->mg_pool, &mgp->mg_objs[mgp->mg_count],
+                    POOL_MAGAZINE_SIZE / 2);
+  }
+  mgp->mg_objs[mgp->mg_count++] = objp;
+}
+
+/**
+ * @brief   Returns all the objects cached in a magazine to the pool.
+ *
+ * @param[in] mgp       pointer to a @p PoolMagazine structure
+ *
+ * @api
+ */
+void chPoolMagazineFlush(PoolMagazine *mgp) {
+
+  chDbgCheck(mgp != NULL, "chPoolMagazineFlush");
+
+  chPoolFreeBatch(mgp->mg_pool, mgp->mg_objs, mgp->mg_count);
+  mgp->mg_count = 0;
+}
+#endif /* CH_USE_POOL_MAGAZINES */
 #endif /* CH_USE_MEMPOOLS */
 
 /** @} */
@@ -64,8 +64,25 @@
  *          The mechanism works with any number of nested mutexes and any
  *          number of involved threads. The algorithm complexity (worst case)
  *          is N with N equal to the number of nested mutexes.
+ *
+ *          <h2>Priority ceiling mutexes</h2>
+ *          Mutexes initialized using @p chMtxInitCeiling() implement the
+ *          <b>immediate</b> priority ceiling protocol instead.<br>
+ *          The locking thread is raised to the mutex ceiling, the highest
+ *          priority among the threads using the mutex, as soon as the mutex
+ *          is acquired and the priority is restored on unlock. While the
+ *          mutex is owned no other thread using it can run so, on a single
+ *          core and as long as the owner does not sleep, the mutex is always
+ *          found free and there are neither waiting queues nor inheritance
+ *          chains to be walked.<br>
+ *          If an owner sleeps while holding the mutex then a contending
+ *          thread is queued and the priority inheritance mechanism is used
+ *          as fallback.
  * @pre     In order to use the mutex APIs the @p CH_USE_MUTEXES option
  *          must be enabled in @p chconf.h.
+ * @pre     In order to use the priority ceiling mutexes the
+ *          @p CH_USE_MUTEXES_CEILING option must be enabled in
+ *          @p chconf.h.
  * @post    Enabling mutexes requires 5-12 (depending on the architecture)
  *          extra bytes in the @p Thread structure.
  * @{
@@ -75,6 +92,30 @@
 
 #if CH_USE_MUTEXES || defined(__DOXYGEN__)
 
+/*
+ * Priority of a mutexes owner, the highest among its base priority, the
+ * ceilings of the owned mutexes and the priorities of the threads waiting
+ * on them.
+ */
+static tprio_t owner_prio(Thread *tp) {
+  tprio_t prio = tp->p_realprio;
+  Mutex *mp = tp->p_mtxlist;
+
+  while (mp != NULL) {
+    /* If the highest priority thread waiting in the mutexes list has a
+       greater priority than the current thread base priority then the final
+       priority will have at least that priority.*/
+    if (chMtxQueueNotEmptyS(mp) && (mp->m_queue.p_next->p_prio > prio))
+      prio = mp->m_queue.p_next->p_prio;
+#if CH_USE_MUTEXES_CEILING
+    if (mp->m_ceiling > prio)
+      prio = mp->m_ceiling;
+#endif
+    mp = mp->m_next;
+  }
+  return prio;
+}
+
 /**
  * @brief   Initializes s @p Mutex structure.
  *
@@ -88,7 +129,38 @@ void chMtxInit(Mutex *mp) {
 
   queue_init(&mp->m_queue);
   mp->m_owner = NULL;
+#if CH_USE_MUTEXES_CEILING
+  mp->m_ceiling = 0;
+#endif
+}
+
+#if CH_USE_MUTEXES_CEILING || defined(__DOXYGEN__)
+/**
+ * @brief   Initializes s @p Mutex structure as a priority ceiling mutex.
+ * @details The mutex implements the immediate priority ceiling protocol,
+ *          the owner runs at the ceiling priority until the mutex is
+ *          unlocked.
+ * @pre     The configuration option @p CH_USE_MUTEXES_CEILING must be enabled
+ *          in order to use this function.
+ * @note    The ceiling must be equal or greater than the priority of all
+ *          the threads using the mutex.
+ *
+ * @param[out] mp       pointer to a @p Mutex structure
+ * @param[in] ceiling   the priority ceiling, usually the priority of the
+ *                      highest priority thread using the mutex
+ *
+ * @init
+ */
+void chMtxInitCeiling(Mutex *mp, tprio_t ceiling) {
+
+  chDbgCheck((mp != NULL) && (ceiling > IDLEPRIO) && (ceiling <= HIGHPRIO),
+             "chMtxInitCeiling");
+
+  queue_init(&mp->m_queue);
+  mp->m_owner = NULL;
+  mp->m_ceiling = ceiling;
 }
+#endif /* CH_USE_MUTEXES_CEILING */
 
 /**
  * @brief   Locks the specified mutex.
@@ -121,6 +193,11 @@ void chMtxLockS(Mutex *mp) {
   Thread *ctp = currp;
 
   chDbgCheck(mp != NULL, "chMtxLockS");
+#if CH_USE_MUTEXES_CEILING
+  chDbgAssert((mp->m_ceiling == 0) || (ctp->p_realprio <= mp->m_ceiling),
+              "chMtxLockS(), #3",
+              "ceiling violation");
+#endif
 
   /* Ia the mutex already locked? */
   if (mp->m_owner != NULL) {
@@ -131,6 +208,10 @@ void chMtxLockS(Mutex *mp) {
     /* Does the running thread have higher priority than the mutex
        ownning thread? */
     while (tp->p_prio < ctp->p_prio) {
+#if CH_OPTIMIZED_READYLIST
+      /* The ready list index refers to the priority before boosting.*/
+      tprio_t oldprio = tp->p_prio;
+#endif
       /* Make priority of thread tp match the running thread's priority.*/
       tp->p_prio = ctp->p_prio;
       /* The following states need priority queues reordering.*/
@@ -162,11 +243,16 @@ void chMtxLockS(Mutex *mp) {
         tp->p_state = THD_STATE_CURRENT;
 #endif
         /* Re-enqueues tp with its new priority on the ready list.*/
+#if CH_OPTIMIZED_READYLIST
+        chSchReadyI(readylist_remove(tp, oldprio));
+#else
         chSchReadyI(dequeue(tp));
+#endif
       }
       break;
     }
     /* Sleep on the mutex.*/
+    chDbgTraceEventI(TRACE_EV_MTX_WAIT, 0, mp, TRACE_ID(mp->m_owner));
     prio_insert(ctp, &mp->m_queue);
     ctp->p_u.wtobjp = mp;
     chSchGoSleepS(THD_STATE_WTMTX);
@@ -180,6 +266,13 @@ void chMtxLockS(Mutex *mp) {
     mp->m_owner = ctp;
     mp->m_next = ctp->p_mtxlist;
     ctp->p_mtxlist = mp;
+#if CH_USE_MUTEXES_CEILING
+    /* Immediate priority ceiling, while the priority is raised no other
+       thread using the mutex can run and contend it. The running thread
+       is not in the ready list so no reordering is required.*/
+    if (mp->m_ceiling > ctp->p_prio)
+      ctp->p_prio = mp->m_ceiling;
+#endif
   }
 }
 
@@ -237,6 +330,10 @@ bool_t chMtxTryLockS(Mutex *mp) {
   mp->m_owner = currp;
   mp->m_next = currp->p_mtxlist;
   currp->p_mtxlist = mp;
+#if CH_USE_MUTEXES_CEILING
+  if (mp->m_ceiling > currp->p_prio)
+    currp->p_prio = mp->m_ceiling;
+#endif
   return TRUE;
 }
 
@@ -252,7 +349,7 @@ bool_t chMtxTryLockS(Mutex *mp) {
  */
 Mutex *chMtxUnlock(void) {
   Thread *ctp = currp;
-  Mutex *ump, *mp;
+  Mutex *ump;
 
   chSysLock();
   chDbgAssert(ctp->p_mtxlist != NULL,
@@ -269,31 +366,33 @@ Mutex *chMtxUnlock(void) {
   if (chMtxQueueNotEmptyS(ump)) {
     Thread *tp;
 
-    /* Recalculates the optimal thread priority by scanning the owned
-       mutexes list.*/
-    tprio_t newprio = ctp->p_realprio;
-    mp = ctp->p_mtxlist;
-    while (mp != NULL) {
-      /* If the highest priority thread waiting in the mutexes list has a
-         greater priority than the current thread base priority then the final
-         priority will have at least that priority.*/
-      if (chMtxQueueNotEmptyS(mp) && (mp->m_queue.p_next->p_prio > newprio))
-        newprio = mp->m_queue.p_next->p_prio;
-      mp = mp->m_next;
-    }
     /* Assigns to the current thread the highest priority among all the
-       waiting threads.*/
-    ctp->p_prio = newprio;
+       waiting threads and ceilings by scanning the owned mutexes list.*/
+    ctp->p_prio = owner_prio(ctp);
     /* Awakens the highest priority thread waiting for the unlocked mutex and
        assigns the mutex to it.*/
     tp = fifo_remove(&ump->m_queue);
     ump->m_owner = tp;
     ump->m_next = tp->p_mtxlist;
     tp->p_mtxlist = ump;
+#if CH_USE_MUTEXES_CEILING
+    if (ump->m_ceiling > tp->p_prio)
+      tp->p_prio = ump->m_ceiling;
+#endif
+    chDbgTraceEventI(TRACE_EV_MTX_UNLOCK, 0, ump, TRACE_ID(tp));
     chSchWakeupS(tp, RDY_OK);
   }
-  else
+  else {
     ump->m_owner = NULL;
+#if CH_USE_MUTEXES_CEILING
+    if (ump->m_ceiling != 0) {
+      /* Drops the ceiling, with no other owned mutexes this is just the
+         thread base priority.*/
+      ctp->p_prio = owner_prio(ctp);
+      chSchRescheduleS();
+    }
+#endif
+  }
   chSysUnlock();
   return ump;
 }
@@ -312,7 +411,7 @@ Mutex *chMtxUnlock(void) {
  */
 Mutex *chMtxUnlockS(void) {
   Thread *ctp = currp;
-  Mutex *ump, *mp;
+  Mutex *ump;
 
   chDbgAssert(ctp->p_mtxlist != NULL,
               "chMtxUnlockS(), #1",
@@ -331,27 +430,27 @@ Mutex *chMtxUnlockS(void) {
 
     /* Recalculates the optimal thread priority by scanning the owned
        mutexes list.*/
-    tprio_t newprio = ctp->p_realprio;
-    mp = ctp->p_mtxlist;
-    while (mp != NULL) {
-      /* If the highest priority thread waiting in the mutexes list has a
-         greater priority than the current thread base priority then the final
-         priority will have at least that priority.*/
-      if (chMtxQueueNotEmptyS(mp) && (mp->m_queue.p_next->p_prio > newprio))
-        newprio = mp->m_queue.p_next->p_prio;
-      mp = mp->m_next;
-    }
-    ctp->p_prio = newprio;
+    ctp->p_prio = owner_prio(ctp);
     /* Awakens the highest priority thread waiting for the unlocked mutex and
        assigns the mutex to it.*/
     tp = fifo_remove(&ump->m_queue);
     ump->m_owner = tp;
     ump->m_next = tp->p_mtxlist;
     tp->p_mtxlist = ump;
+#if CH_USE_MUTEXES_CEILING
+    if (ump->m_ceiling > tp->p_prio)
+      tp->p_prio = ump->m_ceiling;
+#endif
+    chDbgTraceEventI(TRACE_EV_MTX_UNLOCK, 0, ump, TRACE_ID(tp));
     chSchReadyI(tp);
   }
-  else
+  else {
     ump->m_owner = NULL;
+#if CH_USE_MUTEXES_CEILING
+    if (ump->m_ceiling != 0)
+      ctp->p_prio = owner_prio(ctp);
+#endif
+  }
   return ump;
 }
 
@@ -379,6 +478,11 @@ void chMtxUnlockAll(void) {
         ump->m_owner = tp;
         ump->m_next = tp->p_mtxlist;
         tp->p_mtxlist = ump;
+#if CH_USE_MUTEXES_CEILING
+        if (ump->m_ceiling > tp->p_prio)
+          tp->p_prio = ump->m_ceiling;
+#endif
+        chDbgTraceEventI(TRACE_EV_MTX_UNLOCK, 0, ump, TRACE_ID(tp));
         chSchReadyI(tp);
       }
       else
@@ -53,6 +53,76 @@
 
 #if CH_USE_QUEUES || defined(__DOXYGEN__)
 
+#if (CH_QUEUES_MAX_CHUNK > 1) || defined(__DOXYGEN__)
+#include <string.h>
+
+/**
+ * @brief   Reads a chunk of data from a queue buffer.
+ * @details The transferred size is limited by the queue counter and by
+ *          @p CH_QUEUES_MAX_CHUNK, the wraparound of the circular buffer
+ *          is handled using at most two copy operations.
+ *
+ * @param[in] qp        pointer to a @p GenericQueue structure, the
+ *                      counter must represent the filled bytes
+ * @param[out] bp       pointer to the data buffer
+ * @param[in] n         the maximum amount of data to be transferred
+ * @return              The number of bytes transferred.
+ */
+static size_t qread(GenericQueue *qp, uint8_t *bp, size_t n) {
+  size_t s1;
+
+  if (n > CH_QUEUES_MAX_CHUNK)
+    n = CH_QUEUES_MAX_CHUNK;
+  if (n > chQSpaceI(qp))
+    n = chQSpaceI(qp);
+  s1 = qp->q_top - qp->q_rdptr;
+  if (n < s1) {
+    memcpy(bp, qp->q_rdptr, n);
+    qp->q_rdptr += n;
+  }
+  else {
+    memcpy(bp, qp->q_rdptr, s1);
+    memcpy(bp + s1, qp->q_buffer, n - s1);
+    qp->q_rdptr = qp->q_buffer + (n - s1);
+  }
+  qp->q_counter -= n;
+  return n;
+}
+
+/**
+ * @brief   Writes a chunk of data into a queue buffer.
+ * @details The transferred size is limited by the queue counter and by
+ *          @p CH_QUEUES_MAX_CHUNK, the wraparound of the circular buffer
+ *          is handled using at most two copy operations.
+ *
+ * @param[in] qp        pointer to a @p GenericQueue structure, the
+ *                      counter must represent the empty bytes
+ * @param[in] bp        pointer to the data buffer
+ * @param[in] n         the maximum amount of data to be transferred
+ * @return              The number of bytes transferred.
+ */
+static size_t qwrite(GenericQueue *qp, const uint8_t *bp, size_t n) {
+  size_t s1;
+
+  if (n > CH_QUEUES_MAX_CHUNK)
+    n = CH_QUEUES_MAX_CHUNK;
+  if (n > chQSpaceI(qp))
+    n = chQSpaceI(qp);
+  s1 = qp->q_top - qp->q_wrptr;
+  if (n < s1) {
+    memcpy(qp->q_wrptr, bp, n);
+    qp->q_wrptr += n;
+  }
+  else {
+    memcpy(qp->q_wrptr, bp, s1);
+    memcpy(qp->q_buffer, bp + s1, n - s1);
+    qp->q_wrptr = qp->q_buffer + (n - s1);
+  }
+  qp->q_counter -= n;
+  return n;
+}
+#endif /* CH_QUEUES_MAX_CHUNK > 1 */
+
 /**
  * @brief   Puts the invoking thread into the queue's threads queue.
  *
@@ -206,6 +276,8 @@ msg_t chIQGetTimeout(InputQueue *iqp, systime_t time) {
  * @note    The callback is invoked if the queue is empty before entering the
  *          @p THD_STATE_WTQUEUE state in order to solicit the low level to
  *          start queue filling.
+ * @note    The data is moved in chunks of up to @p CH_QUEUES_MAX_CHUNK
+ *          bytes, each chunk within its own critical section.
  *
  * @param[in] iqp       pointer to an @p InputQueue structure
  * @param[out] bp       pointer to the data buffer
@@ -239,6 +311,18 @@ size_t chIQReadTimeout(InputQueue *iqp, uint8_t *bp,
       }
     }
 
+#if CH_QUEUES_MAX_CHUNK > 1
+    {
+      size_t done = qread((GenericQueue *)iqp, bp, n);
+
+      chSysUnlock(); /* Gives a preemption chance in a controlled point.*/
+      bp += done;
+      r += done;
+      n -= done;
+    }
+    if (n == 0)
+      return r;
+#else
     iqp->q_counter--;
     *bp++ = *iqp->q_rdptr++;
     if (iqp->q_rdptr >= iqp->q_top)
@@ -248,6 +332,7 @@ size_t chIQReadTimeout(InputQueue *iqp, uint8_t *bp,
     r++;
     if (--n == 0)
       return r;
+#endif
 
     chSysLock();
   }
@@ -377,8 +462,9 @@ msg_t chOQGetI(OutputQueue *oqp) {
  *          been reset.
  * @note    The function is not atomic, if you need atomicity it is suggested
  *          to use a semaphore or a mutex for mutual exclusion.
- * @note    The callback is invoked after writing each character into the
- *          buffer.
+ * @note    The callback is invoked after writing each chunk of up to
+ *          @p CH_QUEUES_MAX_CHUNK bytes into the buffer, each chunk is
+ *          written within its own critical section.
  *
  * @param[in] oqp       pointer to an @p OutputQueue structure
  * @param[out] bp       pointer to the data buffer
@@ -408,6 +494,21 @@ size_t chOQWriteTimeout(OutputQueue *oqp, const uint8_t *bp,
         return w;
       }
     }
+#if CH_QUEUES_MAX_CHUNK > 1
+    {
+      size_t done = qwrite((GenericQueue *)oqp, bp, n);
+
+      if (nfy)
+        nfy(oqp);
+
+      chSysUnlock(); /* Gives a preemption chance in a controlled point.*/
+      bp += done;
+      w += done;
+      n -= done;
+    }
+    if (n == 0)
+      return w;
+#else
     oqp->q_counter--;
     *oqp->q_wrptr++ = *bp++;
     if (oqp->q_wrptr >= oqp->q_top)
@@ -420,6 +521,7 @@ size_t chOQWriteTimeout(OutputQueue *oqp, const uint8_t *bp,
     w++;
     if (--n == 0)
       return w;
+#endif
     chSysLock();
   }
 }
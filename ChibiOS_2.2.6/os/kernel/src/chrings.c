@@ -0,0 +1,228 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,2011 Giovanni Di Sirio.
+
+    This file is part of ChibiOS/RT.
+
+    ChibiOS/RT is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/RT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+                                      ---
+
+    A special exception to the GPL can be applied should you wish to distribute
+    a combined work that includes ChibiOS/RT, without being obliged to provide
+    the source code for any proprietary components. See the file exception.txt
+    for full details of how and when the exception can be applied.
+*/
+
+/**
+ * @file    chrings.c
+ * @brief   Single producer single consumer rings code.
+ *
+ * @addtogroup rings
+ * @details Lock-free records streaming.
+ *          <h2>Operation mode</h2>
+ *          A ring is a circular buffer of fixed size records with exactly
+ *          one producer and one consumer, for example an interrupt handler
+ *          and a thread. Records are transferred without entering the
+ *          kernel, the indexes are exchanged using acquire/release ordering
+ *          only.<br>
+ *          The consumer can block when the ring is empty, the producer rings
+ *          a doorbell only when it writes into an empty ring, the doorbell
+ *          signals a binary semaphore and broadcasts an event source.<br>
+ *          Operations defined for rings:
+ *          - <b>Write</b>: Wait-free record write, usable also from
+ *            contexts that cannot invoke the kernel.
+ *          - <b>Put</b>: Record write ringing the doorbell when required.
+ *          - <b>Read</b>: Wait-free record read.
+ *          - <b>Get</b>: Record read waiting on the doorbell if the ring is
+ *            empty.
+ *          .
+ * @pre     In order to use the rings APIs the @p CH_USE_RINGS option must
+ *          be enabled in @p chconf.h.
+ * @{
+ */
+
+#include <string.h>
+
+#include "ch.h"
+
+#if CH_USE_RINGS || defined(__DOXYGEN__)
+/**
+ * @brief   Initializes a @p Ring object.
+ *
+ * @param[out] rp       pointer to a @p Ring structure
+ * @param[in] buf       pointer to the records buffer
+ * @param[in] size      size of a record
+ * @param[in] n         number of records in the buffer, it must be a power
+ *                      of two
+ *
+ * @init
+ */
+void chRingInit(Ring *rp, void *buf, size_t size, cnt_t n) {
+
+  chDbgCheck((rp != NULL) && (buf != NULL) && (size > 0) &&
+             (n > 0) && ((n & (n - 1)) == 0), "chRingInit");
+
+  rp->r_buffer = buf;
+  rp->r_size = size;
+  rp->r_mask = (uint32_t)n - 1;
+  rp->r_head = rp->r_tail = 0;
+  chBSemInit(&rp->r_doorbell, TRUE);
+#if CH_USE_EVENTS
+  chEvtInit(&rp->r_event);
+#endif
+}
+
+/**
+ * @brief   Writes a record into a ring.
+ * @details The function is wait-free and does not invoke the kernel, it
+ *          can be used from any context including foreign threads and
+ *          interrupt handlers not allowed to use the kernel APIs. When the
+ *          ring was empty the caller is responsible for invoking
+ *          @p chRingDoorbellI() from a context where it is allowed.
+ * @note    Must be invoked only by the producer.
+ *
+ * @param[in] rp        pointer to a @p Ring structure
+ * @param[in] recp      pointer to the record to be written
+ * @return              The operation status.
+ * @retval RING_OK      if the record has been written.
+ * @retval RING_WAS_EMPTY if the record has been written into an empty ring.
+ * @retval RING_FULL    if the ring is full.
+ */
+msg_t chRingWrite(Ring *rp, const void *recp) {
+  uint32_t head = rp->r_head;
+
+  if (head - RING_LOAD_ACQUIRE(&rp->r_tail) > rp->r_mask)
+    return RING_FULL;
+  memcpy(rp->r_buffer + (head & rp->r_mask) * rp->r_size, recp, rp->r_size);
+  RING_STORE_RELEASE(&rp->r_head, head + 1);
+  /* The fence orders the index store before the following load, pairing
+     with the consumer that loads the write index after storing the read
+     index, at least one side sees the other's store.*/
+  RING_FENCE();
+  if (RING_LOAD_ACQUIRE(&rp->r_tail) == head)
+    return RING_WAS_EMPTY;
+  return RING_OK;
+}
+
+/**
+ * @brief   Reads a record from a ring.
+ * @details The function is wait-free and does not invoke the kernel.
+ * @note    Must be invoked only by the consumer.
+ *
+ * @param[in] rp        pointer to a @p Ring structure
+ * @param[out] recp     pointer to the record buffer
+ * @return              The operation status.
+ * @retval TRUE         if a record has been read.
+ * @retval FALSE        if the ring is empty.
+ */
+bool_t chRingRead(Ring *rp, void *recp) {
+  uint32_t tail = rp->r_tail;
+
+  if (RING_LOAD_ACQUIRE(&rp->r_head) == tail) {
+    RING_FENCE();
+    if (RING_LOAD_ACQUIRE(&rp->r_head) == tail)
+      return FALSE;
+  }
+  memcpy(recp, rp->r_buffer + (tail & rp->r_mask) * rp->r_size, rp->r_size);
+  RING_STORE_RELEASE(&rp->r_tail, tail + 1);
+  return TRUE;
+}
+
+/**
+ * @brief   Rings the doorbell of a ring.
+ * @details The doorbell semaphore is signaled and the event source, if
+ *          any, is broadcast.
+ * @post    This function does not reschedule so a call to a rescheduling
+ *          function must be performed before unlocking the kernel. Note that
+ *          interrupt handlers always reschedule on exit so an explicit
+ *          reschedule must not be performed in ISRs.
+ *
+ * @param[in] rp        pointer to a @p Ring structure
+ *
+ * @iclass
+ */
+void chRingDoorbellI(Ring *rp) {
+
+  chDbgCheck(rp != NULL, "chRingDoorbellI");
+
+  chBSemSignalI(&rp->r_doorbell);
+#if CH_USE_EVENTS
+  chEvtBroadcastI(&rp->r_event);
+#endif
+}
+
+/**
+ * @brief   Puts a record into a ring.
+ * @details The record is written using @p chRingWrite() and the doorbell
+ *          is rung if the ring was empty.
+ * @note    Must be invoked only by the producer.
+ *
+ * @param[in] rp        pointer to a @p Ring structure
+ * @param[in] recp      pointer to the record to be written
+ * @return              The operation status.
+ * @retval RING_OK      if the record has been written.
+ * @retval RING_FULL    if the ring is full.
+ *
+ * @iclass
+ */
+msg_t chRingPutI(Ring *rp, const void *recp) {
+  msg_t msg;
+
+  chDbgCheck((rp != NULL) && (recp != NULL), "chRingPutI");
+
+  msg = chRingWrite(rp, recp);
+  if (msg == RING_WAS_EMPTY) {
+    chRingDoorbellI(rp);
+    msg = RING_OK;
+  }
+  return msg;
+}
+
+/**
+ * @brief   Gets a record from a ring.
+ * @details If the ring is empty the invoking thread waits on the doorbell
+ *          until a record is written or the specified time runs out.
+ * @note    Must be invoked only by the consumer.
+ *
+ * @param[in] rp        pointer to a @p Ring structure
+ * @param[out] recp     pointer to the record buffer
+ * @param[in] time      the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval RDY_OK       if a record has been read.
+ * @retval RDY_RESET    if the doorbell semaphore has been reset.
+ * @retval RDY_TIMEOUT  if the operation has timed out.
+ *
+ * @api
+ */
+msg_t chRingGetTimeout(Ring *rp, void *recp, systime_t time) {
+
+  chDbgCheck((rp != NULL) && (recp != NULL), "chRingGetTimeout");
+
+  /* A doorbell rung after a failed read leaves the semaphore signaled,
+     the wait then returns immediately and the read is retried.*/
+  while (!chRingRead(rp, recp)) {
+    msg_t msg = chBSemWaitTimeout(&rp->r_doorbell, time);
+
+    if (msg != RDY_OK)
+      return msg;
+  }
+  return RDY_OK;
+}
+#endif /* CH_USE_RINGS */
+
+/** @} */
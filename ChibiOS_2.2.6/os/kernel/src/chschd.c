@@ -61,7 +61,126 @@ void scheduler_init(void) {
 #if CH_USE_REGISTRY
   rlist.r_newer = rlist.r_older = (Thread *)&rlist;
 #endif
+#if CH_DBG_THREADS_ACCOUNTING
+  rlist.r_switched = port_rt_get_counter_value();
+#endif
+#if CH_OPTIMIZED_READYLIST
+  {
+    unsigned i;
+
+    rlist.r_summary = 0;
+    for (i = 0; i < RL_BITMAP_WORDS; i++)
+      rlist.r_bitmap[i] = 0;
+  }
+#endif
+}
+
+#if CH_OPTIMIZED_READYLIST || defined(__DOXYGEN__)
+/**
+ * @brief   Index of the least significant bit set in a non-zero word.
+ * @note    The port layer can provide an optimized @p port_ctz() macro.
+ */
+#if defined(port_ctz)
+#define rl_ctz(w) port_ctz(w)
+#elif defined(__GNUC__)
+#define rl_ctz(w) ((unsigned)__builtin_ctzl((unsigned long)(w)))
+#else
+static unsigned rl_ctz(uint32_t w) {
+  unsigned n = 0;
+
+  while ((w & 1) == 0) {
+    w >>= 1;
+    n++;
+  }
+  return n;
+}
+#endif
+
+/**
+ * @brief   Returns the lowest non-empty priority level above @p prio.
+ * @details The search is performed on the priorities bitmap, the summary
+ *          word makes the operation O(1).
+ *
+ * @param[in] prio      the reference priority
+ * @return              The found priority level.
+ * @retval NOPRIO       if there are no ready threads above @p prio.
+ */
+static tprio_t rl_next(tprio_t prio) {
+  unsigned w = prio >> 5;
+  uint32_t bits;
+
+  /* Levels above prio in the same bitmap word, note that the mask is zero
+     when prio is the last level of the word.*/
+  bits = rlist.r_bitmap[w] & ~(((uint32_t)2 << (prio & 31)) - 1);
+  if (bits)
+    return (tprio_t)((w << 5) + rl_ctz(bits));
+  bits = rlist.r_summary & ~(((uint32_t)2 << w) - 1);
+  if (!bits)
+    return NOPRIO;
+  w = rl_ctz(bits);
+  return (tprio_t)((w << 5) + rl_ctz(rlist.r_bitmap[w]));
+}
+
+/**
+ * @brief   Inserts a thread in the indexed ready list.
+ * @details The thread is inserted after the last thread having its same
+ *          priority or, if there is none, after the last thread of the
+ *          nearest higher priority level.
+ * @note    The thread state is not modified.
+ *
+ * @param[in] tp        the thread to be inserted
+ * @return              The thread pointer.
+ *
+ * @notapi
+ */
+Thread *readylist_insert(Thread *tp) {
+  tprio_t prio = tp->p_prio;
+  Thread *cp;
+
+  if (rlist.r_bitmap[prio >> 5] & ((uint32_t)1 << (prio & 31)))
+    cp = rlist.r_last[prio];
+  else {
+    tprio_t next = rl_next(prio);
+
+    cp = next != NOPRIO ? rlist.r_last[next] : (Thread *)&rlist.r_queue;
+    rlist.r_bitmap[prio >> 5] |= (uint32_t)1 << (prio & 31);
+    rlist.r_summary |= (uint32_t)1 << (prio >> 5);
+  }
+  rlist.r_last[prio] = tp;
+  /* Insertion on p_next.*/
+  tp->p_prev = cp;
+  tp->p_next = cp->p_next;
+  tp->p_next->p_prev = cp->p_next = tp;
+  return tp;
+}
+
+/**
+ * @brief   Removes a thread from the indexed ready list.
+ * @note    The priority is passed explicitly because the priority of a
+ *          ready thread can be modified before its removal, the index
+ *          is organized on the priority used at insertion time.
+ *
+ * @param[in] tp        the thread to be removed
+ * @param[in] prio      the priority of the thread when it was inserted
+ * @return              The removed thread pointer.
+ *
+ * @notapi
+ */
+Thread *readylist_remove(Thread *tp, tprio_t prio) {
+
+  if (rlist.r_last[prio] == tp) {
+    /* The list header has NOPRIO so it never matches.*/
+    if (tp->p_prev->p_prio == prio)
+      rlist.r_last[prio] = tp->p_prev;
+    else {
+      rlist.r_bitmap[prio >> 5] &= ~((uint32_t)1 << (prio & 31));
+      if (!rlist.r_bitmap[prio >> 5])
+        rlist.r_summary &= ~((uint32_t)1 << (prio >> 5));
+    }
+  }
+  return dequeue(tp);
 }
+#endif /* CH_OPTIMIZED_READYLIST */
 
 /**
  * @brief   Inserts a thread in the Ready List.
@@ -79,7 +198,9 @@ void scheduler_init(void) {
  */
 #if !defined(PORT_OPTIMIZED_READYI) || defined(__DOXYGEN__)
 Thread *chSchReadyI(Thread *tp) {
+#if !CH_OPTIMIZED_READYLIST
   Thread *cp;
+#endif
 
   /* Integrity check.*/
   chDbgAssert((tp->p_state != THD_STATE_READY) &&
@@ -88,6 +209,9 @@ Thread *chSchReadyI(Thread *tp) {
               "invalid state");
 
   tp->p_state = THD_STATE_READY;
+#if CH_OPTIMIZED_READYLIST
+  return readylist_insert(tp);
+#else
   cp = (Thread *)&rlist.r_queue;
   do {
     cp = cp->p_next;
@@ -97,6 +221,7 @@ Thread *chSchReadyI(Thread *tp) {
   tp->p_prev = cp->p_prev;
   tp->p_prev->p_next = cp->p_prev = tp;
   return tp;
+#endif
 }
 #endif /* !defined(PORT_OPTIMIZED_READYI) */
 
@@ -117,7 +242,7 @@ void chSchGoSleepS(tstate_t newstate) {
 #if CH_TIME_QUANTUM > 0
   rlist.r_preempt = CH_TIME_QUANTUM;
 #endif
-  setcurrp(fifo_remove(&rlist.r_queue));
+  setcurrp(readylist_fifo_remove());
   currp->p_state = THD_STATE_CURRENT;
   chDbgTrace(otp);
   chSysSwitchI(currp, otp);
@@ -250,7 +375,7 @@ void chSchDoRescheduleI(void) {
 #endif
   otp = currp;
   /* Picks the first thread from the ready queue and makes it current.*/
-  setcurrp(fifo_remove(&rlist.r_queue));
+  setcurrp(readylist_fifo_remove());
   currp->p_state = THD_STATE_CURRENT;
   chSchReadyI(otp);
   chDbgTrace(otp);
@@ -191,6 +191,7 @@ msg_t chSemWaitS(Semaphore *sp) {
               "inconsistent semaphore");
 
   if (--sp->s_cnt < 0) {
+    chDbgTraceEventI(TRACE_EV_SEM_WAIT, 0, sp, 0);
     currp->p_u.wtobjp = sp;
     sem_insert(currp, &sp->s_queue);
     chSchGoSleepS(THD_STATE_WTSEM);
@@ -260,6 +261,7 @@ msg_t chSemWaitTimeoutS(Semaphore *sp, systime_t time) {
       sp->s_cnt++;
       return RDY_TIMEOUT;
     }
+    chDbgTraceEventI(TRACE_EV_SEM_WAIT, 0, sp, 0);
     currp->p_u.wtobjp = sp;
     sem_insert(currp, &sp->s_queue);
     return chSchGoSleepTimeoutS(THD_STATE_WTSEM, time);
@@ -284,8 +286,11 @@ void chSemSignal(Semaphore *sp) {
               "inconsistent semaphore");
 
   chSysLock();
-  if (++sp->s_cnt <= 0)
-    chSchWakeupS(fifo_remove(&sp->s_queue), RDY_OK);
+  if (++sp->s_cnt <= 0) {
+    Thread *tp = fifo_remove(&sp->s_queue);
+    chDbgTraceEventI(TRACE_EV_SEM_SIGNAL, 0, sp, TRACE_ID(tp));
+    chSchWakeupS(tp, RDY_OK);
+  }
   chSysUnlock();
 }
 
@@ -313,11 +318,46 @@ void chSemSignalI(Semaphore *sp) {
     /* note, it is done this way in order to allow a tail call on
              chSchReadyI().*/
     Thread *tp = fifo_remove(&sp->s_queue);
+    chDbgTraceEventI(TRACE_EV_SEM_SIGNAL, 0, sp, TRACE_ID(tp));
     tp->p_u.rdymsg = RDY_OK;
     chSchReadyI(tp);
   }
 }
 
+/**
+ * @brief   Adds the specified value to the semaphore counter.
+ * @details This function is equivalent to @p n invocations of
+ *          @p chSemSignalI(), up to @p n waiting threads are readied.
+ * @post    This function does not reschedule so a call to a rescheduling
+ *          function must be performed before unlocking the kernel. Note that
+ *          interrupt handlers always reschedule on exit so an explicit
+ *          reschedule must not be performed in ISRs.
+ *
+ * @param[in] sp        pointer to a @p Semaphore structure
+ * @param[in] n         value to be added to the semaphore counter. The value
+ *                      must be positive.
+ *
+ * @iclass
+ */
+void chSemAddCounterI(Semaphore *sp, cnt_t n) {
+
+  chDbgCheck((sp != NULL) && (n > 0), "chSemAddCounterI");
+
+  chDbgAssert(((sp->s_cnt >= 0) && isempty(&sp->s_queue)) ||
+              ((sp->s_cnt < 0) && notempty(&sp->s_queue)),
+              "chSemAddCounterI(), #1",
+              "inconsistent semaphore");
+
+  while (n > 0) {
+    if (++sp->s_cnt <= 0) {
+      Thread *tp = fifo_remove(&sp->s_queue);
+      chDbgTraceEventI(TRACE_EV_SEM_SIGNAL, 0, sp, TRACE_ID(tp));
+      chSchReadyI(tp)->p_u.rdymsg = RDY_OK;
+    }
+    n--;
+  }
+}
+
 /**
  * @brief   Sets the semaphore counter to the specified value.
  * @post    After invoking this function all the threads waiting on the
@@ -382,10 +422,14 @@ msg_t chSemSignalWait(Semaphore *sps, Semaphore *spw) {
               "inconsistent semaphore");
 
   chSysLock();
-  if (++sps->s_cnt <= 0)
-    chSchReadyI(fifo_remove(&sps->s_queue))->p_u.rdymsg = RDY_OK;
+  if (++sps->s_cnt <= 0) {
+    Thread *tp = fifo_remove(&sps->s_queue);
+    chDbgTraceEventI(TRACE_EV_SEM_SIGNAL, 0, sps, TRACE_ID(tp));
+    chSchReadyI(tp)->p_u.rdymsg = RDY_OK;
+  }
   if (--spw->s_cnt < 0) {
     Thread *ctp = currp;
+    chDbgTraceEventI(TRACE_EV_SEM_WAIT, 0, spw, 0);
     sem_insert(ctp, &spw->s_queue);
     ctp->p_u.wtobjp = spw;
     chSchGoSleepS(THD_STATE_WTSEM);
@@ -110,6 +110,31 @@ void chSysInit(void) {
 #endif
 }
 
+#if CH_DBG_THREADS_ACCOUNTING || defined(__DOXYGEN__)
+/**
+ * @brief   Accounts the time spent by a thread being switched out.
+ * @details The run burst of the thread being switched out is measured
+ *          using the port realtime counter and added to its runtime.
+ * @note    This function is invoked by @p chSysSwitchI(), it should never
+ *          be used from user code directly.
+ *
+ * @param[in] ntp       the thread to be switched in
+ * @param[in] otp       the thread to be switched out
+ *
+ * @special
+ */
+void _sys_switch_accounting(Thread *ntp, Thread *otp) {
+  rtcnt_t now = port_rt_get_counter_value();
+  rtcnt_t burst = now - rlist.r_switched;
+
+  otp->p_runtime += burst;
+  if (burst > otp->p_maxburst)
+    otp->p_maxburst = burst;
+  ntp->p_switches++;
+  rlist.r_switched = now;
+}
+#endif /* CH_DBG_THREADS_ACCOUNTING */
+
 /**
  * @brief   Handles time ticks for round robin preemption and timer increments.
  * @details Decrements the remaining time quantum of the running thread
@@ -118,6 +143,8 @@ void chSysInit(void) {
  * @note    The frequency of the timer determines the system tick granularity
  *          and, together with the @p CH_TIME_QUANTUM macro, the round robin
  *          interval.
+ * @note    In tickless mode this function is invoked by the port when the
+ *          virtual timers alarm fires, not periodically.
  *
  * @iclass
  */
@@ -92,9 +92,17 @@ Thread *_thread_init(Thread *tp, tprio_t prio) {
 #if CH_DBG_THREADS_PROFILING
   tp->p_time = 0;
 #endif
+#if CH_DBG_THREADS_ACCOUNTING
+  tp->p_runtime = 0;
+  tp->p_switches = 0;
+  tp->p_maxburst = 0;
+#endif
 #if CH_USE_DYNAMIC
   tp->p_refs = 1;
 #endif
+#if CH_USE_POOL_MAGAZINES
+  tp->p_magazine = NULL;
+#endif
 #if CH_USE_WAITEXIT
   list_init(&tp->p_waiting);
 #endif
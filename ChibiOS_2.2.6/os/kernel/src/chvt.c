@@ -48,10 +48,67 @@ VTList vtlist;
  */
 void vt_init(void) {
 
+#if !CH_USE_VT_WHEEL
   vtlist.vt_next = vtlist.vt_prev = (void *)&vtlist;
   vtlist.vt_time = (systime_t)-1;
+#else
+  {
+    unsigned level, idx;
+
+    for (level = 0; level < VT_WHEEL_LEVELS; level++)
+      for (idx = 0; idx < VT_WHEEL_SLOTS; idx++) {
+        VTSlot *sp = &vtlist.vt_wheel[level][idx];
+
+        sp->vt_next = sp->vt_prev = (VirtualTimer *)sp;
+      }
+    vtlist.vt_armed = 0;
+  }
+#endif
+#if !CH_USE_TICKLESS
   vtlist.vt_systime = 0;
+#else
+  vtlist.vt_lasttime = 0;
+#endif
+}
+
+#if CH_USE_VT_WHEEL || defined(__DOXYGEN__)
+/**
+ * @brief   Inserts a timer in the wheel slot of its expiration time.
+ * @details The level is chosen by the distance between the expiration time
+ *          and the current system time, the slot by the expiration time
+ *          bits covered by that level. Timers in the upper levels are moved
+ *          toward the lower levels each time a lower level wraps.
+ *
+ * @param[in] vtp       the @p VirtualTimer structure pointer, the
+ *                      @p vt_time field contains the absolute expiration
+ *                      time
+ */
+static void wheel_insert(VirtualTimer *vtp) {
+  systime_t time = vtp->vt_time;
+  systime_t delta = time - vtlist.vt_systime;
+  unsigned level = 0;
+  VTSlot *sp;
+
+  while ((level < VT_WHEEL_LEVELS - 1) && ((delta >>= VT_WHEEL_BITS) != 0)) {
+    time >>= VT_WHEEL_BITS;
+    level++;
+  }
+  sp = &vtlist.vt_wheel[level][time & (VT_WHEEL_SLOTS - 1)];
+  vtp->vt_prev = sp->vt_prev;
+  vtp->vt_next = (VirtualTimer *)sp;
+  vtp->vt_prev->vt_next = sp->vt_prev = vtp;
+}
+
+/**
+ * @brief   Removes a timer from its wheel slot.
+ *
+ * @param[in] vtp       the @p VirtualTimer structure pointer
+ */
+#define wheel_remove(vtp) {                                             \
+  (vtp)->vt_prev->vt_next = (vtp)->vt_next;                             \
+  (vtp)->vt_next->vt_prev = (vtp)->vt_prev;                             \
 }
+#endif /* CH_USE_VT_WHEEL */
 
 /**
  * @brief   Enables a virtual timer.
@@ -74,13 +131,39 @@ void vt_init(void) {
  * @iclass
  */
 void chVTSetI(VirtualTimer *vtp, systime_t time, vtfunc_t vtfunc, void *par) {
+#if !CH_USE_VT_WHEEL
   VirtualTimer *p;
+#endif
 
   chDbgCheck((vtp != NULL) && (vtfunc != NULL) && (time != TIME_IMMEDIATE),
              "chVTSetI");
 
   vtp->vt_par = par;
   vtp->vt_func = vtfunc;
+#if CH_USE_VT_WHEEL
+  vtp->vt_time = vtlist.vt_systime + time;
+  wheel_insert(vtp);
+  vtlist.vt_armed++;
+#else /* !CH_USE_VT_WHEEL */
+#if CH_USE_TICKLESS
+  {
+    systime_t now = port_timer_get_time();
+
+    if (&vtlist == (VTList *)vtlist.vt_next) {
+      /* Empty list, the deltas base is moved to the current time.*/
+      vtlist.vt_lasttime = now;
+      port_timer_set_alarm(now + time);
+    }
+    else {
+      /* The delay is made relative to the deltas base, saturating.*/
+      systime_t offset = now - vtlist.vt_lasttime;
+
+      time = time > (systime_t)-1 - offset ? (systime_t)-1 : time + offset;
+      if (time < vtlist.vt_next->vt_time)
+        port_timer_set_alarm(vtlist.vt_lasttime + time);
+    }
+  }
+#endif
   p = vtlist.vt_next;
   while (p->vt_time < time) {
     time -= p->vt_time;
@@ -92,6 +175,7 @@ void chVTSetI(VirtualTimer *vtp, systime_t time, vtfunc_t vtfunc, void *par) {
   vtp->vt_time = time;
   if (p != (void *)&vtlist)
     p->vt_time -= time;
+#endif /* !CH_USE_VT_WHEEL */
 }
 
 /**
@@ -109,12 +193,137 @@ void chVTResetI(VirtualTimer *vtp) {
               "chVTResetI(), #1",
               "timer not set or already triggered");
 
+#if CH_USE_VT_WHEEL
+  wheel_remove(vtp);
+  vtp->vt_func = (vtfunc_t)NULL;
+  vtlist.vt_armed--;
+#else /* !CH_USE_VT_WHEEL */
   if (vtp->vt_next != (void *)&vtlist)
     vtp->vt_next->vt_time += vtp->vt_time;
   vtp->vt_prev->vt_next = vtp->vt_next;
   vtp->vt_next->vt_prev = vtp->vt_prev;
   vtp->vt_func = (vtfunc_t)NULL;
+#if CH_USE_TICKLESS
+  /* If the first timer has been removed then the alarm is moved to the new
+     first deadline, the deltas base does not change.*/
+  if (vtp->vt_prev == (void *)&vtlist) {
+    if (&vtlist == (VTList *)vtlist.vt_next)
+      port_timer_stop_alarm();
+    else
+      port_timer_set_alarm(vtlist.vt_lasttime + vtlist.vt_next->vt_time);
+  }
+#endif
+#endif /* !CH_USE_VT_WHEEL */
+}
+
+#if CH_USE_TICKLESS || defined(__DOXYGEN__)
+/**
+ * @brief   Virtual timers alarm handler.
+ * @details Serves all the timers whose deadline has been reached then
+ *          programs the alarm on the next deadline, if any.
+ * @note    In tickless mode this function replaces the @p chVTDoTickI()
+ *          macro and is invoked by @p chSysTimerHandlerI() when the port
+ *          alarm fires.
+ *
+ * @iclass
+ */
+void chVTDoTickI(void) {
+  systime_t now = port_timer_get_time();
+  VirtualTimer *vtp;
+
+  while (((vtp = vtlist.vt_next) != (void *)&vtlist) &&
+         (vtp->vt_time <= (systime_t)(now - vtlist.vt_lasttime))) {
+    vtfunc_t fn = vtp->vt_func;
+
+    /* The deltas base advances to the deadline being served.*/
+    vtlist.vt_lasttime += vtp->vt_time;
+    vtp->vt_func = (vtfunc_t)NULL;
+    vtp->vt_next->vt_prev = (void *)&vtlist;
+    vtlist.vt_next = vtp->vt_next;
+    chDbgTraceEventI(TRACE_EV_VT_FIRE, 0, vtp, TRACE_ID(fn));
+    fn(vtp->vt_par);
+  }
+  if (&vtlist == (VTList *)vtlist.vt_next)
+    port_timer_stop_alarm();
+  else
+    port_timer_set_alarm(vtlist.vt_lasttime + vtlist.vt_next->vt_time);
+}
+#endif /* CH_USE_TICKLESS */
+
+#if CH_USE_VT_WHEEL || defined(__DOXYGEN__)
+/**
+ * @brief   Virtual timers ticker.
+ * @details Advances the system time, when the lower levels wrap the timers
+ *          of the next slot of the upper levels are redistributed, then
+ *          the timers of the current slot of the first level are served.
+ * @note    With the timer wheel this function replaces the
+ *          @p chVTDoTickI() macro.
+ *
+ * @iclass
+ */
+void chVTDoTickI(void) {
+  systime_t now = ++vtlist.vt_systime;
+  systime_t t = now;
+  unsigned level = 0;
+  VirtualTimer *vtp;
+  VTSlot *sp;
+
+  if (vtlist.vt_armed == 0)
+    return;
+
+  /* Cascade, a level is processed only if all the lower levels wrapped.*/
+  while (((t & (VT_WHEEL_SLOTS - 1)) == 0) && (++level < VT_WHEEL_LEVELS)) {
+    t >>= VT_WHEEL_BITS;
+    sp = &vtlist.vt_wheel[level][t & (VT_WHEEL_SLOTS - 1)];
+    while ((vtp = sp->vt_next) != (VirtualTimer *)sp) {
+      wheel_remove(vtp);
+      wheel_insert(vtp);
+    }
+  }
+
+  /* All the timers in the current slot expire now, the callbacks can set
+     timers again but never in this same slot.*/
+  sp = &vtlist.vt_wheel[0][now & (VT_WHEEL_SLOTS - 1)];
+  while ((vtp = sp->vt_next) != (VirtualTimer *)sp) {
+    vtfunc_t fn = vtp->vt_func;
+
+    wheel_remove(vtp);
+    vtp->vt_func = (vtfunc_t)NULL;
+    vtlist.vt_armed--;
+    chDbgTraceEventI(TRACE_EV_VT_FIRE, 0, vtp, TRACE_ID(fn));
+    fn(vtp->vt_par);
+  }
+}
+
+/**
+ * @brief   Ticks before the next tick requiring processing.
+ * @details The search is limited to the first level, a wrap of the first
+ *          level is conservatively reported as an event if there are
+ *          timers armed, this makes the function run in bounded time.
+ * @note    This function is meant to be used by ports implementing a
+ *          low power idle mode.
+ *
+ * @return              The number of ticks, zero if there are no armed
+ *                      timers.
+ *
+ * @notapi
+ */
+systime_t vt_wheel_next(void) {
+  systime_t delta;
+
+  if (vtlist.vt_armed == 0)
+    return 0;
+  for (delta = 1; delta < VT_WHEEL_SLOTS; delta++) {
+    systime_t t = vtlist.vt_systime + delta;
+    VTSlot *sp = &vtlist.vt_wheel[0][t & (VT_WHEEL_SLOTS - 1)];
+
+    if (((t & (VT_WHEEL_SLOTS - 1)) == 0) ||
+        (sp->vt_next != (VirtualTimer *)sp))
+      return delta;
+  }
+  return delta;
 }
+#endif /* CH_USE_VT_WHEEL */
 
 /**
  * @brief   Checks if the current system time is within the specified time
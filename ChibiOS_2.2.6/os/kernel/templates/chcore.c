@@ -137,4 +137,39 @@ void port_halt(void) {
 void port_switch(Thread *ntp, Thread *otp) {
 }
 
+#if CH_USE_TICKLESS || defined(__DOXYGEN__)
+/**
+ * @brief   Returns the system time.
+ * @details The system time is the value of a free-running counter running
+ *          at @p CH_FREQUENCY, the counter must wrap on the whole
+ *          @p systime_t range.
+ * @note    Only required if @p CH_USE_TICKLESS is enabled.
+ *
+ * @return              The current counter value.
+ */
+systime_t port_timer_get_time(void) {
+
+  return 0;
+}
+
+/**
+ * @brief   Programs the one-shot system alarm.
+ * @details When the counter reaches @p time the port must invoke
+ *          @p chSysTimerHandlerI() from an interrupt handler. If @p time
+ *          is already in the past the alarm must fire as soon as possible.
+ * @note    Only required if @p CH_USE_TICKLESS is enabled.
+ *
+ * @param[in] time      the absolute counter value of the alarm
+ */
+void port_timer_set_alarm(systime_t time) {
+}
+
+/**
+ * @brief   Stops the one-shot system alarm.
+ * @note    Only required if @p CH_USE_TICKLESS is enabled.
+ */
+void port_timer_stop_alarm(void) {
+}
+#endif /* CH_USE_TICKLESS */
+
 /** @} */
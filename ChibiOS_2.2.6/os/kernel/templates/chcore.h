@@ -52,6 +52,39 @@
  */
 #define CH_ARCHITECTURE_VARIANT_NAME ""
 
+/**
+ * @brief   Tickless mode support.
+ * @details Must be defined to @p TRUE if the port implements the
+ *          @p port_timer_get_time(), @p port_timer_set_alarm() and
+ *          @p port_timer_stop_alarm() functions required by
+ *          @p CH_USE_TICKLESS.
+ */
+#define PORT_SUPPORTS_TICKLESS FALSE
+
+/**
+ * @brief   Realtime counter support.
+ * @details Must be defined to @p TRUE if the port implements the
+ *          @p port_rt_get_counter_value() function and the @p rtcnt_t
+ *          type required by @p CH_DBG_THREADS_ACCOUNTING.
+ */
+#define PORT_SUPPORTS_RT FALSE
+
+/**
+ * @brief   Realtime counter type.
+ * @details A free running counter, usually a cycles counter, wrapping
+ *          around on the type width.
+ */
+typedef uint32_t rtcnt_t;
+
+/**
+ * @brief   Realtime counter frequency.
+ * @details Optional, if defined the trace buffer uses the realtime counter
+ *          for its timestamps.
+ */
+#if defined(__DOXYGEN__)
+#define PORT_RT_FREQUENCY 0
+#endif
+
 /**
  * @brief   Base type for stack and memory alignment.
  */
@@ -176,6 +209,14 @@ extern "C" {
   void port_wait_for_interrupt(void);
   void port_halt(void);
   void port_switch(Thread *ntp, Thread *otp);
+#if CH_USE_TICKLESS
+  systime_t port_timer_get_time(void);
+  void port_timer_set_alarm(systime_t time);
+  void port_timer_stop_alarm(void);
+#endif
+#if PORT_SUPPORTS_RT
+  rtcnt_t port_rt_get_counter_value(void);
+#endif
 #ifdef __cplusplus
 }
 #endif
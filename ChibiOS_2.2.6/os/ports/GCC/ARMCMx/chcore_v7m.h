@@ -141,6 +141,16 @@
  */
 typedef void *regarm_t;
 
+/**
+ * @brief   Realtime counter supported, it is the DWT cycles counter.
+ */
+#define PORT_SUPPORTS_RT TRUE
+
+/**
+ * @brief   Realtime counter type.
+ */
+typedef uint32_t rtcnt_t;
+
 #if !defined(__DOXYGEN__)
 struct extctx {
   regarm_t      r0;
@@ -196,6 +206,21 @@ struct intctx {
  */
 #define PORT_FAST_IRQ_HANDLER(id) void id(void)
 
+/**
+ * @brief   Realtime counter initialization.
+ * @details The DWT cycles counter is enabled when the threads accounting
+ *          is active.
+ */
+#if CH_DBG_THREADS_ACCOUNTING || defined(__DOXYGEN__)
+#define port_rt_init() {                                                    \
+  SCB_DEMCR |= DEMCR_TRCENA;                                                \
+  DWT_CYCCNT = 0;                                                           \
+  DWT_CTRL |= DWT_CTRL_CYCCNTENA;                                           \
+}
+#else
+#define port_rt_init()
+#endif
+
 /**
  * @brief   Port-related initialization code.
  */
@@ -207,8 +232,16 @@ struct intctx {
     CORTEX_PRIORITY_MASK(CORTEX_PRIORITY_PENDSV));                          \
   NVICSetSystemHandlerPriority(HANDLER_SYSTICK,                             \
     CORTEX_PRIORITY_MASK(CORTEX_PRIORITY_SYSTICK));                         \
+  port_rt_init();                                                           \
 }
 
+/**
+ * @brief   Returns the realtime counter value.
+ *
+ * @return              The current DWT cycles counter value.
+ */
+#define port_rt_get_counter_value() DWT_CYCCNT
+
 /**
  * @brief   Kernel-lock action.
  * @details Usually this function just disables interrupts but may perform
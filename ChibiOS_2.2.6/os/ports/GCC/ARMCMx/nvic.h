@@ -184,6 +184,21 @@ typedef struct {
 #define AIRCR_PRIGROUP_MASK     (0x7 << 8)
 #define AIRCR_PRIGROUP(n)       ((n) << 8)
 
+/**
+ * @brief Debug Exception and Monitor Control Register.
+ */
+#define SCB_DEMCR               (*((volatile uint32_t *)0xE000EDFC))
+
+#define DEMCR_TRCENA            (0x1 << 24)
+
+/**
+ * @brief DWT control register and cycles counter, ARMv7-M only.
+ */
+#define DWT_CTRL                (*((volatile uint32_t *)0xE0001000))
+#define DWT_CYCCNT              (*((volatile uint32_t *)0xE0001004))
+
+#define DWT_CTRL_CYCCNTENA      (0x1 << 0)
+
 #ifdef __cplusplus
 extern "C" {
 #endif
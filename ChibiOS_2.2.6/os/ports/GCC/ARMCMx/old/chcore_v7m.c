@@ -130,7 +130,7 @@ void PendSVVector(void) {
   PUSH_CONTEXT(sp_thd, prio)
 
   (otp = currp)->p_ctx.r13 = sp_thd;
-  ntp = fifo_remove(&rlist.r_queue);
+  ntp = readylist_fifo_remove();
   setcurrp(ntp);
   ntp->p_state = THD_STATE_CURRENT;
   chSchReadyI(otp);
@@ -0,0 +1,98 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,2011 Giovanni Di Sirio.
+
+    This file is part of ChibiOS/RT.
+
+    ChibiOS/RT is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/RT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+                                      ---
+
+    A special exception to the GPL can be applied should you wish to distribute
+    a combined work that includes ChibiOS/RT, without being obliged to provide
+    the source code for any proprietary components. See the file exception.txt
+    for full details of how and when the exception can be applied.
+*/
+
+/**
+ * @addtogroup SIMX64_CORE
+ * @{
+ */
+
+#include <stdlib.h>
+#include <stddef.h>
+
+#include "ch.h"
+#include "hal.h"
+
+#if defined(__APPLE__)
+#define ASM_SYMBOL(s) "_" #s
+#else
+#define ASM_SYMBOL(s) #s
+#endif
+
+/**
+ * Performs a context switch between two threads.
+ * @note    The System V AMD64 ABI passes @p ntp into @p rdi and @p otp into
+ *          @p rsi, only the callee-saved registers are preserved.
+ * @param otp the thread to be switched out
+ * @param ntp the thread to be switched in
+ */
+__attribute__((used))
+static void __dummy(Thread *ntp, Thread *otp) {
+  (void)ntp; (void)otp;
+
+  asm volatile (".globl " ASM_SYMBOL(port_switch) "             \n\t" \
+                ASM_SYMBOL(port_switch) ":                      \n\t" \
+                "push    %%rbp                                  \n\t" \
+                "push    %%rbx                                  \n\t" \
+                "push    %%r12                                  \n\t" \
+                "push    %%r13                                  \n\t" \
+                "push    %%r14                                  \n\t" \
+                "push    %%r15                                  \n\t" \
+                "movq    %%rsp, %c0(%%rsi)                      \n\t" \
+                "movq    %c0(%%rdi), %%rsp                      \n\t" \
+                "pop     %%r15                                  \n\t" \
+                "pop     %%r14                                  \n\t" \
+                "pop     %%r13                                  \n\t" \
+                "pop     %%r12                                  \n\t" \
+                "pop     %%rbx                                  \n\t" \
+                "pop     %%rbp                                  \n\t" \
+                "ret" : : "i" (offsetof(Thread, p_ctx.rsp)));
+}
+
+/**
+ * Threads start point. The thread function and its argument are placed into
+ * @p r12 and @p r13 by @p SETUP_CONTEXT(), the stack is 16 bytes aligned
+ * when entering here so the calls are ABI compliant.
+ */
+__attribute__((used))
+static void __dummy2(void) {
+
+  asm volatile (".globl " ASM_SYMBOL(_port_thread_start) "      \n\t" \
+                ASM_SYMBOL(_port_thread_start) ":               \n\t" \
+                "movq    %r13, %rdi                             \n\t" \
+                "callq   *%r12                                  \n\t" \
+                "movq    %rax, %rdi                             \n\t" \
+                "callq   " ASM_SYMBOL(chThdExit));
+}
+
+/**
+ * Halts the system. In this implementation it just exits the simulation.
+ */
+void port_halt(void) {
+
+  exit(2);
+}
+
+/** @} */
@@ -0,0 +1,267 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,2011 Giovanni Di Sirio.
+
+    This file is part of ChibiOS/RT.
+
+    ChibiOS/RT is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/RT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+                                      ---
+
+    A special exception to the GPL can be applied should you wish to distribute
+    a combined work that includes ChibiOS/RT, without being obliged to provide
+    the source code for any proprietary components. See the file exception.txt
+    for full details of how and when the exception can be applied.
+*/
+
+/**
+ * @addtogroup SIMX64_CORE
+ * @{
+ */
+
+#ifndef _CHCORE_H_
+#define _CHCORE_H_
+
+#if !defined(__x86_64__) || defined(_WIN64)
+#error "the SIMX64 port requires a System V AMD64 ABI host"
+#endif
+
+/**
+ * Macro defining the a simulated architecture into x86-64.
+ */
+#define CH_ARCHITECTURE_SIMX64
+
+/**
+ * Name of the implemented architecture.
+ */
+#define CH_ARCHITECTURE_NAME "Simulator"
+
+/**
+ * @brief   Name of the architecture variant (optional).
+ */
+#define CH_CORE_VARIANT_NAME "x86-64 (integer only)"
+
+/**
+ * Tickless mode supported, the alarm and the counter are implemented by the
+ * Posix platform code.
+ */
+#define PORT_SUPPORTS_TICKLESS TRUE
+
+/**
+ * Realtime counter supported, it is the host monotonic clock in nanoseconds
+ * implemented by the Posix platform code.
+ */
+#define PORT_SUPPORTS_RT TRUE
+
+/**
+ * Realtime counter type, 64 bits because the idle thread can run for many
+ * seconds while the host process is suspended.
+ */
+typedef uint64_t rtcnt_t;
+
+/**
+ * Realtime counter frequency.
+ */
+#define PORT_RT_FREQUENCY 1000000000
+
+/**
+ * 16 bytes stack alignment.
+ */
+typedef struct {
+  uint8_t a[16];
+} stkalign_t __attribute__((aligned(16)));
+
+/**
+ * Generic x86-64 register.
+ */
+typedef void *regx64;
+
+/**
+ * Interrupt saved context.
+ * This structure represents the stack frame saved during a preemption-capable
+ * interrupt handler.
+ */
+struct extctx {
+};
+
+/**
+ * System saved context.
+ * @note In this demo the floating point registers are not saved.
+ * @note Only the System V AMD64 ABI callee-saved registers are part of the
+ *       context, @p r12 and @p r13 also carry the thread function and its
+ *       argument on the first switch.
+ */
+struct intctx {
+  regx64  r15;
+  regx64  r14;
+  regx64  r13;
+  regx64  r12;
+  regx64  rbx;
+  regx64  rbp;
+  regx64  rip;
+};
+
+/**
+ * Platform dependent part of the @p Thread structure.
+ * This structure usually contains just the saved stack pointer defined as a
+ * pointer to a @p intctx structure.
+ */
+struct context {
+  struct intctx volatile *rsp;
+};
+
+#define APUSH(p, a) (p) -= sizeof(void *), *(void **)(p) = (void*)(a)
+
+/**
+ * Platform dependent part of the @p chThdCreateI() API.
+ * This code usually setup the context switching frame represented by a
+ * @p intctx structure.
+ * @note The two padding words keep the stack 16 bytes aligned when
+ *       @p _port_thread_start() is entered.
+ */
+#define SETUP_CONTEXT(workspace, wsize, pf, arg) {                      \
+  uint8_t *rsp = (uint8_t *)workspace + wsize;                          \
+  APUSH(rsp, 0);                                                        \
+  APUSH(rsp, 0);                                                        \
+  rsp -= sizeof(struct intctx);                                         \
+  ((struct intctx *)rsp)->rip = (void *)_port_thread_start;             \
+  ((struct intctx *)rsp)->rbp = 0;                                      \
+  ((struct intctx *)rsp)->rbx = 0;                                      \
+  ((struct intctx *)rsp)->r12 = (void *)pf;                             \
+  ((struct intctx *)rsp)->r13 = arg;                                    \
+  ((struct intctx *)rsp)->r14 = 0;                                      \
+  ((struct intctx *)rsp)->r15 = 0;                                      \
+  tp->p_ctx.rsp = (struct intctx *)rsp;                                 \
+}
+
+/**
+ * Stack size for the system idle thread.
+ */
+#ifndef IDLE_THREAD_STACK_SIZE
+#define IDLE_THREAD_STACK_SIZE 256
+#endif
+
+/**
+ * Per-thread stack overhead for interrupts servicing, it is used in the
+ * calculation of the correct working area size.
+ * It requires stack space because the simulated "interrupt handlers" can
+ * invoke host library functions inside so it better have a lot of space.
+ */
+#ifndef INT_REQUIRED_STACK
+#define INT_REQUIRED_STACK 16384
+#endif
+
+/**
+ * Enforces a correct alignment for a stack area size value.
+ */
+#define STACK_ALIGN(n) ((((n) - 1) | (sizeof(stkalign_t) - 1)) + 1)
+
+ /**
+  * Computes the thread working area global size.
+  */
+#define THD_WA_SIZE(n) STACK_ALIGN(sizeof(Thread) +                     \
+                                   sizeof(void *) * 2 +                 \
+                                   sizeof(struct intctx) +              \
+                                   sizeof(struct extctx) +              \
+                                  (n) + (INT_REQUIRED_STACK))
+
+/**
+ * Macro used to allocate a thread working area aligned as both position and
+ * size.
+ */
+#define WORKING_AREA(s, n) stkalign_t s[THD_WA_SIZE(n) / sizeof(stkalign_t)]
+
+/**
+ * IRQ prologue code, inserted at the start of all IRQ handlers enabled to
+ * invoke system APIs.
+ */
+#define PORT_IRQ_PROLOGUE()
+
+/**
+ * IRQ epilogue code, inserted at the end of all IRQ handlers enabled to
+ * invoke system APIs.
+ */
+#define PORT_IRQ_EPILOGUE()
+
+/**
+ * IRQ handler function declaration.
+ */
+#define PORT_IRQ_HANDLER(id) void id(void)
+
+/**
+ * Simulator initialization.
+ */
+#define port_init()
+
+/**
+ * Does nothing in this simulator.
+ */
+#define port_lock() asm volatile("nop")
+
+/**
+ * Does nothing in this simulator.
+ */
+#define port_unlock() asm volatile("nop")
+
+/**
+ * Does nothing in this simulator.
+ */
+#define port_lock_from_isr()
+
+/**
+ * Does nothing in this simulator.
+ */
+#define port_unlock_from_isr()
+
+/**
+ * Does nothing in this simulator.
+ */
+#define port_disable()
+
+/**
+ * Does nothing in this simulator.
+ */
+#define port_suspend()
+
+/**
+ * Does nothing in this simulator.
+ */
+#define port_enable()
+
+/**
+ * In the simulator this waits for the simulated interrupt sources, the host
+ * process is suspended while there is nothing to do.
+ */
+#define port_wait_for_interrupt() WaitIntSources()
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void port_switch(Thread *ntp, Thread *otp);
+  void port_halt(void);
+  void _port_thread_start(void);
+  void ChkIntSources(void);
+  void WaitIntSources(void);
+#if CH_USE_TICKLESS
+  systime_t port_timer_get_time(void);
+  void port_timer_set_alarm(systime_t time);
+  void port_timer_stop_alarm(void);
+#endif
+  rtcnt_t port_rt_get_counter_value(void);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _CHCORE_H_ */
+
+/** @} */
@@ -32,6 +32,7 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "ch.h"
@@ -126,12 +127,218 @@ static void cmd_systime(BaseChannel *chp, int argc, char *argv[]) {
   shellPrintLine(chp, buf);
 }
 
+#if CH_USE_REGISTRY || defined(__DOXYGEN__)
+static const char *states[] = {
+  "READY",
+  "CURRENT",
+  "SUSPENDED",
+  "WTSEM",
+  "WTMTX",
+  "WTCOND",
+  "SLEEPING",
+  "WTEXIT",
+  "WTOREVT",
+  "WTANDEVT",
+  "SNDMSG",
+  "WTMSG",
+  "WTQUEUE",
+  "FINAL"
+};
+
+#if CH_DBG_THREADS_ACCOUNTING || defined(__DOXYGEN__)
+/*
+ * Maximum number of threads sampled by the top command.
+ */
+#if !defined(SHELL_TOP_THREADS) || defined(__DOXYGEN__)
+#define SHELL_TOP_THREADS       16
+#endif
+
+/*
+ * The runtime is 64 bits wide, the read is atomic only if performed with
+ * the kernel locked.
+ */
+static uint64_t get_runtime(Thread *tp) {
+  uint64_t runtime;
+
+  chSysLock();
+  runtime = chThdGetRuntime(tp);
+  chSysUnlock();
+  return runtime;
+}
+
+/*
+ * Formats a share in tenths of percent.
+ */
+static void print_share(char *buf, uint64_t part, uint64_t total) {
+  unsigned long pm = total > 0 ? (unsigned long)((part * 1000) / total) : 0;
+
+  sprintf(buf, "%3lu.%lu%%", pm / 10, pm % 10);
+}
+#endif /* CH_DBG_THREADS_ACCOUNTING */
+
+/*
+ * Saved stack pointer of a thread, all the ports keep it as the only field
+ * of the context structure.
+ */
+#define thread_sp(tp) (*(void **)&(tp)->p_ctx)
+
+static void cmd_threads(BaseChannel *chp, int argc, char *argv[]) {
+  Thread *tp;
+  char buf[160];
+  char *p;
+#if CH_DBG_THREADS_ACCOUNTING
+  uint64_t total = 0;
+#endif
+
+  (void)argv;
+  if (argc > 0) {
+    usage(chp, "threads");
+    return;
+  }
+#if CH_DBG_THREADS_ACCOUNTING
+  tp = chRegFirstThread();
+  do {
+    total += get_runtime(tp);
+    tp = chRegNextThread(tp);
+  } while (tp != NULL);
+#endif
+  shellPrint(chp, "    addr    stack prio");
+#if CH_USE_DYNAMIC
+  shellPrint(chp, " refs");
+#endif
+  shellPrint(chp, "     state");
+#if CH_DBG_THREADS_PROFILING
+  shellPrint(chp, "     time");
+#endif
+#if CH_DBG_THREADS_ACCOUNTING
+  shellPrint(chp, "  runtime(k)    cpu  switches   maxburst");
+#endif
+  shellPrintLine(chp, "");
+  tp = chRegFirstThread();
+  do {
+    p = buf;
+    p += sprintf(p, "%8lx %8lx %4lu",
+                 (unsigned long)tp, (unsigned long)thread_sp(tp),
+                 (unsigned long)tp->p_prio);
+#if CH_USE_DYNAMIC
+    p += sprintf(p, " %4i", (int)tp->p_refs - 1);
+#endif
+    p += sprintf(p, " %9s", states[tp->p_state]);
+#if CH_DBG_THREADS_PROFILING
+    p += sprintf(p, " %8lu", (unsigned long)tp->p_time);
+#endif
+#if CH_DBG_THREADS_ACCOUNTING
+    {
+      uint64_t runtime = get_runtime(tp);
+      char share[24];
+
+      print_share(share, runtime, total);
+      sprintf(p, " %11lu %6s %9lu %10lu",
+              (unsigned long)(runtime / 1000), share,
+              (unsigned long)chThdGetSwitches(tp),
+              (unsigned long)chThdGetMaxBurst(tp));
+    }
+#endif
+    shellPrintLine(chp, buf);
+    tp = chRegNextThread(tp);
+  } while (tp != NULL);
+}
+
+#if CH_DBG_THREADS_ACCOUNTING || defined(__DOXYGEN__)
+static void cmd_top(BaseChannel *chp, int argc, char *argv[]) {
+  Thread *threads[SHELL_TOP_THREADS];
+  uint64_t runtimes[SHELL_TOP_THREADS];
+  bool_t alive[SHELL_TOP_THREADS];
+  tprio_t prios[SHELL_TOP_THREADS];
+  tstate_t tstates[SHELL_TOP_THREADS];
+  uint64_t total, runtime;
+  unsigned long ms = 1000;
+  int i, n;
+  Thread *tp;
+  char buf[64], share[24];
+
+  if (argc > 1) {
+    usage(chp, "top [ms]");
+    return;
+  }
+  if (argc == 1)
+    ms = strtoul(argv[0], NULL, 0);
+  if (ms == 0)
+    ms = 1;
+
+  /* First sample, the threads are identified by address. A reference is
+     kept on the sampled threads so that their memory cannot be released
+     and reused by another thread during the sampling interval.*/
+  n = 0;
+  tp = chRegFirstThread();
+  do {
+    if (n < SHELL_TOP_THREADS) {
+#if CH_USE_DYNAMIC
+      threads[n] = chThdAddRef(tp);
+#else
+      threads[n] = tp;
+#endif
+      alive[n] = FALSE;
+      runtimes[n++] = get_runtime(tp);
+    }
+    tp = chRegNextThread(tp);
+  } while (tp != NULL);
+
+  chThdSleepMilliseconds(ms);
+
+  /* Second sample, only the threads still present are accounted. The
+     priority and state are taken while the registry reference is held.*/
+  total = 0;
+  tp = chRegFirstThread();
+  do {
+    for (i = 0; i < n; i++) {
+      if (threads[i] == tp) {
+        alive[i] = TRUE;
+        prios[i] = tp->p_prio;
+        tstates[i] = tp->p_state;
+        /* A static thread recreated in the same working area restarts its
+           runtime from zero.*/
+        runtime = get_runtime(tp);
+        runtimes[i] = runtime >= runtimes[i] ? runtime - runtimes[i] :
+                                               runtime;
+        total += runtimes[i];
+        break;
+      }
+    }
+    tp = chRegNextThread(tp);
+  } while (tp != NULL);
+
+#if CH_USE_DYNAMIC
+  for (i = 0; i < n; i++)
+    chThdRelease(threads[i]);
+#endif
+
+  shellPrintLine(chp, "    addr prio     state    cpu");
+  for (i = 0; i < n; i++) {
+    if (!alive[i])
+      continue;
+    print_share(share, runtimes[i], total);
+    sprintf(buf, "%8lx %4lu %9s %6s",
+            (unsigned long)threads[i], (unsigned long)prios[i],
+            states[tstates[i]], share);
+    shellPrintLine(chp, buf);
+  }
+}
+#endif /* CH_DBG_THREADS_ACCOUNTING */
+#endif /* CH_USE_REGISTRY */
+
 /**
  * @brief Array of the default commands.
  */
 static ShellCommand local_commands[] = {
   {"info", cmd_info},
   {"systime", cmd_systime},
+#if CH_USE_REGISTRY
+  {"threads", cmd_threads},
+#if CH_DBG_THREADS_ACCOUNTING
+  {"top", cmd_top},
+#endif
+#endif
   {NULL, NULL}
 };
 
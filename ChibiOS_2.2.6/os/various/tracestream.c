@@ -0,0 +1,223 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,2011 Giovanni Di Sirio.
+
+    This file is part of ChibiOS/RT.
+
+    ChibiOS/RT is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/RT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+                                      ---
+
+    A special exception to the GPL can be applied should you wish to distribute
+    a combined work that includes ChibiOS/RT, without being obliged to provide
+    the source code for any proprietary components. See the file exception.txt
+    for full details of how and when the exception can be applied.
+*/
+
+
+/**
+ * @file tracestream.c
+ * @brief Kernel trace streaming code.
+ * @addtogroup trace_stream
+ * @{
+ */
+
+#include <string.h>
+
+#include "ch.h"
+#include "tracestream.h"
+
+#if CH_DBG_ENABLE_TRACE || defined(__DOXYGEN__)
+
+static void put16(uint8_t *p, uint16_t v) {
+
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+}
+
+static void put32(uint8_t *p, uint32_t v) {
+
+  put16(p, (uint16_t)v);
+  put16(p + 2, (uint16_t)(v >> 16));
+}
+
+static void put64(uint8_t *p, uint64_t v) {
+
+  put32(p, (uint32_t)v);
+  put32(p + 4, (uint32_t)(v >> 32));
+}
+
+static void encode(uint8_t *p, const TraceEvent *tep) {
+
+  p[TRACE_OFF_TYPE] = tep->te_type;
+  p[TRACE_OFF_STATE] = tep->te_state;
+  put16(p + TRACE_OFF_LOST, tep->te_lost);
+  put32(p + TRACE_OFF_THREAD, TRACE_ID(tep->te_tp));
+  put32(p + TRACE_OFF_OBJECT, TRACE_ID(tep->te_objp));
+  put32(p + TRACE_OFF_ARG, tep->te_arg);
+  put64(p + TRACE_OFF_TIME, (uint64_t)tep->te_time);
+}
+
+/*
+ * Writes a buffer on the channel, the write is retried until completion
+ * because a partial record would desynchronize the stream. Returns FALSE
+ * if the thread has been asked to terminate meanwhile. Only used for the
+ * stream preamble.
+ */
+static bool_t send(BaseChannel *chp, const uint8_t *bp, size_t n) {
+
+  while (n > 0) {
+    size_t done = chIOWriteTimeout(chp, bp, n, MS2ST(TRACE_STREAM_PERIOD));
+
+    bp += done;
+    n -= done;
+    if ((n > 0) && chThdShouldTerminate())
+      return FALSE;
+  }
+  return TRUE;
+}
+
+static bool_t send_header(BaseChannel *chp) {
+  uint8_t buf[TRACE_RECORD_SIZE];
+
+  memset(buf, 0, sizeof(buf));
+  buf[TRACE_OFF_TYPE] = TRACE_EV_HEADER;
+  buf[TRACE_OFF_STATE] = sizeof(tracetime_t) * 8;
+  put16(buf + TRACE_OFF_LOST, TRACE_VERSION);
+  put32(buf + TRACE_OFF_THREAD, TRACE_MAGIC);
+  put32(buf + TRACE_OFF_OBJECT, TRACE_FREQUENCY);
+  put64(buf + TRACE_OFF_TIME, (uint64_t)TRACE_TIMESTAMP());
+  return send(chp, buf, sizeof(buf));
+}
+
+/*
+ * The kernel does not keep threads names, the threads are labeled by
+ * priority except the idle thread and the drain thread itself.
+ */
+static bool_t send_names(BaseChannel *chp) {
+#if CH_USE_REGISTRY
+  uint8_t buf[TRACE_RECORD_SIZE];
+  bool_t ok = TRUE;
+  Thread *tp;
+
+  /* The iteration is always completed in order to release the references
+     taken by the registry functions.*/
+  tp = chRegFirstThread();
+  do {
+    char *p = (char *)buf + TRACE_OFF_NAME;
+
+    memset(buf, 0, sizeof(buf));
+    buf[TRACE_OFF_TYPE] = TRACE_EV_NAME;
+    put32(buf + TRACE_OFF_THREAD, TRACE_ID(tp));
+    if (tp == chThdSelf())
+      strcpy(p, "trace");
+    else if (tp->p_prio == IDLEPRIO)
+      strcpy(p, "idle");
+    else {
+      unsigned prio = tp->p_prio, d = 100;
+
+      strcpy(p, "prio ");
+      p += 5;
+      while (d > prio && d > 1)
+        d /= 10;
+      while (d > 0) {
+        *p++ = (char)('0' + (prio / d) % 10);
+        d /= 10;
+      }
+    }
+    if (ok)
+      ok = send(chp, buf, sizeof(buf));
+    tp = chRegNextThread(tp);
+  } while (tp != NULL);
+  return ok;
+#else /* !CH_USE_REGISTRY */
+  (void)chp;
+  return TRUE;
+#endif /* !CH_USE_REGISTRY */
+}
+
+/*
+ * Drain thread, both the trace buffer and the channel are polled because
+ * waking up the thread on each record or on each freed byte would trace
+ * the drain activity itself, possibly more than the channel can carry.
+ */
+static msg_t trace_stream_thread(void *p) {
+  BaseChannel *chp = p;
+  TraceEvent events[TRACE_STREAM_BATCH];
+  uint8_t buf[TRACE_STREAM_BATCH * TRACE_RECORD_SIZE];
+  size_t off = 0, len = 0, done;
+
+  chDbgTraceStream(TRUE);
+  if (send_header(chp) && send_names(chp)) {
+    /* The termination is accepted only at a record boundary, a partially
+       written record would desynchronize the stream.*/
+    while (!chThdShouldTerminate() || ((off % TRACE_RECORD_SIZE) != 0)) {
+      if (len == 0) {
+        cnt_t i, n = chDbgTraceFetch(events, TRACE_STREAM_BATCH);
+
+        if (n == 0) {
+          chThdSleepMilliseconds(TRACE_STREAM_PERIOD);
+          continue;
+        }
+        for (i = 0; i < n; i++)
+          encode(buf + i * TRACE_RECORD_SIZE, &events[i]);
+        off = 0;
+        len = n * TRACE_RECORD_SIZE;
+      }
+      done = chIOWriteTimeout(chp, buf + off, len, TIME_IMMEDIATE);
+      off += done;
+      len -= done;
+      /* Channel full, its transmission is given a tick to progress.*/
+      if (len > 0)
+        chThdSleep(1);
+    }
+  }
+  chDbgTraceStream(FALSE);
+  return 0;
+}
+
+/**
+ * @brief Spawns a trace drain thread.
+ * @details The thread switches the trace buffer in streaming mode and
+ *          writes the records on the channel, a header record and the
+ *          threads labels are sent first.
+ *
+ * @param[in] chp the channel the stream is written to
+ * @param[in] size size of the thread working area to be allocated
+ * @param[in] prio the priority level for the new thread
+ * @return A pointer to the drain thread or @p NULL if the thread cannot
+ *         be created.
+ */
+Thread *traceStreamCreate(BaseChannel *chp, size_t size, tprio_t prio) {
+
+  return chThdCreateFromHeap(NULL, size, prio, trace_stream_thread,
+                             (void *)chp);
+}
+
+/**
+ * @brief Stops a trace drain thread.
+ * @details The thread is asked to terminate and waited, the record being
+ *          written is completed first. The trace buffer returns in
+ *          overwrite mode.
+ *
+ * @param[in] tp pointer to the drain thread
+ */
+void traceStreamStop(Thread *tp) {
+
+  chThdTerminate(tp);
+  chThdWait(tp);
+}
+
+#endif /* CH_DBG_ENABLE_TRACE */
+
+/** @} */
@@ -0,0 +1,68 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,2011 Giovanni Di Sirio.
+
+    This file is part of ChibiOS/RT.
+
+    ChibiOS/RT is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/RT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+                                      ---
+
+    A special exception to the GPL can be applied should you wish to distribute
+    a combined work that includes ChibiOS/RT, without being obliged to provide
+    the source code for any proprietary components. See the file exception.txt
+    for full details of how and when the exception can be applied.
+*/
+
+
+/**
+ * @file tracestream.h
+ * @brief Kernel trace streaming macros and structures.
+ * @addtogroup trace_stream
+ * @{
+ */
+
+#ifndef _TRACESTREAM_H_
+#define _TRACESTREAM_H_
+
+/**
+ * @brief Polling interval of the drain thread in milliseconds.
+ * @details The drain thread sleeps for this time when the trace buffer is
+ *          empty. While the channel is full the drain thread polls it every
+ *          system tick.
+ */
+#if !defined(TRACE_STREAM_PERIOD) || defined(__DOXYGEN__)
+#define TRACE_STREAM_PERIOD         10
+#endif
+
+/**
+ * @brief Number of records fetched and written at once.
+ * @note  The drain thread stack must accommodate the records and their
+ *        encoded form.
+ */
+#if !defined(TRACE_STREAM_BATCH) || defined(__DOXYGEN__)
+#define TRACE_STREAM_BATCH          16
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  Thread *traceStreamCreate(BaseChannel *chp, size_t size, tprio_t prio);
+  void traceStreamStop(Thread *tp);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _TRACESTREAM_H_ */
+
+/** @} */
@@ -49,6 +49,21 @@
 #define TEST_NO_BENCHMARKS      FALSE
 #endif
 
+/**
+ * @brief   Time windows extension, in ticks.
+ * @details In tickless mode the system time keeps advancing between the
+ *          alarm and the moment the woken thread reads it, one tick is
+ *          allowed for the deadline computation and one for the wakeup
+ *          latency.
+ */
+#if !defined(TEST_TIME_TOLERANCE) || defined(__DOXYGEN__)
+#if CH_USE_TICKLESS
+#define TEST_TIME_TOLERANCE     2
+#else
+#define TEST_TIME_TOLERANCE     0
+#endif
+#endif
+
 #define MAX_THREADS             5
 #define MAX_TOKENS              16
 
@@ -56,7 +71,7 @@
 #define THREADS_STACK_SIZE      48
 #elif defined(CH_ARCHITECTURE_STM8)
 #define THREADS_STACK_SIZE      64
-#elif defined(CH_ARCHITECTURE_SIMIA32)
+#elif defined(CH_ARCHITECTURE_SIMIA32) || defined(CH_ARCHITECTURE_SIMX64)
 #define THREADS_STACK_SIZE      512
 #else
 #define THREADS_STACK_SIZE      128
@@ -148,10 +163,11 @@ extern "C" {
  *
  * @param[in] point     numeric assertion identifier
  * @param[in] start     initial time in the window (included)
- * @param[in] end       final time in the window (not included)
+ * @param[in] end       final time in the window (not included), it is
+ *                      extended by @p TEST_TIME_TOLERANCE
  */
 #define test_assert_time_window(point, start, end) {                        \
-  if (_test_assert_time_window(point, start, end))                          \
+  if (_test_assert_time_window(point, start, (end) + TEST_TIME_TOLERANCE))  \
     return;                                                                 \
 }
 
@@ -59,6 +59,12 @@
  * - @subpage test_benchmarks_011
  * - @subpage test_benchmarks_012
  * - @subpage test_benchmarks_013
+ * - @subpage test_benchmarks_014
+ * - @subpage test_benchmarks_015
+ * - @subpage test_benchmarks_016
+ * - @subpage test_benchmarks_017
+ * - @subpage test_benchmarks_018
+ * - @subpage test_benchmarks_019
  * .
  * @file testbmk.c Kernel Benchmarks
  * @brief Kernel Benchmarks source file
@@ -453,7 +459,7 @@ ROMCONST struct testcase testbmk8 = {
  *
  * <h2>Description</h2>
  * Four bytes are written and then read from an @p InputQueue into a continuous
- * loop.<br>
+ * loop, the bytes are read one at time then using @p chIQReadTimeout().<br>
  * The performance is calculated by measuring the number of iterations after
  * a second of continuous operations.
  */
@@ -484,6 +490,26 @@ static void bmk9_execute(void) {
   test_print("--- Score : ");
   test_printn(n * 4);
   test_println(" bytes/S");
+
+  n = 0;
+  test_wait_tick();
+  test_start_timer(1000);
+  do {
+    uint8_t buf[4];
+
+    chIQPutI(&iq, 0);
+    chIQPutI(&iq, 1);
+    chIQPutI(&iq, 2);
+    chIQPutI(&iq, 3);
+    (void)chIQReadTimeout(&iq, buf, sizeof(buf), TIME_IMMEDIATE);
+    n++;
+#if defined(SIMULATOR)
+    ChkIntSources();
+#endif
+  } while (!test_timer_done);
+  test_print("--- Score : ");
+  test_printn(n * 4);
+  test_println(" bytes/S, chIQReadTimeout()");
 }
 
 ROMCONST struct testcase testbmk9 = {
@@ -499,12 +525,26 @@ ROMCONST struct testcase testbmk9 = {
  * <h2>Description</h2>
  * A virtual timer is set and immediately reset into a continuous loop.<br>
  * The performance is calculated by measuring the number of iterations after
- * a second of continuous operations.
+ * a second of continuous operations.<br>
+ * The measurement is repeated with 10, 100 and 1000 background timers armed
+ * with long timeouts in order to evaluate how the set/reset cost scales with
+ * the number of armed timers.
  */
 
+/**
+ * @brief   Maximum number of background timers in the benchmark.
+ */
+#if !defined(BMK_BACKGROUND_TIMERS) || defined(__DOXYGEN__)
+#if defined(SIMULATOR)
+#define BMK_BACKGROUND_TIMERS   1000
+#else
+#define BMK_BACKGROUND_TIMERS   100
+#endif
+#endif
+
 static void tmo(void *param) {(void)param;}
 
-static void bmk10_execute(void) {
+static uint32_t bmk10_loop(void) {
   static VirtualTimer vt1, vt2;
   uint32_t n = 0;
 
@@ -522,9 +562,38 @@ static void bmk10_execute(void) {
     ChkIntSources();
 #endif
   } while (!test_timer_done);
+  return n;
+}
+
+static void bmk10_execute(void) {
+  static VirtualTimer vtbg[BMK_BACKGROUND_TIMERS];
+  unsigned i, nbg;
+  uint32_t n;
+
+  n = bmk10_loop();
   test_print("--- Score : ");
   test_printn(n * 2);
   test_println(" timers/S");
+
+  for (nbg = 10; nbg <= BMK_BACKGROUND_TIMERS; nbg *= 10) {
+    /* The background timers expire after the measurement and before the
+       timer used in the loop.*/
+    chSysLock();
+    for (i = 0; i < nbg; i++)
+      chVTSetI(&vtbg[i], 2000 + i * 7, tmo, NULL);
+    chSysUnlock();
+    n = bmk10_loop();
+    chSysLock();
+    for (i = 0; i < nbg; i++)
+      if (chVTIsArmedI(&vtbg[i]))
+        chVTResetI(&vtbg[i]);
+    chSysUnlock();
+    test_print("--- Score : ");
+    test_printn(n * 2);
+    test_print(" timers/S, ");
+    test_printn(nbg);
+    test_println(" background timers");
+  }
 }
 
 ROMCONST struct testcase testbmk10 = {
@@ -688,6 +757,548 @@ ROMCONST struct testcase testbmk13 = {
   bmk13_execute
 };
 
+/**
+ * @page test_benchmarks_014 Mass reschedule vs ready threads
+ *
+ * <h2>Description</h2>
+ * A growing number of threads with equal priority are atomically rescheduled
+ * by resetting the semaphore where they are waiting on, each thread is
+ * inserted in the ready list behind the ones already awakened. The operation
+ * is performed into a continuous loop for each threads count.<br>
+ * The performance is calculated by measuring the number of threads wakeups
+ * after a second of continuous operations, with a linear ready list the cost
+ * of a single wakeup grows with the number of ready threads while with the
+ * @p CH_OPTIMIZED_READYLIST option it is expected to remain constant.
+ */
+
+/**
+ * @brief   Maximum number of ready threads in the benchmark.
+ */
+#if !defined(BMK_READY_THREADS) || defined(__DOXYGEN__)
+#if defined(SIMULATOR)
+#define BMK_READY_THREADS       48
+#else
+#define BMK_READY_THREADS       8
+#endif
+#endif
+
+static stkalign_t wa14[BMK_READY_THREADS][WA_SIZE / sizeof(stkalign_t)];
+static Thread *threads14[BMK_READY_THREADS];
+
+static void bmk14_setup(void) {
+
+  chSemInit(&sem1, 0);
+}
+
+static void bmk14_execute(void) {
+  static const unsigned counts[] = {1, BMK_READY_THREADS / 4,
+                                    BMK_READY_THREADS};
+  unsigned i, j;
+  uint32_t n;
+
+  for (i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+    for (j = 0; j < counts[i]; j++)
+      threads14[j] = chThdCreateStatic(wa14[j], WA_SIZE,
+                                       chThdGetPriority()+1, thread3, NULL);
+
+    n = 0;
+    test_wait_tick();
+    test_start_timer(1000);
+    do {
+      chSemReset(&sem1, 0);
+      n++;
+#if defined(SIMULATOR)
+      ChkIntSources();
+#endif
+    } while (!test_timer_done);
+    for (j = 0; j < counts[i]; j++)
+      chThdTerminate(threads14[j]);
+    chSemReset(&sem1, 0);
+    for (j = 0; j < counts[i]; j++)
+      chThdWait(threads14[j]);
+
+    test_print("--- Score : ");
+    test_printn(n * counts[i]);
+    test_print(" wakeups/S, ");
+    test_printn(counts[i]);
+    test_println(" threads");
+  }
+}
+
+ROMCONST struct testcase testbmk14 = {
+  "Benchmark, mass reschedule vs ready threads",
+  bmk14_setup,
+  NULL,
+  bmk14_execute
+};
+
+#if (CH_USE_HEAP && !CH_USE_MALLOC_HEAP) || defined(__DOXYGEN__)
+/**
+ * @page test_benchmarks_015 Heap random allocation/release
+ *
+ * <h2>Description</h2>
+ * A local heap is stressed with a pseudo-random sequence of allocations and
+ * releases of blocks of random size into a continuous loop.<br>
+ * The performance is calculated by measuring the number of operations after
+ * a second of continuous operations, the heap fragmentation at the end of
+ * the loop is also reported. The heap is expected to be back to a single
+ * fragment after releasing all the blocks.
+ */
+
+#define BMK15_BLOCKS        16
+
+static MemoryHeap heap15;
+
+static void bmk15_setup(void) {
+
+  chHeapInit(&heap15, test.buffer, sizeof(union test_buffers));
+}
+
+static void bmk15_execute(void) {
+  void *blocks[BMK15_BLOCKS];
+  uint32_t n = 0, seed = 1;
+  size_t frags, sz;
+  unsigned i;
+
+  for (i = 0; i < BMK15_BLOCKS; i++)
+    blocks[i] = NULL;
+  test_wait_tick();
+  test_start_timer(1000);
+  do {
+    /* Linear congruential generator, the upper bits are used.*/
+    seed = seed * 1103515245 + 12345;
+    i = (unsigned)(seed >> 16) % BMK15_BLOCKS;
+    if (blocks[i] == NULL)
+      blocks[i] = chHeapAlloc(&heap15, 16 + (size_t)(seed >> 20) %
+                                       (sizeof(union test_buffers) / 32));
+    else {
+      chHeapFree(blocks[i]);
+      blocks[i] = NULL;
+    }
+    n++;
+#if defined(SIMULATOR)
+    ChkIntSources();
+#endif
+  } while (!test_timer_done);
+  frags = chHeapStatus(&heap15, &sz);
+  for (i = 0; i < BMK15_BLOCKS; i++)
+    if (blocks[i] != NULL)
+      chHeapFree(blocks[i]);
+  test_assert(1, chHeapStatus(&heap15, NULL) == 1, "heap fragmented");
+
+  test_print("--- Score : ");
+  test_printn(n);
+  test_println(" alloc+free/S");
+  test_print("--- Frags : ");
+  test_printn((uint32_t)frags);
+  test_print(" fragments, ");
+  test_printn((uint32_t)sz);
+  test_println(" bytes free");
+}
+
+ROMCONST struct testcase testbmk15 = {
+  "Benchmark, heap random alloc/free",
+  bmk15_setup,
+  NULL,
+  bmk15_execute
+};
+#endif /* CH_USE_HEAP && !CH_USE_MALLOC_HEAP */
+
+#if (CH_USE_MEMPOOLS && CH_USE_MAILBOXES) || defined(__DOXYGEN__)
+/**
+ * @page test_benchmarks_016 Memory pool producers/consumers
+ *
+ * <h2>Description</h2>
+ * One, two and four pairs of producer and consumer threads exchange memory
+ * pool objects through a mailbox, the producers allocate the objects and
+ * the consumers release them. The measurement is repeated using per-thread
+ * magazines if the option @p CH_USE_POOL_MAGAZINES is enabled.<br>
+ * The performance is calculated by measuring the number of objects
+ * exchanged after a second of continuous operations.
+ */
+
+#define BMK16_PAIRS         4
+#define BMK16_MBSIZE        16
+#define BMK16_OBJ_SIZE      MEM_ALIGN_NEXT(sizeof(void *) * 4)
+#define BMK16_OBJECTS       (BMK16_PAIRS * 32 + BMK16_MBSIZE)
+
+static stkalign_t wa16[BMK16_PAIRS * 2][WA_SIZE / sizeof(stkalign_t)];
+static Thread *threads16[BMK16_PAIRS * 2];
+static stkalign_t bmk16_buf[BMK16_OBJECTS * BMK16_OBJ_SIZE /
+                            sizeof(stkalign_t)];
+static msg_t bmk16_mbbuf[BMK16_MBSIZE];
+static MemoryPool mp16;
+static Mailbox mb16;
+static uint32_t bmk16_counts[BMK16_PAIRS];
+static bool_t bmk16_magazines;
+#if CH_USE_POOL_MAGAZINES
+static PoolMagazine bmk16_mags[BMK16_PAIRS * 2];
+#endif
+
+static void *bmk16_alloc(unsigned i) {
+
+#if CH_USE_POOL_MAGAZINES
+  if (bmk16_magazines)
+    return chPoolMagazineAlloc(&bmk16_mags[i]);
+#else
+  (void)i;
+#endif
+  return chPoolAlloc(&mp16);
+}
+
+static void bmk16_free(unsigned i, void *objp) {
+
+#if CH_USE_POOL_MAGAZINES
+  if (bmk16_magazines) {
+    chPoolMagazineFree(&bmk16_mags[i], objp);
+    return;
+  }
+#else
+  (void)i;
+#endif
+  chPoolFree(&mp16, objp);
+}
+
+static msg_t producer16(void *p) {
+  unsigned i = (unsigned)(size_t)p;
+  void *objp;
+
+  while (!chThdShouldTerminate()) {
+    objp = bmk16_alloc(i);
+    if (objp != NULL)
+      (void)chMBPost(&mb16, (msg_t)objp, TIME_INFINITE);
+    else
+      chThdYield();
+#if defined(SIMULATOR)
+    ChkIntSources();
+#endif
+  }
+  (void)chMBPost(&mb16, (msg_t)0, TIME_INFINITE);
+  return 0;
+}
+
+static msg_t consumer16(void *p) {
+  unsigned i = (unsigned)(size_t)p;
+  msg_t msg;
+
+  while (TRUE) {
+    (void)chMBFetch(&mb16, &msg, TIME_INFINITE);
+    if (msg == 0)
+      break;
+    bmk16_free(BMK16_PAIRS + i, (void *)msg);
+    bmk16_counts[i]++;
+#if defined(SIMULATOR)
+    ChkIntSources();
+#endif
+  }
+  return 0;
+}
+
+static void bmk16_setup(void) {
+  unsigned i;
+
+  chPoolInit(&mp16, BMK16_OBJ_SIZE, NULL);
+  for (i = 0; i < BMK16_OBJECTS; i++)
+    chPoolFree(&mp16, (uint8_t *)bmk16_buf + i * BMK16_OBJ_SIZE);
+  chMBInit(&mb16, bmk16_mbbuf, BMK16_MBSIZE);
+}
+
+static void bmk16_run(unsigned pairs) {
+  unsigned i;
+  uint32_t n;
+
+  for (i = 0; i < pairs; i++) {
+    bmk16_counts[i] = 0;
+#if CH_USE_POOL_MAGAZINES
+    chPoolMagazineInit(&bmk16_mags[i], &mp16);
+    chPoolMagazineInit(&bmk16_mags[BMK16_PAIRS + i], &mp16);
+#endif
+    threads16[i * 2] = chThdCreateStatic(wa16[i * 2], WA_SIZE,
+                                         chThdGetPriority()-1,
+                                         producer16, (void *)(size_t)i);
+    threads16[i * 2 + 1] = chThdCreateStatic(wa16[i * 2 + 1], WA_SIZE,
+                                             chThdGetPriority()-1,
+                                             consumer16, (void *)(size_t)i);
+  }
+  chThdSleepMilliseconds(1000);
+  for (i = 0; i < pairs; i++)
+    chThdTerminate(threads16[i * 2]);
+  for (i = 0; i < pairs * 2; i++)
+    chThdWait(threads16[i]);
+  n = 0;
+  for (i = 0; i < pairs; i++) {
+    n += bmk16_counts[i];
+#if CH_USE_POOL_MAGAZINES
+    chPoolMagazineFlush(&bmk16_mags[i]);
+    chPoolMagazineFlush(&bmk16_mags[BMK16_PAIRS + i]);
+#endif
+  }
+
+  test_print("--- Score : ");
+  test_printn(n);
+  test_print(" objects/S, ");
+  test_printn(pairs * 2);
+  test_println(bmk16_magazines ? " threads, magazines" : " threads");
+}
+
+static void bmk16_execute(void) {
+  unsigned pairs;
+
+  bmk16_magazines = FALSE;
+  for (pairs = 1; pairs <= BMK16_PAIRS; pairs *= 2)
+    bmk16_run(pairs);
+#if CH_USE_POOL_MAGAZINES
+  bmk16_magazines = TRUE;
+  for (pairs = 1; pairs <= BMK16_PAIRS; pairs *= 2)
+    bmk16_run(pairs);
+#endif
+}
+
+ROMCONST struct testcase testbmk16 = {
+  "Benchmark, memory pool producers/consumers",
+  bmk16_setup,
+  NULL,
+  bmk16_execute
+};
+#endif /* CH_USE_MEMPOOLS && CH_USE_MAILBOXES */
+
+/**
+ * @page test_benchmarks_017 I/O Queues large blocks throughput
+ *
+ * <h2>Description</h2>
+ * A 128 bytes block is read from an @p InputQueue using
+ * @p chIQReadTimeout() and then written into an @p OutputQueue using
+ * @p chOQWriteTimeout() into a continuous loop, the lower side of the
+ * queues is served byte by byte as an interrupt handler would do.<br>
+ * The performance is calculated by measuring the number of iterations after
+ * a second of continuous operations.
+ */
+
+#define BMK17_BLOCK         128
+
+static void bmk17_execute(void) {
+  static uint8_t ib[BMK17_BLOCK], ob[BMK17_BLOCK], buf[BMK17_BLOCK];
+  static InputQueue iq;
+  static OutputQueue oq;
+  uint32_t n = 0;
+  unsigned i;
+
+  chIQInit(&iq, ib, sizeof(ib), NULL);
+  chOQInit(&oq, ob, sizeof(ob), NULL);
+  test_wait_tick();
+  test_start_timer(1000);
+  do {
+    chSysLock();
+    for (i = 0; i < BMK17_BLOCK; i++)
+      chIQPutI(&iq, (uint8_t)i);
+    chSysUnlock();
+    (void)chIQReadTimeout(&iq, buf, BMK17_BLOCK, TIME_IMMEDIATE);
+    (void)chOQWriteTimeout(&oq, buf, BMK17_BLOCK, TIME_IMMEDIATE);
+    chSysLock();
+    for (i = 0; i < BMK17_BLOCK; i++)
+      (void)chOQGetI(&oq);
+    chSysUnlock();
+    n++;
+#if defined(SIMULATOR)
+    ChkIntSources();
+#endif
+  } while (!test_timer_done);
+  test_print("--- Score : ");
+  test_printn(n * BMK17_BLOCK * 2);
+  test_println(" bytes/S");
+}
+
+ROMCONST struct testcase testbmk17 = {
+  "Benchmark, I/O Queues large blocks throughput",
+  NULL,
+  NULL,
+  bmk17_execute
+};
+
+#if CH_USE_MAILBOXES || defined(__DOXYGEN__)
+/**
+ * @page test_benchmarks_018 Mailbox batches throughput
+ *
+ * <h2>Description</h2>
+ * A producer thread posts messages into a mailbox and a consumer thread
+ * fetches them, using @p chMBPostBatch() and @p chMBFetchBatch() with
+ * batches of 1, 4, 16 and 64 messages.<br>
+ * The performance is calculated by measuring the number of messages
+ * exchanged after a second of continuous operations.
+ */
+
+#define BMK18_MAX_BATCH     64
+
+static msg_t bmk18_mbbuf[BMK18_MAX_BATCH];
+static Mailbox mb18;
+static cnt_t bmk18_batch;
+static uint32_t bmk18_count;
+
+static msg_t producer18(void *p) {
+  msg_t msgs[BMK18_MAX_BATCH];
+  cnt_t i;
+
+  (void)p;
+  for (i = 0; i < bmk18_batch; i++)
+    msgs[i] = i + 1;
+  while (!chThdShouldTerminate()) {
+    (void)chMBPostBatch(&mb18, msgs, bmk18_batch, TIME_INFINITE);
+#if defined(SIMULATOR)
+    ChkIntSources();
+#endif
+  }
+  msgs[0] = 0;
+  (void)chMBPostBatch(&mb18, msgs, 1, TIME_INFINITE);
+  return 0;
+}
+
+static msg_t consumer18(void *p) {
+  msg_t msgs[BMK18_MAX_BATCH];
+  cnt_t i, n;
+
+  (void)p;
+  while (TRUE) {
+    n = chMBFetchBatch(&mb18, msgs, bmk18_batch, TIME_INFINITE);
+    for (i = 0; i < n; i++)
+      if (msgs[i] == 0)
+        return 0;
+    bmk18_count += n;
+#if defined(SIMULATOR)
+    ChkIntSources();
+#endif
+  }
+}
+
+static void bmk18_execute(void) {
+
+  for (bmk18_batch = 1; bmk18_batch <= BMK18_MAX_BATCH; bmk18_batch *= 4) {
+    chMBInit(&mb18, bmk18_mbbuf, BMK18_MAX_BATCH);
+    bmk18_count = 0;
+    threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriority()-1,
+                                   producer18, NULL);
+    threads[1] = chThdCreateStatic(wa[1], WA_SIZE, chThdGetPriority()-1,
+                                   consumer18, NULL);
+    chThdSleepMilliseconds(1000);
+    chThdTerminate(threads[0]);
+    test_wait_threads();
+
+    test_print("--- Score : ");
+    test_printn(bmk18_count);
+    test_print(" msgs/S, batch ");
+    test_printn(bmk18_batch);
+    test_println("");
+  }
+}
+
+ROMCONST struct testcase testbmk18 = {
+  "Benchmark, mailbox batches",
+  NULL,
+  NULL,
+  bmk18_execute
+};
+#endif /* CH_USE_MAILBOXES */
+
+#if CH_USE_MUTEXES_CEILING || defined(__DOXYGEN__)
+/**
+ * @page test_benchmarks_019 Mutexes priority ceiling performance
+ *
+ * <h2>Description</h2>
+ * A priority ceiling mutex is locked/unlocked into a continuous loop as in
+ * @ref test_benchmarks_012.<br>
+ * Then a contended scenario is measured using both a priority inheritance
+ * and a priority ceiling mutex: the tester thread locks the mutex and
+ * signals an higher priority thread that locks the mutex too, then the
+ * mutex is unlocked. With priority inheritance the higher priority thread
+ * preempts the owner and blocks on the mutex, with the ceiling it is only
+ * made ready and runs after the unlock.<br>
+ * The performance is calculated by measuring the number of iterations after
+ * a second of continuous operations, the context switches per iteration
+ * are printed if @p CH_DBG_THREADS_ACCOUNTING is enabled.
+ */
+
+static msg_t thread19(void *p) {
+
+  (void)p;
+  while (TRUE) {
+    chSemWait(&sem1);
+    if (chThdShouldTerminate())
+      return 0;
+    chMtxLock(&mtx1);
+    chMtxUnlock();
+  }
+}
+
+static void bmk19_contended(const char *name) {
+  uint32_t n = 0;
+
+  threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriority()+1,
+                                 thread19, NULL);
+  test_wait_tick();
+  test_start_timer(1000);
+  do {
+    chMtxLock(&mtx1);
+    chSemSignal(&sem1);
+    chMtxUnlock();
+    n++;
+#if defined(SIMULATOR)
+    ChkIntSources();
+#endif
+  } while (!test_timer_done);
+#if CH_DBG_THREADS_ACCOUNTING
+  /* Each switch to the helper thread is paired with a switch back.*/
+  test_print("--- Switch: ");
+  test_printn((chThdGetSwitches(threads[0]) * 2) / n);
+  test_print(" ctxswc/cycle, ");
+  test_println(name);
+#endif
+  chThdTerminate(threads[0]);
+  chSemSignal(&sem1);
+  test_wait_threads();
+  test_print("--- Score : ");
+  test_printn(n);
+  test_print(" cycles/S, ");
+  test_println(name);
+}
+
+static void bmk19_execute(void) {
+  uint32_t n = 0;
+
+  chMtxInitCeiling(&mtx1, chThdGetPriority()+1);
+  test_wait_tick();
+  test_start_timer(1000);
+  do {
+    chMtxLock(&mtx1);
+    chMtxUnlock();
+    chMtxLock(&mtx1);
+    chMtxUnlock();
+    chMtxLock(&mtx1);
+    chMtxUnlock();
+    chMtxLock(&mtx1);
+    chMtxUnlock();
+    n++;
+#if defined(SIMULATOR)
+    ChkIntSources();
+#endif
+  } while (!test_timer_done);
+  test_print("--- Score : ");
+  test_printn(n * 4);
+  test_println(" lock+unlock/S, ceiling");
+
+  chSemInit(&sem1, 0);
+  chMtxInit(&mtx1);
+  bmk19_contended("inheritance");
+  chMtxInitCeiling(&mtx1, chThdGetPriority()+1);
+  bmk19_contended("ceiling");
+}
+
+ROMCONST struct testcase testbmk19 = {
+  "Benchmark, mutexes ceiling vs inheritance",
+  NULL,
+  NULL,
+  bmk19_execute
+};
+#endif /* CH_USE_MUTEXES_CEILING */
+
 /**
  * @brief   Test sequence for benchmarks.
  */
@@ -708,6 +1319,20 @@ ROMCONST struct testcase * ROMCONST patternbmk[] = {
   &testbmk12,
 #endif
   &testbmk13,
+  &testbmk14,
+#if CH_USE_HEAP && !CH_USE_MALLOC_HEAP
+  &testbmk15,
+#endif
+#if CH_USE_MEMPOOLS && CH_USE_MAILBOXES
+  &testbmk16,
+#endif
+  &testbmk17,
+#if CH_USE_MAILBOXES
+  &testbmk18,
+#endif
+#if CH_USE_MUTEXES_CEILING
+  &testbmk19,
+#endif
 #endif
   NULL
 };
@@ -140,7 +140,8 @@ ROMCONST struct testcase testdyn1 = {
  * Five thread creation are attempted from a pool containing only four
  * elements.<br>
  * The test expects the first four threads to successfully start and the last
- * one to fail.
+ * one to fail. The sequence is repeated through a magazine attached to the
+ * test thread if the option @p CH_USE_POOL_MAGAZINES is enabled.
  */
 
 static void dyn2_setup(void) {
@@ -151,6 +152,9 @@ static void dyn2_setup(void) {
 static void dyn2_execute(void) {
   int i;
   tprio_t prio = chThdGetPriority();
+#if CH_USE_POOL_MAGAZINES
+  PoolMagazine mg;
+#endif
 
   /* Adding the WAs to the pool. */
   for (i = 0; i < 4; i++)
@@ -178,6 +182,33 @@ static void dyn2_execute(void) {
   for (i = 0; i < 4; i++)
     test_assert(3, chPoolAlloc(&mp1) != NULL, "pool list empty");
   test_assert(4, chPoolAlloc(&mp1) == NULL, "pool list not empty");
+
+#if CH_USE_POOL_MAGAZINES
+  /* Same sequence through a magazine, the working areas of the terminated
+     threads are cached in the magazine until it is flushed. */
+  for (i = 0; i < 4; i++)
+    chPoolFree(&mp1, wa[i]);
+  chPoolMagazineInit(&mg, &mp1);
+  chPoolMagazineAttach(&mg);
+  threads[0] = chThdCreateFromMemoryPool(&mp1, prio-1, thread, "A");
+  threads[1] = chThdCreateFromMemoryPool(&mp1, prio-2, thread, "B");
+  threads[2] = chThdCreateFromMemoryPool(&mp1, prio-3, thread, "C");
+  threads[3] = chThdCreateFromMemoryPool(&mp1, prio-4, thread, "D");
+  threads[4] = chThdCreateFromMemoryPool(&mp1, prio-5, thread, "E");
+  test_assert(5, (threads[0] != NULL) &&
+                 (threads[1] != NULL) &&
+                 (threads[2] != NULL) &&
+                 (threads[3] != NULL) &&
+                 (threads[4] == NULL),
+                 "thread creation failed");
+  test_wait_threads();
+  test_assert_sequence(6, "ABCD");
+  chPoolMagazineAttach(NULL);
+  chPoolMagazineFlush(&mg);
+  for (i = 0; i < 4; i++)
+    test_assert(7, chPoolAlloc(&mp1) != NULL, "pool list empty");
+  test_assert(8, chPoolAlloc(&mp1) == NULL, "pool list not empty");
+#endif
 }
 
 ROMCONST struct testcase testdyn2 = {
@@ -50,6 +50,7 @@
  *
  * <h2>Test Cases</h2>
  * - @subpage test_mbox_001
+ * - @subpage test_mbox_002
  * .
  * @file testmbox.c
  * @brief Mailboxes test source file
@@ -218,6 +219,94 @@ ROMCONST struct testcase testmbox1 = {
   mbox1_execute
 };
 
+/**
+ * @page test_mbox_002 Batch operations
+ *
+ * <h2>Description</h2>
+ * Messages are posted/fetched in batches, partial batches are tested on
+ * full and empty mailboxes and across the buffer wrap. A thread waiting
+ * on an empty mailbox is released by a batch post.
+ */
+
+static msg_t thread2(void *p) {
+  msg_t msgs[MB_SIZE];
+  cnt_t i, n;
+
+  (void)p;
+  n = chMBFetchBatch(&mb1, msgs, MB_SIZE, TIME_INFINITE);
+  for (i = 0; i < n; i++)
+    test_emit_token(msgs[i]);
+  return 0;
+}
+
+static void mbox2_setup(void) {
+
+  chMBInit(&mb1, (msg_t *)test.wa.T0, MB_SIZE);
+}
+
+static void mbox2_execute(void) {
+  static const msg_t src[MB_SIZE + 2] = {'A', 'B', 'C', 'D', 'E', 'F', 'G'};
+  msg_t msgs[MB_SIZE + 2];
+  cnt_t i, n;
+
+  /*
+   * Partial batch on a mailbox with not enough space.
+   */
+  n = chMBPostBatch(&mb1, src, 3, TIME_INFINITE);
+  test_assert(1, n == 3, "wrong posted count");
+  n = chMBPostBatch(&mb1, &src[3], 4, TIME_INFINITE);
+  test_assert(2, n == 2, "wrong posted count");
+  test_assert(3, chMBGetFreeCountI(&mb1) == 0, "still empty");
+  n = chMBPostBatch(&mb1, src, 2, 1);
+  test_assert(4, n == 0, "posted on a full mailbox");
+  chSysLock();
+  n = chMBPostBatchI(&mb1, src, 2);
+  chSysUnlock();
+  test_assert(5, n == 0, "posted on a full mailbox");
+
+  /*
+   * Partial fetches, the second one crosses the buffer wrap.
+   */
+  n = chMBFetchBatch(&mb1, msgs, 2, TIME_INFINITE);
+  test_assert(6, n == 2, "wrong fetched count");
+  chSysLock();
+  n = chMBPostBatchI(&mb1, &src[5], 2);
+  chSysUnlock();
+  test_assert(7, n == 2, "wrong posted count");
+  n = chMBFetchBatch(&mb1, &msgs[2], MB_SIZE + 2, TIME_INFINITE);
+  test_assert(8, n == MB_SIZE, "wrong fetched count");
+  for (i = 0; i < MB_SIZE + 2; i++)
+    test_emit_token(msgs[i]);
+  test_assert_sequence(9, "ABCDEFG");
+  n = chMBFetchBatch(&mb1, msgs, 2, 1);
+  test_assert(10, n == 0, "fetched from an empty mailbox");
+  chSysLock();
+  n = chMBFetchBatchI(&mb1, msgs, 2);
+  chSysUnlock();
+  test_assert(11, n == 0, "fetched from an empty mailbox");
+  test_assert(12, chMBGetFreeCountI(&mb1) == MB_SIZE, "not empty");
+  test_assert(13, chMBGetUsedCountI(&mb1) == 0, "still full");
+
+  /*
+   * Waiting thread released by a batch, the mailbox buffer is the first
+   * working area so the second one is used.
+   */
+  threads[1] = chThdCreateStatic(wa[1], WA_SIZE, chThdGetPriority() + 1,
+                                 thread2, NULL);
+  n = chMBPostBatch(&mb1, src, 3, TIME_INFINITE);
+  test_assert(14, n == 3, "wrong posted count");
+  test_wait_threads();
+  test_assert_sequence(15, "ABC");
+  test_assert(16, chMBGetFreeCountI(&mb1) == MB_SIZE, "not empty");
+}
+
+ROMCONST struct testcase testmbox2 = {
+  "Mailboxes, batch operations",
+  mbox2_setup,
+  NULL,
+  mbox2_execute
+};
+
 #endif /* CH_USE_MAILBOXES */
 
 /**
@@ -226,6 +315,7 @@ ROMCONST struct testcase testmbox1 = {
 ROMCONST struct testcase * ROMCONST patternmbox[] = {
 #if CH_USE_MAILBOXES
   &testmbox1,
+  &testmbox2,
 #endif
   NULL
 };
@@ -46,6 +46,7 @@
  * - @p CH_USE_MUTEXES
  * - @p CH_USE_CONDVARS
  * - @p CH_DBG_THREADS_PROFILING
+ * - @p CH_USE_MUTEXES_CEILING
  * .
  * In case some of the required options are not enabled then some or all tests
  * may be skipped.
@@ -59,6 +60,7 @@
  * - @subpage test_mtx_006
  * - @subpage test_mtx_007
  * - @subpage test_mtx_008
+ * - @subpage test_mtx_009
  * .
  * @file testmtx.c
  * @brief Mutexes and CondVars test source file
@@ -622,6 +624,70 @@ ROMCONST struct testcase testmtx8 = {
   mtx8_execute
 };
 #endif /* CH_USE_CONDVARS */
+
+#if CH_USE_MUTEXES_CEILING
+/**
+ * @page test_mtx_009 Priority ceiling
+ *
+ * <h2>Description</h2>
+ * A priority ceiling mutex is locked and unlocked, also nested with a
+ * priority inheritance mutex, then an higher priority thread is created
+ * while the mutex is owned.<br>
+ * The test expects the owner to run at the ceiling priority until the
+ * unlock, the created thread to not preempt the owner and to find the
+ * mutex free without ever entering the mutex queue.
+ */
+
+static void mtx9_setup(void) {
+
+  chMtxInitCeiling(&m1, chThdGetPriority() + 2);
+  chMtxInit(&m2);
+}
+
+static msg_t thread13(void *p) {
+
+  chMtxLock(&m1);
+  test_emit_token(*(char *)p);
+  chMtxUnlock();
+  return 0;
+}
+
+static void mtx9_execute(void) {
+  tprio_t prio = chThdGetPriority();
+  bool_t b;
+
+  chMtxLock(&m1);
+  test_assert(1, chThdGetPriority() == prio + 2, "not at ceiling");
+  chMtxLock(&m2);
+  chMtxUnlock();
+  test_assert(2, chThdGetPriority() == prio + 2, "ceiling lost");
+  chMtxUnlock();
+  test_assert(3, chThdGetPriority() == prio, "wrong priority level");
+
+  b = chMtxTryLock(&m1);
+  test_assert(4, b, "already locked");
+  test_assert(5, chThdGetPriority() == prio + 2, "not at ceiling");
+  chMtxUnlockAll();
+  test_assert(6, chThdGetPriority() == prio, "wrong priority level");
+
+  chMtxLock(&m1);
+  threads[0] = chThdCreateStatic(wa[0], WA_SIZE, prio + 1, thread13, "B");
+  test_emit_token('A');
+  test_assert(7, threads[0]->p_state == THD_STATE_READY, "preempted");
+  chMtxUnlock();
+  test_wait_threads();
+  test_assert_sequence(8, "AB");
+  test_assert(9, isempty(&m1.m_queue), "queue not empty");
+  test_assert(10, m1.m_owner == NULL, "still owned");
+}
+
+ROMCONST struct testcase testmtx9 = {
+  "Mutexes, priority ceiling",
+  mtx9_setup,
+  NULL,
+  mtx9_execute
+};
+#endif /* CH_USE_MUTEXES_CEILING */
 #endif /* CH_USE_MUTEXES */
 
 /**
@@ -641,6 +707,9 @@ ROMCONST struct testcase * ROMCONST patternmtx[] = {
   &testmtx7,
   &testmtx8,
 #endif
+#if CH_USE_MUTEXES_CEILING
+  &testmtx9,
+#endif
 #endif
   NULL
 };
@@ -47,6 +47,7 @@
  *
  * <h2>Test Cases</h2>
  * - @subpage test_pools_001
+ * - @subpage test_pools_002
  * .
  * @file testpools.c
  * @brief Memory Pools test source file
@@ -104,6 +105,65 @@ ROMCONST struct testcase testpools1 = {
   pools1_execute
 };
 
+/**
+ * @page test_pools_002 Batch operations test
+ *
+ * <h2>Description</h2>
+ * Five memory blocks are added to a memory pool as a single batch then
+ * removed with a batch allocation, the same blocks are then allocated and
+ * released through a magazine if the option @p CH_USE_POOL_MAGAZINES is
+ * enabled.<br>
+ * The test expects to find the pool queue in the proper status after each
+ * operation.
+ */
+
+static void pools2_setup(void) {
+
+  chPoolInit(&mp1, THD_WA_SIZE(THREADS_STACK_SIZE), NULL);
+}
+
+static void pools2_execute(void) {
+  void *objs[MAX_THREADS + 1];
+  int i;
+#if CH_USE_POOL_MAGAZINES
+  PoolMagazine mg;
+#endif
+
+  /* Adding the WAs to the pool as a batch. */
+  for (i = 0; i < MAX_THREADS; i++)
+    objs[i] = wa[i];
+  chPoolFreeBatch(&mp1, objs, MAX_THREADS);
+
+  /* Empting the pool with a bigger batch. */
+  test_assert(1, chPoolAllocBatch(&mp1, objs, MAX_THREADS + 1) == MAX_THREADS,
+              "wrong batch size");
+  test_assert(2, chPoolAlloc(&mp1) == NULL, "list not empty");
+
+#if CH_USE_POOL_MAGAZINES
+  /* Allocating all the objects through a magazine. */
+  chPoolFreeBatch(&mp1, objs, MAX_THREADS);
+  chPoolMagazineInit(&mg, &mp1);
+  for (i = 0; i < MAX_THREADS; i++)
+    test_assert(3, (objs[i] = chPoolMagazineAlloc(&mg)) != NULL, "list empty");
+  test_assert(4, chPoolMagazineAlloc(&mg) == NULL, "list not empty");
+
+  /* Releasing through the magazine, the objects return to the pool only
+     after a flush. */
+  for (i = 0; i < MAX_THREADS; i++)
+    chPoolMagazineFree(&mg, objs[i]);
+  chPoolMagazineFlush(&mg);
+  test_assert(5, chPoolAllocBatch(&mp1, objs, MAX_THREADS + 1) == MAX_THREADS,
+              "wrong batch size");
+#endif
+}
+
+ROMCONST struct testcase testpools2 = {
+  "Memory Pools, batch operations",
+  pools2_setup,
+  NULL,
+  pools2_execute
+};
+
 #endif /* CH_USE_MEMPOOLS */
 
 /*
@@ -112,6 +172,7 @@ ROMCONST struct testcase testpools1 = {
 ROMCONST struct testcase * ROMCONST patternpools[] = {
 #if CH_USE_MEMPOOLS
   &testpools1,
+  &testpools2,
 #endif
   NULL
 };
@@ -33,7 +33,8 @@
  * File: @ref testqueues.c
  *
  * <h2>Description</h2>
- * This module implements the test sequence for the @ref io_queues subsystem.
+ * This module implements the test sequence for the @ref io_queues and
+ * @ref rings subsystems.
  * The tests are performed by inserting and removing data from queues and by
  * checking both the queues status and the correct sequence of the extracted
  * data.
@@ -46,6 +47,7 @@
  * <h2>Preconditions</h2>
  * The module requires the following kernel options:
  * - @p CH_USE_QUEUES (and dependent options)
+ * - @p CH_USE_RINGS (and dependent options)
  * .
  * In case some of the required options are not enabled then some or all tests
  * may be skipped.
@@ -53,6 +55,8 @@
  * <h2>Test Cases</h2>
  * - @subpage test_queues_001
  * - @subpage test_queues_002
+ * - @subpage test_queues_003
+ * - @subpage test_queues_004
  * .
  * @file testqueues.c
  * @brief I/O Queues test source file
@@ -226,6 +230,158 @@ ROMCONST struct testcase testqueues2 = {
 };
 #endif /* CH_USE_QUEUES */
 
+#if CH_USE_RINGS
+
+#define TEST_RINGS_SIZE 4
+
+static Ring rg;
+static uint32_t rgbuf[TEST_RINGS_SIZE];
+
+/**
+ * @page test_queues_003 Rings functionality and APIs
+ *
+ * <h2>Description</h2>
+ * This test case tests the wait-free operations on a @p Ring object, the
+ * ring is filled, emptied and wrapped around several times. The doorbell
+ * must be rung only when a record is put into an empty ring.
+ */
+
+static void queues3_setup(void) {
+
+  chRingInit(&rg, rgbuf, sizeof(uint32_t), TEST_RINGS_SIZE);
+}
+
+static void queues3_execute(void) {
+  unsigned i;
+  uint32_t rec;
+
+  /* Initial empty state */
+  test_assert(1, chRingGetUsed(&rg) == 0, "not empty");
+  test_assert(2, !chRingRead(&rg, &rec), "read from an empty ring");
+
+  /* Ring filling */
+  rec = 'A';
+  test_assert(3, chRingWrite(&rg, &rec) == RING_WAS_EMPTY,
+              "failed to report RING_WAS_EMPTY");
+  for (i = 1; i < TEST_RINGS_SIZE; i++) {
+    rec = 'A' + i;
+    test_assert(4, chRingWrite(&rg, &rec) == RING_OK, "wrong write status");
+  }
+  test_assert(5, chRingGetUsed(&rg) == TEST_RINGS_SIZE, "still has space");
+  test_assert(6, chRingWrite(&rg, &rec) == RING_FULL,
+              "failed to report RING_FULL");
+
+  /* Ring emptying */
+  while (chRingRead(&rg, &rec))
+    test_emit_token((char)rec);
+  test_assert(7, chRingGetUsed(&rg) == 0, "still full");
+  test_assert_sequence(8, "ABCD");
+
+  /* Wrapping around */
+  for (i = 0; i < TEST_RINGS_SIZE * 3; i++) {
+    uint32_t out;
+
+    rec = i;
+    chRingWrite(&rg, &rec);
+    rec = i + 1;
+    chRingWrite(&rg, &rec);
+    test_assert(9, chRingRead(&rg, &out) && (out == i), "wrong record");
+    test_assert(10, chRingRead(&rg, &out) && (out == i + 1), "wrong record");
+  }
+
+  /* Doorbell rung on the first put only */
+  chSysLock();
+  rec = 'A';
+  chRingPutI(&rg, &rec);
+  rec = 'B';
+  chRingPutI(&rg, &rec);
+  chSysUnlock();
+  test_assert(11, chBSemWaitTimeout(&rg.r_doorbell, TIME_IMMEDIATE) == RDY_OK,
+              "doorbell not rung");
+  test_assert(12, chBSemWaitTimeout(&rg.r_doorbell, TIME_IMMEDIATE) == RDY_TIMEOUT,
+              "doorbell rung twice");
+  test_assert(13, chRingGetTimeout(&rg, &rec, TIME_IMMEDIATE) == RDY_OK,
+              "wrong get status");
+  test_assert(14, chRingGetTimeout(&rg, &rec, TIME_IMMEDIATE) == RDY_OK,
+              "wrong get status");
+
+  /* Timeout */
+  test_assert(15, chRingGetTimeout(&rg, &rec, 10) == RDY_TIMEOUT,
+              "wrong timeout return");
+}
+
+ROMCONST struct testcase testqueues3 = {
+  "Queues, SPSC rings",
+  queues3_setup,
+  NULL,
+  queues3_execute
+};
+
+/**
+ * @page test_queues_004 Rings blocking consumer
+ *
+ * <h2>Description</h2>
+ * A consumer thread blocked on an empty @p Ring object is woken by the
+ * doorbell rung from a lower priority producer thread and from a virtual
+ * timer callback, the records must be received in order.
+ */
+
+static msg_t thread3(void *p) {
+  unsigned i;
+
+  (void)p;
+  for (i = 0; i < 8; i++) {
+    uint32_t rec = 'A' + i;
+
+    chSysLock();
+    chRingPutI(&rg, &rec);
+    chSchRescheduleS();
+    chSysUnlock();
+  }
+  return 0;
+}
+
+static void vt_put(void *p) {
+  uint32_t rec = 'V';
+
+  (void)p;
+  chSysLockFromIsr();
+  chRingPutI(&rg, &rec);
+  chSysUnlockFromIsr();
+}
+
+static void queues4_execute(void) {
+  unsigned i;
+  uint32_t rec;
+  VirtualTimer vt;
+
+  /* Thread producer */
+  threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriority()-1, thread3, NULL);
+  for (i = 0; i < 8; i++) {
+    if (chRingGetTimeout(&rg, &rec, MS2ST(100)) != RDY_OK)
+      break;
+    test_emit_token((char)rec);
+  }
+  test_wait_threads();
+  test_assert_sequence(1, "ABCDEFGH");
+
+  /* Interrupt producer */
+  chSysLock();
+  chVTSetI(&vt, MS2ST(5), vt_put, NULL);
+  chSysUnlock();
+  test_assert(2, chRingGetTimeout(&rg, &rec, MS2ST(100)) == RDY_OK,
+              "not woken");
+  test_assert(3, rec == 'V', "wrong record");
+}
+
+ROMCONST struct testcase testqueues4 = {
+  "Queues, SPSC rings blocking consumer",
+  queues3_setup,
+  NULL,
+  queues4_execute
+};
+#endif /* CH_USE_RINGS */
+
 /**
  * @brief   Test sequence for queues.
  */
@@ -233,6 +389,10 @@ ROMCONST struct testcase * ROMCONST patternqueues[] = {
 #if CH_USE_QUEUES
   &testqueues1,
   &testqueues2,
+#endif
+#if CH_USE_RINGS
+  &testqueues3,
+  &testqueues4,
 #endif
   NULL
 };
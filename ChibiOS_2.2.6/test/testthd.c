@@ -50,6 +50,7 @@
  * - @subpage test_threads_002
  * - @subpage test_threads_003
  * - @subpage test_threads_004
+ * - @subpage test_threads_005
  * .
  * @file testthd.c
  * @brief Threads and Scheduler test source file
@@ -229,6 +230,57 @@ ROMCONST struct testcase testthd4 = {
   thd4_execute
 };
 
+#if CH_DBG_THREADS_ACCOUNTING || defined(__DOXYGEN__)
+/**
+ * @page test_threads_005 Threads accounting test
+ *
+ * <h2>Description</h2>
+ * A lower priority thread consumes CPU time while the test thread sleeps,
+ * its runtime, number of switches and longest burst are verified to have
+ * been accounted.
+ */
+
+static msg_t thread5(void *p) {
+  systime_t start = chTimeNow();
+
+  (void)p;
+  /* Busy loop, the profiling based test_cpu_pulse() is not usable here
+     because the accounting does not require the profiling.*/
+  while (chTimeIsWithin(start, start + MS2ST(20))) {
+#if defined(SIMULATOR)
+    ChkIntSources();
+#endif
+  }
+  return 0;
+}
+
+static void thd5_execute(void) {
+  uint32_t switches;
+
+  threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriority()-1,
+                                 thread5, NULL);
+  test_assert(1, chThdGetRuntime(threads[0]) == 0, "runtime not zero");
+  test_assert(2, chThdGetSwitches(threads[0]) == 0, "switches not zero");
+  switches = chThdGetSwitches(chThdSelf());
+  chThdWait(threads[0]);
+  test_assert(3, chThdGetSwitches(chThdSelf()) > switches,
+              "switch not accounted");
+  test_assert(4, chThdGetSwitches(threads[0]) >= 1, "switch not accounted");
+  test_assert(5, chThdGetRuntime(threads[0]) > 0, "runtime not accounted");
+  test_assert(6, (chThdGetMaxBurst(threads[0]) > 0) &&
+                 (chThdGetMaxBurst(threads[0]) <= chThdGetRuntime(threads[0])),
+              "wrong burst");
+  threads[0] = NULL;
+}
+
+ROMCONST struct testcase testthd5 = {
+  "Threads, accounting",
+  NULL,
+  NULL,
+  thd5_execute
+};
+#endif /* CH_DBG_THREADS_ACCOUNTING */
+
 /**
  * @brief   Test sequence for threads.
  */
@@ -237,5 +289,8 @@ ROMCONST struct testcase * ROMCONST patternthd[] = {
   &testthd2,
   &testthd3,
   &testthd4,
+#if CH_DBG_THREADS_ACCOUNTING || defined(__DOXYGEN__)
+  &testthd5,
+#endif
   NULL
 };
@@ -0,0 +1,309 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,2011 Giovanni Di Sirio.
+
+    This file is part of ChibiOS/RT.
+
+    ChibiOS/RT is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/RT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+                                      ---
+
+    A special exception to the GPL can be applied should you wish to distribute
+    a combined work that includes ChibiOS/RT, without being obliged to provide
+    the source code for any proprietary components. See the file exception.txt
+    for full details of how and when the exception can be applied.
+*/
+
+
+/*
+ * Converts a ChibiOS/RT binary trace stream into the Chrome/Perfetto JSON
+ * timeline format.
+ *
+ * Usage: chtrace2json [input [output]]
+ *
+ * Each thread is a timeline track showing its running slices, interrupts
+ * are on a separate track. Semaphores, mutexes, mailboxes and virtual
+ * timers events are instant events on the track of the thread generating
+ * them, the wake up events are linked by flow arrows to the switch in of
+ * the readied thread and the wake up to run latency statistics are
+ * printed on the standard error.
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "chtrace.h"
+
+#define MAX_THREADS         256
+#define ISR_TID             0
+
+typedef struct {
+  uint32_t      id;
+  char          name[TRACE_NAME_SIZE + 1];
+  int           named;
+  int           waking;
+  unsigned      flow;
+  uint64_t      wake_time;
+} thread_t;
+
+static const char *states[] = {
+  "READY", "CURRENT", "SUSPENDED", "WTSEM", "WTMTX", "WTCOND", "SLEEPING",
+  "WTEXIT", "WTOREVT", "WTANDEVT", "SNDMSG", "WTMSG", "WTQUEUE", "FINAL"
+};
+
+static const char *events[] = {
+  "header", "name", "switch", "isr enter", "isr leave", "sem wait",
+  "sem signal", "mtx wait", "mtx unlock", "mb post", "mb fetch", "vt fire"
+};
+
+static thread_t threads[MAX_THREADS];
+static unsigned nthreads;
+static FILE *out;
+static int first = 1;
+static uint32_t freq;
+static uint64_t origin;
+
+static uint32_t get16(const uint8_t *p) {
+
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8);
+}
+
+static uint32_t get32(const uint8_t *p) {
+
+  return get16(p) | (get16(p + 2) << 16);
+}
+
+static uint64_t get64(const uint8_t *p) {
+
+  return (uint64_t)get32(p) | ((uint64_t)get32(p + 4) << 32);
+}
+
+/*
+ * Thread lookup, the track identifiers start from one because the track
+ * zero is reserved to the interrupts.
+ */
+static unsigned lookup(uint32_t id) {
+  unsigned i;
+
+  for (i = 0; i < nthreads; i++)
+    if (threads[i].id == id)
+      return i + 1;
+  if (nthreads == MAX_THREADS) {
+    fprintf(stderr, "chtrace2json: too many threads\n");
+    exit(1);
+  }
+  memset(&threads[nthreads], 0, sizeof(thread_t));
+  threads[nthreads].id = id;
+  return ++nthreads;
+}
+
+static double us(uint64_t t) {
+
+  return (double)(t - origin) * 1000000.0 / (double)freq;
+}
+
+static void emit(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+
+static void emit(const char *fmt, ...) {
+  va_list ap;
+
+  fputs(first ? "\n  " : ",\n  ", out);
+  first = 0;
+  va_start(ap, fmt);
+  vfprintf(out, fmt, ap);
+  va_end(ap);
+}
+
+int main(int argc, char *argv[]) {
+  FILE *in = stdin;
+  uint8_t rec[TRACE_RECORD_SIZE];
+  unsigned width, cur = 0, flows = 0, isrdepth = 0;
+  int started = 0;
+  uint64_t mask, raw, last = 0, t = 0, start = 0;
+  unsigned long nrec = 0, lost = 0, nlat = 0;
+  uint64_t latmin = UINT64_MAX, latmax = 0, latsum = 0;
+  unsigned i;
+
+  out = stdout;
+  if (argc > 3) {
+    fprintf(stderr, "Usage: chtrace2json [input [output]]\n");
+    return 1;
+  }
+  if ((argc > 1) && ((in = fopen(argv[1], "rb")) == NULL)) {
+    perror(argv[1]);
+    return 1;
+  }
+  if ((argc > 2) && ((out = fopen(argv[2], "w")) == NULL)) {
+    perror(argv[2]);
+    return 1;
+  }
+
+  if ((fread(rec, sizeof(rec), 1, in) != 1) ||
+      (rec[TRACE_OFF_TYPE] != TRACE_EV_HEADER) ||
+      (get32(rec + TRACE_OFF_THREAD) != TRACE_MAGIC)) {
+    fprintf(stderr, "chtrace2json: not a trace stream\n");
+    return 1;
+  }
+  if (get16(rec + TRACE_OFF_LOST) != TRACE_VERSION) {
+    fprintf(stderr, "chtrace2json: unsupported version %u\n",
+            (unsigned)get16(rec + TRACE_OFF_LOST));
+    return 1;
+  }
+  width = rec[TRACE_OFF_STATE];
+  freq = get32(rec + TRACE_OFF_OBJECT);
+  if ((width == 0) || (width > 64) || (freq == 0)) {
+    fprintf(stderr, "chtrace2json: invalid header\n");
+    return 1;
+  }
+  mask = width == 64 ? UINT64_MAX : (((uint64_t)1 << width) - 1);
+
+  fputs("{\"displayTimeUnit\": \"ns\", \"traceEvents\": [", out);
+  emit("{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %u, "
+       "\"args\": {\"name\": \"interrupts\"}}", ISR_TID);
+
+  while (fread(rec, sizeof(rec), 1, in) == 1) {
+    unsigned type = rec[TRACE_OFF_TYPE];
+    unsigned state = rec[TRACE_OFF_STATE];
+    uint32_t tid = get32(rec + TRACE_OFF_THREAD);
+    uint32_t obj = get32(rec + TRACE_OFF_OBJECT);
+    uint32_t arg = get32(rec + TRACE_OFF_ARG);
+    unsigned n = lookup(tid);
+    thread_t *tp = &threads[n - 1];
+
+    nrec++;
+    if (type == TRACE_EV_NAME) {
+      memcpy(tp->name, rec + TRACE_OFF_NAME, TRACE_NAME_SIZE);
+      tp->named = 1;
+      emit("{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, "
+           "\"tid\": %u, \"args\": {\"name\": \"%s (%08x)\"}}",
+           n, tp->name, (unsigned)tid);
+      continue;
+    }
+
+    /* Timestamps narrower than 64 bits are extended assuming that two
+       consecutive records are less than a counter period apart. The
+       origin is the first event because the records buffered before the
+       stream start are older than the header.*/
+    raw = get64(rec + TRACE_OFF_TIME) & mask;
+    if (!started) {
+      origin = t = raw;
+      started = 1;
+    }
+    else
+      t += (raw - last) & mask;
+    last = raw;
+
+    if (get16(rec + TRACE_OFF_LOST) != 0) {
+      lost += get16(rec + TRACE_OFF_LOST);
+      emit("{\"name\": \"lost %u records\", \"ph\": \"i\", \"s\": \"g\", "
+           "\"pid\": 1, \"tid\": %u, \"ts\": %.3f}",
+           (unsigned)get16(rec + TRACE_OFF_LOST), ISR_TID, us(t));
+    }
+
+    switch (type) {
+    case TRACE_EV_SWITCH:
+      if (cur == 0)
+        cur = lookup(arg);
+      else
+        emit("{\"name\": \"running\", \"ph\": \"X\", \"pid\": 1, "
+             "\"tid\": %u, \"ts\": %.3f, \"dur\": %.3f, "
+             "\"args\": {\"out\": \"%s\"}}",
+             cur, us(start), us(t) - us(start),
+             state < sizeof(states) / sizeof(states[0]) ?
+             states[state] : "?");
+      cur = n;
+      start = t;
+      if (tp->waking) {
+        uint64_t lat = t - tp->wake_time;
+
+        emit("{\"name\": \"wakeup\", \"cat\": \"wakeup\", \"ph\": \"f\", "
+             "\"bp\": \"e\", \"id\": %u, \"pid\": 1, \"tid\": %u, "
+             "\"ts\": %.3f}", tp->flow, n, us(t));
+        tp->waking = 0;
+        nlat++;
+        latsum += lat;
+        if (lat < latmin)
+          latmin = lat;
+        if (lat > latmax)
+          latmax = lat;
+      }
+      break;
+    case TRACE_EV_ISR_ENTER:
+      isrdepth++;
+      emit("{\"name\": \"ISR %u\", \"ph\": \"B\", \"pid\": 1, \"tid\": %u, "
+           "\"ts\": %.3f}", state, ISR_TID, us(t));
+      break;
+    case TRACE_EV_ISR_LEAVE:
+      /* An exit without entry happens when the stream starts within an
+         interrupt handler.*/
+      if (isrdepth > 0) {
+        isrdepth--;
+        emit("{\"ph\": \"E\", \"pid\": 1, \"tid\": %u, \"ts\": %.3f}",
+             ISR_TID, us(t));
+      }
+      break;
+    case TRACE_EV_SEM_SIGNAL:
+    case TRACE_EV_MTX_UNLOCK:
+      {
+        unsigned w = lookup(arg);
+
+        threads[w - 1].waking = 1;
+        threads[w - 1].wake_time = t;
+        threads[w - 1].flow = ++flows;
+        emit("{\"name\": \"wakeup\", \"cat\": \"wakeup\", \"ph\": \"s\", "
+             "\"id\": %u, \"pid\": 1, \"tid\": %u, \"ts\": %.3f}",
+             flows, isrdepth > 0 ? ISR_TID : n, us(t));
+      }
+      /* Falls through.*/
+    case TRACE_EV_SEM_WAIT:
+    case TRACE_EV_MTX_WAIT:
+    case TRACE_EV_MB_POST:
+    case TRACE_EV_MB_FETCH:
+    case TRACE_EV_VT_FIRE:
+      emit("{\"name\": \"%s\", \"ph\": \"i\", \"s\": \"t\", \"pid\": 1, "
+           "\"tid\": %u, \"ts\": %.3f, "
+           "\"args\": {\"object\": \"%08x\", \"arg\": \"%08x\"%s}}",
+           events[type], isrdepth > 0 ? ISR_TID : n, us(t),
+           (unsigned)obj, (unsigned)arg,
+           state & TRACE_MB_BATCH ? ", \"batch\": true" : "");
+      break;
+    default:
+      fprintf(stderr, "chtrace2json: unknown record type %u\n", type);
+      break;
+    }
+  }
+  if (cur != 0)
+    emit("{\"name\": \"running\", \"ph\": \"X\", \"pid\": 1, \"tid\": %u, "
+         "\"ts\": %.3f, \"dur\": %.3f}", cur, us(start), us(t) - us(start));
+
+  /* Threads seen without a name record, created after the stream start.*/
+  for (i = 0; i < nthreads; i++)
+    if (!threads[i].named)
+      emit("{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, "
+           "\"tid\": %u, \"args\": {\"name\": \"thread %08x\"}}",
+           i + 1, (unsigned)threads[i].id);
+  fputs("\n]}\n", out);
+
+  fprintf(stderr, "records: %lu, lost: %lu, threads: %u\n",
+          nrec, lost, nthreads);
+  if (nlat > 0)
+    fprintf(stderr, "wakeup to run latency: %lu samples, "
+            "min %.3f uS, avg %.3f uS, max %.3f uS\n", nlat,
+            (double)latmin * 1000000.0 / freq,
+            (double)latsum / nlat * 1000000.0 / freq,
+            (double)latmax * 1000000.0 / freq);
+  return 0;
+}
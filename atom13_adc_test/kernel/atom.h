@@ -70,7 +70,6 @@ typedef struct atom_tcb
 
 
 /* Global data */
-extern ATOM_TCB *tcbReadyQ;
 extern uint8_t atomOSStarted;
 
 
@@ -110,6 +109,8 @@ extern uint8_t tcbEnqueuePriority (ATOM_TCB **tcb_queue_ptr, ATOM_TCB *tcb_ptr);
 extern ATOM_TCB *tcbDequeueHead (ATOM_TCB **tcb_queue_ptr);
 extern ATOM_TCB *tcbDequeueEntry (ATOM_TCB **tcb_queue_ptr, ATOM_TCB *tcb_ptr);
 extern ATOM_TCB *tcbDequeuePriority (ATOM_TCB **tcb_queue_ptr, uint8_t priority);
+extern uint8_t tcbEnqueueReady (ATOM_TCB *tcb_ptr);
+extern ATOM_TCB *tcbDequeueReady (uint8_t priority);
 
 extern ATOM_TCB *atomCurrentContext (void);
 
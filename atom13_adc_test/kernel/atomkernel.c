@@ -140,6 +140,8 @@
  * \li tcbDequeueHead(): Dequeues the head of a TCB list.
  * \li tcbDequeueEntry(): Dequeues a particular entry from a TCB list.
  * \li tcbDequeuePriority(): Dequeues an entry from a TCB list using priority.
+ * \li tcbEnqueueReady(): Enqueues a TCB on the ready queue.
+ * \li tcbDequeueReady(): Dequeues the next TCB to run from the ready queue.
  *
  */
 
@@ -150,18 +152,25 @@
 
 /* Global data */
 
+/** Set to TRUE when OS is started and running threads */
+uint8_t atomOSStarted = FALSE;
+
+
+/* Local data */
+
 /**
- * This is the head of the queue of threads that are ready to run. It is
- * ordered by priority, with the higher priority threads coming first. Where
- * there are multiple threads of the same priority, the TCB (task control
- * block) pointers are FIFO-ordered.
- *
- * Dequeuing the head is a fast operation because the list is ordered.
- * Enqueuing may have to walk up to the end of the list. This means that
- * context-switch times depend on the number of threads on the ready queue,
- * but efficient use is made of available RAM on tiny systems by avoiding
- * priority tables etc. This scheme can be easily swapped out for other
- * scheduler schemes by replacing the TCB enqueue and dequeue functions.
+ * This is the queue of threads that are ready to run. There is one list
+ * per priority level, where there are multiple threads of the same
+ * priority the TCB (task control block) pointers are FIFO-ordered. Each
+ * list is circular, the head's prev_tcb pointer is the tail of the list,
+ * so that TCBs can be enqueued at the tail without walking the list.
+ *
+ * A two-level bitmap records which priority levels have ready threads. Bit
+ * (priority & 31) of ready_map[priority >> 5] is set when the list for that
+ * priority is not empty, and bit n of ready_group is set when ready_map[n]
+ * is non-zero. The highest priority ready thread is found with two
+ * find-first-set operations, so enqueuing and dequeuing take constant time
+ * whatever the number of threads on the ready queue.
  *
  * Once a thread is scheduled in, it is not present on the ready queue or any
  * other kernel queue while it is running. When scheduled out it will be
@@ -169,13 +178,13 @@
  * on some OS primitive if no longer ready (e.g. on the suspended TCB queue
  * for a semaphore, or in the timer list if suspended on a timer delay).
  */
-ATOM_TCB *tcbReadyQ = NULL;
+static ATOM_TCB *ready_queue[256];
 
-/** Set to TRUE when OS is started and running threads */
-uint8_t atomOSStarted = FALSE;
+/** Ready queue priority bitmap, one bit per priority level */
+static uint32_t ready_map[8];
 
-
-/* Local data */
+/** Ready queue group bitmap, one bit per non-zero ready_map entry */
+static uint8_t ready_group;
 
 /** This is a pointer to the TCB for the currently-running thread */
 static ATOM_TCB *curr_tcb = NULL;
@@ -196,6 +205,7 @@ static int atomIntCnt = 0;
 /* Forward declarations */
 static void atomThreadSwitch(ATOM_TCB *old_tcb, ATOM_TCB *new_tcb);
 static void atomIdleThread (uint32_t data);
+static uint8_t tcbLowestBit (uint32_t bits);
 
 
 /**
@@ -253,7 +263,7 @@ void atomSched (uint8_t timer_tick)
          * actually be the suspending thread if it was unsuspended
          * before the scheduler was called.
          */
-        new_tcb = tcbDequeueHead (&tcbReadyQ);
+        new_tcb = tcbDequeueReady (IDLE_THREAD_PRIORITY);
 
         /**
          * Don't need to add the current thread to any queue because
@@ -296,13 +306,13 @@ void atomSched (uint8_t timer_tick)
         if (lowest_pri >= 0)
         {
             /* Check for a thread at the given minimum priority level or higher */
-            new_tcb = tcbDequeuePriority (&tcbReadyQ, (uint8_t)lowest_pri);
+            new_tcb = tcbDequeueReady ((uint8_t)lowest_pri);
 
             /* If a thread was found, schedule it in */
             if (new_tcb)
             {
                 /* Add the current thread to the ready queue */
-                (void)tcbEnqueuePriority (&tcbReadyQ, curr_tcb);
+                (void)tcbEnqueueReady (curr_tcb);
 
                 /* Switch to the new thread */
                 atomThreadSwitch (curr_tcb, new_tcb);
@@ -455,7 +465,7 @@ uint8_t atomThreadCreate (ATOM_TCB *tcb_ptr, uint8_t priority, void (*entry_poin
         CRITICAL_START ();
 
         /* Put this thread on the ready queue */
-        if (tcbEnqueuePriority (&tcbReadyQ, tcb_ptr) != ATOM_OK)
+        if (tcbEnqueueReady (tcb_ptr) != ATOM_OK)
         {
             /* Exit critical region */
             CRITICAL_END ();
@@ -657,10 +667,19 @@ ATOM_TCB *atomCurrentContext (void)
 uint8_t atomOSInit (void *idle_thread_stack_top, uint32_t idle_thread_stack_size)
 {
     uint8_t status;
+    int i;
 
     /* Initialise data */
     curr_tcb = NULL;
-    tcbReadyQ = NULL;
+    for (i = 0; i < 256; i++)
+    {
+        ready_queue[i] = NULL;
+    }
+    for (i = 0; i < 8; i++)
+    {
+        ready_map[i] = 0;
+    }
+    ready_group = 0;
     atomOSStarted = FALSE;
 
     /* Create the idle thread */
@@ -709,7 +728,7 @@ void atomOSStart (void)
      * the idle thread (the lowest priority allowed to be scheduled is the
      * idle thread's priority, 255).
      */
-    new_tcb = tcbDequeuePriority (&tcbReadyQ, 255);
+    new_tcb = tcbDequeueReady (IDLE_THREAD_PRIORITY);
     if (new_tcb)
     {
         /* Set the new currently-running thread pointer */
@@ -1030,3 +1049,181 @@ ATOM_TCB *tcbDequeuePriority (ATOM_TCB **tcb_queue_ptr, uint8_t priority)
 
     return (ret_ptr);
 }
+
+
+/**
+ * \b tcbEnqueueReady
+ *
+ * This is an internal function not for use by application code.
+ *
+ * Enqueues the TCB \c tcb_ptr on the ready queue. The TCB is placed at the
+ * end of the TCBs at the same priority, calls to tcbDequeueReady() will
+ * dequeue same-priority TCBs in FIFO order.
+ *
+ * \b NOTE: Assumes that the caller is already in a critical section.
+ *
+ * @param[in] tcb_ptr Pointer to TCB to enqueue
+ *
+ * @retval ATOM_OK Success
+ * @retval ATOM_ERR_PARAM Bad parameters
+ */
+uint8_t tcbEnqueueReady (ATOM_TCB *tcb_ptr)
+{
+    uint8_t status;
+    uint8_t priority;
+    ATOM_TCB *head_ptr;
+
+    /* Parameter check */
+    if (tcb_ptr == NULL)
+    {
+        /* Return error */
+        status = ATOM_ERR_PARAM;
+    }
+    else
+    {
+        priority = tcb_ptr->priority;
+        head_ptr = ready_queue[priority];
+        if (head_ptr == NULL)
+        {
+            /* List is empty, the TCB becomes the head and the tail */
+            tcb_ptr->prev_tcb = tcb_ptr->next_tcb = tcb_ptr;
+            ready_queue[priority] = tcb_ptr;
+
+            /* Mark the priority level as ready */
+            ready_map[priority >> 5] |= ((uint32_t)1 << (priority & 31));
+            ready_group |= (uint8_t)(1 << (priority >> 5));
+        }
+        else
+        {
+            /* Insert at the tail, between the current tail and the head */
+            tcb_ptr->prev_tcb = head_ptr->prev_tcb;
+            tcb_ptr->next_tcb = head_ptr;
+            head_ptr->prev_tcb->next_tcb = tcb_ptr;
+            head_ptr->prev_tcb = tcb_ptr;
+        }
+
+        /* Successful */
+        status = ATOM_OK;
+    }
+
+    return (status);
+}
+
+
+/**
+ * \b tcbDequeueReady
+ *
+ * This is an internal function not for use by application code.
+ *
+ * Dequeues the first TCB of the highest priority ready threads from the
+ * ready queue, if that priority is the given priority or higher.
+ *
+ * The TCB will be removed from the queue. Same priority TCBs will be dequeued
+ * in FIFO order.
+ *
+ * \b NOTE: Assumes that the caller is already in a critical section.
+ *
+ * @param[in] priority Minimum priority to qualify for dequeue
+ *
+ * @return Pointer to the dequeued TCB, or NULL if none found within priority
+ */
+ATOM_TCB *tcbDequeueReady (uint8_t priority)
+{
+    ATOM_TCB *ret_ptr;
+    uint8_t group, ready_pri;
+
+    /* Check for an empty queue */
+    if (ready_group == 0)
+    {
+        /* Return NULL */
+        ret_ptr = NULL;
+    }
+    else
+    {
+        /* Find the highest priority level with ready threads */
+        group = tcbLowestBit (ready_group);
+        ready_pri = (uint8_t)((group << 5) + tcbLowestBit (ready_map[group]));
+
+        /* Check if it is within our range */
+        if (ready_pri > priority)
+        {
+            /* No higher priority ready threads found */
+            ret_ptr = NULL;
+        }
+        else
+        {
+            /* Remove the list head */
+            ret_ptr = ready_queue[ready_pri];
+            if (ret_ptr->next_tcb == ret_ptr)
+            {
+                /* Last TCB at this priority, the level is no longer ready */
+                ready_queue[ready_pri] = NULL;
+                ready_map[group] &= ~((uint32_t)1 << (ready_pri & 31));
+                if (ready_map[group] == 0)
+                {
+                    ready_group &= (uint8_t)~(1 << group);
+                }
+            }
+            else
+            {
+                ret_ptr->prev_tcb->next_tcb = ret_ptr->next_tcb;
+                ret_ptr->next_tcb->prev_tcb = ret_ptr->prev_tcb;
+                ready_queue[ready_pri] = ret_ptr->next_tcb;
+            }
+            ret_ptr->next_tcb = ret_ptr->prev_tcb = NULL;
+        }
+    }
+
+    return (ret_ptr);
+}
+
+
+/**
+ * \b tcbLowestBit
+ *
+ * This is an internal function not for use by application code.
+ *
+ * Returns the index of the least significant set bit of \c bits, used to
+ * find the highest priority level in the ready queue bitmaps. Uses the
+ * compiler's count trailing zeroes builtin where available, which maps
+ * onto a single instruction on many architectures.
+ *
+ * @param[in] bits Bitmap, must be non-zero
+ *
+ * @return Index of the lowest set bit (0-31)
+ */
+static uint8_t tcbLowestBit (uint32_t bits)
+{
+#ifdef __GNUC__
+    return ((uint8_t)__builtin_ctzl ((unsigned long)bits));
+#else
+    uint8_t n = 0;
+
+    /* Binary search, constant time */
+    if ((bits & 0xFFFF) == 0)
+    {
+        n += 16;
+        bits >>= 16;
+    }
+    if ((bits & 0xFF) == 0)
+    {
+        n += 8;
+        bits >>= 8;
+    }
+    if ((bits & 0xF) == 0)
+    {
+        n += 4;
+        bits >>= 4;
+    }
+    if ((bits & 0x3) == 0)
+    {
+        n += 2;
+        bits >>= 2;
+    }
+    if ((bits & 0x1) == 0)
+    {
+        n += 1;
+    }
+    return (n);
+#endif
+}
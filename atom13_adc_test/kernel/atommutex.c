@@ -224,7 +224,7 @@ uint8_t atomMutexDelete (ATOM_MUTEX *mutex)
                 tcb_ptr->suspend_wake_status = ATOM_ERR_DELETED;
 
                 /* Put the thread on the ready queue */
-                if (tcbEnqueuePriority (&tcbReadyQ, tcb_ptr) != ATOM_OK)
+                if (tcbEnqueueReady (tcb_ptr) != ATOM_OK)
                 {
                     /* Exit critical region */
                     CRITICAL_END ();
@@ -592,7 +592,7 @@ uint8_t atomMutexPut (ATOM_MUTEX * mutex)
                      * ordering is taken care of by an ordered list enqueue.
                      */
                     tcb_ptr = tcbDequeueHead (&mutex->suspQ);
-                    if (tcbEnqueuePriority (&tcbReadyQ, tcb_ptr) != ATOM_OK)
+                    if (tcbEnqueueReady (tcb_ptr) != ATOM_OK)
                     {
                         /* Exit critical region */
                         CRITICAL_END ();
@@ -705,7 +705,7 @@ static void atomMutexTimerCallback (POINTER cb_data)
         (void)tcbDequeueEntry (&timer_data_ptr->mutex_ptr->suspQ, timer_data_ptr->tcb_ptr);
 
         /* Put the thread on the ready queue */
-        (void)tcbEnqueuePriority (&tcbReadyQ, timer_data_ptr->tcb_ptr);
+        (void)tcbEnqueueReady (timer_data_ptr->tcb_ptr);
 
         /* Exit critical region */
         CRITICAL_END ();
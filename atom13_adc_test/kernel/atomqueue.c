@@ -62,6 +62,10 @@
  * threads are woken and returned a status code to indicate the reason for
  * being woken.
  *
+ * \par Zero-copy APIs
+ * Large messages can be written and read in place in the queue storage,
+ * outside of the critical sections, rather than copied in and out of it.
+ *
  *
  * \n <b> Usage instructions: </b> \n
  *
@@ -84,6 +88,26 @@
  * indicating that the queue is full. This allows messages to be received
  * by interrupt handlers or threads which you do not wish to block.
  * 
+ * Messages can also be sent and received without copying. A sender calls
+ * atomQueueReserve() to obtain a pointer to a free message slot in the queue
+ * storage, writes the message in place and then calls atomQueueCommit() to
+ * make it available to receivers. A receiver calls atomQueuePeek() to obtain
+ * a pointer to the first message in the queue, reads it in place and then
+ * calls atomQueueRelease() to free the slot for senders. Reserve and peek
+ * block in the same way as put and get. atomQueuePut() and atomQueueGet()
+ * are implemented on top of these, copying the message into the reserved
+ * slot or out of the peeked slot.
+ *
+ * Each commit applies to the oldest outstanding reservation and each
+ * release to the oldest outstanding peek. Messages are delivered in the
+ * order the slots were reserved: a committed message is only made available
+ * once all the slots reserved before it have also been committed, and
+ * released slots are only freed once all the slots peeked before them have
+ * also been released. Several senders and receivers, including interrupt
+ * handlers, can therefore hold slots at the same time, but a slot should not
+ * be held for longer than necessary as it may hold up the messages or free
+ * space behind it.
+ *
  * A queue which is no longer required can be deleted using atomQueueDelete().
  * This function automatically wakes up any threads which are waiting on the
  * deleted queue.
@@ -111,8 +135,9 @@ typedef struct queue_timer
 
 /* Forward declarations */
 
-static uint8_t queue_remove (ATOM_QUEUE *qptr, uint8_t* msgptr);
-static uint8_t queue_insert (ATOM_QUEUE *qptr, uint8_t* msgptr);
+static uint8_t *queue_reserve (ATOM_QUEUE *qptr);
+static uint8_t *queue_peek (ATOM_QUEUE *qptr);
+static uint8_t queue_wake (ATOM_TCB **tcb_queue_ptr, uint32_t count);
 static void atomQueueTimerCallback (POINTER cb_data);
 
 
@@ -174,6 +199,12 @@ uint8_t atomQueueCreate (ATOM_QUEUE *qptr, uint8_t *buff_ptr, uint32_t unit_size
         qptr->remove_index = 0;
         qptr->num_msgs_stored = 0;
 
+        /* Initialise the zero-copy slot counts */
+        qptr->num_reserved = 0;
+        qptr->num_committed = 0;
+        qptr->num_peeked = 0;
+        qptr->num_released = 0;
+
         /* Successful */
         status = ATOM_OK;
     }
@@ -236,7 +267,7 @@ uint8_t atomQueueDelete (ATOM_QUEUE *qptr)
                 tcb_ptr->suspend_wake_status = ATOM_ERR_DELETED;
 
                 /* Put the thread on the ready queue */
-                if (tcbEnqueuePriority (&tcbReadyQ, tcb_ptr) != ATOM_OK)
+                if (tcbEnqueueReady (tcb_ptr) != ATOM_OK)
                 {
                     /* Exit critical region */
                     CRITICAL_END ();
@@ -321,6 +352,10 @@ uint8_t atomQueueDelete (ATOM_QUEUE *qptr)
  * This function can only be called from interrupt context if the \c timeout
  * parameter is -1 (in which case it does not block).
  *
+ * The message is taken using atomQueuePeek() and copied out of the queue
+ * storage outside of the critical section, before its slot is freed using
+ * atomQueueRelease().
+ *
  * @param[in] qptr Pointer to queue object
  * @param[in] timeout Max system ticks to block (0 = forever, -1 =  no block)
  * @param[out] msgptr Pointer to which the received message will be copied
@@ -335,6 +370,139 @@ uint8_t atomQueueDelete (ATOM_QUEUE *qptr)
  * @retval ATOM_ERR_TIMER Problem registering the timeout
  */
 uint8_t atomQueueGet (ATOM_QUEUE *qptr, int32_t timeout, uint8_t *msgptr)
+{
+    uint8_t status;
+    uint8_t *slot_ptr;
+
+    /* Check parameters */
+    if ((qptr == NULL) || (msgptr == NULL))
+    {
+        /* Bad pointer */
+        status = ATOM_ERR_PARAM;
+    }
+    else
+    {
+        /* Take the first message, blocking if requested */
+        status = atomQueuePeek (qptr, timeout, &slot_ptr);
+        if (status == ATOM_OK)
+        {
+            /* Copy the message out of the queue and free its slot */
+            memcpy (msgptr, slot_ptr, qptr->unit_size);
+            status = atomQueueRelease (qptr);
+        }
+    }
+
+    return (status);
+}
+
+
+/**
+ * \b atomQueuePut
+ *
+ * Attempt to put a message onto a queue.
+ *
+ * Sends one message at a time. Messages are copied from the passed
+ * \c msgptr storage area which should contain a message of \c unit_size
+ * bytes.
+ *
+ * If the queue is currently full, the call will do one of the following
+ * depending on the \c timeout value specified:
+ *
+ * \c timeout == 0 : Call will block until space is available \n
+ * \c timeout > 0 : Call will block until space or the specified timeout \n
+ * \c timeout == -1 : Return immediately if the queue is full \n
+ *
+ * If a maximum timeout value is specified (\c timeout > 0), and no space
+ * is available on the queue for the specified number of system ticks, the
+ * call will return with \c ATOM_TIMEOUT.
+ *
+ * This function can only be called from interrupt context if the \c timeout
+ * parameter is -1 (in which case it does not block and may fail to post a
+ * message if the queue is full).
+ *
+ * A slot is reserved using atomQueueReserve() and the message is copied
+ * into it outside of the critical section, before it is sent using
+ * atomQueueCommit().
+ *
+ * @param[in] qptr Pointer to queue object
+ * @param[in] timeout Max system ticks to block (0 = forever, -1 =  no block)
+ * @param[out] msgptr Pointer from which the message should be copied out
+ *
+ * @retval ATOM_OK Success
+ * @retval ATOM_WOULDBLOCK Called with timeout == -1 but queue was full
+ * @retval ATOM_TIMEOUT Queue wait timed out before being woken
+ * @retval ATOM_ERR_DELETED Queue was deleted while suspended
+ * @retval ATOM_ERR_CONTEXT Not called in thread context and attempted to block
+ * @retval ATOM_ERR_PARAM Bad parameter
+ * @retval ATOM_ERR_QUEUE Problem putting the thread on the suspend queue
+ * @retval ATOM_ERR_TIMER Problem registering the timeout
+ */
+uint8_t atomQueuePut (ATOM_QUEUE *qptr, int32_t timeout, uint8_t *msgptr)
+{
+    uint8_t status;
+    uint8_t *slot_ptr;
+
+    /* Check parameters */
+    if ((qptr == NULL) || (msgptr == NULL))
+    {
+        /* Bad pointer */
+        status = ATOM_ERR_PARAM;
+    }
+    else
+    {
+        /* Reserve a slot, blocking if requested */
+        status = atomQueueReserve (qptr, timeout, &slot_ptr);
+        if (status == ATOM_OK)
+        {
+            /* Copy the message into the queue and send it */
+            memcpy (slot_ptr, msgptr, qptr->unit_size);
+            status = atomQueueCommit (qptr);
+        }
+    }
+
+    return (status);
+}
+
+
+/**
+ * \b atomQueuePeek
+ *
+ * Attempt to access a message on a queue without copying it.
+ *
+ * Retrieves one message at a time. On success \c slotptr is set to point to
+ * the message of \c unit_size bytes in the queue storage, which the caller
+ * may read in place. The slot remains allocated to the caller until it is
+ * freed by calling atomQueueRelease(). Where multiple messages are in the
+ * queue, messages are retrieved in FIFO order.
+ *
+ * If the queue is currently empty, the call will do one of the following
+ * depending on the \c timeout value specified:
+ *
+ * \c timeout == 0 : Call will block until a message is available \n
+ * \c timeout > 0 : Call will block until a message or the specified timeout \n
+ * \c timeout == -1 : Return immediately if no message is on the queue \n
+ *
+ * If a maximum timeout value is specified (\c timeout > 0), and no message
+ * is present on the queue for the specified number of system ticks, the
+ * call will return with \c ATOM_TIMEOUT.
+ *
+ * This function can only be called from interrupt context if the \c timeout
+ * parameter is -1 (in which case it does not block).
+ *
+ * @param[in] qptr Pointer to queue object
+ * @param[in] timeout Max system ticks to block (0 = forever, -1 =  no block)
+ * @param[out] slotptr Set to point to the received message in the queue
+ *
+ * @retval ATOM_OK Success
+ * @retval ATOM_TIMEOUT Queue wait timed out before being woken
+ * @retval ATOM_WOULDBLOCK Called with timeout == -1 but queue was empty
+ * @retval ATOM_ERR_DELETED Queue was deleted while suspended
+ * @retval ATOM_ERR_CONTEXT Not called in thread context and attempted to block
+ * @retval ATOM_ERR_PARAM Bad parameter
+ * @retval ATOM_ERR_QUEUE Problem putting the thread on the suspend queue
+ * @retval ATOM_ERR_TIMER Problem registering the timeout
+ */
+uint8_t atomQueuePeek (ATOM_QUEUE *qptr, int32_t timeout, uint8_t **slotptr)
 {
     CRITICAL_STORE;
     uint8_t status;
@@ -343,7 +511,7 @@ uint8_t atomQueueGet (ATOM_QUEUE *qptr, int32_t timeout, uint8_t *msgptr)
     ATOM_TCB *curr_tcb_ptr;
 
     /* Check parameters */
-    if ((qptr == NULL) || (msgptr == NULL))
+    if ((qptr == NULL) || (slotptr == NULL))
     {
         /* Bad pointer */
         status = ATOM_ERR_PARAM;
@@ -442,7 +610,7 @@ uint8_t atomQueueGet (ATOM_QUEUE *qptr, int32_t timeout, uint8_t *msgptr)
                             /**
                              * Check suspend_wake_status. If it is ATOM_OK
                              * then we were woken because a message has been
-                             * put on the queue and we can now copy it out.
+                             * put on the queue and we can now take it.
                              * Otherwise we were woken because we timed out
                              * waiting for a message, or the queue was
                              * deleted, so we should just quit.
@@ -452,8 +620,8 @@ uint8_t atomQueueGet (ATOM_QUEUE *qptr, int32_t timeout, uint8_t *msgptr)
                                 /* Enter critical region */
                                 CRITICAL_START();
 
-                                /* Copy the message out of the queue */
-                                status = queue_remove (qptr, msgptr);
+                                /* Take the message */
+                                *slotptr = queue_peek (qptr);
 
                                 /* Exit critical region */
                                 CRITICAL_END();
@@ -483,19 +651,12 @@ uint8_t atomQueueGet (ATOM_QUEUE *qptr, int32_t timeout, uint8_t *msgptr)
         }
         else
         {
-            /* No need to block, there is a message to copy out of the queue */
-            status = queue_remove (qptr, msgptr);
+            /* No need to block, there is a message to take */
+            *slotptr = queue_peek (qptr);
+            status = ATOM_OK;
 
             /* Exit critical region */
             CRITICAL_END ();
-
-            /**
-             * The scheduler may now make a policy decision to thread
-             * switch if we are currently in thread context. If we are
-             * in interrupt context it will be handled by atomIntExit().
-             */
-            if (atomCurrentContext())
-                atomSched (FALSE);
         }
     }
 
@@ -504,13 +665,14 @@ uint8_t atomQueueGet (ATOM_QUEUE *qptr, int32_t timeout, uint8_t *msgptr)
 
 
 /**
- * \b atomQueuePut
+ * \b atomQueueReserve
  *
- * Attempt to put a message onto a queue.
+ * Attempt to reserve space for a message on a queue without copying it.
  *
- * Sends one message at a time. Messages are copied from the passed
- * \c msgptr storage area which should contain a message of \c unit_size
- * bytes.
+ * Sends one message at a time. On success \c slotptr is set to point to a
+ * free message slot of \c unit_size bytes in the queue storage, which the
+ * caller should fill in place. The message is sent by calling
+ * atomQueueCommit().
  *
  * If the queue is currently full, the call will do one of the following
  * depending on the \c timeout value specified:
@@ -524,12 +686,12 @@ uint8_t atomQueueGet (ATOM_QUEUE *qptr, int32_t timeout, uint8_t *msgptr)
  * call will return with \c ATOM_TIMEOUT.
  *
  * This function can only be called from interrupt context if the \c timeout
- * parameter is -1 (in which case it does not block and may fail to post a
- * message if the queue is full).
+ * parameter is -1 (in which case it does not block and may fail to reserve
+ * a slot if the queue is full).
  *
  * @param[in] qptr Pointer to queue object
  * @param[in] timeout Max system ticks to block (0 = forever, -1 =  no block)
- * @param[out] msgptr Pointer from which the message should be copied out
+ * @param[out] slotptr Set to point to the reserved message slot
  *
  * @retval ATOM_OK Success
  * @retval ATOM_WOULDBLOCK Called with timeout == -1 but queue was full
@@ -540,7 +702,7 @@ uint8_t atomQueueGet (ATOM_QUEUE *qptr, int32_t timeout, uint8_t *msgptr)
  * @retval ATOM_ERR_QUEUE Problem putting the thread on the suspend queue
  * @retval ATOM_ERR_TIMER Problem registering the timeout
  */
-uint8_t atomQueuePut (ATOM_QUEUE *qptr, int32_t timeout, uint8_t *msgptr)
+uint8_t atomQueueReserve (ATOM_QUEUE *qptr, int32_t timeout, uint8_t **slotptr)
 {
     CRITICAL_STORE;
     uint8_t status;
@@ -549,7 +711,7 @@ uint8_t atomQueuePut (ATOM_QUEUE *qptr, int32_t timeout, uint8_t *msgptr)
     ATOM_TCB *curr_tcb_ptr;
 
     /* Check parameters */
-    if ((qptr == NULL) || (msgptr == NULL))
+    if ((qptr == NULL) || (slotptr == NULL))
     {
         /* Bad pointer */
         status = ATOM_ERR_PARAM;
@@ -560,7 +722,8 @@ uint8_t atomQueuePut (ATOM_QUEUE *qptr, int32_t timeout, uint8_t *msgptr)
         CRITICAL_START ();
 
         /* If queue is full, block the calling thread */
-        if (qptr->num_msgs_stored == qptr->max_num_msgs)
+        if ((qptr->num_msgs_stored + qptr->num_reserved + qptr->num_peeked)
+            == qptr->max_num_msgs)
         {
             /* If called with timeout >= 0, we should block */
             if (timeout >= 0)
@@ -650,7 +813,8 @@ uint8_t atomQueuePut (ATOM_QUEUE *qptr, int32_t timeout, uint8_t *msgptr)
                             /**
                              * Check suspend_wake_status. If it is ATOM_OK
                              * then we were woken because a message has been
-                             * removed from the queue and we can now add ours.
+                             * removed from the queue and we can now reserve
+                             * its slot.
                              * Otherwise we were woken because we timed out
                              * waiting for a message, or the queue was
                              * deleted, so we should just quit.
@@ -660,8 +824,8 @@ uint8_t atomQueuePut (ATOM_QUEUE *qptr, int32_t timeout, uint8_t *msgptr)
                                 /* Enter critical region */
                                 CRITICAL_START();
 
-                                /* Copy the message into the queue */
-                                status = queue_insert (qptr, msgptr);
+                                /* Reserve the free slot */
+                                *slotptr = queue_reserve (qptr);
 
                                 /* Exit critical region */
                                 CRITICAL_END();
@@ -691,8 +855,151 @@ uint8_t atomQueuePut (ATOM_QUEUE *qptr, int32_t timeout, uint8_t *msgptr)
         }
         else
         {
-            /* No need to block, there is space to copy into the queue */
-            status = queue_insert (qptr, msgptr);
+            /* No need to block, there is a free slot to reserve */
+            *slotptr = queue_reserve (qptr);
+            status = ATOM_OK;
+
+            /* Exit critical region */
+            CRITICAL_END ();
+        }
+    }
+
+    return (status);
+}
+
+
+/**
+ * \b atomQueueCommit
+ *
+ * Send a message previously written in place in a slot obtained using
+ * atomQueueReserve().
+ *
+ * The commit applies to the oldest outstanding reservation on the queue.
+ * The message is made available to receivers once all the slots reserved
+ * before it have also been committed, at which point threads waiting to
+ * receive are woken up. If called at thread context then the scheduler will
+ * be called during this function which may schedule in one of the woken
+ * threads depending on relative priorities.
+ *
+ * This function can be called from interrupt context.
+ *
+ * @param[in] qptr Pointer to queue object
+ *
+ * @retval ATOM_OK Success
+ * @retval ATOM_ERR_PARAM Bad parameter or no outstanding reservation
+ * @retval ATOM_ERR_QUEUE Problem putting a woken thread on the ready queue
+ * @retval ATOM_ERR_TIMER Problem cancelling a timeout on a woken thread
+ */
+uint8_t atomQueueCommit (ATOM_QUEUE *qptr)
+{
+    CRITICAL_STORE;
+    uint8_t status;
+
+    /* Check parameters */
+    if (qptr == NULL)
+    {
+        /* Bad pointer */
+        status = ATOM_ERR_PARAM;
+    }
+    else
+    {
+        /* Protect access to the queue object and OS queues */
+        CRITICAL_START ();
+
+        /* Check there is a reservation to commit */
+        if (qptr->num_committed == qptr->num_reserved)
+        {
+            CRITICAL_END ();
+            status = ATOM_ERR_PARAM;
+        }
+        else
+        {
+            /* Once all reserved slots are committed, store their messages */
+            if (++qptr->num_committed == qptr->num_reserved)
+            {
+                qptr->num_msgs_stored += qptr->num_reserved;
+                status = queue_wake (&qptr->getSuspQ, qptr->num_reserved);
+                qptr->num_reserved = qptr->num_committed = 0;
+            }
+            else
+            {
+                status = ATOM_OK;
+            }
+
+            /* Exit critical region */
+            CRITICAL_END ();
+
+            /**
+             * The scheduler may now make a policy decision to thread
+             * switch if we are currently in thread context. If we are
+             * in interrupt context it will be handled by atomIntExit().
+             */
+            if (atomCurrentContext())
+                atomSched (FALSE);
+        }
+    }
+
+    return (status);
+}
+
+
+/**
+ * \b atomQueueRelease
+ *
+ * Free the slot of a message previously obtained using atomQueuePeek().
+ *
+ * The release applies to the oldest outstanding peek on the queue. The slot
+ * is made available to senders once all the slots peeked before it have
+ * also been released, at which point threads waiting to send are woken up.
+ * If called at thread context then the scheduler will be called during this
+ * function which may schedule in one of the woken threads depending on
+ * relative priorities.
+ *
+ * This function can be called from interrupt context.
+ *
+ * @param[in] qptr Pointer to queue object
+ *
+ * @retval ATOM_OK Success
+ * @retval ATOM_ERR_PARAM Bad parameter or no outstanding peek
+ * @retval ATOM_ERR_QUEUE Problem putting a woken thread on the ready queue
+ * @retval ATOM_ERR_TIMER Problem cancelling a timeout on a woken thread
+ */
+uint8_t atomQueueRelease (ATOM_QUEUE *qptr)
+{
+    CRITICAL_STORE;
+    uint8_t status;
+    uint32_t num_freed;
+
+    /* Check parameters */
+    if (qptr == NULL)
+    {
+        /* Bad pointer */
+        status = ATOM_ERR_PARAM;
+    }
+    else
+    {
+        /* Protect access to the queue object and OS queues */
+        CRITICAL_START ();
+
+        /* Check there is a peeked slot to release */
+        if (qptr->num_released == qptr->num_peeked)
+        {
+            CRITICAL_END ();
+            status = ATOM_ERR_PARAM;
+        }
+        else
+        {
+            /* Once all peeked slots are released, free them */
+            if (++qptr->num_released == qptr->num_peeked)
+            {
+                num_freed = qptr->num_peeked;
+                qptr->num_peeked = qptr->num_released = 0;
+                status = queue_wake (&qptr->putSuspQ, num_freed);
+            }
+            else
+            {
+                status = ATOM_OK;
+            }
 
             /* Exit critical region */
             CRITICAL_END ();
@@ -750,7 +1057,7 @@ static void atomQueueTimerCallback (POINTER cb_data)
         (void)tcbDequeueEntry (timer_data_ptr->suspQ, timer_data_ptr->tcb_ptr);
 
         /* Put the thread on the ready queue */
-        (void)tcbEnqueuePriority (&tcbReadyQ, timer_data_ptr->tcb_ptr);
+        (void)tcbEnqueueReady (timer_data_ptr->tcb_ptr);
 
         /* Exit critical region */
         CRITICAL_END ();
@@ -764,186 +1071,128 @@ static void atomQueueTimerCallback (POINTER cb_data)
 
 
 /**
- * \b queue_remove
+ * \b queue_peek
  *
  * This is an internal function not for use by application code.
  *
- * Removes a message from a queue. Assumes that there is a message present,
- * which is already checked by the calling functions with interrupts locked
- * out.
- *
- * Also wakes up a suspended thread if there are any waiting to send on the
- * queue.
+ * Takes the first message on a queue for a receiver. Assumes that there is
+ * a message present, which is already checked by the calling functions with
+ * interrupts locked out. The message slot stays allocated to the receiver
+ * until it is released.
  *
  * Assumes interrupts are already locked out.
  *
  * @param[in] qptr Pointer to an ATOM_QUEUE object
- * @param[in] msgptr Destination pointer for the message to be copied into
  *
- * @retval ATOM_OK Success
- * @retval ATOM_ERR_PARAM Bad parameter
- * @retval ATOM_ERR_QUEUE Problem putting a thread on the ready queue
- * @retval ATOM_ERR_TIMER Problem cancelling a timeout
+ * @return Pointer to the message in the queue storage
  */
-static uint8_t queue_remove (ATOM_QUEUE *qptr, uint8_t* msgptr)
+static uint8_t *queue_peek (ATOM_QUEUE *qptr)
 {
-    uint8_t status;
-    ATOM_TCB *tcb_ptr;
+    uint8_t *slot_ptr;
 
-    /* Check parameters */
-    if ((qptr == NULL) || (msgptr == NULL))
-    {
-        /* Bad pointer */
-        status = ATOM_ERR_PARAM;
-    }
-    else
-    {
-        /* There is a message on the queue, copy it out */
-        memcpy (msgptr, (qptr->buff_ptr + qptr->remove_index), qptr->unit_size);
-        qptr->remove_index += qptr->unit_size;
-        qptr->num_msgs_stored--;
+    /* There is a message on the queue, take it */
+    slot_ptr = qptr->buff_ptr + qptr->remove_index;
+    qptr->remove_index += qptr->unit_size;
+    qptr->num_msgs_stored--;
+    qptr->num_peeked++;
 
-        /* Check if the remove index should now wrap to the beginning */
-        if (qptr->remove_index >= (qptr->unit_size * qptr->max_num_msgs))
-            qptr->remove_index = 0;
+    /* Check if the remove index should now wrap to the beginning */
+    if (qptr->remove_index >= (qptr->unit_size * qptr->max_num_msgs))
+        qptr->remove_index = 0;
 
-        /**
-         * If there are threads waiting to send, wake one up now. Waiting
-         * threads are woken up in priority order, with same-priority
-         * threads woken up in FIFO order.
-         */
-        tcb_ptr = tcbDequeueHead (&qptr->putSuspQ);
-        if (tcb_ptr)
-        {
-            /* Move the waiting thread to the ready queue */
-            if (tcbEnqueuePriority (&tcbReadyQ, tcb_ptr) == ATOM_OK)
-            {
-                /* Set OK status to be returned to the waiting thread */
-                tcb_ptr->suspend_wake_status = ATOM_OK;
+    return (slot_ptr);
+}
 
-                /* If there's a timeout on this suspension, cancel it */
-                if ((tcb_ptr->suspend_timo_cb != NULL)
-                    && (atomTimerCancel (tcb_ptr->suspend_timo_cb) != ATOM_OK))
-                {
-                    /* There was a problem cancelling a timeout */
-                    status = ATOM_ERR_TIMER;
-                }
-                else
-                {
-                    /* Flag as no timeout registered */
-                    tcb_ptr->suspend_timo_cb = NULL;
 
-                    /* Successful */
-                    status = ATOM_OK;
-                }
-            }
-            else
-            {
-                /**
-                 * There was a problem putting the thread on the ready
-                 * queue.
-                 */
-                status = ATOM_ERR_QUEUE;
-            }
-        }
-        else
-        {
-            /* There were no threads waiting to send */
-            status = ATOM_OK;
-        }
-    }
+/**
+ * \b queue_reserve
+ *
+ * This is an internal function not for use by application code.
+ *
+ * Reserves a free message slot on a queue for a sender. Assumes that the
+ * queue has space for one message, which has already been checked by the
+ * calling function with interrupts locked out. The message slot stays
+ * allocated to the sender until it is committed.
+ *
+ * Assumes interrupts are already locked out.
+ *
+ * @param[in] qptr Pointer to an ATOM_QUEUE object
+ *
+ * @return Pointer to the message slot in the queue storage
+ */
+static uint8_t *queue_reserve (ATOM_QUEUE *qptr)
+{
+    uint8_t *slot_ptr;
 
-    return (status);
+    /* There is space in the queue, reserve it */
+    slot_ptr = qptr->buff_ptr + qptr->insert_index;
+    qptr->insert_index += qptr->unit_size;
+    qptr->num_reserved++;
+
+    /* Check if the insert index should now wrap to the beginning */
+    if (qptr->insert_index >= (qptr->unit_size * qptr->max_num_msgs))
+        qptr->insert_index = 0;
+
+    return (slot_ptr);
 }
 
 
 /**
- * \b queue_insert
+ * \b queue_wake
  *
  * This is an internal function not for use by application code.
  *
- * Inserts a message onto a queue. Assumes that the queue has space for one
- * message, which has already been checked by the calling function with
- * interrupts locked out.
- *
- * Also wakes up a suspended thread if there are any waiting to receive on the
- * queue.
+ * Wakes up to \c count threads suspended on one of a queue's suspend lists,
+ * once messages have been stored on the queue or slots freed. Waiting
+ * threads are woken up in priority order, with same-priority threads woken
+ * up in FIFO order.
  *
  * Assumes interrupts are already locked out.
  *
- * @param[in] qptr Pointer to an ATOM_QUEUE object
- * @param[in] msgptr Source pointer for the message to be copied out of
+ * @param[in] tcb_queue_ptr Pointer to the suspend list head pointer
+ * @param[in] count Maximum number of threads to wake
  *
  * @retval ATOM_OK Success
- * @retval ATOM_ERR_PARAM Bad parameter
  * @retval ATOM_ERR_QUEUE Problem putting a thread on the ready queue
  * @retval ATOM_ERR_TIMER Problem cancelling a timeout
  */
-static uint8_t queue_insert (ATOM_QUEUE *qptr, uint8_t* msgptr)
+static uint8_t queue_wake (ATOM_TCB **tcb_queue_ptr, uint32_t count)
 {
     uint8_t status;
     ATOM_TCB *tcb_ptr;
 
-    /* Check parameters */
-    if ((qptr == NULL) || (msgptr == NULL))
-    {
-        /* Bad pointer */
-        status = ATOM_ERR_PARAM;
-    }
-    else
-    {
-        /* There is space in the queue, copy it in */
-        memcpy ((qptr->buff_ptr + qptr->insert_index), msgptr, qptr->unit_size);
-        qptr->insert_index += qptr->unit_size;
-        qptr->num_msgs_stored++;
-
-        /* Check if the insert index should now wrap to the beginning */
-        if (qptr->insert_index >= (qptr->unit_size * qptr->max_num_msgs))
-            qptr->insert_index = 0;
+    /* Default to success status unless errors occur during wakeup */
+    status = ATOM_OK;
 
-        /**
-         * If there are threads waiting to receive, wake one up now. Waiting
-         * threads are woken up in priority order, with same-priority
-         * threads woken up in FIFO order.
-         */
-        tcb_ptr = tcbDequeueHead (&qptr->getSuspQ);
-        if (tcb_ptr)
+    while ((count-- > 0)
+        && ((tcb_ptr = tcbDequeueHead (tcb_queue_ptr)) != NULL))
+    {
+        /* Move the waiting thread to the ready queue */
+        if (tcbEnqueueReady (tcb_ptr) == ATOM_OK)
         {
-            /* Move the waiting thread to the ready queue */
-            if (tcbEnqueuePriority (&tcbReadyQ, tcb_ptr) == ATOM_OK)
-            {
-                /* Set OK status to be returned to the waiting thread */
-                tcb_ptr->suspend_wake_status = ATOM_OK;
+            /* Set OK status to be returned to the waiting thread */
+            tcb_ptr->suspend_wake_status = ATOM_OK;
 
-                /* If there's a timeout on this suspension, cancel it */
-                if ((tcb_ptr->suspend_timo_cb != NULL)
-                    && (atomTimerCancel (tcb_ptr->suspend_timo_cb) != ATOM_OK))
-                {
-                    /* There was a problem cancelling a timeout */
-                    status = ATOM_ERR_TIMER;
-                }
-                else
-                {
-                    /* Flag as no timeout registered */
-                    tcb_ptr->suspend_timo_cb = NULL;
-
-                    /* Successful */
-                    status = ATOM_OK;
-                }
+            /* If there's a timeout on this suspension, cancel it */
+            if ((tcb_ptr->suspend_timo_cb != NULL)
+                && (atomTimerCancel (tcb_ptr->suspend_timo_cb) != ATOM_OK))
+            {
+                /* There was a problem cancelling a timeout */
+                status = ATOM_ERR_TIMER;
             }
             else
             {
-                /**
-                 * There was a problem putting the thread on the ready
-                 * queue.
-                 */
-                status = ATOM_ERR_QUEUE;
+                /* Flag as no timeout registered */
+                tcb_ptr->suspend_timo_cb = NULL;
             }
         }
         else
         {
-            /* There were no threads waiting to send */
-            status = ATOM_OK;
+            /**
+             * There was a problem putting the thread on the ready
+             * queue.
+             */
+            status = ATOM_ERR_QUEUE;
         }
     }
 
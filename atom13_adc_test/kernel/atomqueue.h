@@ -39,11 +39,19 @@ typedef struct atom_queue
     uint32_t    insert_index;   /* Next byte index to insert into */
     uint32_t    remove_index;   /* Next byte index to remove from */
     uint32_t    num_msgs_stored;/* Number of messages stored */
+    uint32_t    num_reserved;   /* Slots reserved by senders, not yet stored */
+    uint32_t    num_committed;  /* Reserved slots which have been committed */
+    uint32_t    num_peeked;     /* Slots peeked by receivers, not yet free */
+    uint32_t    num_released;   /* Peeked slots which have been released */
 } ATOM_QUEUE;
 
 extern uint8_t atomQueueCreate (ATOM_QUEUE *qptr, uint8_t *buff_ptr, uint32_t unit_size, uint32_t max_num_msgs);
 extern uint8_t atomQueueDelete (ATOM_QUEUE *qptr);
 extern uint8_t atomQueueGet (ATOM_QUEUE *qptr, int32_t timeout, uint8_t *msgptr);
 extern uint8_t atomQueuePut (ATOM_QUEUE *qptr, int32_t timeout, uint8_t *msgptr);
+extern uint8_t atomQueueReserve (ATOM_QUEUE *qptr, int32_t timeout, uint8_t **slotptr);
+extern uint8_t atomQueueCommit (ATOM_QUEUE *qptr);
+extern uint8_t atomQueuePeek (ATOM_QUEUE *qptr, int32_t timeout, uint8_t **slotptr);
+extern uint8_t atomQueueRelease (ATOM_QUEUE *qptr);
 
 #endif /* __ATOM_QUEUE_H */
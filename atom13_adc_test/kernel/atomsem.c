@@ -206,7 +206,7 @@ uint8_t atomSemDelete (ATOM_SEM *sem)
                 tcb_ptr->suspend_wake_status = ATOM_ERR_DELETED;
 
                 /* Put the thread on the ready queue */
-                if (tcbEnqueuePriority (&tcbReadyQ, tcb_ptr) != ATOM_OK)
+                if (tcbEnqueueReady (tcb_ptr) != ATOM_OK)
                 {
                     /* Exit critical region */
                     CRITICAL_END ();
@@ -521,7 +521,7 @@ uint8_t atomSemPut (ATOM_SEM * sem)
              * ordering is taken care of by an ordered list enqueue.
              */
             tcb_ptr = tcbDequeueHead (&sem->suspQ);
-            if (tcbEnqueuePriority (&tcbReadyQ, tcb_ptr) != ATOM_OK)
+            if (tcbEnqueueReady (tcb_ptr) != ATOM_OK)
             {
                 /* Exit critical region */
                 CRITICAL_END ();
@@ -665,7 +665,7 @@ static void atomSemTimerCallback (POINTER cb_data)
         (void)tcbDequeueEntry (&timer_data_ptr->sem_ptr->suspQ, timer_data_ptr->tcb_ptr);
 
         /* Put the thread on the ready queue */
-        (void)tcbEnqueuePriority (&tcbReadyQ, timer_data_ptr->tcb_ptr);
+        (void)tcbEnqueueReady (timer_data_ptr->tcb_ptr);
 
         /* Exit critical region */
         CRITICAL_END ();
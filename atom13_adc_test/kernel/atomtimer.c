@@ -55,7 +55,7 @@
  * (SYSTEM_TICKS_PER_SEC) architecture ports arrange for atomTimerTick() to be
  * called. The tick increments the system tick count, which can be queried by
  * application code using atomTimeGet(). On this tick, the registered timer
- * list is checked for any timers which have expired. Those which have expired
+ * wheel is checked for any timers which have expired. Those which have expired
  * have their callback functions called. It is also on this system tick that
  * round-robin rescheduling time-slices occur. On exit from the tick interrupt
  * handler the kernel checks whether there are two or more threads 
@@ -64,6 +64,16 @@
  * interrupts which do not allow for round-robin rescheduling to occur, as
  * they should only occur on a new timer tick.
  *
+ * \par Timer wheel
+ * Registered timers are held in a hashed timer wheel of
+ * ATOM_TIMER_WHEEL_SIZE slots. A timer is placed in the slot indexed by the
+ * low bits of the tick count at which it expires, and each slot list is
+ * kept sorted by expiry time. On each system tick only the slot for the
+ * current tick is examined, and only the timers at the head of that slot
+ * which are due are touched, so the cost of the tick does not depend on the
+ * number of outstanding timers. Registering or cancelling a timer only
+ * walks the slot list for its expiry time.
+ *
  */
 
 
@@ -71,6 +81,25 @@
 #include "atom.h"
 
 
+/* Constants */
+
+/**
+ * Number of slots in the timer wheel. Must be a power of two. Ports may
+ * override this in atomport.h, larger wheels trade RAM for shorter slot
+ * lists when many timers are outstanding.
+ */
+#ifndef ATOM_TIMER_WHEEL_SIZE
+#define ATOM_TIMER_WHEEL_SIZE   16
+#endif
+
+#if (ATOM_TIMER_WHEEL_SIZE & (ATOM_TIMER_WHEEL_SIZE - 1)) != 0
+#error "ATOM_TIMER_WHEEL_SIZE must be a power of two"
+#endif
+
+/** Wheel slot for a given expiry tick count */
+#define TIMER_SLOT(ticks)   ((ticks) & (ATOM_TIMER_WHEEL_SIZE - 1))
+
+
 /* Data types */
 
 /* Delay callbacks data structure */
@@ -85,12 +114,19 @@ typedef struct delay_timer
 
 /* Local data */
 
-/** Pointer to the head of the outstanding timers queue */
-static ATOM_TIMER *timer_queue = NULL;
+/** Outstanding timers, one list sorted by expiry time per wheel slot */
+static ATOM_TIMER *timer_wheel[ATOM_TIMER_WHEEL_SIZE];
 
 /** Current system tick count */
 static uint32_t system_ticks = 0;
 
+/**
+ * Timer tick count. Counts system ticks like system_ticks but is not
+ * affected by atomTimeSet(), so that outstanding timers keep their
+ * expiry times when the system time is changed.
+ */
+static uint32_t timer_ticks = 0;
+
 
 /* Forward declarations */
 static void atomTimerCallbacks (void);
@@ -114,9 +150,9 @@ static void atomTimerDelayCallback (POINTER cb_data);
  * can also be used by application code requiring timer facilities at
  * system tick resolution.
  *
- * This function can be called from interrupt context, but loops internally
- * through the time list, so the potential execution cycles cannot be
- * determined in advance.
+ * This function can be called from interrupt context. It loops internally
+ * through the wheel slot list for the expiry time only, which holds on
+ * average 1/ATOM_TIMER_WHEEL_SIZE of the outstanding timers.
  *
  * @param[in] timer_ptr Pointer to timer descriptor
  *
@@ -126,6 +162,7 @@ static void atomTimerDelayCallback (POINTER cb_data);
 uint8_t atomTimerRegister (ATOM_TIMER *timer_ptr)
 {
     uint8_t status;
+    ATOM_TIMER **prev_ptr;
     CRITICAL_STORE;
 
     /* Parameter check */
@@ -141,26 +178,23 @@ uint8_t atomTimerRegister (ATOM_TIMER *timer_ptr)
         CRITICAL_START ();
 
         /*
-         * Enqueue in the list of timers.
+         * Enqueue in the wheel slot for the expiry time.
          *
-         * The list is not ordered, all timers are inserted at the start
-         * of the list. On each system tick increment the list is walked
-         * and the remaining ticks count for that timer is decremented.
-         * Once the remaining ticks reaches zero, the timer callback is
-         * made.
+         * The slot list is ordered by the number of ticks remaining until
+         * expiry, timers with the same expiry time are called back in the
+         * order they were registered. The remaining ticks are computed
+         * relative to the current timer tick count so that the ordering
+         * holds across tick count wraparound.
          */
-        if (timer_queue == NULL)
-        {
-            /* List is empty, insert new head */
-            timer_ptr->next_timer = NULL;
-            timer_queue = timer_ptr;
-        }
-        else
+        timer_ptr->expiry_ticks = timer_ticks + timer_ptr->cb_ticks;
+        prev_ptr = &timer_wheel[TIMER_SLOT(timer_ptr->expiry_ticks)];
+        while ((*prev_ptr != NULL)
+            && (((*prev_ptr)->expiry_ticks - timer_ticks) <= timer_ptr->cb_ticks))
         {
-            /* List has at least one entry, enqueue new timer before */
-            timer_ptr->next_timer = timer_queue;
-            timer_queue = timer_ptr;
+            prev_ptr = &(*prev_ptr)->next_timer;
         }
+        timer_ptr->next_timer = *prev_ptr;
+        *prev_ptr = timer_ptr;
 
         /* End of list protection */
         CRITICAL_END ();
@@ -178,9 +212,8 @@ uint8_t atomTimerRegister (ATOM_TIMER *timer_ptr)
  *
  * Cancel a timer callback previously registered using atomTimerRegister().
  *
- * This function can be called from interrupt context, but loops internally
- * through the time list, so the potential execution cycles cannot be
- * determined in advance.
+ * This function can be called from interrupt context. It loops internally
+ * through the wheel slot list for the timer's expiry time only.
  *
  * @param[in] timer_ptr Pointer to timer to cancel
  *
@@ -191,7 +224,7 @@ uint8_t atomTimerRegister (ATOM_TIMER *timer_ptr)
 uint8_t atomTimerCancel (ATOM_TIMER *timer_ptr)
 {
     uint8_t status = ATOM_ERR_NOT_FOUND;
-    ATOM_TIMER *prev_ptr, *next_ptr;
+    ATOM_TIMER **prev_ptr;
     CRITICAL_STORE;
 
     /* Parameter check */
@@ -205,23 +238,19 @@ uint8_t atomTimerCancel (ATOM_TIMER *timer_ptr)
         /* Protect the list */
         CRITICAL_START ();
 
-        /* Walk the list to find the relevant timer */
-        prev_ptr = next_ptr = timer_queue;
-        while (next_ptr)
+        /*
+         * Walk the slot list to find the relevant timer. Only pointers
+         * are compared, the descriptor of a timer which was never
+         * registered is not otherwise trusted.
+         */
+        prev_ptr = &timer_wheel[TIMER_SLOT(timer_ptr->expiry_ticks)];
+        while (*prev_ptr)
         {
             /* Is this entry the one we're looking for? */
-            if (next_ptr == timer_ptr)
+            if (*prev_ptr == timer_ptr)
             {
-                if (next_ptr == timer_queue)
-                {
-                    /* We're removing the list head */
-                    timer_queue = next_ptr->next_timer;
-                }
-                else
-                {
-                    /* We're removing a mid or tail TCB */
-                    prev_ptr->next_timer = next_ptr->next_timer;
-                }
+                /* Unlink it */
+                *prev_ptr = timer_ptr->next_timer;
 
                 /* Successful */
                 status = ATOM_OK;
@@ -229,8 +258,7 @@ uint8_t atomTimerCancel (ATOM_TIMER *timer_ptr)
             }
 
             /* Move on to the next in the list */
-            prev_ptr = next_ptr;
-            next_ptr = next_ptr->next_timer;
+            prev_ptr = &(*prev_ptr)->next_timer;
 
         }
 
@@ -298,8 +326,9 @@ void atomTimerTick (void)
     /* Only do anything if the OS is started */
     if (atomOSStarted)
     {
-        /* Increment the system tick count */
+        /* Increment the system and timer tick counts */
         system_ticks++;
+        timer_ticks++;
 
         /* Check for any callbacks that are due */
         atomTimerCallbacks ();
@@ -405,57 +434,30 @@ uint8_t atomTimerDelay (uint32_t ticks)
  *
  * Find any callbacks that are due and call them up.
  *
+ * Due timers can only be at the head of the wheel slot for the current
+ * timer tick count, later timers in the slot are not touched.
+ *
  * @return None
  */
 static void atomTimerCallbacks (void)
 {
-    ATOM_TIMER *prev_ptr, *next_ptr;
-
-    /*
-     * Walk the list decrementing each timer's remaining ticks count and
-     * looking for due callbacks.
-     */
-    prev_ptr = next_ptr = timer_queue;
-    while (next_ptr)
-    {
-        /* Is this entry due? */
-        if (--(next_ptr->cb_ticks) == 0)
-        {
-            /* Remove the entry from the timer list */
-            if (next_ptr == timer_queue)
-            {
-                /* We're removing the list head */
-                timer_queue = next_ptr->next_timer;
-            }
-            else
-            {
-                /* We're removing a mid or tail timer */
-                prev_ptr->next_timer = next_ptr->next_timer;
-            }
-
-            /* Call the registered callback */
-            if (next_ptr->cb_func)
-            {
-                next_ptr->cb_func (next_ptr->cb_data);
-            }
+    ATOM_TIMER **slot_ptr, *next_ptr;
 
-            /* Do not update prev_ptr, we have just removed this one */
-
-        }
+    slot_ptr = &timer_wheel[TIMER_SLOT(timer_ticks)];
+    while (((next_ptr = *slot_ptr) != NULL)
+        && (next_ptr->expiry_ticks == timer_ticks))
+    {
+        /*
+         * Remove the entry from the slot list before the callback, which
+         * may register the timer again.
+         */
+        *slot_ptr = next_ptr->next_timer;
 
-        /* Entry is not due, leave it in there with its count decremented */
-        else
+        /* Call the registered callback */
+        if (next_ptr->cb_func)
         {
-            /*
-             * Update prev_ptr to this entry. We will need it if we want
-             * to remove a mid or tail timer.
-             */
-            prev_ptr = next_ptr;
+            next_ptr->cb_func (next_ptr->cb_data);
         }
-
-        /* Move on to the next in the list */
-        next_ptr = next_ptr->next_timer;
-
     }
 
 }
@@ -487,7 +489,7 @@ static void atomTimerDelayCallback (POINTER cb_data)
         CRITICAL_START ();
 
         /* Put the thread on the ready queue */
-        (void)tcbEnqueuePriority (&tcbReadyQ, timer_data_ptr->tcb_ptr);
+        (void)tcbEnqueueReady (timer_data_ptr->tcb_ptr);
 
         /* Exit critical region */
         CRITICAL_END ();
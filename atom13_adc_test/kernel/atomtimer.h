@@ -46,7 +46,8 @@ typedef struct atom_timer
     uint32_t	    cb_ticks;   /* Ticks until callback */
 
 	/* Internal data */
-    struct atom_timer *next_timer;		/* Next timer in doubly-linked list */
+    uint32_t        expiry_ticks;       /* Timer tick count at expiry */
+    struct atom_timer *next_timer;		/* Next timer in wheel slot list */
 
 } ATOM_TIMER;
 
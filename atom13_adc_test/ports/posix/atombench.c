@@ -0,0 +1,637 @@
+/*
+ * Copyright (c) 2010, Kelvin Lawson. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. No personal names or organizations' names associated with the
+ *    Atomthreads project may be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE ATOMTHREADS PROJECT AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE PROJECT OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * Benchmark harness.
+ *
+ * This is built like one of the automated test modules (it provides the
+ * test_start() entry point used by tests-main.c) and prints a series of
+ * kernel performance scores. Each benchmark runs for one second of
+ * system ticks. The output format matches the ChibiOS/RT test suite
+ * benchmarks so that results can be compared on the same host.
+ *
+ * Threads in Atomthreads never terminate, so each benchmark uses its own
+ * set of threads and kernel objects which are left blocked forever once
+ * the benchmark has completed.
+ */
+
+
+#include <time.h>
+
+#include "atom.h"
+#include "atomtests.h"
+#include "atomsem.h"
+#include "atomqueue.h"
+
+
+/* Duration of each benchmark */
+#define BENCH_TICKS             SYSTEM_TICKS_PER_SEC
+
+/* Number of benchmark threads */
+#define NUM_BENCH_THREADS       4
+
+/* Maximum number of ready threads in the ready queue switch benchmark */
+#define NUM_READY_THREADS       64
+
+/* Maximum number of threads suspended with a timeout by the timer benchmark */
+#define NUM_TIMER_THREADS       256
+
+/* Timeout used by the timer benchmark threads, never expires */
+#define TIMER_BENCH_TIMEOUT     0x7FFFFFFF
+
+/* Number of system ticks measured by the timer benchmark */
+#define TIMER_BENCH_TICKS       100000
+
+/* Number of ready queue rotations measured by the ready queue benchmark */
+#define READY_BENCH_ROTATIONS   1000000
+
+
+/* Benchmark OS objects */
+static ATOM_TCB tcb[NUM_BENCH_THREADS];
+static uint8_t bench_thread_stack[NUM_BENCH_THREADS][TEST_THREAD_STACK_SIZE];
+static ATOM_SEM sem1, sem2, sem3, sem4, sem5, sem6, sem7;
+static ATOM_QUEUE queue1, queue2;
+static uint8_t queue1_storage[4 * sizeof(uint32_t)];
+static uint8_t queue2_storage[4 * sizeof(uint32_t)];
+static ATOM_TCB timer_tcb[NUM_TIMER_THREADS];
+static uint8_t timer_thread_stack[NUM_TIMER_THREADS][TEST_THREAD_STACK_SIZE];
+static ATOM_TCB ready_tcb[NUM_READY_THREADS];
+static uint8_t ready_thread_stack[NUM_READY_THREADS][TEST_THREAD_STACK_SIZE];
+
+/* Ready queue switch benchmark state */
+static volatile int ready_stop;
+static volatile uint32_t ready_count;
+
+
+/* Forward declarations */
+static int bench_switch (void);
+static int bench_sem (void);
+static int bench_sem_trip (void);
+static int bench_queue_trip (void);
+static int bench_timer (void);
+static int bench_switch_ready (void);
+static uint32_t bench_wait_tick (void);
+static uint32_t bench_tick_rate (void);
+static uint32_t bench_rotate_rate (void);
+static void switch_thread_func (uint32_t param);
+static void sem_thread_func (uint32_t param);
+static void queue_thread_func (uint32_t param);
+static void timer_thread_func (uint32_t param);
+static void ready_thread_func (uint32_t param);
+
+
+/**
+ * \b test_start
+ *
+ * Start the benchmarks.
+ *
+ * @retval Number of failures
+ */
+uint32_t test_start (void)
+{
+    int failures;
+
+    /* Create the benchmark objects */
+    if ((atomSemCreate (&sem1, 0) != ATOM_OK)
+        || (atomSemCreate (&sem2, 0) != ATOM_OK)
+        || (atomSemCreate (&sem3, 0) != ATOM_OK)
+        || (atomSemCreate (&sem4, 0) != ATOM_OK)
+        || (atomSemCreate (&sem5, 0) != ATOM_OK)
+        || (atomSemCreate (&sem6, 0) != ATOM_OK)
+        || (atomSemCreate (&sem7, 0) != ATOM_OK)
+        || (atomQueueCreate (&queue1, queue1_storage, sizeof(uint32_t), 4) != ATOM_OK)
+        || (atomQueueCreate (&queue2, queue2_storage, sizeof(uint32_t), 4) != ATOM_OK))
+    {
+        ATOMLOG (_STR("Error creating objects\n"));
+        return (1);
+    }
+
+    /* Run the benchmarks */
+    failures = bench_switch ();
+    failures += bench_sem ();
+    failures += bench_sem_trip ();
+    failures += bench_queue_trip ();
+    failures += bench_timer ();
+    failures += bench_switch_ready ();
+
+    /* Quit */
+    return failures;
+
+}
+
+
+/**
+ * \b bench_switch
+ *
+ * Context switch: a higher priority thread waits on a semaphore in a loop,
+ * each post switches to it and back.
+ *
+ * @retval Number of failures
+ */
+static int bench_switch (void)
+{
+    uint32_t start, n;
+
+    if (atomThreadCreate(&tcb[0], TEST_THREAD_PRIO - 1, switch_thread_func, 0,
+          &bench_thread_stack[0][TEST_THREAD_STACK_SIZE - 1],
+          TEST_THREAD_STACK_SIZE) != ATOM_OK)
+    {
+        ATOMLOG (_STR("Error creating test thread\n"));
+        return (1);
+    }
+
+    n = 0;
+    start = bench_wait_tick ();
+    do
+    {
+        atomSemPut (&sem1);
+        atomSemPut (&sem1);
+        atomSemPut (&sem1);
+        atomSemPut (&sem1);
+        n += 4;
+    } while ((atomTimeGet() - start) < BENCH_TICKS);
+    ATOMLOG (_STR("--- Benchmark, context switch\n"));
+    ATOMLOG (_STR("--- Score : %lu ctxswc/S\n"), (unsigned long)(n * 2));
+
+    return (0);
+}
+
+
+/**
+ * \b bench_sem
+ *
+ * Semaphores put/get: a semaphore is posted and taken in a loop by the
+ * same thread, no context switch takes place.
+ *
+ * @retval Number of failures
+ */
+static int bench_sem (void)
+{
+    uint32_t start, n;
+
+    n = 0;
+    start = bench_wait_tick ();
+    do
+    {
+        atomSemPut (&sem2);
+        atomSemGet (&sem2, 0);
+        atomSemPut (&sem2);
+        atomSemGet (&sem2, 0);
+        atomSemPut (&sem2);
+        atomSemGet (&sem2, 0);
+        atomSemPut (&sem2);
+        atomSemGet (&sem2, 0);
+        n += 4;
+    } while ((atomTimeGet() - start) < BENCH_TICKS);
+    ATOMLOG (_STR("--- Benchmark, semaphores put/get\n"));
+    ATOMLOG (_STR("--- Score : %lu put+get/S\n"), (unsigned long)n);
+
+    return (0);
+}
+
+
+/**
+ * \b bench_sem_trip
+ *
+ * Semaphore round trip: the benchmark thread posts a semaphore to a
+ * lower priority thread and waits for the reply on a second semaphore.
+ *
+ * @retval Number of failures
+ */
+static int bench_sem_trip (void)
+{
+    uint32_t start, n;
+
+    if (atomThreadCreate(&tcb[1], TEST_THREAD_PRIO + 1, sem_thread_func, 0,
+          &bench_thread_stack[1][TEST_THREAD_STACK_SIZE - 1],
+          TEST_THREAD_STACK_SIZE) != ATOM_OK)
+    {
+        ATOMLOG (_STR("Error creating test thread\n"));
+        return (1);
+    }
+
+    n = 0;
+    start = bench_wait_tick ();
+    do
+    {
+        atomSemPut (&sem3);
+        atomSemGet (&sem4, 0);
+        n++;
+    } while ((atomTimeGet() - start) < BENCH_TICKS);
+    ATOMLOG (_STR("--- Benchmark, semaphore round trip\n"));
+    ATOMLOG (_STR("--- Score : %lu trips/S, %lu ctxswc/S\n"),
+        (unsigned long)n, (unsigned long)(n * 2));
+
+    return (0);
+}
+
+
+/**
+ * \b bench_queue_trip
+ *
+ * Queue round trip: the benchmark thread sends a message to a lower
+ * priority thread and waits for the reply on a second queue.
+ *
+ * @retval Number of failures
+ */
+static int bench_queue_trip (void)
+{
+    uint32_t start, n;
+    uint32_t msg;
+
+    if (atomThreadCreate(&tcb[2], TEST_THREAD_PRIO + 1, queue_thread_func, 0,
+          &bench_thread_stack[2][TEST_THREAD_STACK_SIZE - 1],
+          TEST_THREAD_STACK_SIZE) != ATOM_OK)
+    {
+        ATOMLOG (_STR("Error creating test thread\n"));
+        return (1);
+    }
+
+    n = 0;
+    msg = 0;
+    start = bench_wait_tick ();
+    do
+    {
+        atomQueuePut (&queue1, 0, (uint8_t *)&msg);
+        atomQueueGet (&queue2, 0, (uint8_t *)&msg);
+        n++;
+    } while ((atomTimeGet() - start) < BENCH_TICKS);
+    ATOMLOG (_STR("--- Benchmark, queue round trip\n"));
+    ATOMLOG (_STR("--- Score : %lu trips/S, %lu ctxswc/S\n"),
+        (unsigned long)n, (unsigned long)(n * 2));
+
+    if (msg != n)
+    {
+        ATOMLOG (_STR("Queue data mismatch\n"));
+        return (1);
+    }
+    return (0);
+}
+
+
+/**
+ * \b bench_timer
+ *
+ * Timer tick: increasing numbers of lower priority threads are suspended
+ * on a semaphore with a timeout, each one holding a registered timer, and
+ * the cost of the system tick handler is measured. The timeouts never
+ * expire during the benchmark.
+ *
+ * @retval Number of failures
+ */
+static int bench_timer (void)
+{
+    int armed, target;
+
+    armed = 0;
+    for (target = 0; target <= NUM_TIMER_THREADS; target = (target ? target * 4 : 16))
+    {
+        /* Create the additional threads */
+        while (armed < target)
+        {
+            if (atomThreadCreate(&timer_tcb[armed], TEST_THREAD_PRIO + 1,
+                  timer_thread_func, 0,
+                  &timer_thread_stack[armed][TEST_THREAD_STACK_SIZE - 1],
+                  TEST_THREAD_STACK_SIZE) != ATOM_OK)
+            {
+                ATOMLOG (_STR("Error creating test thread\n"));
+                return (1);
+            }
+            armed++;
+        }
+
+        /* Let the new threads run and suspend on the semaphore */
+        atomTimerDelay (2);
+
+        ATOMLOG (_STR("--- Benchmark, timer tick, %d timeouts armed\n"), armed);
+        ATOMLOG (_STR("--- Score : %lu ticks/S\n"),
+            (unsigned long)bench_tick_rate ());
+    }
+
+    return (0);
+}
+
+
+/**
+ * \b bench_switch_ready
+ *
+ * Context switch with a loaded ready queue: increasing numbers of threads
+ * are ready to run at the same priority. Each one in turn posts a
+ * semaphore to a higher priority thread, which preempts it, and is
+ * queued behind all the other ready threads. When the higher priority
+ * thread suspends again the next ready thread is scheduled in.
+ *
+ * The cost of the ready queue operations performed by the scheduler on
+ * each of these switches is also measured on its own, without the port
+ * context switch overhead.
+ *
+ * @retval Number of failures
+ */
+static int bench_switch_ready (void)
+{
+    int ready, target, i;
+    uint32_t n;
+
+    if (atomThreadCreate(&tcb[3], TEST_THREAD_PRIO + 1, switch_thread_func,
+          1,
+          &bench_thread_stack[3][TEST_THREAD_STACK_SIZE - 1],
+          TEST_THREAD_STACK_SIZE) != ATOM_OK)
+    {
+        ATOMLOG (_STR("Error creating test thread\n"));
+        return (1);
+    }
+
+    /* Let it run and suspend on sem6 */
+    atomTimerDelay (1);
+
+    ready = 0;
+    for (target = 4; target <= NUM_READY_THREADS; target *= 4)
+    {
+        /* Release the threads stopped by the previous run */
+        for (i = 0; i < ready; i++)
+        {
+            atomSemPut (&sem7);
+        }
+
+        /* Create the additional threads */
+        ready_stop = FALSE;
+        while (ready < target)
+        {
+            if (atomThreadCreate(&ready_tcb[ready], TEST_THREAD_PRIO + 2,
+                  ready_thread_func, 0,
+                  &ready_thread_stack[ready][TEST_THREAD_STACK_SIZE - 1],
+                  TEST_THREAD_STACK_SIZE) != ATOM_OK)
+            {
+                ATOMLOG (_STR("Error creating test thread\n"));
+                return (1);
+            }
+            ready++;
+        }
+
+        /* All the threads are now on the ready queue */
+        ATOMLOG (_STR("--- Benchmark, ready queue, %d threads ready\n"), ready);
+        ATOMLOG (_STR("--- Score : %lu rotations/S\n"),
+            (unsigned long)bench_rotate_rate ());
+
+        /* Let the lower priority threads run for the benchmark duration */
+        (void)bench_wait_tick ();
+        ready_count = 0;
+        atomTimerDelay (BENCH_TICKS);
+        n = ready_count;
+
+        /* Stop the threads, they block on sem7 */
+        ready_stop = TRUE;
+        atomTimerDelay (2);
+
+        ATOMLOG (_STR("--- Benchmark, context switch, %d threads ready\n"), ready);
+        ATOMLOG (_STR("--- Score : %lu ctxswc/S\n"), (unsigned long)(n * 2));
+    }
+
+    return (0);
+}
+
+
+/**
+ * \b bench_wait_tick
+ *
+ * Waits for the start of a new system tick.
+ *
+ * @retval The current system time
+ */
+static uint32_t bench_wait_tick (void)
+{
+    uint32_t now;
+
+    now = atomTimeGet ();
+    while (atomTimeGet () == now)
+        ;
+    return (now + 1);
+}
+
+
+/**
+ * \b bench_tick_rate
+ *
+ * Measures the rate of the system tick handler.
+ *
+ * The handler is called TIMER_BENCH_TICKS times in a row with the real
+ * system tick locked out and timed using the host monotonic clock. The
+ * system time is restored afterwards.
+ *
+ * @retval Number of system ticks per second
+ */
+static uint32_t bench_tick_rate (void)
+{
+    CRITICAL_STORE;
+    struct timespec t0, t1;
+    uint32_t now, i;
+    uint64_t ns;
+
+    CRITICAL_START ();
+    now = atomTimeGet ();
+    clock_gettime (CLOCK_MONOTONIC, &t0);
+    for (i = 0; i < TIMER_BENCH_TICKS; i++)
+    {
+        atomTimerTick ();
+    }
+    clock_gettime (CLOCK_MONOTONIC, &t1);
+    atomTimeSet (now);
+    CRITICAL_END ();
+
+    ns = (uint64_t)(t1.tv_sec - t0.tv_sec) * 1000000000
+         + (uint64_t)t1.tv_nsec - (uint64_t)t0.tv_nsec;
+    if (ns == 0)
+    {
+        ns = 1;
+    }
+    return ((uint32_t)((uint64_t)TIMER_BENCH_TICKS * 1000000000 / ns));
+}
+
+
+/**
+ * \b bench_rotate_rate
+ *
+ * Measures the rate of ready queue rotations, as performed by the
+ * scheduler when a thread is preempted and the next thread of the same
+ * priority is scheduled in. The thread at the head of the ready queue is
+ * dequeued and enqueued again behind the other threads of its priority
+ * READY_BENCH_ROTATIONS times with the system tick locked out, timed
+ * using the host monotonic clock.
+ *
+ * @retval Number of rotations per second
+ */
+static uint32_t bench_rotate_rate (void)
+{
+    CRITICAL_STORE;
+    struct timespec t0, t1;
+    ATOM_TCB *tcb_ptr;
+    uint32_t i;
+    uint64_t ns;
+
+    CRITICAL_START ();
+    clock_gettime (CLOCK_MONOTONIC, &t0);
+    for (i = 0; i < READY_BENCH_ROTATIONS; i++)
+    {
+        tcb_ptr = tcbDequeueReady (255);
+        (void)tcbEnqueueReady (tcb_ptr);
+    }
+    clock_gettime (CLOCK_MONOTONIC, &t1);
+    CRITICAL_END ();
+
+    ns = (uint64_t)(t1.tv_sec - t0.tv_sec) * 1000000000
+         + (uint64_t)t1.tv_nsec - (uint64_t)t0.tv_nsec;
+    if (ns == 0)
+    {
+        ns = 1;
+    }
+    return ((uint32_t)((uint64_t)READY_BENCH_ROTATIONS * 1000000000 / ns));
+}
+
+
+/**
+ * \b switch_thread_func
+ *
+ * Context switch benchmark thread, waits on a semaphore forever.
+ *
+ * @param[in] param Zero to wait on sem1, non-zero to wait on sem6
+ *
+ * @return None
+ */
+static void switch_thread_func (uint32_t param)
+{
+    ATOM_SEM *sem;
+
+    sem = param ? &sem6 : &sem1;
+
+    while (1)
+    {
+        atomSemGet (sem, 0);
+    }
+}
+
+
+/**
+ * \b sem_thread_func
+ *
+ * Semaphore round trip benchmark thread, replies on sem4 to each post
+ * of sem3.
+ *
+ * @param[in] param Unused (optional thread entry parameter)
+ *
+ * @return None
+ */
+static void sem_thread_func (uint32_t param)
+{
+    /* Compiler warning */
+    param = param;
+
+    while (1)
+    {
+        atomSemGet (&sem3, 0);
+        atomSemPut (&sem4);
+    }
+}
+
+
+/**
+ * \b queue_thread_func
+ *
+ * Queue round trip benchmark thread, returns each message received on
+ * queue1 incremented on queue2.
+ *
+ * @param[in] param Unused (optional thread entry parameter)
+ *
+ * @return None
+ */
+static void queue_thread_func (uint32_t param)
+{
+    uint32_t msg;
+
+    /* Compiler warning */
+    param = param;
+
+    while (1)
+    {
+        atomQueueGet (&queue1, 0, (uint8_t *)&msg);
+        msg++;
+        atomQueuePut (&queue2, 0, (uint8_t *)&msg);
+    }
+}
+
+
+/**
+ * \b timer_thread_func
+ *
+ * Timer benchmark thread, waits on sem5 with a timeout forever.
+ *
+ * @param[in] param Unused (optional thread entry parameter)
+ *
+ * @return None
+ */
+static void timer_thread_func (uint32_t param)
+{
+    /* Compiler warning */
+    param = param;
+
+    while (1)
+    {
+        atomSemGet (&sem5, TIMER_BENCH_TIMEOUT);
+    }
+}
+
+
+/**
+ * \b ready_thread_func
+ *
+ * Ready queue switch benchmark thread, posts sem6 in a loop until the
+ * benchmark is stopped, then waits on sem7 for the next run.
+ *
+ * @param[in] param Unused (optional thread entry parameter)
+ *
+ * @return None
+ */
+static void ready_thread_func (uint32_t param)
+{
+    /* Compiler warning */
+    param = param;
+
+    while (1)
+    {
+        if (ready_stop)
+        {
+            atomSemGet (&sem7, 0);
+        }
+        else
+        {
+            atomSemPut (&sem6);
+            ready_count++;
+        }
+    }
+}
@@ -0,0 +1,300 @@
+/*
+ * Copyright (c) 2010, Kelvin Lawson. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. No personal names or organizations' names associated with the
+ *    Atomthreads project may be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE ATOMTHREADS PROJECT AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE PROJECT OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <errno.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <sys/time.h>
+#include <ucontext.h>
+
+#include "atom.h"
+#include "atomport-private.h"
+
+
+/** Set containing the system tick signal, used for critical regions */
+sigset_t posixTickSigSet;
+
+
+/** Forward declarations */
+static void thread_shell (void);
+static void posix_tick_handler (int signum);
+
+
+/**
+ * \b thread_shell
+ *
+ * Shell routine which is used to call all thread entry points.
+ *
+ * The initial context of every thread is created by makecontext(), which
+ * can only pass int-sized arguments to the entry function, so as on the
+ * AVR port the entry point and parameter are instead taken from the TCB.
+ *
+ * New threads are restored with the system tick signal blocked, exactly
+ * like interrupts are disabled when a thread is first restored on the
+ * embedded ports. The signal is unblocked here before calling the
+ * thread entry point.
+ *
+ * @return None
+ */
+static void thread_shell (void)
+{
+    ATOM_TCB *curr_tcb;
+
+    /* Get the TCB of the thread being started */
+    curr_tcb = atomCurrentContext();
+
+    /**
+     * Enable interrupts - the system tick signal is blocked when a thread
+     * is first restored.
+     */
+    sigprocmask (SIG_UNBLOCK, &posixTickSigSet, NULL);
+
+    /* Call the thread entry point */
+    if (curr_tcb && curr_tcb->entry_point)
+    {
+        curr_tcb->entry_point(curr_tcb->entry_param);
+    }
+
+    /* Not reached - threads should never return from the entry point */
+
+}
+
+
+/**
+ * \b archThreadContextInit
+ *
+ * Architecture-specific thread context initialisation routine.
+ *
+ * The thread context is a ucontext_t which is placed at the top of the
+ * thread's own stack, below it the rest of the stack area is handed to
+ * makecontext() for use as the thread stack. The TCB sp_save_ptr points
+ * to the context, which is saved and restored by swapcontext().
+ *
+ * makecontext() needs the base and size of the stack area, which are only
+ * available in the TCB when ATOM_STACK_CHECKING is defined. This port
+ * therefore always enables stack-checking in atomport.h.
+ *
+ * @param[in] tcb_ptr Pointer to the TCB of the thread being created
+ * @param[in] stack_top Pointer to the top of the new thread's stack
+ * @param[in] entry_point Pointer to the thread entry point function
+ * @param[in] entry_param Parameter to be passed to the thread entry point
+ *
+ * @return None
+ */
+void archThreadContextInit (ATOM_TCB *tcb_ptr, void *stack_top, void (*entry_point)(uint32_t), uint32_t entry_param)
+{
+    ucontext_t *context;
+    uint8_t *stack_base;
+
+    /* Entry point and parameter are taken from the TCB by thread_shell() */
+    (void)entry_point;
+    (void)entry_param;
+
+    /**
+     * Place the context save area at the top of the stack, aligned to
+     * 16 bytes which satisfies the alignment of the FPU state.
+     */
+    context = (ucontext_t *)(((uintptr_t)stack_top + 1 - sizeof(ucontext_t))
+                  & ~(uintptr_t)15);
+    stack_base = (uint8_t *)stack_top - (tcb_ptr->stack_size - 1);
+
+    /* Initialise the context from the current one */
+    getcontext (context);
+
+    /* The stack is the area below the context save area */
+    context->uc_link = NULL;
+    context->uc_stack.ss_sp = stack_base;
+    context->uc_stack.ss_size = (size_t)((uint8_t *)context - stack_base);
+    context->uc_stack.ss_flags = 0;
+
+    /* New threads start with interrupts disabled, see thread_shell() */
+    sigaddset (&context->uc_sigmask, POSIX_TICK_SIGNAL);
+
+    /* All threads are started via thread_shell() */
+    makecontext (context, thread_shell, 0);
+
+    /**
+     * All thread context has now been initialised. Save the context
+     * pointer to the thread's TCB so it knows where to start looking
+     * when the thread is started.
+     */
+    tcb_ptr->sp_save_ptr = context;
+
+}
+
+
+/**
+ * \b archContextSwitch
+ *
+ * Architecture-specific context switch routine.
+ *
+ * Saves the context of the old thread and restores the context of the
+ * new thread. Called with the system tick signal blocked, which is saved
+ * and restored as part of the signal mask in the context so the new
+ * thread resumes inside its own critical region.
+ *
+ * The switch may also take place from within the system tick handler, in
+ * which case the handler completes when the interrupted thread is
+ * scheduled back in. For this reason the handler is not run on an
+ * alternate signal stack, each thread's stack must accommodate it.
+ *
+ * @param[in] old_tcb_ptr Pointer to the TCB of the thread being scheduled out
+ * @param[in] new_tcb_ptr Pointer to the TCB of the thread being scheduled in
+ *
+ * @return None
+ */
+void archContextSwitch (ATOM_TCB *old_tcb_ptr, ATOM_TCB *new_tcb_ptr)
+{
+    swapcontext ((ucontext_t *)old_tcb_ptr->sp_save_ptr,
+                 (ucontext_t *)new_tcb_ptr->sp_save_ptr);
+}
+
+
+/**
+ * \b archFirstThreadRestore
+ *
+ * Architecture-specific first thread restore routine.
+ *
+ * Restores the context of the first thread, the context of main() is
+ * discarded and never returned to.
+ *
+ * @param[in] new_tcb_ptr Pointer to the TCB of the thread being restored
+ *
+ * @return None
+ */
+void archFirstThreadRestore (ATOM_TCB *new_tcb_ptr)
+{
+    setcontext ((ucontext_t *)new_tcb_ptr->sp_save_ptr);
+}
+
+
+/**
+ * \b posixInitSystemTickTimer
+ *
+ * Initialise the system tick timer. Uses the ITIMER_REAL interval timer
+ * which raises SIGALRM on every system tick.
+ *
+ * The tick signal is blocked on return, it is unblocked when the first
+ * thread is restored in the same way as interrupts are enabled on the
+ * embedded ports.
+ *
+ * @return None
+ */
+void posixInitSystemTickTimer ( void )
+{
+    struct sigaction sa;
+    struct itimerval itv;
+
+    /* Interrupts disabled until the OS is started */
+    sigemptyset (&posixTickSigSet);
+    sigaddset (&posixTickSigSet, POSIX_TICK_SIGNAL);
+    sigprocmask (SIG_BLOCK, &posixTickSigSet, NULL);
+
+    /* Install the system tick handler */
+    sa.sa_handler = posix_tick_handler;
+    sa.sa_mask = posixTickSigSet;
+    sa.sa_flags = SA_RESTART;
+    sigaction (POSIX_TICK_SIGNAL, &sa, NULL);
+
+    /* Start the periodic timer */
+    itv.it_interval.tv_sec = 0;
+    itv.it_interval.tv_usec = 1000000 / SYSTEM_TICKS_PER_SEC;
+    itv.it_value = itv.it_interval;
+    setitimer (ITIMER_REAL, &itv, NULL);
+}
+
+
+/**
+ *
+ * System tick handler.
+ *
+ * This is responsible for regularly calling the OS system tick handler.
+ * The system tick handler checks if any timer callbacks are necessary,
+ * and runs the scheduler.
+ *
+ * As with all interrupts, the handler calls atomIntEnter() and
+ * atomIntExit() on entry and exit, scheduling decisions are deferred
+ * until the handler has completed.
+ *
+ * @param[in] signum Unused (signal number)
+ *
+ * @return None
+ */
+static void posix_tick_handler (int signum)
+{
+    int saved_errno;
+
+    /* Compiler warning */
+    (void)signum;
+
+    /* The interrupted thread may be inside a system call */
+    saved_errno = errno;
+
+    /* Call the interrupt entry routine */
+    atomIntEnter();
+
+    /* Call the OS system tick handler */
+    atomTimerTick();
+
+    /* Call the interrupt exit routine */
+    atomIntExit(TRUE);
+
+    errno = saved_errno;
+}
+
+
+/**
+ * \b posixLog
+ *
+ * Thread-safe printf().
+ *
+ * All threads share a single host thread so the C library stream locks do
+ * not protect against a thread switch in the middle of an output call.
+ * The system tick is blocked while printing instead.
+ *
+ * @param[in] format printf() format string
+ *
+ * @return Number of characters printed
+ */
+int posixLog (const char *format, ...)
+{
+    CRITICAL_STORE;
+    va_list args;
+    int count;
+
+    CRITICAL_START ();
+    va_start (args, format);
+    count = vprintf (format, args);
+    va_end (args);
+    fflush (stdout);
+    CRITICAL_END ();
+
+    return (count);
+}
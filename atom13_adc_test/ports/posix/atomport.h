@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2010, Kelvin Lawson. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. No personal names or organizations' names associated with the
+ *    Atomthreads project may be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE ATOMTHREADS PROJECT AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE PROJECT OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __ATOM_PORT_H
+#define __ATOM_PORT_H
+
+#include <signal.h>
+#include <stddef.h>
+
+/* Portable uint8_t and friends available from stdint.h on this platform */
+#include <stdint.h>
+
+
+/* Required number of system ticks per second (normally 100 for 10ms tick) */
+#define SYSTEM_TICKS_PER_SEC            100
+
+
+/**
+ * Architecture-specific types.
+ * Most of these are available from stdint.h on this platform, which is
+ * included above.
+ */
+#define POINTER void *
+
+
+/**
+ * Critical region protection.
+ *
+ * The system tick is delivered as a signal, so interrupt lockouts are
+ * implemented by blocking the tick signal in the process signal mask.
+ * The previous mask is saved so that critical regions can nest.
+ */
+extern sigset_t posixTickSigSet;
+
+#define CRITICAL_STORE      sigset_t posix_sigmask
+#define CRITICAL_START()    sigprocmask(SIG_BLOCK, &posixTickSigSet, &posix_sigmask)
+#define CRITICAL_END()      sigprocmask(SIG_SETMASK, &posix_sigmask, NULL)
+
+
+/**
+ * Stack-checking is always enabled on this port: the thread context is
+ * created using makecontext() which needs to know the base and size of the
+ * thread stack, and these are only stored in the TCB when stack-checking
+ * is enabled.
+ */
+#ifndef ATOM_STACK_CHECKING
+#define ATOM_STACK_CHECKING
+#endif
+
+
+#endif /* __ATOM_PORT_H */
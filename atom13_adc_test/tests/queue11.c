@@ -0,0 +1,393 @@
+/*
+ * Copyright (c) 2010, Kelvin Lawson. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. No personal names or organizations' names associated with the
+ *    Atomthreads project may be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE ATOMTHREADS PROJECT AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE PROJECT OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "atom.h"
+#include "atomqueue.h"
+#include "atomtests.h"
+
+
+/* Test queue size */
+#define QUEUE_ENTRIES       4
+
+/* Test message size */
+#define MSG_SIZE            16
+
+
+/* Number of test threads */
+#define NUM_TEST_THREADS      1
+
+
+/* Test OS objects */
+static ATOM_QUEUE queue1;
+static uint8_t queue1_storage[QUEUE_ENTRIES][MSG_SIZE];
+static ATOM_TCB tcb[NUM_TEST_THREADS];
+static uint8_t test_thread_stack[NUM_TEST_THREADS][TEST_THREAD_STACK_SIZE];
+
+
+/* Test result tracking */
+static volatile int g_result;
+
+
+/* Forward declarations */
+static void test1_thread_func (uint32_t param);
+static void fill_msg (uint8_t *slot_ptr, uint8_t value);
+static int check_msg (uint8_t *slot_ptr, uint8_t value);
+
+
+/**
+ * \b test_start
+ *
+ * Start queue test.
+ *
+ * This tests the zero-copy queue APIs.
+ *
+ * Messages are written in place into slots obtained with atomQueueReserve()
+ * and read in place from slots obtained with atomQueuePeek(). Checks that
+ * messages only become available once all earlier reservations have been
+ * committed, that slots only become free once all earlier peeks have been
+ * released, that the zero-copy and copying APIs can be mixed, and that a
+ * thread blocking in atomQueuePeek() is woken by a commit.
+ *
+ * We test using 16-byte messages.
+ *
+ * @retval Number of failures
+ */
+uint32_t test_start (void)
+{
+    int failures, count;
+    uint8_t *slot_ptr[QUEUE_ENTRIES];
+    uint8_t *peek_ptr;
+    uint8_t msg[MSG_SIZE];
+
+    /* Default to zero failures */
+    failures = 0;
+    g_result = 0;
+
+    /* Create test queue */
+    if (atomQueueCreate (&queue1, &queue1_storage[0][0], MSG_SIZE, QUEUE_ENTRIES) != ATOM_OK)
+    {
+        ATOMLOG (_STR("Error creating test queue\n"));
+        failures++;
+    }
+    else
+    {
+        /* Commit and release with nothing outstanding should fail */
+        if (atomQueueCommit (&queue1) != ATOM_ERR_PARAM)
+        {
+            ATOMLOG (_STR("Commit nothing\n"));
+            failures++;
+        }
+        if (atomQueueRelease (&queue1) != ATOM_ERR_PARAM)
+        {
+            ATOMLOG (_STR("Release nothing\n"));
+            failures++;
+        }
+
+        /* Reserve two slots, check they are consecutive in the storage */
+        if ((atomQueueReserve (&queue1, -1, &slot_ptr[0]) != ATOM_OK)
+            || (atomQueueReserve (&queue1, -1, &slot_ptr[1]) != ATOM_OK))
+        {
+            ATOMLOG (_STR("Failed reserve\n"));
+            failures++;
+        }
+        else if ((slot_ptr[0] != &queue1_storage[0][0])
+            || (slot_ptr[1] != &queue1_storage[1][0]))
+        {
+            ATOMLOG (_STR("Bad slot\n"));
+            failures++;
+        }
+        else
+        {
+            fill_msg (slot_ptr[0], 1);
+            fill_msg (slot_ptr[1], 2);
+
+            /* First commit, the second reservation is still outstanding */
+            if (atomQueueCommit (&queue1) != ATOM_OK)
+            {
+                ATOMLOG (_STR("Failed commit\n"));
+                failures++;
+            }
+            if (atomQueuePeek (&queue1, -1, &peek_ptr) != ATOM_WOULDBLOCK)
+            {
+                ATOMLOG (_STR("Early msg\n"));
+                failures++;
+            }
+
+            /* Second commit, both messages should now be available */
+            if (atomQueueCommit (&queue1) != ATOM_OK)
+            {
+                ATOMLOG (_STR("Failed commit\n"));
+                failures++;
+            }
+            for (count = 1; count <= 2; count++)
+            {
+                if (atomQueuePeek (&queue1, -1, &peek_ptr) != ATOM_OK)
+                {
+                    ATOMLOG (_STR("Failed peek\n"));
+                    failures++;
+                }
+                else if (check_msg (peek_ptr, (uint8_t)count) == 0)
+                {
+                    ATOMLOG (_STR("Val%d\n"), count);
+                    failures++;
+                }
+            }
+        }
+
+        /* Two slots are peeked, fill the other two using the copy API */
+        fill_msg (msg, 3);
+        if (atomQueuePut (&queue1, -1, msg) != ATOM_OK)
+        {
+            ATOMLOG (_STR("Failed post\n"));
+            failures++;
+        }
+        fill_msg (msg, 4);
+        if (atomQueuePut (&queue1, -1, msg) != ATOM_OK)
+        {
+            ATOMLOG (_STR("Failed post\n"));
+            failures++;
+        }
+        if (atomQueueReserve (&queue1, -1, &slot_ptr[0]) != ATOM_WOULDBLOCK)
+        {
+            ATOMLOG (_STR("Not full\n"));
+            failures++;
+        }
+
+        /* Release the first peek, the second is still outstanding */
+        if (atomQueueRelease (&queue1) != ATOM_OK)
+        {
+            ATOMLOG (_STR("Failed release\n"));
+            failures++;
+        }
+        if (atomQueueReserve (&queue1, -1, &slot_ptr[0]) != ATOM_WOULDBLOCK)
+        {
+            ATOMLOG (_STR("Early free\n"));
+            failures++;
+        }
+
+        /* Release the second peek, both slots should now be free */
+        if (atomQueueRelease (&queue1) != ATOM_OK)
+        {
+            ATOMLOG (_STR("Failed release\n"));
+            failures++;
+        }
+        for (count = 5; count <= 6; count++)
+        {
+            if (atomQueueReserve (&queue1, -1, &slot_ptr[0]) != ATOM_OK)
+            {
+                ATOMLOG (_STR("Failed reserve\n"));
+                failures++;
+            }
+            else
+            {
+                fill_msg (slot_ptr[0], (uint8_t)count);
+                if (atomQueueCommit (&queue1) != ATOM_OK)
+                {
+                    ATOMLOG (_STR("Failed commit\n"));
+                    failures++;
+                }
+            }
+        }
+
+        /* Drain the queue using the copy API */
+        for (count = 3; count <= 6; count++)
+        {
+            if (atomQueueGet (&queue1, -1, msg) != ATOM_OK)
+            {
+                ATOMLOG (_STR("Failed get\n"));
+                failures++;
+            }
+            else if (check_msg (msg, (uint8_t)count) == 0)
+            {
+                ATOMLOG (_STR("Val%d\n"), count);
+                failures++;
+            }
+        }
+
+        /* Create a higher priority thread that will block on the empty queue */
+        if (atomThreadCreate(&tcb[0], TEST_THREAD_PRIO - 1, test1_thread_func, 0,
+              &test_thread_stack[0][TEST_THREAD_STACK_SIZE - 1],
+              TEST_THREAD_STACK_SIZE) != ATOM_OK)
+        {
+            ATOMLOG (_STR("Error creating test thread 1\n"));
+            failures++;
+        }
+        else
+        {
+            /* Send a message in place, the commit should wake the thread */
+            if (atomQueueReserve (&queue1, 0, &slot_ptr[0]) != ATOM_OK)
+            {
+                ATOMLOG (_STR("Failed reserve\n"));
+                failures++;
+            }
+            else
+            {
+                fill_msg (slot_ptr[0], 7);
+                if (atomQueueCommit (&queue1) != ATOM_OK)
+                {
+                    ATOMLOG (_STR("Failed commit\n"));
+                    failures++;
+                }
+            }
+
+            /* The thread should have run and released the slot already */
+            if (g_result != 1)
+            {
+                ATOMLOG (_STR("Not woken\n"));
+                failures++;
+            }
+        }
+    }
+
+    /* Check thread stack usage (if enabled) */
+#ifdef ATOM_STACK_CHECKING
+    {
+        uint32_t used_bytes, free_bytes;
+        int thread;
+
+        /* Check all threads */
+        for (thread = 0; thread < NUM_TEST_THREADS; thread++)
+        {
+            /* Check thread stack usage */
+            if (atomThreadStackCheck (&tcb[thread], &used_bytes, &free_bytes) != ATOM_OK)
+            {
+                ATOMLOG (_STR("StackCheck\n"));
+                failures++;
+            }
+            else
+            {
+                /* Check the thread did not use up to the end of stack */
+                if (free_bytes == 0)
+                {
+                    ATOMLOG (_STR("StackOverflow %d\n"), thread);
+                    failures++;
+                }
+
+                /* Log the stack usage */
+#ifdef TESTS_LOG_STACK_USAGE
+                ATOMLOG (_STR("StackUse:%d\n"), (int)used_bytes);
+#endif
+            }
+        }
+    }
+#endif
+
+    /* Quit */
+    return failures;
+}
+
+
+/**
+ * \b test1_thread_func
+ *
+ * Entry point for test thread 1.
+ *
+ * @param[in] param Unused (optional thread entry parameter)
+ *
+ * @return None
+ */
+static void test1_thread_func (uint32_t param)
+{
+    uint8_t *peek_ptr;
+
+    /* Compiler warnings */
+    param = param;
+
+    /* Block waiting for a message, check it in place and release it */
+    if (atomQueuePeek (&queue1, 0, &peek_ptr) != ATOM_OK)
+    {
+        ATOMLOG (_STR("Failed peek\n"));
+    }
+    else if (check_msg (peek_ptr, 7) == 0)
+    {
+        ATOMLOG (_STR("Val7\n"));
+    }
+    else if (atomQueueRelease (&queue1) != ATOM_OK)
+    {
+        ATOMLOG (_STR("Failed release\n"));
+    }
+    else
+    {
+        /* No failures */
+        g_result = 1;
+    }
+
+    /* Wait forever */
+    while (1)
+    {
+        atomTimerDelay (SYSTEM_TICKS_PER_SEC);
+    }
+}
+
+
+/**
+ * \b fill_msg
+ *
+ * Fills a test message with a pattern derived from \c value.
+ *
+ * @param[out] slot_ptr Message to fill
+ * @param[in] value Pattern seed
+ *
+ * @return None
+ */
+static void fill_msg (uint8_t *slot_ptr, uint8_t value)
+{
+    int i;
+
+    for (i = 0; i < MSG_SIZE; i++)
+    {
+        slot_ptr[i] = (uint8_t)(value + i);
+    }
+}
+
+
+/**
+ * \b check_msg
+ *
+ * Checks a test message against the pattern derived from \c value.
+ *
+ * @param[in] slot_ptr Message to check
+ * @param[in] value Pattern seed
+ *
+ * @retval 1 if the message matches, 0 otherwise
+ */
+static int check_msg (uint8_t *slot_ptr, uint8_t value)
+{
+    int i;
+
+    for (i = 0; i < MSG_SIZE; i++)
+    {
+        if (slot_ptr[i] != (uint8_t)(value + i))
+        {
+            return (0);
+        }
+    }
+    return (1);
+}
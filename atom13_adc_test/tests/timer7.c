@@ -28,6 +28,7 @@
  */
 
 
+#include <stddef.h>
 #include "atom.h"
 #include "atomtests.h"
 
@@ -159,7 +160,7 @@ static void testCallback (POINTER cb_data)
     int expected_order;
 
     /* Pull out the expected ordere */
-    expected_order = (int)cb_data;
+    expected_order = (int)(size_t)cb_data;
 
     /* Store our callback order in cb_order[] */
     cb_order[cb_cnt] = expected_order;